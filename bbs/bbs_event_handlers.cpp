@@ -24,6 +24,7 @@
 #include "core/eventbus.h"
 #include "core/os.h"
 #include "core/strings.h"
+#include "local_io/local_io.h"
 #include "instmsg.h"
 #include "multinst.h"
 #include "utility.h"
@@ -60,6 +61,8 @@ static void CheckForHangup() {
 }
 
 static void GiveupTimeSlices() {
+  // Batched local screen output is otherwise only shown on the next write.
+  bout.localIO()->Flush();
   yield();
   if (inst_msg_waiting() && (!a()->sess().in_chatroom() || !a()->sess().chatline())) {
     process_inst_msgs();
@@ -291,6 +291,9 @@ int f_action(int start_pos, int end_pos, char* aword) {
 
 // Sends out a raw_message to everyone in channel LOC
 static void out_msg(const std::string& message, int loc) {
+  if (send_chat_channel_str(loc, message)) {
+    return;
+  }
   for (auto i = 1; i <= num_instances(); i++) {
     auto ir = a()->instances().at(i);
     if (ir.loc_code() == loc && i != a()->sess().instance_number()) {
@@ -412,6 +415,15 @@ int main_loop(const char* raw_message, char* from_message, char* color_string, c
 // Fills an array with information of who's online.
 std::vector<int> who_online(int loc) {
   std::vector<int> r{};
+  if (const auto members = chat_channel_members(loc)) {
+    // Only the instances in the channel need to be checked.
+    for (const auto i : members.value()) {
+      if (!a()->instances().at(i).invisible() || so()) {
+        r.emplace_back(i);
+      }
+    }
+    return r;
+  }
   for (auto i = 1; i <= wwiv::stl::size_int(a()->instances()); i++) {
     const auto ir = a()->instances().at(i);
     if (!ir.invisible() || so()) {
@@ -466,12 +478,7 @@ void ch_direct(const std::string& message, int loc, char* color_string, int node
     a()->users()->readuser(&u, ir.user_number());
     const auto s = fmt::sprintf("|#9From %.12s|#6 [to %s]|#1: %s%s", a()->user()->name(),
                                 u.name(), color_string, message);
-    for (auto i = 1; i <= num_instances(); i++) {
-      ir = a()->instances().at(i);
-      if (ir.loc_code() == loc && i != a()->sess().instance_number()) {
-        send_inst_str(i, s);
-      }
-    }
+    out_msg(s, loc);
     bout.print("|#1[|#9Message directed to {}|#1\r\n", u.name());
   } else {
     bout.outstr(message);
@@ -708,6 +715,9 @@ void exec_action(const char* message, char* color_string, int loc, int nact) {
     }
     sprintf(tmsg, actions[nact]->toall, a()->user()->GetName(), oa.value().GetName());
     sprintf(final, "%s%s", color_string, tmsg);
+    if (send_chat_channel_str(loc, final, p)) {
+      return;
+    }
     for (int c = 1; c <= num_instances(); c++) {
       const auto ir = a()->instances().at(c);
       if (ir.loc_code() == loc && c != a()->sess().instance_number() && c != p) {
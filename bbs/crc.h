@@ -18,12 +18,9 @@
 #ifndef INCLUDED_BBS_CRC_H
 #define INCLUDED_BBS_CRC_H
 
-#include <cstddef>
 #include <cstdint>
 
-unsigned long int crc32buf(const char *buffer, std::size_t nLength);
-
-// used by old sr.cpp and friends.
+// The XModem CRC-16 used by old sr.cpp and friends, see core/crc.h
 extern uint16_t crc;
 
 #endif  // INCLUDED_BBS_CRC_H
@@ -31,6 +31,7 @@
 #include "bbs/mmkey.h"
 #include "bbs/msgbase1.h"
 #include "bbs/newuser.h"
+#include "bbs/subacc.h"
 #include "bbs/sysoplog.h"
 #include "bbs/utility.h"
 #include "bbs/xfer.h"
@@ -1156,6 +1157,7 @@ void config_scan_plus(int type) {
         case 5:
           if (type == 0) {
             bool nextsub = false;
+            RefreshSubStats();
             qscan(static_cast<uint16_t>(top + pos), nextsub);
           } else {
             auto cudn_saved = a()->current_user_dir_num();
@@ -536,6 +536,7 @@ void dlboardedit() {
           if (bin.yesno()) {
             File::Remove(FilePath(a()->config()->datadir(), StrCat(fn, ".dir")));
             File::Remove(FilePath(a()->config()->datadir(), StrCat(fn, ".ext")));
+            File::Remove(FilePath(a()->config()->datadir(), StrCat(fn, ".exi")));
           }
         }
       }
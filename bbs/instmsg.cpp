@@ -28,12 +28,15 @@
 #include "core/os.h"
 #include "core/strings.h"
 #include "fmt/printf.h"
+#include "sdk/chat_bus.h"
 #include "sdk/config.h"
 #include "sdk/instance.h"
 #include "sdk/instance_message.h"
 #include "sdk/names.h"
 
+#include <algorithm>
 #include <chrono>
+#include <memory>
 #include <string>
 
 using std::chrono::seconds;
@@ -54,6 +57,20 @@ bool is_chat_invis() {
   return chat_invis; 
 }
 
+// Returns the chat channel bus, or nullptr if it is not available.
+static ChatBus* chat_bus() {
+  static std::unique_ptr<ChatBus> bus;
+  static auto initialized = false;
+  if (!initialized) {
+    initialized = true;
+    auto b = std::make_unique<ChatBus>(a()->config()->datadir(), a()->sess().instance_number());
+    if (*b) {
+      bus = std::move(b);
+    }
+  }
+  return bus.get();
+}
+
 void send_inst_str(int whichinst, const std::string& s) {
   send_instance_string(*a()->config(), instance_message_type_t::user, whichinst,
                        a()->sess().user_num(), a()->sess().instance_number(), s);
@@ -64,6 +81,25 @@ void send_inst_sysstr(int whichinst, const std::string& s) {
                        a()->sess().user_num(), a()->sess().instance_number(), s);
 }
 
+bool send_chat_channel_str(int loc, const std::string& s, int exclude_instance) {
+  auto* bus = chat_bus();
+  if (!bus) {
+    return false;
+  }
+  return bus->Send(loc, a()->sess().user_num(), s, exclude_instance);
+}
+
+std::optional<std::vector<int>> chat_channel_members(int loc) {
+  auto* bus = chat_bus();
+  if (!bus) {
+    return std::nullopt;
+  }
+  auto members = bus->members(loc);
+  const auto self = a()->sess().instance_number();
+  members.erase(std::remove(std::begin(members), std::end(members), self), std::end(members));
+  return {members};
+}
+
 /*
  * "Broadcasts" a message to all online instances.
  */
@@ -108,6 +144,12 @@ void process_inst_msgs() {
   last_iia = steady_clock::now();
   const auto oiia = setiia(std::chrono::milliseconds(0));
 
+  if (auto* bus = chat_bus()) {
+    for (const auto& m : bus->Receive()) {
+      handle_inst_msg(m);
+    }
+  }
+
   // Handle semaphores
   const auto sem_fnd = FilePath(a()->sess().dirs().scratch_directory(), "*.wwiv");
   FindFiles ffs(sem_fnd, FindFiles::FindFilesType::files, FindFiles::WinNameType::long_name);
@@ -155,6 +197,14 @@ std::optional<int> user_online(int user_number) {
 * some info about this instance.
 */
 void write_inst(int loc, int subloc, int flags) {
+  if (auto* bus = chat_bus()) {
+    if (loc >= INST_LOC_CH1 && loc <= INST_LOC_CH10) {
+      bus->Join(loc);
+    } else {
+      bus->Leave();
+    }
+  }
+
   static Instance ti(a()->config()->root_directory(), a()->config()->datadir(), a()->sess().instance_number());
 
   auto re_write = false;
@@ -257,6 +307,11 @@ void write_inst(int loc, int subloc, int flags) {
 bool inst_msg_waiting() {
   if (iia.count() == 0) return false;
 
+  // Chat lines are checked every time since that is only a read of shared memory.
+  if (auto* bus = chat_bus(); bus && bus->pending()) {
+    return true;
+  }
+
   const auto l = steady_clock::now();
   if ((l - last_iia) < iia) {
     return false;
@@ -22,6 +22,7 @@
 #include <chrono>
 #include <optional>
 #include <string>
+#include <vector>
 #include "sdk/instance.h"
 
 constexpr int INST_MSG_STRING = 1;  // A string to print out to the user
@@ -36,6 +37,11 @@ constexpr int INST_MSG_CHAT = 6;  // External chat request
 
 
 void send_inst_str(int whichinst, const std::string& send_string);
+// Sends message to the other instances in chat channel loc except exclude_instance.
+// Returns false if the chat bus is not available.
+bool send_chat_channel_str(int loc, const std::string& message, int exclude_instance = 0);
+// Returns the other instances in chat channel loc, or nullopt if the chat bus is not available.
+std::optional<std::vector<int>> chat_channel_members(int loc);
 void broadcast(const std::string& message);
 void process_inst_msgs();
 int  num_instances();
@@ -36,6 +36,7 @@
 #include "bbs/readmail.h"
 #include "bbs/shortmsg.h"
 #include "bbs/stuffin.h"
+#include "bbs/subacc.h"
 #include "bbs/sysoplog.h"
 #include "bbs/trashcan.h"
 #include "bbs/utility.h"
@@ -894,6 +895,7 @@ void logon() {
 
   if (a()->HasConfigFlag(OP_FLAGS_USE_FORCESCAN) && !done_newscan_all) {
     auto nextsub = false;
+    RefreshSubStats();
     if (a()->user()->sl() < 255) {
       a()->sess().forcescansub(true);
       qscan(a()->GetForcedReadSubNumber(), nextsub);
@@ -34,6 +34,11 @@
 #include "local_io/keycodes.h"
 #include "sdk/filenames.h"
 #include "sdk/files/files.h"
+#include "sdk/files/keyword_index.h"
+#include <algorithm>
+#include <iterator>
+#include <optional>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -42,12 +47,154 @@ using namespace wwiv::local::io;
 using namespace wwiv::stl;
 using namespace wwiv::strings;
 
+using wwiv::sdk::files::keyword_posting_t;
+using wwiv::sdk::files::KeywordIndex;
+
 // Local function prototypes
 int  compare_criteria(search_record * sr, uploadsrec * ur);
 bool lp_compare_strings(const char *raw, const char *formula);
-bool lp_compare_strings_wh(const char *raw, const char *formula, unsigned *pos, int size);
+template <typename Eval>
+typename Eval::value_type lp_compare_strings_wh(const Eval& eval, const char* formula,
+                                                unsigned* pos, int size);
 int  lp_get_token(const char *formula, unsigned *pos);
-int  lp_get_value(const char *raw, const char *formula, unsigned *pos);
+template <typename Eval>
+typename Eval::value_type lp_get_value(const Eval& eval, const char* formula, unsigned* pos);
+
+/**
+ * Evaluates a search formula against the text of a file.
+ */
+struct lp_text_eval {
+  using value_type = bool;
+  const char* raw;
+
+  [[nodiscard]] bool none() const { return false; }
+  [[nodiscard]] bool term(const std::string& text, bool sign) const {
+    return ifind_first(raw, text) == sign;
+  }
+  [[nodiscard]] bool group(bool inner, bool sign) const { return inner == sign; }
+  [[nodiscard]] bool both(bool l, bool r) const { return l && r; }
+  [[nodiscard]] bool either(bool l, bool r) const { return l || r; }
+};
+
+/**
+ * Evaluates a search formula using the file keyword index, giving the files
+ * which may match, or std::nullopt when any file may match (i.e. for negated
+ * terms, since the index only knows which files may contain a term).
+ */
+struct lp_keyword_eval {
+  using value_type = std::optional<std::vector<keyword_posting_t>>;
+  const KeywordIndex& index;
+
+  [[nodiscard]] value_type none() const { return std::vector<keyword_posting_t>{}; }
+  [[nodiscard]] value_type term(const std::string& text, bool sign) const {
+    if (!sign) {
+      return std::nullopt;
+    }
+    return index.Find(text);
+  }
+  [[nodiscard]] value_type group(value_type inner, bool sign) const {
+    if (!sign) {
+      return std::nullopt;
+    }
+    return inner;
+  }
+  [[nodiscard]] value_type both(value_type l, value_type r) const {
+    if (!l) {
+      return r;
+    }
+    if (!r) {
+      return l;
+    }
+    std::vector<keyword_posting_t> v;
+    std::set_intersection(std::begin(*l), std::end(*l), std::begin(*r), std::end(*r),
+                          std::back_inserter(v));
+    return v;
+  }
+  [[nodiscard]] value_type either(value_type l, value_type r) const {
+    if (!l || !r) {
+      return std::nullopt;
+    }
+    std::vector<keyword_posting_t> v;
+    std::set_union(std::begin(*l), std::end(*l), std::begin(*r), std::end(*r),
+                   std::back_inserter(v));
+    return v;
+  }
+};
+
+/**
+ * The files which may match the keywords being searched for, using the file
+ * keyword index, so the files which can't match (and their extended
+ * descriptions) don't need to be read.
+ */
+class lp_keyword_filter {
+public:
+  // Only the directories named in filenames, which are the ones being
+  // searched, are brought up to date in the index.
+  lp_keyword_filter(const search_record& sr, const std::vector<std::string>& filenames)
+      : formula_(sr.search) {
+    if (formula_.empty()) {
+      return;
+    }
+    index_ = &a()->fileapi()->keywords();
+    index_->Refresh(*a()->fileapi(), filenames);
+  }
+
+  /** True if any file in the directory named filename may match. */
+  bool may_match_dir(const std::string& filename) {
+    if (!update()) {
+      return true;
+    }
+    const auto area = index_->area_number(filename);
+    if (!area) {
+      return true;
+    }
+    const auto it = std::lower_bound(std::begin(*candidates_), std::end(*candidates_),
+                                     keyword_posting_t{area.value(), 0});
+    return it != std::end(*candidates_) && it->area == area.value();
+  }
+
+  /** True if the file numbered record in the current directory may match. */
+  bool may_match(int record) {
+    if (!update()) {
+      return true;
+    }
+    // Only trust the index if it still matches the directory when entering it.
+    if (const auto& filename = a()->dirs()[a()->udir[a()->current_user_dir_num()].subnum].filename;
+        filename != area_filename_) {
+      area_filename_ = filename;
+      area_ = index_->IsCurrent(filename) ? index_->area_number(filename) : std::nullopt;
+    }
+    if (!area_) {
+      return true;
+    }
+    return std::binary_search(std::begin(*candidates_), std::end(*candidates_),
+                              keyword_posting_t{area_.value(), static_cast<uint32_t>(record)});
+  }
+
+private:
+  // Evaluates the formula again if the index has changed, returning true if
+  // there are candidates to filter with.
+  bool update() {
+    if (!index_) {
+      return false;
+    }
+    if (generation_ != index_->generation()) {
+      unsigned pos = 0;
+      candidates_ = lp_compare_strings_wh(lp_keyword_eval{*index_}, formula_.c_str(), &pos,
+                                          ssize(formula_));
+      generation_ = index_->generation();
+    }
+    return candidates_.has_value();
+  }
+
+  const std::string formula_;
+  KeywordIndex* index_{nullptr};
+  int generation_{-1};
+  std::optional<std::vector<keyword_posting_t>> candidates_;
+  // The directory last checked by may_match and its area in the index.
+  std::string area_filename_;
+  std::optional<uint16_t> area_;
+};
 
 // These are defined in listplus.cpp
 extern int bulk_move;
@@ -127,24 +274,44 @@ int listfiles_plus_function(int type) {
   auto max_lines = calc_max_lines();
   auto all_done = false;
 
+  // When scanning many directories for new files or a filename, use the file
+  // catalog to skip the directories that can't contain a match.
+  std::optional<std::set<std::string>> candidates;
+  if (search_rec.alldirs != THIS_DIR &&
+      (search_rec.nscandate || search_rec.filemask != "        .   ")) {
+    candidates = file_areas_with_candidates(
+        search_rec.nscandate,
+        search_rec.filemask != "        .   " ? search_rec.filemask : std::string());
+  }
+  // The directories to search, before using the keyword index.
+  auto searches_dir = [&](uint16_t this_dir) {
+    if (search_rec.alldirs == THIS_DIR) {
+      return this_dir == save_dir;
+    }
+    const auto subnum = a()->udir[this_dir].subnum;
+    if (candidates && !candidates->count(a()->dirs()[subnum].filename)) {
+      return false;
+    }
+    return (a()->sess().qsc_n[subnum / 32] & (1L << (subnum % 32))) != 0 ||
+           (search_rec.alldirs == ALL_DIRS && type != LP_NSCAN_NSCAN);
+  };
+  std::vector<std::string> search_dirs;
+  for (uint16_t this_dir = 0; this_dir < a()->udir.size(); this_dir++) {
+    if (searches_dir(this_dir)) {
+      search_dirs.emplace_back(a()->dirs()[a()->udir[this_dir].subnum].filename);
+    }
+  }
+  lp_keyword_filter keywords(search_rec, search_dirs);
+
   for (uint16_t this_dir = 0; this_dir < a()->udir.size() && !a()->sess().hangup() && !all_done;
        this_dir++) {
     int also_this_dir = a()->udir[this_dir].subnum;
-    auto scan_dir = false;
     bin.checka(&all_done);
 
-    if (search_rec.alldirs == THIS_DIR) {
-      if (this_dir == save_dir) {
-        scan_dir = true;
-      }
-    } else {
-      if (a()->sess().qsc_n[also_this_dir / 32] & (1L << (also_this_dir % 32))) {
-        scan_dir = true;
-      }
-
-      if (search_rec.alldirs == ALL_DIRS && (type != LP_NSCAN_NSCAN)) {
-        scan_dir = true;
-      }
+    auto scan_dir = searches_dir(this_dir);
+    if (scan_dir && search_rec.alldirs != THIS_DIR &&
+        !keywords.may_match_dir(a()->dirs()[also_this_dir].filename)) {
+      scan_dir = false;
     }
 
     int save_first_file = 0;
@@ -168,7 +335,8 @@ int listfiles_plus_function(int type) {
           bool force_menu = false;
           auto f = a()->current_file_area()->ReadFile(first_file + amount);
           file_recs[matches] = f.u();
-          if (compare_criteria(&search_rec, &file_recs[matches])) {
+          if (keywords.may_match(first_file + amount) &&
+              compare_criteria(&search_rec, &file_recs[matches])) {
             int lines_left = max_lines - lines;
             int needed = check_lines_needed(&file_recs[matches]);
             if (needed <= lines_left) {
@@ -612,27 +780,27 @@ int compare_criteria(search_record * sr, uploadsrec * ur) {
 bool lp_compare_strings(const char *raw, const char *formula) {
   unsigned i = 0;
 
-  return lp_compare_strings_wh(raw, formula, &i, ssize(formula));
+  return lp_compare_strings_wh(lp_text_eval{raw}, formula, &i, ssize(formula));
 }
 
-bool lp_compare_strings_wh(const char *raw, const  char *formula, unsigned *pos, int size) {
-  bool rvalue;
-
-  auto lvalue = lp_get_value(raw, formula, pos) ? true : false;
+template <typename Eval>
+typename Eval::value_type lp_compare_strings_wh(const Eval& eval, const char* formula,
+                                                unsigned* pos, int size) {
+  auto lvalue = lp_get_value(eval, formula, pos);
   while (*pos < static_cast<unsigned>(size)) {
     const auto token = lp_get_token(formula, pos);
 
     switch (token) {
     case STR_SPC:                         // Added
-    case STR_AND:
-      rvalue = lp_compare_strings_wh(raw, formula, pos, size);
-      lvalue = lvalue && rvalue;
-      break;
+    case STR_AND: {
+      auto rvalue = lp_compare_strings_wh(eval, formula, pos, size);
+      lvalue = eval.both(std::move(lvalue), std::move(rvalue));
+    } break;
 
-    case STR_OR:
-      rvalue = lp_compare_strings_wh(raw, formula, pos, size);
-      lvalue = lvalue || rvalue;
-      break;
+    case STR_OR: {
+      auto rvalue = lp_compare_strings_wh(eval, formula, pos, size);
+      lvalue = eval.either(std::move(lvalue), std::move(rvalue));
+    } break;
 
     case STR_CLOSE_PAREN:
     case 0:
@@ -663,7 +831,8 @@ int lp_get_token(const char *formula, unsigned *pos) {
   return formula[*pos - 1];
 }
 
-int lp_get_value(const char *raw, const char *formula, unsigned *pos) {
+template <typename Eval>
+typename Eval::value_type lp_get_value(const Eval& eval, const char* formula, unsigned* pos) {
   char szBuffer[255];
   int tpos = 0;
   int sign = 1, started_number = 0;
@@ -682,22 +851,18 @@ OPERATOR_CHECK_1:
       x = formula[*pos];
       goto OPERATOR_CHECK_1;
     }
-    return 0;
+    return eval.none();
 
   case STR_AND:
   case STR_SPC:
   case STR_OR:
-    return 0;
+    return eval.none();
   }
 
   switch (x) {
   case STR_OPEN_PAREN:
     ++*pos;
-    if (lp_compare_strings_wh(raw, formula, pos, ssize(formula))) {
-      return (sign) ? 1 : 0;
-    } else {
-      return (sign) ? 0 : 1;
-    }
+    return eval.group(lp_compare_strings_wh(eval, formula, pos, ssize(formula)), sign != 0);
   }
 
   bool done = false;
@@ -731,10 +896,7 @@ OPERATOR_CHECK_1:
   szBuffer[tpos] = 0;
   StringTrim(szBuffer);
 
-  if (ifind_first(raw, szBuffer)) {
-    return (sign ? 1 : 0);
-  }
-  return (sign ? 0 : 1);
+  return eval.term(szBuffer, sign != 0);
 }
 
 
@@ -48,6 +48,7 @@
 #include "bbs/newuser.h"
 #include "bbs/readmail.h"
 #include "bbs/stuffin.h"
+#include "bbs/subacc.h"
 #include "bbs/subedit.h"
 #include "bbs/sysopf.h"
 #include "bbs/sysoplog.h"
@@ -377,6 +378,7 @@ void ScanSub() {
   if (!a()->usub.empty()) {
     write_inst(INST_LOC_SUBS, a()->current_user_sub().subnum, INST_FLAGS_NONE);
     bool nextsub = false;
+    RefreshSubStats();
     qscan(a()->current_user_sub_num(), nextsub);
   }
 }
@@ -391,7 +391,6 @@ void qscan(uint16_t start_subnum, bool& nextsub) {
   bout.nl();
   auto memory_last_read = a()->sess().qsc_p[sub_number];
 
-  iscan1(sub_number);
   auto num_lines = 3;
   if (const auto on_disk_last_post = WWIVReadLastRead(sub_number); !on_disk_last_post || on_disk_last_post > memory_last_read) {
     const auto old_subnum = a()->current_user_sub_num();
@@ -439,6 +438,7 @@ void nscan(uint16_t start_subnum) {
   bool nextsub = true;
 
   bout.outstr("\r\n|#3-=< Q-Scan All >=-\r\n");
+  RefreshSubStats();
   for (auto i = start_subnum; i < a()->usub.size() && nextsub && !a()->sess().hangup();
        i++) {
     if (a()->sess().qsc_q[a()->usub[i].subnum / 32] & (1L << (a()->usub[i].subnum % 32))) {
@@ -1,15 +1,27 @@
 /*	@(#)crctab.h 1.2 96/09/13	*/
 
+#ifndef CRCTAB_H
+#define CRCTAB_H
+
 #include <cstdint>
+#include "core/crc.h"
 
 /*
- *  Crc calculation stuff.  See crctab.c
+ *  Crc calculation stuff, the tables live in core/crc.cpp
  */
 
-extern uint16_t crctab[256];
-
-#define updcrc(cp, crc) (crctab[((crc >> 8) & 255)] ^ (crc << 8) ^ cp)
+/*
+ * 16-bit CRC-CCITT of the octet cp.  Unlike the augmented updcrc from
+ * crctab.c, the CRC is complete after the last octet so two zero octets
+ * must not be fed through it before sending the CRC.
+ */
+inline uint32_t updcrc(uint32_t cp, uint32_t crc) {
+  return wwiv::core::crc16_ccitt_update(static_cast<uint16_t>(crc), static_cast<uint8_t>(cp));
+}
 
-extern unsigned long cr3tab[];
+/* 32-bit CRC of the octet b, without the initial or final inversion. */
+inline uint32_t UPDC32(uint32_t b, uint32_t c) {
+  return wwiv::core::crc32_update(c, static_cast<uint8_t>(b));
+}
 
-#define UPDC32(b, c) (cr3tab[((int)c ^ b) & 0xff] ^ ((c >> 8) & 0x00FFFFFF))
+#endif
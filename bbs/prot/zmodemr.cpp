@@ -706,13 +706,7 @@ int acceptPacket(ZModem* info) {
 }
 
 int calcCrc(u_char* str, int len) {
-  int crc = 0;
-  while (--len >= 0) {
-    crc = updcrc(*str++, crc);
-  }
-  crc = updcrc(0, crc);
-  crc = updcrc(0, crc);
-  return crc & 0xffff;
+  return wwiv::core::crc16_ccitt(str, len);
 }
 
 #if defined(_MSC_VER)
@@ -782,8 +782,6 @@ int SendMoreFileData(ZModem* info) {
   *ptr++ = type;
 
   if (!crc32) {
-    crc = updcrc(0, crc);
-    crc = updcrc(0, crc);
     ptr = putZdle(ptr, static_cast<u_char>((crc >> 8) & 0xff), info);
     ptr = putZdle(ptr, static_cast<u_char>(crc & 0xff), info);
   } else {
@@ -974,11 +972,7 @@ int YXmitData(u_char* buffer, int len, ZModem* info) {
     trail[0] = static_cast<u_char>(crc % 256);
     return ZXmitStr(trail, 1, info);
   } else {
-    for (i = 0; i < len; ++i) {
-      crc = updcrc(buffer[i], crc);
-    }
-    crc = updcrc(0, crc);
-    crc = updcrc(0, crc);
+    crc = wwiv::core::crc16_ccitt(buffer, len);
     trail[0] = static_cast<u_char>(crc / 256);
     trail[1] = static_cast<u_char>(crc % 256);
     return ZXmitStr(trail, 2, info);
@@ -143,8 +143,6 @@ int ZXmitHdrHex(int type, u_char data[4], ZModem* info) {
     ptr = putHex(ptr, *data);
     crc = updcrc(*data, crc);
   }
-  crc = updcrc(0, crc);
-  crc = updcrc(0, crc);
   ptr = putHex(ptr, (crc >> 8) & 0xff);
   ptr = putHex(ptr, crc & 0xff);
   *ptr++ = '\r';
@@ -176,8 +174,6 @@ int ZXmitHdrBin(int type, u_char data[4], ZModem* info) {
     ptr = putZdle(ptr, *data, info);
     crc = updcrc(*data, crc);
   }
-  crc = updcrc(0, crc);
-  crc = updcrc(0, crc);
   ptr = putZdle(ptr, (crc >> 8) & 0xff, info);
   ptr = putZdle(ptr, crc & 0xff, info);
 
@@ -264,8 +260,6 @@ int ZXmitData(int format, int len, u_char term, u_char* data, ZModem* info) {
   }
   *ptr++ = term;
   if (format == ZBIN) {
-    crc = updcrc(0, crc);
-    crc = updcrc(0, crc);
     ptr = putZdle(ptr, (crc >> 8) & 0xff, info);
     ptr = putZdle(ptr, crc & 0xff, info);
   } else {
@@ -279,23 +273,7 @@ int ZXmitData(int format, int len, u_char term, u_char* data, ZModem* info) {
 }
 
 /* compute 32-bit crc for a file, returns 0 on not found */
-uint32_t FileCrc(char* name) {
-  FILE* ifile = fopen(name, "r");
-  int i;
-
-  if (ifile == nullptr) { /* shouldn't happen, since we did access( 2 ) */
-    return 0;
-  }
-
-  uint32_t crc = 0xffffffff;
-
-  while ((i = fgetc(ifile)) != EOF) {
-    crc = UPDC32(i, crc);
-  }
-
-  fclose(ifile);
-  return ~crc;
-}
+uint32_t FileCrc(char* name) { return wwiv::core::crc32file(name); }
 
 u_char* ZEnc4(uint32_t n) {
   static u_char buf[4];
@@ -40,6 +40,7 @@
 #include "common/pause.h"
 #include "core/clock.h"
 #include "core/file.h"
+#include "core/findfiles.h"
 #include "core/scope_exit.h"
 #include "core/stl.h"
 #include "core/strings.h"
@@ -47,6 +48,7 @@
 #include "fmt/format.h"
 #include "local_io/wconstants.h"
 #include "sdk/filenames.h"
+#include "sdk/files/zip.h"
 #include "sdk/instance.h"
 #include "sdk/qscan.h"
 #include "sdk/qwk_config.h"
@@ -205,6 +207,7 @@ void build_qwk_packet() {
   }
 
   bool msgs_ok = true;
+  RefreshSubStats();
   for (uint16_t i = 0; i < a()->usub.size() && !a()->sess().hangup() && !qwk_info.abort && msgs_ok; i++) {
     msgs_ok = max_msgs ? qwk_info.qwk_rec_num <= max_msgs : true;
     if (a()->sess().qsc_q[a()->usub[i].subnum / 32] & (1L << (a()->usub[i].subnum % 32))) {
@@ -713,9 +716,23 @@ void finish_qwk(qwk_state *qwk_info) {
   if (!qwk_info->abort) {
     auto parem1 = FilePath(a()->sess().dirs().qwk_directory(), qwkname);
     auto parem2 = FilePath(a()->sess().dirs().qwk_directory(), "*.*");
-    wwiv::bbs::CommandLine cl(a()->arcs[archiver].arca);
-    cl.args(parem1.string(), parem2.string());
-    ExecuteExternalProgram(cl, a()->spawn_option(SPAWNOPT_ARCH_A));
+    if (wwiv::sdk::files::is_zip_arcrec(a()->arcs[archiver])) {
+      // ZIP packets are created in process.
+      FindFiles ff(parem2, FindFiles::FindFilesType::files);
+      wwiv::sdk::files::ZipWriter zip(parem1);
+      for (const auto& f : ff) {
+        if (!iequals(f.name, qwkname)) {
+          zip.AddFile(FilePath(a()->sess().dirs().qwk_directory(), f.name));
+        }
+      }
+      if (!zip.Close()) {
+        File::Remove(parem1);
+      }
+    } else {
+      wwiv::bbs::CommandLine cl(a()->arcs[archiver].arca);
+      cl.args(parem1.string(), parem2.string());
+      ExecuteExternalProgram(cl, a()->spawn_option(SPAWNOPT_ARCH_A));
+    }
 
     qwk_file_to_send = FilePath(a()->sess().dirs().qwk_directory(), qwkname).string();
 
@@ -56,6 +56,7 @@
 #include "sdk/status.h"
 #include "sdk/subxtr.h"
 #include "sdk/vardec.h"
+#include "sdk/files/zip.h"
 #include "sdk/net/networks.h"
 
 #include <chrono>
@@ -103,12 +104,27 @@ static void qwk_receive_file(const std::string& fn, bool* received, int prot_num
   }
 }
 
+// Largest .MSG we'll read from a ZIP reply packet, far more than any user
+// will upload in one session.
+static constexpr size_t kMaxReplyMsgSize = 16 * 1024 * 1024;
+
 static std::filesystem::path ready_reply_packet(const std::string& packet_name, const std::string& msg_name) {
   const auto archiver = match_archiver(a()->arcs, packet_name).value_or(a()->arcs[0]);
-  wwiv::bbs::CommandLine cl(archiver.arce);
-  cl.args(packet_name, msg_name);
-
-  ExecuteExternalProgram(cl, EFLAG_QWK_DIR);
+  if (wwiv::sdk::files::is_zip_arcrec(archiver)) {
+    // ZIP packets are extracted in process.
+    const wwiv::sdk::files::ZipReader zip(std::filesystem::path{packet_name});
+    if (const auto contents = zip.Read(msg_name, kMaxReplyMsgSize)) {
+      File f(FilePath(a()->sess().dirs().qwk_directory(), msg_name));
+      if (f.Open(File::modeBinary | File::modeReadWrite | File::modeCreateFile |
+                 File::modeTruncate)) {
+        f.Write(contents.value());
+      }
+    }
+  } else {
+    wwiv::bbs::CommandLine cl(archiver.arce);
+    cl.args(packet_name, msg_name);
+    ExecuteExternalProgram(cl, EFLAG_QWK_DIR);
+  }
 
   const auto mask = FilePath(a()->sess().dirs().qwk_directory(), msg_name);
   FindFiles ff(mask, FindFiles::FindFilesType::files);
@@ -50,6 +50,7 @@
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <tuple>
 
 using namespace wwiv::common;
 using namespace wwiv::core;
@@ -671,24 +672,81 @@ static std::string get_line_color(std::string& line) {
   return colors.text_color;
 }
 
+/**
+ * Returns the attribute after applying the pipe color codes in color on
+ * top of attr, the same way that Output::outstr would.
+ */
+static uint8_t apply_line_color(const std::string& color, uint8_t attr) {
+  const auto& user = *a()->user();
+  auto it = std::cbegin(color);
+  const auto fin = std::cend(color);
+  while (it != fin) {
+    if (*it++ != '|' || it == fin) {
+      continue;
+    }
+    if (*it == '#') {
+      if (++it != fin && std::isdigit(static_cast<uint8_t>(*it))) {
+        attr = user.color(*it++ - '0');
+      }
+      continue;
+    }
+    std::string s;
+    while (it != fin && s.size() < 2 && std::isdigit(static_cast<uint8_t>(*it))) {
+      s.push_back(*it++);
+    }
+    if (s.empty()) {
+      continue;
+    }
+    if (const auto c = to_number<int>(s); c < 16) {
+      attr = static_cast<uint8_t>(c | (attr & 0xf0));
+    } else {
+      attr = static_cast<uint8_t>((c << 4) | (attr & 0x0f));
+    }
+  }
+  return attr;
+}
+
+/**
+ * Returns true if l contains MCI codes which need to be interpreted by
+ * Output::outstr each time the line is displayed.
+ */
+static bool needs_mci(const std::string& l) {
+  return bout.mci_enabled() && (l.find("|@") != std::string::npos ||
+                                l.find("|{") != std::string::npos ||
+                                l.find("|[") != std::string::npos);
+}
+
+/**
+ * Draws the visible lines of the message into screen, and then sends only
+ * the parts of the screen that have changed since they were last displayed
+ * so that scrolling doesn't resend the whole message area.
+ */
 static void display_message_text_new(const std::vector<std::string>& lines, int start,
-                                     int message_height, int screen_width, int lines_start, Type2MessageData& msg) {
+                                     int message_height, int screen_width, int lines_start,
+                                     Type2MessageData& msg, DeltaFrameBuffer& screen) {
   auto had_ansi = false;
   auto& colors = a()->config()->raw_config().colors.msg;
   if (colors.kludge_color.empty()) {
     colors.kludge_color = "|08";
   }
   const auto colorize = msg.sub.colorize_text;
+  const auto default_attr = a()->user()->color(0);
 
-  for (auto i = start; i < start + message_height; i++) {
+  Ansi ansi(&screen, {}, default_attr);
+  // Lines with MCI codes are displayed using outstr after the rest of the screen.
+  std::vector<std::tuple<int, std::string, std::string>> mci_lines;
+  for (auto row = 0; row < message_height; row++) {
+    const auto i = start + row;
     // Do this so we don't pop up a pause for sure.
     bout.clear_lines_listed();
     std::string color = "|#0";
 
+    screen.gotoxy(0, row);
+    screen.curatr(default_attr);
     if (i >= size_int(lines)) {
-      break;
+      screen.clear_eol();
+      continue;
     }
-    bout.goxy(1, i - start + lines_start);
     auto l = lines.at(i);
     if (l.find("\x1b[") != std::string::npos) {
       had_ansi = true;
@@ -714,11 +772,29 @@ static void display_message_text_new(const std::vector<std::string>& lines, int
         color = get_line_color(l);
       }
     }
+    if (needs_mci(l)) {
+      screen.clear_eol();
+      mci_lines.emplace_back(row, color, l);
+      continue;
+    }
+    screen.curatr(apply_line_color(color, default_attr));
+    ansi.reset();
+    ansi.write(l);
+    screen.clear_eol();
+  }
+  bout.write_ansi(screen.delta(1, lines_start, static_cast<uint8_t>(bout.curatr())));
+
+  for (const auto& [row, color, l] : mci_lines) {
+    bout.goxy(1, row + lines_start);
     bout.ansic(0);
     bout.outstr(color);
     bout.outstr(l);
     bout.clreol();
   }
+  if (!mci_lines.empty()) {
+    // The screen no longer knows what is displayed in these rows.
+    screen.invalidate();
+  }
 }
 
 static std::string percent_read(int start, int end) {
@@ -748,6 +824,7 @@ static ReadMessageResult display_type2_message_new(int& msgno, Type2MessageData&
 
   auto start = first;
   auto dirty = true;
+  DeltaFrameBuffer screen(fs.screen_width(), fs.message_height());
   ReadMessageResult result{};
   result.lines_start = fs.lines_start();
   result.lines_end = fs.lines_end();
@@ -757,7 +834,7 @@ static ReadMessageResult display_type2_message_new(int& msgno, Type2MessageData&
     if (dirty) {
       bout.ansic(0);
       display_message_text_new(lines, start, fs.message_height(), fs.screen_width(),
-                               fs.lines_start(), msg);
+                               fs.lines_start(), msg, screen);
       dirty = false;
       fs.DrawBottomBar(start == last ? "END" : percent_read(start, last));
       fs.ClearCommandLine();
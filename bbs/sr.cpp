@@ -32,6 +32,7 @@
 #include "common/datetime.h"
 #include "common/input.h"
 #include "common/output.h"
+#include "core/crc.h"
 #include "core/numbers.h"
 #include "core/scope_exit.h"
 #include "core/stl.h"
@@ -58,16 +59,7 @@ unsigned char checksum = 0;
 
 void calc_CRC(unsigned char b) {
   checksum = checksum + b;
-
-  crc ^= (static_cast<uint16_t>(b) << 8);
-  for (auto i = 0; i < 8; i++) {
-    if (crc & 0x8000) {
-      crc = crc << 1;
-      crc ^= 0x1021;
-    } else {
-      crc = crc << 1;
-    }
-  }
+  crc = crc16_ccitt_update(crc, b);
 }
 
 
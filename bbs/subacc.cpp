@@ -30,6 +30,7 @@
 #include "core/version.h"
 #include "core/wwivport.h"
 #include "sdk/config.h"
+#include "sdk/msgapi/sub_stats.h"
 #include "sdk/status.h"
 #include "sdk/subxtr.h"
 #include "sdk/vardec.h"
@@ -39,6 +40,7 @@
 
 using namespace wwiv::core;
 using namespace wwiv::sdk;
+using namespace wwiv::sdk::msgapi;
 using namespace wwiv::strings;
 
 /////////////////////////////////////////////////////////////////////////////
@@ -50,6 +52,22 @@ using namespace wwiv::strings;
 static std::unique_ptr<File> fileSub; // File object for '.sub' file
 static char subdat_fn[MAX_PATH];      // filename of .sub file
 
+// Summary of message counts and last qscan for all subs (substats.dat).
+static SubStats& sub_stats() {
+  static SubStats stats(a()->config()->datadir());
+  return stats;
+}
+
+// Updates substats.dat for the current sub from the open fileSub.
+static void update_sub_stats(uint32_t num_messages) {
+  postrec p{};
+  if (num_messages > 0) {
+    fileSub->Seek(num_messages * sizeof(postrec), File::Whence::begin);
+    fileSub->Read(&p, sizeof(postrec));
+  }
+  sub_stats().update(a()->current_sub().filename, {num_messages, p.qscan});
+}
+
 using namespace wwiv::core;
 using namespace wwiv::stl;
 using namespace wwiv::strings;
@@ -78,12 +96,24 @@ bool open_sub(bool wr) {
   return fileSub->IsOpen();
 }
 
+void RefreshSubStats() {
+  sub_stats().Refresh();
+}
+
 uint32_t WWIVReadLastRead(int sub_number) {
+  const auto& sub_filename = a()->subs().sub(sub_number).filename;
+
+  // Use the shared summary when we have one so we don't need to touch the sub.
+  auto& stats = sub_stats();
+  if (const auto s = stats.get(sub_filename)) {
+    // Not sure why but iscan1 returned 1 for empty subs.
+    return s->num_messages == 0 ? 1 : s->last_qscan;
+  }
+
   // open file, and create it if necessary
   postrec p{};
 
-  const auto fn =
-      FilePath(a()->config()->datadir(), StrCat(a()->subs().sub(sub_number).filename, ".sub"));
+  const auto fn = FilePath(a()->config()->datadir(), StrCat(sub_filename, ".sub"));
   if (!File::Exists(fn)) {
     File subFile(fn);
     if (!subFile.Open(File::modeBinary | File::modeCreateFile | File::modeReadWrite)) {
@@ -103,13 +133,16 @@ uint32_t WWIVReadLastRead(int sub_number) {
   subFile.Read(&p, sizeof(postrec));
 
   if (p.owneruser == 0) {
+    stats.seed(sub_filename, {});
     // Not sure why but iscan1 returned 1 for empty subs.
     return 1;
   }
 
   // read in sub date, if don't already know it
-  subFile.Seek(p.owneruser * sizeof(postrec), File::Whence::begin);
+  const auto num_messages = p.owneruser;
+  subFile.Seek(num_messages * sizeof(postrec), File::Whence::begin);
   subFile.Read(&p, sizeof(postrec));
+  stats.seed(sub_filename, {num_messages, p.qscan});
   return p.qscan;
 }
 
@@ -239,6 +272,7 @@ void add_post(postrec* pp) {
   // add the new post
   fileSub->Seek(a()->GetNumMessagesInCurrentMessageArea() * sizeof(postrec), File::Whence::begin);
   fileSub->Write(pp, sizeof(postrec));
+  sub_stats().update(a()->current_sub().filename, {p.active_message_count, pp->qscan});
 
   // we've modified the sub
   a()->subchg = 0;
@@ -291,6 +325,7 @@ void delete_message(int mn) {
         a()->SetNumMessagesInCurrentMessageArea(p.owneruser);
         fileSub->Seek(0L, File::Whence::begin);
         fileSub->Write(&p, sizeof(postrec));
+        update_sub_stats(p.owneruser);
         free(buffer);
       }
     }
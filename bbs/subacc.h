@@ -24,6 +24,12 @@ struct postrec;
 
 void close_sub();
 bool open_sub(bool wr);
+/**
+ * Re-reads the message counts for all subs (substats.dat) if another instance
+ * has changed them.  WWIVReadLastRead answers from the counts read here, so
+ * call this once before checking a list of subs.
+ */
+void RefreshSubStats();
 uint32_t WWIVReadLastRead(int sub_number);
 bool iscan1(int si);
 int iscan(int b);
@@ -37,6 +37,7 @@
 #include "sdk/status.h"
 #include "sdk/subxtr.h"
 #include "sdk/usermanager.h"
+#include "sdk/msgapi/sub_stats.h"
 #include "sdk/net/networks.h"
 #include "sdk/net/subscribers.h"
 #include <string>
@@ -46,6 +47,7 @@ using wwiv::common::InputMode;
 using namespace wwiv::core;
 using namespace wwiv::local::io;
 using namespace wwiv::sdk;
+using namespace wwiv::sdk::msgapi;
 using namespace wwiv::sdk::net;
 using namespace wwiv::stl;
 using namespace wwiv::strings;
@@ -244,6 +246,9 @@ static void modify_sub(int n) {
         if (bin.yesno()) {
           File::Rename(old_sub_fullpath, new_sub_fullpath);
           File::Rename(old_msg_fullpath, new_msg_fullpath);
+          SubStats stats(a()->config()->datadir());
+          stats.remove(old_subname);
+          stats.remove(new_fn);
         }
       }
     } break;
@@ -662,6 +667,7 @@ void boardedit() {
           if (bin.yesno()) {
             File::Remove(FilePath(a()->config()->datadir(), StrCat(fn, ".sub")));
             File::Remove(FilePath(a()->config()->msgsdir(), StrCat(fn, ".dat")));
+            SubStats(a()->config()->datadir()).remove(fn);
           }
         }
       }
@@ -148,6 +148,10 @@ int get_new_posts_count(int subnum) {
   if (num == 0) {
     return 0;
   }
+  if (WWIVReadLastRead(subnum) <= q) {
+    // Nothing newer than the last read pointer, no need to walk the sub.
+    return 0;
+  }
   const auto midpoint = num / 2;
   auto msgIndex = num;
   int64_t last_qscan = 0;
@@ -204,6 +208,7 @@ void SubList() {
 
   auto abort = false;
   auto done = false;
+  RefreshSubStats();
   do {
     p = 1;
     auto i1 = 0;
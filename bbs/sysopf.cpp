@@ -612,22 +612,28 @@ static bool print_ftn_net_listing(Network& net) {
 
   auto count = 0;
   if (net.nodelist->initialized()) {
-    for (const auto& e : net.nodelist->entries()) {
-      if (zone != 0 && e.first.zone() != zone) {
-        continue;
+    const auto zones = zone != 0 ? std::vector<uint16_t>{static_cast<uint16_t>(zone)}
+                                 : net.nodelist->zones();
+    auto done = false;
+    for (const auto z : zones) {
+      if (done) {
+        break;
       }
-      if (!name_part.empty()) {
-        const auto bbs_name = ToStringUpperCase(e.second.name());
-        const auto idx = bbs_name.find(name_part);
-        if (idx == std::string::npos) {
-          continue;
+      for (const auto& e : net.nodelist->entries(z)) {
+        if (!name_part.empty()) {
+          const auto bbs_name = ToStringUpperCase(e.name());
+          const auto idx = bbs_name.find(name_part);
+          if (idx == std::string::npos) {
+            continue;
+          }
         }
+        bout.print(" |#5{:<18.18}  |#1{}\r\n", e.address().as_string(false, false), e.name());
+        if (bin.checka()) {
+          done = true;
+          break;
+        }
+        ++count;
       }
-      bout.print(" |#5{:<18.18}  |#1{}\r\n", e.first.as_string(false, false), e.second.name());
-      if (bin.checka()) {
-        break;
-      }
-      ++count;
     }
   }
   if (!abort) {
@@ -42,8 +42,10 @@
 #include "local_io/wconstants.h"
 #include "sdk/config.h"
 #include "sdk/files/arc.h"
+#include "sdk/files/file_catalog.h"
 #include "sdk/files/files.h"
 
+#include <set>
 #include <string>
 #include <vector>
 
@@ -374,6 +376,20 @@ void nscandir(uint16_t nDirNum, bool& need_title, bool *abort) {
   a()->set_current_user_dir_num(old_cur_dir);
 }
 
+std::set<std::string> file_areas_with_candidates(daten_t since, const std::string& filemask) {
+  std::vector<std::string> filenames;
+  for (const auto& ud : a()->udir) {
+    filenames.emplace_back(a()->dirs()[ud.subnum].filename);
+  }
+  auto& catalog = a()->fileapi()->catalog();
+  catalog.Refresh(*a()->fileapi(), filenames);
+  std::set<std::string> result;
+  for (const auto& e : catalog.Find(since, filemask)) {
+    result.insert(catalog.area_filename(e.area));
+  }
+  return result;
+}
+
 void nscanall() {
   a()->sess().scanned_files(true);
 
@@ -403,6 +419,7 @@ void nscanall() {
   bool abort = false;
   int count = 0;
   int color = 3;
+  const auto candidates = file_areas_with_candidates(a()->sess().nscandate(), "");
   bout.outstr("\r|#2Searching ");
   for (uint16_t i = 0; i < size_int(a()->udir) && !abort; i++) {
     count++;
@@ -420,6 +437,9 @@ void nscanall() {
       }
     }
     int nSubNum = a()->udir[i].subnum;
+    if (!candidates.count(a()->dirs()[nSubNum].filename)) {
+      continue;
+    }
     if (a()->sess().qsc_n[nSubNum / 32] & (1L << (nSubNum % 32))) {
       bool need_title = true;
       nscandir(i, need_title, &abort);
@@ -456,6 +476,7 @@ void searchall() {
   bout.nl(2);
   bout.outstr("Search all directories.\r\n");
   const auto filemask = file_mask();
+  const auto candidates = file_areas_with_candidates(0, filemask);
   bout.nl();
   bout.outstr("|#2Searching ");
   bout.clear_lines_listed();
@@ -482,6 +503,9 @@ void searchall() {
           color = 0;
         }
       }
+      if (!candidates.count(a()->dirs()[nDirNum].filename)) {
+        continue;
+      }
       a()->set_current_user_dir_num(i);
       dliscan();
       bool need_title = true;
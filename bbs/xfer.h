@@ -19,6 +19,7 @@
 #define INCLUDED_BBS_XFER_H
 
 #include "core/file.h"
+#include <set>
 #include <string>
 
 struct uploadsrec;
@@ -45,6 +46,12 @@ std::string file_mask();
 void listfiles();
 void nscandir(uint16_t nDirNum, bool& need_title, bool* abort);
 void nscanall();
+/**
+ * Returns the filenames of the user's directories that have a file uploaded on
+ * or after since matching the aligned filemask (or any file if filemask is
+ * empty), using the file catalog so other directories need not be opened.
+ */
+std::set<std::string> file_areas_with_candidates(daten_t since, const std::string& filemask);
 void searchall();
 int recno(const std::string& file_mask);
 int nrecno(const std::string& file_mask, int start_recno);
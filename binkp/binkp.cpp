@@ -24,10 +24,11 @@
 #include "binkp/net_log.h"
 #include "binkp/transfer_file.h"
 #include "core/connection.h"
-#include "core/crc32.h"
+#include "core/crc.h"
 #include "core/datetime.h"
 #include "core/file.h"
 #include "core/log.h"
+#include "core/metrics.h"
 #include "core/os.h"
 #include "core/socket_exceptions.h"
 #include "core/stl.h"
@@ -905,6 +906,22 @@ void BinkP::Run(const wwiv::core::CommandLine& cmdline) {
   NetworkLog net_log(config_->gfiles_directory());
   const auto end_time = system_clock::now();
   const auto log_seconds = duration_cast<seconds>(end_time - start_time);
+  const std::string metric_side = side_ == BinkSide::ORIGINATING ? "originating" : "answering";
+  metrics()
+      .counter("binkp_sessions_total", "BinkP sessions.",
+               {{"side", metric_side}, {"result", error_received_ ? "error" : "ok"}})
+      .inc();
+  metrics()
+      .counter("binkp_bytes_sent_total", "Bytes sent in BinkP sessions.", {{"side", metric_side}})
+      .inc(bytes_sent_);
+  metrics()
+      .counter("binkp_bytes_received_total", "Bytes received in BinkP sessions.",
+               {{"side", metric_side}})
+      .inc(bytes_received_);
+  metrics()
+      .histogram("binkp_session_duration_seconds", "Length of BinkP sessions in seconds.",
+                 {5, 15, 30, 60, 120, 300, 600, 1800}, {{"side", metric_side}})
+      .observe(duration<double>(end_time - start_time).count());
   if (remote_.network().type == network_type_t::wwivnet) {
     // Handle WWIVnet inbound files.
     if (file_manager_) {
@@ -17,7 +17,7 @@
 /**************************************************************************/
 #include "binkp/transfer_file.h"
 
-#include "core/crc32.h"
+#include "core/crc.h"
 #include "core/log.h"
 #include "core/strings.h"
 #include "fmt/printf.h"
@@ -17,7 +17,7 @@
 /**************************************************************************/
 #include "binkp/wfile_transfer_file.h"
 
-#include "core/crc32.h"
+#include "core/crc.h"
 #include "core/datetime.h"
 #include "core/log.h"
 #include "core/strings.h"
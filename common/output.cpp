@@ -613,6 +613,17 @@ int Output::outchr(char c, bool use_buffer) {
   return displayed;
 }
 
+int Output::write_ansi(const std::string& text) {
+  if (text.empty() || sess().hangup()) {
+    return 0;
+  }
+  auto num_written = 0;
+  for (const auto c : text) {
+    num_written += outchr(c, true);
+  }
+  flush();
+  return num_written;
+}
 
 /* This function outoutstr a string to the com port.  This is mainly used
  * for modem commands
@@ -629,6 +640,7 @@ void Output::flush() {
     remoteIO()->write(outchr_buffer_.c_str(), stl::size_int(outchr_buffer_));
     outchr_buffer_.clear();
   }
+  localIO()->Flush();
 }
 
 void Output::rputch(char ch, bool use_buffer_) {
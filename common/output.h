@@ -280,6 +280,13 @@ public:
 
   int outchr(char c, bool use_buffer = false);
 
+  /**
+   * Writes text locally and remotely without interpreting pipe codes, heart
+   * codes or macros. This is used to send ANSI sequences that have already
+   * been rendered, such as from a sdk::ansi::DeltaFrameBuffer.
+   */
+  int write_ansi(const std::string& text);
+
   /**
    * Writes any remaining buffered text remotely.
    */
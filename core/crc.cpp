@@ -0,0 +1,328 @@
+/**************************************************************************/
+/*                                                                        */
+/*                          WWIV Version 5.x                              */
+/*           Copyright (C)2022, WWIV Software Services                    */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/**************************************************************************/
+#include "core/crc.h"
+
+#include "core/file.h"
+#include <cstring>
+#include <memory>
+#include <string>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define WWIV_CRC32_PCLMUL
+#define WWIV_TARGET_PCLMUL __attribute__((target("pclmul,sse4.1")))
+#include <immintrin.h>
+#elif defined(_MSC_VER) && defined(_M_X64)
+#define WWIV_CRC32_PCLMUL
+#define WWIV_TARGET_PCLMUL
+#include <intrin.h>
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#define WWIV_CRC32_ARMV8
+#include <arm_acle.h>
+#if defined(__linux__)
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif
+#endif
+
+namespace wwiv::core {
+
+namespace {
+
+// Table driven CRC-32 (reflected polynomial 0xedb88320), see "Fast CRC
+// Computation Using PCLMULQDQ Instruction" (Intel, 2009) for the folding
+// used by the hardware path and "A Systematic Approach to Building High
+// Performance Software-based CRC Generators" (Kounavis, Berry) for slicing-by-8.
+struct crc32_tables_t {
+  uint32_t t[8][256];
+};
+
+constexpr crc32_tables_t make_crc32_tables() {
+  crc32_tables_t r{};
+  for (uint32_t i = 0; i < 256; i++) {
+    auto c = i;
+    for (auto k = 0; k < 8; k++) {
+      c = (c & 1) ? (c >> 1) ^ 0xedb88320 : c >> 1;
+    }
+    r.t[0][i] = c;
+  }
+  for (auto i = 0; i < 256; i++) {
+    for (auto s = 1; s < 8; s++) {
+      r.t[s][i] = (r.t[s - 1][i] >> 8) ^ r.t[0][r.t[s - 1][i] & 0xff];
+    }
+  }
+  return r;
+}
+
+struct crc16_table_t {
+  uint16_t t[256];
+};
+
+constexpr crc16_table_t make_crc16_ccitt_table() {
+  crc16_table_t r{};
+  for (uint32_t i = 0; i < 256; i++) {
+    auto c = i << 8;
+    for (auto k = 0; k < 8; k++) {
+      c = (c & 0x8000) ? (c << 1) ^ 0x1021 : c << 1;
+    }
+    r.t[i] = static_cast<uint16_t>(c & 0xffff);
+  }
+  return r;
+}
+
+static constexpr auto crc32_tables = make_crc32_tables();
+static constexpr auto crc16_ccitt_table = make_crc16_ccitt_table();
+
+// Little endian loads without alignment requirements.
+inline uint32_t load32(const uint8_t* p) noexcept {
+  return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+         static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+}
+
+#if defined(WWIV_CRC32_PCLMUL)
+
+// Folds 64 byte blocks four at a time, then 16 byte blocks, and finishes
+// with a Barrett reduction.  len must be at least 64 and a multiple of 16.
+WWIV_TARGET_PCLMUL
+uint32_t crc32_pclmul_fold(uint32_t crc, const uint8_t* p, size_t len) {
+  alignas(16) static const uint64_t k1k2[] = {0x0154442bd4, 0x01c6e41596};
+  alignas(16) static const uint64_t k3k4[] = {0x01751997d0, 0x00ccaa009e};
+  alignas(16) static const uint64_t k5k0[] = {0x0163cd6124, 0x0000000000};
+  alignas(16) static const uint64_t poly[] = {0x01db710641, 0x01f7011641};
+
+  auto x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x00));
+  auto x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x10));
+  auto x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x20));
+  auto x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x30));
+  x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(crc)));
+  auto x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(k1k2));
+  p += 64;
+  len -= 64;
+
+  while (len >= 64) {
+    const auto x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    const auto x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    const auto x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+    const auto x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+    x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+    x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x5),
+                       _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x00)));
+    x2 = _mm_xor_si128(_mm_xor_si128(x2, x6),
+                       _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x10)));
+    x3 = _mm_xor_si128(_mm_xor_si128(x3, x7),
+                       _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x20)));
+    x4 = _mm_xor_si128(_mm_xor_si128(x4, x8),
+                       _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 0x30)));
+    p += 64;
+    len -= 64;
+  }
+
+  // Fold the four lanes into one.
+  x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(k3k4));
+  for (const auto& next : {x2, x3, x4}) {
+    const auto x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, next), x5);
+  }
+
+  while (len >= 16) {
+    const auto x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p))),
+                       x5);
+    p += 16;
+    len -= 16;
+  }
+
+  // 128 bits down to 64.
+  x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+  x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+  x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+  x0 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(k5k0));
+  x2 = _mm_srli_si128(x1, 4);
+  x1 = _mm_and_si128(x1, x3);
+  x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+  x1 = _mm_xor_si128(x1, x2);
+
+  // Barrett reduction down to 32.
+  x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(poly));
+  x2 = _mm_and_si128(x1, x3);
+  x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+  x2 = _mm_and_si128(x2, x3);
+  x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+  x1 = _mm_xor_si128(x1, x2);
+  return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+}
+
+uint32_t crc32_pclmul(uint32_t crc, const uint8_t* p, size_t len) {
+  if (len < 64) {
+    return crc32_slicing_by_8(crc, p, len);
+  }
+  const auto folded = len & ~static_cast<size_t>(15);
+  crc = crc32_pclmul_fold(crc, p, folded);
+  return crc32_slicing_by_8(crc, p + folded, len - folded);
+}
+
+bool cpu_has_pclmul() {
+#if defined(_MSC_VER)
+  int info[4]{};
+  __cpuid(info, 1);
+  // ECX bit 1 is PCLMULQDQ and bit 19 is SSE4.1
+  return (info[2] & (1 << 1)) && (info[2] & (1 << 19));
+#else
+  return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+#endif
+}
+
+#elif defined(WWIV_CRC32_ARMV8)
+
+uint32_t crc32_armv8(uint32_t crc, const uint8_t* p, size_t len) {
+  while (len >= 8) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    crc = __crc32d(crc, v);
+    p += 8;
+    len -= 8;
+  }
+  while (len--) {
+    crc = __crc32b(crc, *p++);
+  }
+  return crc;
+}
+
+bool cpu_has_armv8_crc() {
+#if defined(__linux__) && defined(HWCAP_CRC32)
+  return (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0;
+#else
+  return true;
+#endif
+}
+
+#endif
+
+struct crc32_impl_t {
+  crc32_block_fn fn;
+  const char* name;
+};
+
+const crc32_impl_t& crc32_impl() {
+  static const crc32_impl_t impl = []() -> crc32_impl_t {
+    if (auto* hw = crc32_hardware()) {
+#if defined(WWIV_CRC32_PCLMUL)
+      return {hw, "pclmulqdq"};
+#elif defined(WWIV_CRC32_ARMV8)
+      return {hw, "armv8-crc"};
+#endif
+    }
+    return {crc32_slicing_by_8, "slicing-by-8"};
+  }();
+  return impl;
+}
+
+} // namespace
+
+uint32_t crc32_bytewise(uint32_t crc, const uint8_t* p, size_t len) noexcept {
+  const auto& t = crc32_tables.t[0];
+  while (len--) {
+    crc = t[(crc ^ *p++) & 0xff] ^ (crc >> 8);
+  }
+  return crc;
+}
+
+uint32_t crc32_slicing_by_8(uint32_t crc, const uint8_t* p, size_t len) noexcept {
+  const auto& t = crc32_tables.t;
+  while (len >= 8) {
+    const auto lo = load32(p) ^ crc;
+    const auto hi = load32(p + 4);
+    crc = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^ t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24] ^
+          t[3][hi & 0xff] ^ t[2][(hi >> 8) & 0xff] ^ t[1][(hi >> 16) & 0xff] ^ t[0][hi >> 24];
+    p += 8;
+    len -= 8;
+  }
+  return crc32_bytewise(crc, p, len);
+}
+
+crc32_block_fn crc32_hardware() {
+#if defined(WWIV_CRC32_PCLMUL)
+  static const bool supported = cpu_has_pclmul();
+  return supported ? crc32_pclmul : nullptr;
+#elif defined(WWIV_CRC32_ARMV8)
+  static const bool supported = cpu_has_armv8_crc();
+  return supported ? crc32_armv8 : nullptr;
+#else
+  return nullptr;
+#endif
+}
+
+std::string crc32_implementation() { return crc32_impl().name; }
+
+Crc32& Crc32::update(const void* data, size_t len) {
+  crc_ = crc32_impl().fn(crc_, static_cast<const uint8_t*>(data), len);
+  return *this;
+}
+
+Crc16Ccitt& Crc16Ccitt::update(const void* data, size_t len) {
+  const auto* p = static_cast<const uint8_t*>(data);
+  auto crc = crc_;
+  while (len--) {
+    crc = crc16_ccitt_update(crc, *p++);
+  }
+  crc_ = crc;
+  return *this;
+}
+
+uint32_t crc32(const void* data, size_t len) { return Crc32().update(data, len).value(); }
+
+uint16_t crc16_ccitt(const void* data, size_t len) {
+  return Crc16Ccitt().update(data, len).value();
+}
+
+uint32_t crc32_update(uint32_t crc, uint8_t b) noexcept {
+  return crc32_tables.t[0][(crc ^ b) & 0xff] ^ (crc >> 8);
+}
+
+uint16_t crc16_ccitt_update(uint16_t crc, uint8_t b) noexcept {
+  return static_cast<uint16_t>((crc << 8) ^ crc16_ccitt_table.t[((crc >> 8) ^ b) & 0xff]);
+}
+
+uint32_t crc32file(const std::filesystem::path& path) {
+  File file(path);
+  if (!file.Open(File::modeReadOnly | File::modeBinary, File::shareDenyWrite)) {
+    return 0;
+  }
+  constexpr File::size_type kBufferSize = 64 * 1024;
+  const auto buffer = std::make_unique<uint8_t[]>(kBufferSize);
+  Crc32 crc;
+  for (;;) {
+    const auto num_read = file.Read(buffer.get(), kBufferSize);
+    if (num_read < 0) {
+      return 0;
+    }
+    if (num_read == 0) {
+      break;
+    }
+    crc.update(buffer.get(), static_cast<size_t>(num_read));
+  }
+  return crc.value();
+}
+
+uint32_t crc32string(const std::string& contents) { return crc32(contents.data(), contents.size()); }
+
+}
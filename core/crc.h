@@ -0,0 +1,101 @@
+/**************************************************************************/
+/*                                                                        */
+/*                          WWIV Version 5.x                              */
+/*           Copyright (C)2022, WWIV Software Services                    */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/**************************************************************************/
+#ifndef INCLUDED_CORE_CRC_H
+#define INCLUDED_CORE_CRC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace wwiv::core {
+
+/**
+ * Streaming CRC-32 (ANSI X3.66, the one used by zip, binkp and zmodem).
+ *
+ * Blocks are checksummed using slicing-by-8, or with the carry-less multiply
+ * (PCLMULQDQ) or ARMv8 CRC32 instructions when the CPU supports them.  The
+ * choice is made once at runtime, see crc32_implementation().
+ */
+class Crc32 {
+public:
+  Crc32() = default;
+
+  Crc32& update(const void* data, size_t len);
+  Crc32& update(std::string_view s) { return update(s.data(), s.size()); }
+
+  /** The CRC of everything passed to update so far. */
+  [[nodiscard]] uint32_t value() const noexcept { return ~crc_; }
+  void reset() noexcept { crc_ = 0xffffffff; }
+
+private:
+  uint32_t crc_{0xffffffff};
+};
+
+/**
+ * Streaming CRC-16-CCITT as used by XModem, YModem and ZModem (polynomial
+ * 0x1021, MSB first, initial value 0).
+ */
+class Crc16Ccitt {
+public:
+  Crc16Ccitt() = default;
+
+  Crc16Ccitt& update(const void* data, size_t len);
+  Crc16Ccitt& update(std::string_view s) { return update(s.data(), s.size()); }
+
+  [[nodiscard]] uint16_t value() const noexcept { return crc_; }
+  void reset() noexcept { crc_ = 0; }
+
+private:
+  uint16_t crc_{0};
+};
+
+[[nodiscard]] uint32_t crc32(const void* data, size_t len);
+[[nodiscard]] uint16_t crc16_ccitt(const void* data, size_t len);
+
+/**
+ * Updates the CRC-32 register crc with the single octet b.  No inversion is
+ * done, so the caller starts with 0xffffffff and complements the result.
+ * Used by the protocol code that computes the CRC while escaping the data.
+ */
+[[nodiscard]] uint32_t crc32_update(uint32_t crc, uint8_t b) noexcept;
+
+/** Updates the CRC-16-CCITT value crc with the single octet b. */
+[[nodiscard]] uint16_t crc16_ccitt_update(uint16_t crc, uint8_t b) noexcept;
+
+/** Returns the CRC-32 of the contents of the file at path, or 0 on error */
+[[nodiscard]] uint32_t crc32file(const std::filesystem::path& path);
+[[nodiscard]] uint32_t crc32string(const std::string& contents);
+
+/** The name of the CRC-32 block implementation being used. */
+[[nodiscard]] std::string crc32_implementation();
+
+// The individual CRC-32 block implementations, these take and return the
+// CRC-32 register without inversion.  Exposed for tests and benchmarks.
+
+/** The classic table driven implementation, one byte at a time. */
+[[nodiscard]] uint32_t crc32_bytewise(uint32_t crc, const uint8_t* p, size_t len) noexcept;
+[[nodiscard]] uint32_t crc32_slicing_by_8(uint32_t crc, const uint8_t* p, size_t len) noexcept;
+/** The hardware implementation, or nullptr if this CPU doesn't have one. */
+using crc32_block_fn = uint32_t (*)(uint32_t crc, const uint8_t* p, size_t len);
+[[nodiscard]] crc32_block_fn crc32_hardware();
+
+}
+
+#endif
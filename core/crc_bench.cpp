@@ -0,0 +1,84 @@
+/**************************************************************************/
+/*                                                                        */
+/*                          WWIV Version 5.x                              */
+/*           Copyright (C)2022, WWIV Software Services                    */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/**************************************************************************/
+// Compares the throughput of the CRC-32 and CRC-16 implementations.
+//
+// Usage: core_benchmarks [benchmark flags]
+#include "benchmark/benchmark.h"
+
+#include "core/crc.h"
+#include <cstdint>
+#include <vector>
+
+using namespace wwiv::core;
+
+namespace {
+
+std::vector<uint8_t> random_buffer(int64_t size) {
+  std::vector<uint8_t> data(static_cast<size_t>(size));
+  uint32_t seed = 1;
+  for (auto& b : data) {
+    seed = seed * 1103515245 + 12345;
+    b = static_cast<uint8_t>(seed >> 16);
+  }
+  return data;
+}
+
+template <typename F> void run(benchmark::State& state, F f) {
+  const auto data = random_buffer(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(f(data.data(), data.size()));
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+void BM_Crc32_Bytewise(benchmark::State& state) {
+  run(state, [](const uint8_t* p, size_t len) { return crc32_bytewise(0xffffffff, p, len); });
+}
+
+void BM_Crc32_SlicingBy8(benchmark::State& state) {
+  run(state, [](const uint8_t* p, size_t len) { return crc32_slicing_by_8(0xffffffff, p, len); });
+}
+
+void BM_Crc32_Hardware(benchmark::State& state) {
+  auto* hw = crc32_hardware();
+  if (!hw) {
+    state.SkipWithError("No hardware CRC32 on this CPU");
+    return;
+  }
+  run(state, [hw](const uint8_t* p, size_t len) { return hw(0xffffffff, p, len); });
+}
+
+void BM_Crc32(benchmark::State& state) {
+  state.SetLabel(crc32_implementation());
+  run(state, [](const uint8_t* p, size_t len) { return crc32(p, len); });
+}
+
+void BM_Crc16Ccitt(benchmark::State& state) {
+  run(state, [](const uint8_t* p, size_t len) { return crc16_ccitt(p, len); });
+}
+
+} // namespace
+
+// 1MB through 1GB
+#define CRC_SIZES RangeMultiplier(4)->Range(1 << 20, 1 << 30)->Unit(benchmark::kMillisecond)
+
+BENCHMARK(BM_Crc32_Bytewise)->CRC_SIZES;
+BENCHMARK(BM_Crc32_SlicingBy8)->CRC_SIZES;
+BENCHMARK(BM_Crc32_Hardware)->CRC_SIZES;
+BENCHMARK(BM_Crc32)->CRC_SIZES;
+BENCHMARK(BM_Crc16Ccitt)->CRC_SIZES;
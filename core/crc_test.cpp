@@ -0,0 +1,116 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*               Copyright (C)2014-2022, WWIV Software Services           */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+/**************************************************************************/
+#include "gtest/gtest.h"
+#include "core/crc.h"
+#include "core/file.h"
+#include "core/test/file_helper.h"
+#include <string>
+#include <vector>
+
+using namespace wwiv::core;
+
+TEST(Crc32Test, Simple) {
+  wwiv::core::test::FileHelper file;
+  const auto path = file.CreateTempFile("helloworld.txt", "Hello World");
+
+  ASSERT_TRUE(File::Exists(path));
+
+  const auto crc = crc32file(path);
+  const uint32_t expected = 0x4a17b156;
+
+  // use wwiv/scripts/crc32.py to generate golden values as needed.
+  EXPECT_EQ(expected, crc) << " was " << std::hex << crc;
+}
+
+TEST(Crc32Test, CheckValue) {
+  const std::string s{"123456789"};
+  EXPECT_EQ(0xcbf43926u, crc32(s.data(), s.size()));
+  EXPECT_EQ(0xcbf43926u, crc32string(s));
+  EXPECT_EQ(0u, crc32(s.data(), 0));
+}
+
+TEST(Crc32Test, Streaming) {
+  const std::string s{"The quick brown fox jumps over the lazy dog"};
+  Crc32 crc;
+  crc.update(s.substr(0, 5)).update(s.substr(5, 17)).update(s.substr(22));
+  EXPECT_EQ(0x414fa339u, crc.value());
+
+  crc.reset();
+  crc.update(s);
+  EXPECT_EQ(0x414fa339u, crc.value());
+}
+
+TEST(Crc32Test, Update_Byte) {
+  const std::string s{"123456789"};
+  uint32_t crc = 0xffffffff;
+  for (const auto c : s) {
+    crc = crc32_update(crc, static_cast<uint8_t>(c));
+  }
+  EXPECT_EQ(0xcbf43926u, ~crc);
+}
+
+TEST(Crc32Test, Implementations_Agree) {
+  std::vector<uint8_t> data(4099);
+  uint32_t seed = 1;
+  for (auto& b : data) {
+    seed = seed * 1103515245 + 12345;
+    b = static_cast<uint8_t>(seed >> 16);
+  }
+  auto* hw = crc32_hardware();
+  // Every length and alignment around the 16 and 64 byte block sizes.
+  for (size_t offset = 0; offset < 16; offset++) {
+    for (size_t len = 0; len < 300; len++) {
+      const auto* p = data.data() + offset;
+      const auto expected = crc32_bytewise(0xffffffff, p, len);
+      EXPECT_EQ(expected, crc32_slicing_by_8(0xffffffff, p, len)) << len;
+      if (hw) {
+        EXPECT_EQ(expected, hw(0xffffffff, p, len)) << len;
+      }
+    }
+  }
+  const auto expected = crc32_bytewise(0xffffffff, data.data(), data.size());
+  EXPECT_EQ(expected, crc32_slicing_by_8(0xffffffff, data.data(), data.size()));
+  if (hw) {
+    EXPECT_EQ(expected, hw(0xffffffff, data.data(), data.size()));
+  }
+  EXPECT_EQ(~expected, crc32(data.data(), data.size()));
+}
+
+TEST(Crc16CcittTest, CheckValue) {
+  const std::string s{"123456789"};
+  EXPECT_EQ(0x31c3, crc16_ccitt(s.data(), s.size()));
+
+  Crc16Ccitt crc;
+  crc.update(s.substr(0, 4)).update(s.substr(4));
+  EXPECT_EQ(0x31c3, crc.value());
+}
+
+TEST(Crc16CcittTest, Residue) {
+  // Appending the CRC (high byte first) gives a CRC of zero, which is how
+  // XModem and ZModem check received blocks.
+  const std::string s{"WWIV"};
+  auto crc = crc16_ccitt(s.data(), s.size());
+  uint16_t check = 0;
+  for (const auto c : s) {
+    check = crc16_ccitt_update(check, static_cast<uint8_t>(c));
+  }
+  check = crc16_ccitt_update(check, static_cast<uint8_t>(crc >> 8));
+  check = crc16_ccitt_update(check, static_cast<uint8_t>(crc & 0xff));
+  EXPECT_EQ(0, check);
+}
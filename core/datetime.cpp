@@ -308,17 +308,23 @@ struct tm DateTime::to_tm() const noexcept {
   return tm_;
 }
 
+// Converts t to local time into tm.  Unlike localtime, this doesn't use a
+// shared buffer, so it may be used from many threads (i.e. for log timestamps).
+static bool local_tm(time_t t, struct tm& tm) noexcept {
+#ifdef _WIN32
+  return localtime_s(&tm, &t) == 0;
+#else
+  return localtime_r(&t, &tm) != nullptr;
+#endif
+}
+
 void DateTime::update_tm() noexcept {
   if (t_ < 0) {
     t_ = 1;
   }
-  if (const auto * tm = localtime(&t_);tm) {
-    tm_ = *tm;
-  } else {
+  if (!local_tm(t_, tm_)) {
     LOG(ERROR) << "Invalid Time passed to update_tm";    
-    auto tnow = time(nullptr);
-    const auto* nowtm = localtime(&tnow);
-    tm_ = *nowtm;
+    local_tm(time(nullptr), tm_);
   }
 }
 
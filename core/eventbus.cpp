@@ -18,8 +18,19 @@
 /**************************************************************************/
 #include "core/eventbus.h"
 
+#include <atomic>
+
 namespace wwiv::core {
 
+namespace detail {
+
+int next_event_type_id() noexcept {
+  static std::atomic<int> next_id{0};
+  return next_id++;
+}
+
+} // namespace detail
+
 EventBus bus_;
 
 // Returns the singleton global instance.
@@ -19,16 +19,38 @@
 #ifndef INCLUDED_CORE_EVENTBUS_H
 #define INCLUDED_CORE_EVENTBUS_H
 
-#include "core/log.h"
 #include "core/callable/callable.hpp"
-#include <any>
 #include <functional>
-#include <string>
+#include <memory>
 #include <type_traits>
-#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace wwiv::core {
 
+namespace detail {
+
+// Returns a new id for an event type, ids are assigned sequentially from 0.
+int next_event_type_id() noexcept;
+
+// Returns the id for the event type T, which is assigned the first time it
+// is requested.
+template <typename T> int event_type_id() noexcept {
+  static const int id = next_event_type_id();
+  return id;
+}
+
+} // namespace detail
+
+/**
+ * Dispatches events to the handlers registered for the type of the event.
+ *
+ * Handlers are kept in a list per event type, indexed by a type id, and are
+ * called directly with the event, so invoking an event does no lookups by
+ * name and no copies of the event.
+ *
+ * Handlers may not be added to an event type while it is being invoked.
+ */
 class EventBus final {
 public:
   EventBus() = default;
@@ -40,37 +62,54 @@ public:
 
   template<typename T, typename H> void add_handler(H handler) {
     static_assert(!std::is_reference<T>::value, "add_handler: Handler param must not be reference");
-    const std::string name = typeid(T).name();
     if constexpr (callable_traits<H>::argc == 0) {
-      handlers_.emplace(name, [handler](std::any) { handler(); });
+      handlers<T>().emplace_back([h = std::move(handler)](const T&) { h(); });
     } else {
-      handlers_.emplace(name,
-                        [f = std::forward<H>(handler)](auto value) { f(std::any_cast<T>(value)); });
+      handlers<T>().emplace_back(std::move(handler));
     }
   }
 
   template <typename T, typename M, typename I> void add_handler(M method, I instance) {
-    const std::string name = typeid(T).name();
-    std::function<void(T)> f = std::bind(method, instance, std::placeholders::_1);
-    handlers_.emplace(name, [f](auto value) { f(std::any_cast<T>(value)); });
+    handlers<T>().emplace_back(
+        [method, instance](const T& event) { std::invoke(method, instance, event); });
   }
 
   template <typename T> void invoke() { invoke(T{}); }
 
-  template <typename T> void invoke(const T& event_type) {
-    const std::string name = typeid(T).name();
-    auto [first_hdandler, last_handler] = handlers_.equal_range(name);
-    for (auto& it = first_hdandler; it != last_handler; ++it) {
-      try {
-        it->second(std::make_any<T>(event_type));
-      } catch (const std::bad_cast& e) {
-        LOG(INFO) << e.what();
-      }
+  template <typename T> void invoke(const T& event) {
+    const auto id = static_cast<size_t>(detail::event_type_id<T>());
+    if (id >= handlers_.size() || !handlers_[id]) {
+      return;
+    }
+    for (const auto& h : static_cast<handler_list<T>&>(*handlers_[id]).handlers) {
+      h(event);
     }
   }
 
+private:
+  struct handler_list_base {
+    virtual ~handler_list_base() = default;
+  };
+
+  template <typename T> struct handler_list final : handler_list_base {
+    std::vector<std::function<void(const T&)>> handlers;
+  };
+
+  // Returns the handlers for the event type T, creating the list if needed.
+  template <typename T> std::vector<std::function<void(const T&)>>& handlers() {
+    const auto id = static_cast<size_t>(detail::event_type_id<T>());
+    if (id >= handlers_.size()) {
+      handlers_.resize(id + 1);
+    }
+    if (!handlers_[id]) {
+      handlers_[id] = std::make_unique<handler_list<T>>();
+    }
+    return static_cast<handler_list<T>&>(*handlers_[id]).handlers;
+  }
 
-  std::unordered_multimap<std::string, std::function<void(std::any)>> handlers_;
+  // Handler lists indexed by event type id.  Entries are null for types
+  // without handlers on this bus.
+  std::vector<std::unique_ptr<handler_list_base>> handlers_;
 };
 
 EventBus& bus();
@@ -0,0 +1,120 @@
+/**************************************************************************/
+/*                                                                        */
+/*                          WWIV Version 5.x                              */
+/*           Copyright (C)2022, WWIV Software Services                    */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/**************************************************************************/
+// Compares the cost of EventBus::invoke with the previous EventBus, which
+// looked up handlers by the name of the event type and passed events as
+// std::any.
+//
+// Usage: core_benchmarks [benchmark flags]
+#include "benchmark/benchmark.h"
+
+#include "core/callable/callable.hpp"
+#include "core/eventbus.h"
+#include <any>
+#include <functional>
+#include <string>
+#include <unordered_map>
+
+using namespace wwiv::core;
+
+namespace {
+
+// The EventBus before handlers were indexed by type id.
+class NamedEventBus final {
+public:
+  template <typename T, typename H> void add_handler(H handler) {
+    const std::string name = typeid(T).name();
+    if constexpr (callable_traits<H>::argc == 0) {
+      handlers_.emplace(name, [handler](std::any) { handler(); });
+    } else {
+      handlers_.emplace(name,
+                        [f = std::forward<H>(handler)](auto value) { f(std::any_cast<T>(value)); });
+    }
+  }
+
+  template <typename T> void invoke() { invoke(T{}); }
+
+  template <typename T> void invoke(const T& event_type) {
+    const std::string name = typeid(T).name();
+    auto [first_handler, last_handler] = handlers_.equal_range(name);
+    for (auto& it = first_handler; it != last_handler; ++it) {
+      try {
+        it->second(std::make_any<T>(event_type));
+      } catch (const std::bad_cast&) {
+      }
+    }
+  }
+
+  std::unordered_multimap<std::string, std::function<void(std::any)>> handlers_;
+};
+
+// Events similar to those fired from the BBS input loops.
+struct CheckForHangupEvent {};
+struct UpdateTimeLeft {
+  bool check_for_timeout{false};
+};
+struct GiveupTimeslices {};
+struct ProcessInstanceMessages {};
+
+template <typename B> void add_handlers(B& b, int& count) {
+  b.template add_handler<CheckForHangupEvent>([&count]() { ++count; });
+  b.template add_handler<UpdateTimeLeft>([&count](const UpdateTimeLeft& u) {
+    count += u.check_for_timeout ? 1 : 2;
+  });
+  b.template add_handler<GiveupTimeslices>([&count]() { ++count; });
+  b.template add_handler<ProcessInstanceMessages>([&count]() { ++count; });
+}
+
+template <typename B> void BM_Invoke_NoArgs(benchmark::State& state) {
+  B b;
+  auto count = 0;
+  add_handlers(b, count);
+  for (auto _ : state) {
+    b.template invoke<CheckForHangupEvent>();
+  }
+  benchmark::DoNotOptimize(count);
+}
+
+template <typename B> void BM_Invoke_WithArg(benchmark::State& state) {
+  B b;
+  auto count = 0;
+  add_handlers(b, count);
+  for (auto _ : state) {
+    b.invoke(UpdateTimeLeft{true});
+  }
+  benchmark::DoNotOptimize(count);
+}
+
+template <typename B> void BM_Invoke_Unhandled(benchmark::State& state) {
+  struct Unhandled {};
+  B b;
+  auto count = 0;
+  add_handlers(b, count);
+  for (auto _ : state) {
+    b.template invoke<Unhandled>();
+  }
+  benchmark::DoNotOptimize(count);
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_Invoke_NoArgs, NamedEventBus);
+BENCHMARK_TEMPLATE(BM_Invoke_NoArgs, EventBus);
+BENCHMARK_TEMPLATE(BM_Invoke_WithArg, NamedEventBus);
+BENCHMARK_TEMPLATE(BM_Invoke_WithArg, EventBus);
+BENCHMARK_TEMPLATE(BM_Invoke_Unhandled, NamedEventBus);
+BENCHMARK_TEMPLATE(BM_Invoke_Unhandled, EventBus);
@@ -19,6 +19,7 @@
 #include "gtest/gtest.h"
 #include "core/eventbus.h"
 #include <iostream>
+#include <vector>
 
 using namespace wwiv::core;
 
@@ -96,3 +97,30 @@ TEST_F(EventBusTest, Class) {
   b.invoke(MessagePosted{1});
   EXPECT_EQ(2, c.num);
 }
+
+TEST_F(EventBusTest, MultipleHandlers_InOrder) {
+  std::vector<int> calls;
+  b.add_handler<MessagePosted>([&calls](const MessagePosted& m) { calls.push_back(m.num); });
+  b.add_handler<MessagePosted>([&calls]() { calls.push_back(0); });
+
+  b.invoke(MessagePosted{5});
+  EXPECT_EQ((std::vector<int>{5, 0}), calls);
+}
+
+TEST_F(EventBusTest, OnlyHandlersForType) {
+  struct OtherEvent {};
+  auto posted = 0;
+  auto other = 0;
+  b.add_handler<MessagePosted>([&posted]() { posted++; });
+  b.add_handler<OtherEvent>([&other]() { other++; });
+
+  b.invoke<OtherEvent>();
+  EXPECT_EQ(0, posted);
+  EXPECT_EQ(1, other);
+}
+
+TEST_F(EventBusTest, NoHandlers) {
+  struct Unhandled {};
+  b.invoke<Unhandled>();
+  b.invoke(MessagePosted{1});
+}
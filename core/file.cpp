@@ -329,6 +329,17 @@ bool File::set_length(size_type l) {
   return true;
 }
 
+bool File::fsync() {
+  if (!IsOpen()) {
+    return false;
+  }
+#if defined(_WIN32)
+  return _commit(handle_) == 0;
+#else
+  return ::fsync(handle_) == 0;
+#endif
+}
+
 // static
 bool File::is_directory(const std::filesystem::path& path) noexcept {
   std::error_code ec;
@@ -378,6 +389,29 @@ bool File::Rename(const std::filesystem::path& o, const std::filesystem::path& n
   return ec.value() == 0;
 }
 
+bool File::WriteAtomically(const std::filesystem::path& path, const void* data,
+                           size_type size) {
+  // Include the pid so concurrent writers never share a temporary file.
+  auto tmp = path;
+  tmp += StrCat(".", os::get_pid(), ".tmp");
+  {
+    File f(tmp);
+    if (!f.Open(modeBinary | modeReadWrite | modeCreateFile | modeTruncate)) {
+      return false;
+    }
+    if (f.Write(data, size) != size) {
+      f.Close();
+      Remove(tmp);
+      return false;
+    }
+  }
+  if (!Rename(tmp, path)) {
+    Remove(tmp);
+    return false;
+  }
+  return true;
+}
+
 bool File::Remove(const std::filesystem::path& path, bool force) {
   if (!Exists(path)) {
     // Don't try to delete a file that doesn't exist.
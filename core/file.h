@@ -123,6 +123,8 @@ public:
   [[nodiscard]] size_type length() const noexcept;
   size_type Seek(size_type offset, Whence whence);
   bool set_length(size_type l);
+  /** Flushes the data written to this file to the disk. */
+  bool fsync();
   [[nodiscard]] size_type current_position() const;
 
   [[nodiscard]] bool Exists() const noexcept;
@@ -161,6 +163,15 @@ public:
                    const std::filesystem::path& to);
   static bool Move(const std::filesystem::path& from,
                    const std::filesystem::path& to);
+  /**
+   * Replaces the contents of path with size bytes from data.  The data is
+   * written to a temporary file in the same directory which is then renamed
+   * over path, so other processes that have path open or mapped keep seeing
+   * the old contents, and never see a partially written file.  On Windows
+   * this fails while another process has path open.
+   */
+  static bool WriteAtomically(const std::filesystem::path& path, const void* data,
+                              size_type size);
 
   static bool SetFilePermissions(const std::filesystem::path& path, int perm);
 
@@ -17,6 +17,7 @@
 /*                                                                        */
 /**************************************************************************/
 #include "core/file.h"
+#include "core/findfiles.h"
 #include "core/stl.h"
 #include "core/strings.h"
 #include "core/test/file_helper.h"
@@ -439,6 +440,30 @@ TEST(FileTest, MoveFile) {
   EXPECT_FALSE(File::Exists(f1));
 }
 
+TEST(FileTest, WriteAtomically) {
+  wwiv::core::test::FileHelper helper;
+  const auto path = helper.CreateTempFile(test_info_->name(), "old contents");
+#ifndef _WIN32
+  File old_file(path);
+  ASSERT_TRUE(old_file.Open(File::modeBinary | File::modeReadOnly));
+#endif
+
+  const std::string kNew = "new";
+  ASSERT_TRUE(File::WriteAtomically(path, kNew.data(), kNew.size()));
+  EXPECT_EQ(kNew, helper.ReadFile(path));
+
+#ifndef _WIN32
+  // The open file still sees the old contents.
+  char buf[12]{};
+  EXPECT_EQ(12, old_file.Read(buf, sizeof(buf)));
+  EXPECT_EQ("old contents", std::string(buf, sizeof(buf)));
+#endif
+
+  // No temporary files are left behind.
+  FindFiles ff(FilePath(helper.TempDir(), "*.tmp"), FindFiles::FindFilesType::files);
+  EXPECT_TRUE(ff.empty());
+}
+
 TEST(FileTest, Remove_String) {
   static const std::string kHelloWorld = "Hello World";
   wwiv::core::test::FileHelper helper;
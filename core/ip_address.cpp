@@ -86,20 +86,24 @@ bool ip_address::empty() const {
 
 std::optional<ip_address> ip_address::from_string(const std::string& s) { 
   char d[16];
-  auto addr{s};
   if (s.length() < 2) {
     return std::nullopt;
   }
-  if (s.find(':') == std::string::npos) {
-    //make this into a ipv6 address for an ipv4 address
-    addr = wwiv::strings::StrCat("0:0:0:0:0:FFFF:", s);
-  }
 #ifdef __OS2__
   memset(&d, 0x00, 10);
   memset(&d[10], 0x01, 2);
-  const auto ret = inet_pton(AF_INET, addr.c_str(), &d[12]);
+  const auto ret = inet_pton(AF_INET, s.c_str(), &d[12]);
 #else
-  const auto ret = inet_pton(AF_INET6, addr.c_str(), &d);
+  int ret;
+  if (s.find(':') == std::string::npos) {
+    // Store an IPv4 address as an IPv4 mapped IPv6 address, without building
+    // the "::ffff:" string since this is used for every connection.
+    memset(&d, 0x00, 10);
+    memset(&d[10], 0xff, 2);
+    ret = inet_pton(AF_INET, s.c_str(), &d[12]);
+  } else {
+    ret = inet_pton(AF_INET6, s.c_str(), &d);
+  }
 #endif
   if (ret != 1) {
     LOG(INFO) << "result code: " << ret;
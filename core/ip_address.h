@@ -36,6 +36,11 @@ public:
 
   /** True if this IP Address is an empty address (i.e. 0.0.0.0 or ::) */
   [[nodiscard]] bool empty() const;
+  /**
+   * The 16 bytes of the address in network order.  IPv4 addresses are stored
+   * as IPv4 mapped IPv6 addresses (::ffff:a.b.c.d).
+   */
+  [[nodiscard]] const char* data() const noexcept { return data_; }
   [[nodiscard]] static std::optional<ip_address> from_string(const std::string&);
   friend inline bool operator==(const ip_address& lhs, const ip_address& rhs);
   friend inline bool operator!=(const ip_address& lhs, const ip_address& rhs);
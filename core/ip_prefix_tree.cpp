@@ -0,0 +1,109 @@
+/**************************************************************************/
+/*                                                                        */
+/*                          WWIV Version 5.x                              */
+/*           Copyright (C)2022, WWIV Software Services                    */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/**************************************************************************/
+#include "core/ip_prefix_tree.h"
+
+#include "core/strings.h"
+#include <string>
+
+namespace wwiv::core {
+
+using namespace wwiv::strings;
+
+// Returns bit n (0 is the most significant bit) of address.
+static int bit(const ip_address& address, int n) noexcept {
+  const auto b = static_cast<uint8_t>(address.data()[n / 8]);
+  return (b >> (7 - n % 8)) & 1;
+}
+
+IpPrefixTree::IpPrefixTree() : nodes_(1) {}
+
+bool IpPrefixTree::insert(const ip_address& address, int prefix_len) {
+  if (prefix_len < 0 || prefix_len > 128) {
+    return false;
+  }
+  int32_t n = 0;
+  for (auto i = 0; i < prefix_len && !nodes_[n].terminal; i++) {
+    const auto b = bit(address, i);
+    if (nodes_[n].child[b] == 0) {
+      nodes_[n].child[b] = static_cast<int32_t>(nodes_.size());
+      nodes_.emplace_back();
+    }
+    n = nodes_[n].child[b];
+  }
+  if (nodes_[n].terminal) {
+    // Already covered by this or a shorter prefix.
+    return true;
+  }
+  // Anything below here is covered by this prefix.  The nodes are left in
+  // place since they are unreachable once this node is terminal.
+  nodes_[n].terminal = true;
+  nodes_[n].child[0] = nodes_[n].child[1] = 0;
+  ++size_;
+  return true;
+}
+
+bool IpPrefixTree::insert(const std::string& s) {
+  const auto slash = s.find('/');
+  const auto addr = ip_address::from_string(StringTrim(s.substr(0, slash)));
+  if (!addr) {
+    return false;
+  }
+  const auto is_v4 = s.find(':') == std::string::npos;
+  const auto max_len = is_v4 ? 32 : 128;
+  auto len = max_len;
+  if (slash != std::string::npos) {
+    const auto len_str = StringTrim(s.substr(slash + 1));
+    if (len_str.empty() || len_str.size() > 3 ||
+        len_str.find_first_not_of("0123456789") != std::string::npos) {
+      return false;
+    }
+    len = to_number<int>(len_str);
+    if (len > max_len) {
+      return false;
+    }
+  }
+  // IPv4 prefixes are within ::ffff:0:0/96.
+  return insert(addr.value(), is_v4 ? len + 96 : len);
+}
+
+bool IpPrefixTree::contains(const ip_address& address) const noexcept {
+  int32_t n = 0;
+  for (auto i = 0; i <= 128; i++) {
+    if (nodes_[n].terminal) {
+      return true;
+    }
+    if (i == 128) {
+      break;
+    }
+    n = nodes_[n].child[bit(address, i)];
+    if (n == 0) {
+      return false;
+    }
+  }
+  return false;
+}
+
+bool IpPrefixTree::contains(const std::string& s) const {
+  if (empty()) {
+    return false;
+  }
+  const auto addr = ip_address::from_string(s);
+  return addr.has_value() && contains(addr.value());
+}
+
+} // namespace wwiv::core
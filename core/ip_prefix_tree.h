@@ -0,0 +1,75 @@
+/**************************************************************************/
+/*                                                                        */
+/*                          WWIV Version 5.x                              */
+/*           Copyright (C)2022, WWIV Software Services                    */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/**************************************************************************/
+#ifndef INCLUDED_CORE_IP_PREFIX_TREE_H
+#define INCLUDED_CORE_IP_PREFIX_TREE_H
+
+#include "core/ip_address.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace wwiv::core {
+
+/**
+ * A set of IPv4 and IPv6 address prefixes (CIDR blocks), such as 10.0.0.0/8
+ * or 2001:db8::/32, stored as a binary radix tree over the 128 bits of the
+ * address.  IPv4 prefixes are stored as IPv4 mapped IPv6 prefixes, so an IPv4
+ * /8 is a /104 in the tree.
+ *
+ * Lookups walk at most one node per bit of the longest prefix in the set and
+ * never allocate memory.
+ */
+class IpPrefixTree final {
+public:
+  IpPrefixTree();
+
+  /**
+   * Adds an address or a prefix in CIDR notation.  An address without a prefix
+   * length is added as a single address.  Returns false if s is not valid.
+   */
+  bool insert(const std::string& s);
+
+  /** Adds the prefix of length prefix_len bits (0-128) of address. */
+  bool insert(const ip_address& address, int prefix_len);
+
+  /** True if address is within any prefix in this set. */
+  [[nodiscard]] bool contains(const ip_address& address) const noexcept;
+
+  /** True if s is a valid address within any prefix in this set. */
+  [[nodiscard]] bool contains(const std::string& s) const;
+
+  /** Number of prefixes added. */
+  [[nodiscard]] int size() const noexcept { return size_; }
+  [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+private:
+  struct node_t {
+    // Index into nodes_ for the 0 and 1 children, or 0 for none (the root
+    // is never a child).
+    int32_t child[2]{0, 0};
+    // True if a prefix ends at this node.
+    bool terminal{false};
+  };
+
+  std::vector<node_t> nodes_;
+  int size_{0};
+};
+
+} // namespace wwiv::core
+
+#endif
@@ -0,0 +1,95 @@
+/**************************************************************************/
+/*                                                                        */
+/*                          WWIV Version 5.x                              */
+/*           Copyright (C)2022, WWIV Software Services                    */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/**************************************************************************/
+#include "gtest/gtest.h"
+
+#include "core/ip_prefix_tree.h"
+#include <string>
+
+using namespace wwiv::core;
+
+TEST(IpPrefixTreeTest, Empty) {
+  const IpPrefixTree t;
+  EXPECT_TRUE(t.empty());
+  EXPECT_FALSE(t.contains("127.0.0.1"));
+  EXPECT_FALSE(t.contains("::1"));
+}
+
+TEST(IpPrefixTreeTest, SingleAddress_V4) {
+  IpPrefixTree t;
+  ASSERT_TRUE(t.insert("10.0.0.1"));
+  EXPECT_EQ(1, t.size());
+  EXPECT_TRUE(t.contains("10.0.0.1"));
+  EXPECT_FALSE(t.contains("10.0.0.2"));
+  EXPECT_FALSE(t.contains("::1"));
+}
+
+TEST(IpPrefixTreeTest, Prefix_V4) {
+  IpPrefixTree t;
+  ASSERT_TRUE(t.insert("192.168.0.0/16"));
+  EXPECT_TRUE(t.contains("192.168.0.1"));
+  EXPECT_TRUE(t.contains("192.168.255.255"));
+  EXPECT_FALSE(t.contains("192.169.0.1"));
+  EXPECT_FALSE(t.contains("10.0.0.1"));
+}
+
+TEST(IpPrefixTreeTest, Prefix_V4_OddLength) {
+  IpPrefixTree t;
+  ASSERT_TRUE(t.insert("10.0.0.0/9"));
+  EXPECT_TRUE(t.contains("10.127.0.1"));
+  EXPECT_FALSE(t.contains("10.128.0.1"));
+}
+
+TEST(IpPrefixTreeTest, Prefix_V4_All) {
+  IpPrefixTree t;
+  ASSERT_TRUE(t.insert("0.0.0.0/0"));
+  EXPECT_TRUE(t.contains("1.2.3.4"));
+  EXPECT_TRUE(t.contains("255.255.255.255"));
+  EXPECT_FALSE(t.contains("2001:db8::1"));
+}
+
+TEST(IpPrefixTreeTest, Prefix_V6) {
+  IpPrefixTree t;
+  ASSERT_TRUE(t.insert("2001:db8::/32"));
+  EXPECT_TRUE(t.contains("2001:db8::1"));
+  EXPECT_TRUE(t.contains("2001:db8:ffff::1"));
+  EXPECT_FALSE(t.contains("2001:db9::1"));
+  EXPECT_FALSE(t.contains("10.0.0.1"));
+}
+
+TEST(IpPrefixTreeTest, Overlapping) {
+  IpPrefixTree t;
+  ASSERT_TRUE(t.insert("10.1.2.3"));
+  ASSERT_TRUE(t.insert("10.0.0.0/8"));
+  ASSERT_TRUE(t.insert("10.2.0.0/16"));
+  EXPECT_EQ(2, t.size());
+  EXPECT_TRUE(t.contains("10.1.2.3"));
+  EXPECT_TRUE(t.contains("10.2.2.2"));
+  EXPECT_TRUE(t.contains("10.3.3.3"));
+}
+
+TEST(IpPrefixTreeTest, Invalid) {
+  IpPrefixTree t;
+  EXPECT_FALSE(t.insert(""));
+  EXPECT_FALSE(t.insert("bad"));
+  EXPECT_FALSE(t.insert("10.0.0.0/33"));
+  EXPECT_FALSE(t.insert("10.0.0.0/"));
+  EXPECT_FALSE(t.insert("10.0.0.0/x"));
+  EXPECT_FALSE(t.insert("::/129"));
+  EXPECT_TRUE(t.empty());
+  EXPECT_FALSE(t.contains("bad"));
+}
@@ -30,6 +30,7 @@
 #include <functional>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -45,6 +46,13 @@ static std::shared_ptr<Appender> console_appender;
 static std::shared_ptr<Appender> logfile_appender;
 LoggerConfig Logger::config_;
 
+// Serializes formatting and appending log lines, since the network programs
+// log from many threads.  Recursive since formatting the timestamp may log.
+static std::recursive_mutex& log_mutex() {
+  static std::recursive_mutex mu;
+  return mu;
+}
+
 class ConsoleAppender : public Appender {
   bool append(const std::string& message) override {
     std::cerr << message << std::endl;
@@ -116,6 +124,7 @@ Logger::~Logger() noexcept {
         return;
       }
     }
+    std::lock_guard<std::recursive_mutex> lock(log_mutex());
     const auto msg = FormatLogMessage(level_, verbosity_, ss_.str());
     const auto& appenders = config_.log_to[level_];
     if (appenders.empty()) {
@@ -221,8 +230,8 @@ void Logger::Init(int argc, char** argv, LoggerConfig& c) {
 }
 
 static std::string DefaultTimestamp() {
-  const auto dt = DateTime::now();
   const auto nowc = std::chrono::system_clock::now();
+  const auto dt = DateTime::from_time_t(std::chrono::system_clock::to_time_t(nowc));
   const auto duration = nowc.time_since_epoch();
   const auto millis = static_cast<int>(
     std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() % 1000);
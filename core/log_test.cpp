@@ -20,6 +20,7 @@
 #include "core/log.h"
 #include "core/stl.h"
 #include <string>
+#include <thread>
 #include <vector>
 
 using namespace wwiv::core;
@@ -63,3 +64,19 @@ TEST_F(LogTest, Smoke) {
   EXPECT_EQ("2018-01-01 21:12:00,530 INFO  Hello World!", info->log_lines.front());
   EXPECT_TRUE(warning->log_lines.empty());
 }
+
+TEST_F(LogTest, ManyThreads) {
+  std::vector<std::thread> threads;
+  for (auto t = 0; t < 4; t++) {
+    threads.emplace_back([t] {
+      for (auto i = 0; i < 500; i++) {
+        LOG(INFO) << "thread " << t << " line " << i;
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  // Appenders are only called by one thread at a time.
+  EXPECT_EQ(2000, wwiv::stl::ssize(info->log_lines));
+}
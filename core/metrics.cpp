@@ -0,0 +1,361 @@
+/**************************************************************************/
+/*                                                                        */
+/*                          WWIV Version 5.x                              */
+/*           Copyright (C)2022, WWIV Software Services                    */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/**************************************************************************/
+#include "core/metrics.h"
+
+#include "core/file.h"
+#include "core/strings.h"
+#include "core/textfile.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <limits>
+#include <locale>
+#include <sstream>
+#include <stdexcept>
+
+namespace wwiv::core {
+
+Histogram::Histogram(std::vector<double> bounds)
+    : bounds_(std::move(bounds)),
+      buckets_(std::make_unique<std::atomic<uint64_t>[]>(bounds_.size() + 1)) {
+  for (size_t i = 0; i <= bounds_.size(); i++) {
+    buckets_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+void Histogram::observe(double v) noexcept {
+  const auto it = std::lower_bound(std::begin(bounds_), std::end(bounds_), v);
+  buckets_[std::distance(std::begin(bounds_), it)].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  auto sum = sum_.load(std::memory_order_relaxed);
+  while (!sum_.compare_exchange_weak(sum, sum + v, std::memory_order_relaxed)) {
+    // sum was updated with the current value, try again.
+  }
+}
+
+uint64_t Histogram::bucket(int n) const noexcept {
+  if (n < 0 || static_cast<size_t>(n) > bounds_.size()) {
+    return 0;
+  }
+  return buckets_[n].load(std::memory_order_relaxed);
+}
+
+static std::string escape_label_value(const std::string& s) {
+  std::string out;
+  out.reserve(s.size());
+  for (const auto ch : s) {
+    switch (ch) {
+    case '\\':
+      out.append("\\\\");
+      break;
+    case '"':
+      out.append("\\\"");
+      break;
+    case '\n':
+      out.append("\\n");
+      break;
+    default:
+      out.push_back(ch);
+      break;
+    }
+  }
+  return out;
+}
+
+static std::string escape_help(const std::string& s) {
+  std::string out;
+  out.reserve(s.size());
+  for (const auto ch : s) {
+    if (ch == '\\') {
+      out.append("\\\\");
+    } else if (ch == '\n') {
+      out.append("\\n");
+    } else {
+      out.push_back(ch);
+    }
+  }
+  return out;
+}
+
+// Renders labels as {name="value",...}, with extra (i.e. le for histogram
+// buckets) appended to the end.  Returns an empty string when there are none.
+static std::string labels_text(const metric_labels_t& labels, const std::string& extra = {}) {
+  if (labels.empty() && extra.empty()) {
+    return {};
+  }
+  std::string s = "{";
+  for (const auto& [name, value] : labels) {
+    if (s.size() > 1) {
+      s.push_back(',');
+    }
+    s.append(name).append("=\"").append(escape_label_value(value)).append("\"");
+  }
+  if (!extra.empty()) {
+    if (s.size() > 1) {
+      s.push_back(',');
+    }
+    s.append(extra);
+  }
+  s.push_back('}');
+  return s;
+}
+
+static std::string format_double(double v) {
+  if (v == std::numeric_limits<double>::infinity()) {
+    return "+Inf";
+  }
+  std::ostringstream ss;
+  ss.imbue(std::locale::classic());
+  ss << std::setprecision(15) << v;
+  return ss.str();
+}
+
+static const char* type_name(metric_type_t type) {
+  switch (type) {
+  case metric_type_t::counter:
+    return "counter";
+  case metric_type_t::gauge:
+    return "gauge";
+  case metric_type_t::histogram:
+    return "histogram";
+  }
+  return "untyped";
+}
+
+MetricsRegistry::metric_t& MetricsRegistry::metric(const std::string& name,
+                                                   const std::string& help, metric_type_t type,
+                                                   const metric_labels_t& labels) {
+  // Must be called with mu_ held.
+  auto [fit, created] = families_.try_emplace(name, family_t{help, type, {}});
+  auto& family = fit->second;
+  if (!created && family.type != type) {
+    throw std::invalid_argument(
+        strings::StrCat("Metric '", name, "' already exists as a ", type_name(family.type)));
+  }
+  auto [mit, _] = family.metrics.try_emplace(labels_text(labels), metric_t{labels, {}, {}, {}});
+  return mit->second;
+}
+
+Counter& MetricsRegistry::counter(const std::string& name, const std::string& help,
+                                  const metric_labels_t& labels) {
+  std::lock_guard<std::mutex> lock(mu_);
+  auto& m = metric(name, help, metric_type_t::counter, labels);
+  if (!m.counter) {
+    m.counter = std::make_unique<Counter>();
+  }
+  return *m.counter;
+}
+
+Gauge& MetricsRegistry::gauge(const std::string& name, const std::string& help,
+                              const metric_labels_t& labels) {
+  std::lock_guard<std::mutex> lock(mu_);
+  auto& m = metric(name, help, metric_type_t::gauge, labels);
+  if (!m.gauge) {
+    m.gauge = std::make_unique<Gauge>();
+  }
+  return *m.gauge;
+}
+
+Histogram& MetricsRegistry::histogram(const std::string& name, const std::string& help,
+                                      const std::vector<double>& bounds,
+                                      const metric_labels_t& labels) {
+  std::lock_guard<std::mutex> lock(mu_);
+  auto& m = metric(name, help, metric_type_t::histogram, labels);
+  if (!m.histogram) {
+    m.histogram = std::make_unique<Histogram>(bounds);
+  }
+  return *m.histogram;
+}
+
+std::string MetricsRegistry::ToPrometheusText() const {
+  std::lock_guard<std::mutex> lock(mu_);
+  std::ostringstream ss;
+  ss.imbue(std::locale::classic());
+  for (const auto& [name, family] : families_) {
+    ss << "# HELP " << name << " " << escape_help(family.help) << "\n";
+    ss << "# TYPE " << name << " " << type_name(family.type) << "\n";
+    for (const auto& [labels, m] : family.metrics) {
+      switch (family.type) {
+      case metric_type_t::counter:
+        ss << name << labels << " " << m.counter->value() << "\n";
+        break;
+      case metric_type_t::gauge:
+        ss << name << labels << " " << m.gauge->value() << "\n";
+        break;
+      case metric_type_t::histogram: {
+        const auto& h = *m.histogram;
+        const auto& bounds = h.bounds();
+        uint64_t cumulative{0};
+        for (size_t i = 0; i <= bounds.size(); i++) {
+          cumulative += h.bucket(static_cast<int>(i));
+          const auto le = i < bounds.size() ? format_double(bounds[i]) : "+Inf";
+          ss << name << "_bucket" << labels_text(m.labels, strings::StrCat("le=\"", le, "\""))
+             << " " << cumulative << "\n";
+        }
+        ss << name << "_sum" << labels << " " << format_double(h.sum()) << "\n";
+        ss << name << "_count" << labels << " " << h.count() << "\n";
+      } break;
+      }
+    }
+  }
+  return ss.str();
+}
+
+static bool ensure_parent_exists(const std::filesystem::path& path) {
+  const auto dir = path.parent_path();
+  return dir.empty() || File::Exists(dir) || File::mkdirs(dir);
+}
+
+bool MetricsRegistry::Write(const std::filesystem::path& path) const {
+  if (!ensure_parent_exists(path)) {
+    return false;
+  }
+  const auto text = ToPrometheusText();
+  return File::WriteAtomically(path, text.data(), static_cast<File::size_type>(text.size()));
+}
+
+namespace {
+// A metric family parsed from the Prometheus text format.
+struct text_family_t {
+  std::string help;
+  std::string type;
+  // Sample name with labels, and value, in the order read.
+  std::vector<std::pair<std::string, std::string>> samples;
+};
+} // namespace
+
+// Parses text as written by ToPrometheusText.
+static std::map<std::string, text_family_t> parse_prometheus_text(const std::string& text) {
+  std::map<std::string, text_family_t> families;
+  text_family_t* current = nullptr;
+  for (const auto& line : strings::SplitString(text, "\n")) {
+    if (strings::starts_with(line, "# HELP ") || strings::starts_with(line, "# TYPE ")) {
+      const auto rest = line.substr(7);
+      const auto space = rest.find(' ');
+      const auto name = rest.substr(0, space);
+      const auto value = space == std::string::npos ? std::string() : rest.substr(space + 1);
+      current = &families[name];
+      if (line[2] == 'H') {
+        current->help = value;
+      } else {
+        current->type = value;
+      }
+      continue;
+    }
+    const auto space = line.rfind(' ');
+    if (line.empty() || line.front() == '#' || space == std::string::npos || !current) {
+      continue;
+    }
+    current->samples.emplace_back(line.substr(0, space), line.substr(space + 1));
+  }
+  return families;
+}
+
+static std::string render_prometheus_text(const std::map<std::string, text_family_t>& families) {
+  std::string text;
+  for (const auto& [name, family] : families) {
+    text.append("# HELP ").append(name).append(" ").append(family.help).append("\n");
+    text.append("# TYPE ").append(name).append(" ").append(family.type).append("\n");
+    for (const auto& [sample, value] : family.samples) {
+      text.append(sample).append(" ").append(value).append("\n");
+    }
+  }
+  return text;
+}
+
+static bool parse_count(const std::string& s, uint64_t& v) {
+  const auto is_digit = [](char c) { return c >= '0' && c <= '9'; };
+  if (s.empty() || !std::all_of(std::begin(s), std::end(s), is_digit)) {
+    return false;
+  }
+  v = std::strtoull(s.c_str(), nullptr, 10);
+  return true;
+}
+
+// Returns l + sign * r, keeping whole numbers (i.e. counts) exact.
+static std::string add_values(const std::string& l, const std::string& r, int sign = 1) {
+  if (uint64_t lc, rc; parse_count(l, lc) && parse_count(r, rc)) {
+    if (sign > 0) {
+      return std::to_string(lc + rc);
+    }
+    return std::to_string(lc >= rc ? lc - rc : 0);
+  }
+  const auto to_double = [](const std::string& s) {
+    std::istringstream ss(s);
+    ss.imbue(std::locale::classic());
+    double d{0};
+    ss >> d;
+    return d;
+  };
+  return format_double(to_double(l) + sign * to_double(r));
+}
+
+bool MetricsRegistry::Accumulate(const std::filesystem::path& path) {
+  std::lock_guard<std::mutex> accumulate_lock(accumulate_mu_);
+  if (!ensure_parent_exists(path)) {
+    return false;
+  }
+  // Other processes update the same file, so hold a lock file while merging.
+  auto lock_path = path;
+  lock_path += ".lock";
+  File lock_file(lock_path);
+  if (!lock_file.Open(File::modeBinary | File::modeReadWrite | File::modeCreateFile)) {
+    return false;
+  }
+  auto lock = lock_file.lock(FileLockType::write_lock);
+
+  auto merged = parse_prometheus_text(
+      File::Exists(path) ? TextFile(path, "rb").ReadFileIntoString() : std::string());
+  std::map<std::string, std::string> accumulated;
+  for (const auto& [name, family] : parse_prometheus_text(ToPrometheusText())) {
+    auto& m = merged[name];
+    m.help = family.help;
+    m.type = family.type;
+    const auto additive = family.type == "counter" || family.type == "histogram";
+    for (const auto& [sample, value] : family.samples) {
+      auto it = std::find_if(std::begin(m.samples), std::end(m.samples),
+                             [&sample](const auto& s) { return s.first == sample; });
+      if (it == std::end(m.samples)) {
+        it = m.samples.emplace(std::end(m.samples), sample, additive ? "0" : value);
+      }
+      if (!additive) {
+        it->second = value;
+        continue;
+      }
+      const auto done = accumulated_.find(sample);
+      const auto delta =
+          done == std::end(accumulated_) ? value : add_values(value, done->second, -1);
+      it->second = add_values(it->second, delta);
+      accumulated.emplace(sample, value);
+    }
+  }
+  const auto text = render_prometheus_text(merged);
+  if (!File::WriteAtomically(path, text.data(), static_cast<File::size_type>(text.size()))) {
+    return false;
+  }
+  accumulated_ = std::move(accumulated);
+  return true;
+}
+
+// Returns the singleton global instance.
+MetricsRegistry& metrics() {
+  static MetricsRegistry metrics_;
+  return metrics_;
+}
+
+} // namespace wwiv::core
@@ -0,0 +1,165 @@
+/**************************************************************************/
+/*                                                                        */
+/*                          WWIV Version 5.x                              */
+/*           Copyright (C)2022, WWIV Software Services                    */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/**************************************************************************/
+#ifndef INCLUDED_CORE_METRICS_H
+#define INCLUDED_CORE_METRICS_H
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace wwiv::core {
+
+// Label name and value pairs for a metric, i.e. {{"type", "telnet"}}
+typedef std::vector<std::pair<std::string, std::string>> metric_labels_t;
+
+enum class metric_type_t { counter, gauge, histogram };
+
+/** A count that only goes up, i.e. connections accepted. */
+class Counter final {
+public:
+  void inc(uint64_t n = 1) noexcept { value_.fetch_add(n, std::memory_order_relaxed); }
+  [[nodiscard]] uint64_t value() const noexcept { return value_.load(std::memory_order_relaxed); }
+
+private:
+  std::atomic<uint64_t> value_{0};
+};
+
+/** A value that can go up and down, i.e. sessions in progress. */
+class Gauge final {
+public:
+  void set(int64_t v) noexcept { value_.store(v, std::memory_order_relaxed); }
+  void inc(int64_t n = 1) noexcept { value_.fetch_add(n, std::memory_order_relaxed); }
+  void dec(int64_t n = 1) noexcept { value_.fetch_sub(n, std::memory_order_relaxed); }
+  [[nodiscard]] int64_t value() const noexcept { return value_.load(std::memory_order_relaxed); }
+
+private:
+  std::atomic<int64_t> value_{0};
+};
+
+/**
+ * Counts observations, i.e. session lengths in seconds, into buckets with
+ * fixed upper bounds.  There is always a final bucket for values larger than
+ * the last bound.
+ */
+class Histogram final {
+public:
+  // bounds are the upper bound of each bucket, and must be in increasing order.
+  explicit Histogram(std::vector<double> bounds);
+
+  void observe(double v) noexcept;
+
+  [[nodiscard]] const std::vector<double>& bounds() const noexcept { return bounds_; }
+  // Number of observations in bucket n (not cumulative), n may be bounds().size()
+  // for the observations larger than every bound.
+  [[nodiscard]] uint64_t bucket(int n) const noexcept;
+  [[nodiscard]] uint64_t count() const noexcept { return count_.load(std::memory_order_relaxed); }
+  [[nodiscard]] double sum() const noexcept { return sum_.load(std::memory_order_relaxed); }
+
+private:
+  const std::vector<double> bounds_;
+  std::unique_ptr<std::atomic<uint64_t>[]> buckets_;
+  std::atomic<uint64_t> count_{0};
+  std::atomic<double> sum_{0};
+};
+
+/**
+ * Holds the counters, gauges and histograms for this process and renders them
+ * in the Prometheus text exposition format.
+ *
+ * Metrics are created on first use and live as long as the registry, so callers
+ * usually keep a reference in a function static and update it without locking:
+ *
+ *   static auto& packets = metrics().counter("network1_packets_total",
+ *                                            "WWIVnet packets processed by network1.");
+ *   packets.inc();
+ *
+ * Asking for a name that exists with a different type throws std::invalid_argument.
+ */
+class MetricsRegistry final {
+public:
+  MetricsRegistry() = default;
+  MetricsRegistry(const MetricsRegistry&) = delete;
+  MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+  ~MetricsRegistry() = default;
+
+  Counter& counter(const std::string& name, const std::string& help,
+                   const metric_labels_t& labels = {});
+  Gauge& gauge(const std::string& name, const std::string& help,
+               const metric_labels_t& labels = {});
+  // bounds are only used when the histogram is first created.
+  Histogram& histogram(const std::string& name, const std::string& help,
+                       const std::vector<double>& bounds, const metric_labels_t& labels = {});
+
+  /** Returns all of the metrics in the Prometheus text exposition format. */
+  [[nodiscard]] std::string ToPrometheusText() const;
+
+  /**
+   * Writes ToPrometheusText to path, replacing it atomically so that readers
+   * never see a partial file.
+   */
+  bool Write(const std::filesystem::path& path) const;
+
+  /**
+   * Adds the counters and histograms of this registry, as they changed since
+   * the last call, to the ones in the file at path, and replaces the gauges.
+   * Metrics in the file that this registry doesn't have are kept.  The file
+   * is locked while it is updated, so concurrent runs don't lose each others
+   * counts.  Used by programs that exit before they can be scraped, so that
+   * wwivd can serve the totals across all of their runs.
+   */
+  bool Accumulate(const std::filesystem::path& path);
+
+private:
+  struct metric_t {
+    metric_labels_t labels;
+    std::unique_ptr<Counter> counter;
+    std::unique_ptr<Gauge> gauge;
+    std::unique_ptr<Histogram> histogram;
+  };
+
+  struct family_t {
+    std::string help;
+    metric_type_t type;
+    // Keyed by the labels rendered as text.
+    std::map<std::string, metric_t> metrics;
+  };
+
+  metric_t& metric(const std::string& name, const std::string& help, metric_type_t type,
+                   const metric_labels_t& labels);
+
+  mutable std::mutex mu_;
+  std::map<std::string, family_t> families_;
+
+  std::mutex accumulate_mu_;
+  // Values of the counter and histogram samples already added by Accumulate,
+  // keyed by the sample name and labels.
+  std::map<std::string, std::string> accumulated_;
+};
+
+/** Returns the metrics for this process. */
+MetricsRegistry& metrics();
+
+} // namespace wwiv::core
+
+#endif
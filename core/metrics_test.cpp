@@ -0,0 +1,157 @@
+/**************************************************************************/
+/*                                                                        */
+/*                          WWIV Version 5.x                              */
+/*           Copyright (C)2022, WWIV Software Services                    */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/**************************************************************************/
+#include "gtest/gtest.h"
+
+#include "core/file.h"
+#include "core/metrics.h"
+#include "core/test/file_helper.h"
+#include "core/textfile.h"
+#include <stdexcept>
+#include <string>
+
+using namespace wwiv::core;
+using namespace wwiv::core::test;
+
+TEST(MetricsTest, Counter) {
+  MetricsRegistry r;
+  auto& c = r.counter("test_total", "Test counter.");
+  c.inc();
+  c.inc(2);
+  EXPECT_EQ(3u, c.value());
+  // Same name and labels returns the same counter.
+  EXPECT_EQ(&c, &r.counter("test_total", "Test counter."));
+  EXPECT_NE(&c, &r.counter("test_total", "Test counter.", {{"type", "a"}}));
+}
+
+TEST(MetricsTest, Gauge) {
+  MetricsRegistry r;
+  auto& g = r.gauge("test_gauge", "Test gauge.");
+  g.set(5);
+  g.inc();
+  g.dec(3);
+  EXPECT_EQ(3, g.value());
+}
+
+TEST(MetricsTest, Histogram) {
+  Histogram h({1, 5});
+  h.observe(0.5);
+  h.observe(1);
+  h.observe(3);
+  h.observe(10);
+  EXPECT_EQ(2u, h.bucket(0));
+  EXPECT_EQ(1u, h.bucket(1));
+  EXPECT_EQ(1u, h.bucket(2));
+  EXPECT_EQ(4u, h.count());
+  EXPECT_DOUBLE_EQ(14.5, h.sum());
+}
+
+TEST(MetricsTest, WrongType) {
+  MetricsRegistry r;
+  r.counter("test", "Test.");
+  EXPECT_THROW(r.gauge("test", "Test."), std::invalid_argument);
+}
+
+TEST(MetricsTest, ToPrometheusText) {
+  MetricsRegistry r;
+  r.counter("conn_total", "Connections.", {{"type", "telnet"}}).inc(2);
+  r.gauge("active", "Active \\ sessions.").set(1);
+  auto& h = r.histogram("len_seconds", "Lengths.", {0.5, 10}, {{"peer", "a\"b"}});
+  h.observe(0.25);
+  h.observe(20);
+
+  const std::string expected = "# HELP active Active \\\\ sessions.\n"
+                               "# TYPE active gauge\n"
+                               "active 1\n"
+                               "# HELP conn_total Connections.\n"
+                               "# TYPE conn_total counter\n"
+                               "conn_total{type=\"telnet\"} 2\n"
+                               "# HELP len_seconds Lengths.\n"
+                               "# TYPE len_seconds histogram\n"
+                               "len_seconds_bucket{peer=\"a\\\"b\",le=\"0.5\"} 1\n"
+                               "len_seconds_bucket{peer=\"a\\\"b\",le=\"10\"} 1\n"
+                               "len_seconds_bucket{peer=\"a\\\"b\",le=\"+Inf\"} 2\n"
+                               "len_seconds_sum{peer=\"a\\\"b\"} 20.25\n"
+                               "len_seconds_count{peer=\"a\\\"b\"} 2\n";
+  EXPECT_EQ(expected, r.ToPrometheusText());
+}
+
+TEST(MetricsTest, Write) {
+  FileHelper helper;
+  MetricsRegistry r;
+  r.counter("test_total", "Test.").inc();
+  const auto path = helper.Dir("metrics") / "test.prom";
+  ASSERT_TRUE(r.Write(path));
+  EXPECT_EQ(r.ToPrometheusText(), TextFile(path, "rb").ReadFileIntoString());
+  EXPECT_FALSE(File::Exists(helper.Dir("metrics") / "test.prom.tmp"));
+}
+
+TEST(MetricsTest, Accumulate_AddsRuns) {
+  FileHelper helper;
+  const auto path = helper.Dir("metrics") / "test.prom";
+  {
+    MetricsRegistry r;
+    r.counter("test_total", "Test.").inc(2);
+    r.gauge("test_gauge", "Gauge.").set(5);
+    r.histogram("test_seconds", "Hist.", {1.0}).observe(0.5);
+    ASSERT_TRUE(r.Accumulate(path));
+  }
+  MetricsRegistry r;
+  r.counter("test_total", "Test.").inc(3);
+  r.gauge("test_gauge", "Gauge.").set(1);
+  r.histogram("test_seconds", "Hist.", {1.0}).observe(0.25);
+  ASSERT_TRUE(r.Accumulate(path));
+
+  const std::string expected = "# HELP test_gauge Gauge.\n"
+                               "# TYPE test_gauge gauge\n"
+                               "test_gauge 1\n"
+                               "# HELP test_seconds Hist.\n"
+                               "# TYPE test_seconds histogram\n"
+                               "test_seconds_bucket{le=\"1\"} 2\n"
+                               "test_seconds_bucket{le=\"+Inf\"} 2\n"
+                               "test_seconds_sum 0.75\n"
+                               "test_seconds_count 2\n"
+                               "# HELP test_total Test.\n"
+                               "# TYPE test_total counter\n"
+                               "test_total 5\n";
+  EXPECT_EQ(expected, TextFile(path, "rb").ReadFileIntoString());
+}
+
+TEST(MetricsTest, Accumulate_OnlyAddsChanges) {
+  FileHelper helper;
+  const auto path = helper.Dir("metrics") / "test.prom";
+  MetricsRegistry other;
+  other.counter("other_total", "Other.").inc(7);
+  other.counter("test_total", "Test.").inc(10);
+  ASSERT_TRUE(other.Accumulate(path));
+
+  MetricsRegistry r;
+  auto& c = r.counter("test_total", "Test.");
+  c.inc();
+  ASSERT_TRUE(r.Accumulate(path));
+  ASSERT_TRUE(r.Accumulate(path));
+  c.inc(2);
+  ASSERT_TRUE(r.Accumulate(path));
+
+  const std::string expected = "# HELP other_total Other.\n"
+                               "# TYPE other_total counter\n"
+                               "other_total 7\n"
+                               "# HELP test_total Test.\n"
+                               "# TYPE test_total counter\n"
+                               "test_total 13\n";
+  EXPECT_EQ(expected, TextFile(path, "rb").ReadFileIntoString());
+}
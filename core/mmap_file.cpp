@@ -0,0 +1,201 @@
+/**************************************************************************/
+/*                                                                        */
+/*                          WWIV Version 5.x                              */
+/*           Copyright (C)2022, WWIV Software Services                    */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/**************************************************************************/
+#include "core/mmap_file.h"
+
+#include "core/file.h"
+#include "core/log.h"
+#include <utility>
+
+#ifdef _WIN32
+#include "core/wwiv_windows.h"
+#elif !defined(__OS2__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace wwiv::core {
+
+MemoryMappedFile::MemoryMappedFile(std::filesystem::path path, Mode mode)
+    : path_(std::move(path)), mode_(mode) {
+  open_ = open();
+}
+
+MemoryMappedFile::~MemoryMappedFile() { close(); }
+
+uint8_t* MemoryMappedFile::mutable_data() noexcept {
+  return mode_ == Mode::read_write ? data_ : nullptr;
+}
+
+std::string_view MemoryMappedFile::view() const noexcept {
+  if (data_ == nullptr) {
+    return {};
+  }
+  return {reinterpret_cast<const char*>(data_), size_};
+}
+
+#if defined(_WIN32)
+
+bool MemoryMappedFile::open() {
+  const auto rw = mode_ == Mode::read_write;
+  auto* h = CreateFileW(path_.wstring().c_str(), rw ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+                        FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING,
+                        FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (h == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  file_handle_ = h;
+  LARGE_INTEGER size{};
+  if (!GetFileSizeEx(h, &size)) {
+    close();
+    return false;
+  }
+  size_ = static_cast<size_t>(size.QuadPart);
+  if (size_ == 0) {
+    // Can't map an empty file, but it's still a valid (empty) file.
+    return true;
+  }
+  mapping_handle_ = CreateFileMappingW(h, nullptr, rw ? PAGE_READWRITE : PAGE_READONLY, 0, 0, nullptr);
+  if (mapping_handle_ == nullptr) {
+    close();
+    return false;
+  }
+  data_ = static_cast<uint8_t*>(
+      MapViewOfFile(mapping_handle_, rw ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0));
+  if (data_ == nullptr) {
+    close();
+    return false;
+  }
+  return true;
+}
+
+bool MemoryMappedFile::flush() {
+  if (data_ == nullptr || mode_ != Mode::read_write) {
+    return true;
+  }
+  return FlushViewOfFile(data_, 0) != 0;
+}
+
+void MemoryMappedFile::close() {
+  flush();
+  if (data_ != nullptr) {
+    UnmapViewOfFile(data_);
+    data_ = nullptr;
+  }
+  if (mapping_handle_ != nullptr) {
+    CloseHandle(mapping_handle_);
+    mapping_handle_ = nullptr;
+  }
+  if (file_handle_ != nullptr) {
+    CloseHandle(file_handle_);
+    file_handle_ = nullptr;
+  }
+  size_ = 0;
+  open_ = false;
+}
+
+#elif defined(__OS2__)
+
+// No mmap on OS/2, just read the whole thing into memory.
+bool MemoryMappedFile::open() {
+  File f(path_);
+  if (!f.Open(File::modeBinary | File::modeReadOnly)) {
+    return false;
+  }
+  buffer_.resize(static_cast<size_t>(f.length()));
+  if (!buffer_.empty() && f.Read(buffer_.data(), buffer_.size()) != static_cast<File::size_type>(buffer_.size())) {
+    buffer_.clear();
+    return false;
+  }
+  data_ = buffer_.empty() ? nullptr : reinterpret_cast<uint8_t*>(buffer_.data());
+  size_ = buffer_.size();
+  return true;
+}
+
+bool MemoryMappedFile::flush() {
+  if (!open_ || mode_ != Mode::read_write || buffer_.empty()) {
+    return true;
+  }
+  File f(path_);
+  if (!f.Open(File::modeBinary | File::modeReadWrite)) {
+    return false;
+  }
+  return f.Write(buffer_.data(), buffer_.size()) == static_cast<File::size_type>(buffer_.size());
+}
+
+void MemoryMappedFile::close() {
+  flush();
+  buffer_.clear();
+  data_ = nullptr;
+  size_ = 0;
+  open_ = false;
+}
+
+#else
+
+bool MemoryMappedFile::open() {
+  const auto rw = mode_ == Mode::read_write;
+  fd_ = ::open(path_.string().c_str(), rw ? O_RDWR : O_RDONLY);
+  if (fd_ < 0) {
+    return false;
+  }
+  struct stat st {};
+  if (fstat(fd_, &st) != 0) {
+    close();
+    return false;
+  }
+  size_ = static_cast<size_t>(st.st_size);
+  if (size_ == 0) {
+    // Can't map an empty file, but it's still a valid (empty) file.
+    return true;
+  }
+  auto* p = mmap(nullptr, size_, rw ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd_, 0);
+  if (p == MAP_FAILED) {
+    LOG(ERROR) << "Unable to mmap file: " << path_ << "; errno: " << errno;
+    close();
+    return false;
+  }
+  data_ = static_cast<uint8_t*>(p);
+  return true;
+}
+
+bool MemoryMappedFile::flush() {
+  if (data_ == nullptr || mode_ != Mode::read_write) {
+    return true;
+  }
+  return msync(data_, size_, MS_SYNC) == 0;
+}
+
+void MemoryMappedFile::close() {
+  flush();
+  if (data_ != nullptr) {
+    munmap(data_, size_);
+    data_ = nullptr;
+  }
+  if (fd_ >= 0) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+  size_ = 0;
+  open_ = false;
+}
+
+#endif
+
+} // namespace wwiv::core
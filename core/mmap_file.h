@@ -0,0 +1,87 @@
+/**************************************************************************/
+/*                                                                        */
+/*                          WWIV Version 5.x                              */
+/*           Copyright (C)2022, WWIV Software Services                    */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/**************************************************************************/
+#ifndef INCLUDED_CORE_MMAP_FILE_H
+#define INCLUDED_CORE_MMAP_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace wwiv::core {
+
+/**
+ * A file mapped into memory.
+ *
+ * Used for large, mostly read-only data files (indexes, packets) where
+ * reading the whole file through File::Read would be wasteful.  On platforms
+ * without mmap support the contents are read into memory instead, and in
+ * read_write mode written back on flush.
+ *
+ * The size of the mapping is fixed when the file is opened.  To grow a file,
+ * close it, change the length using File::set_length and reopen it.
+ *
+ * Example:
+ *   MemoryMappedFile f(FilePath(datadir, "nodelist.nlx"));
+ *   if (!f) { return false; }
+ *   const auto v = f.view();
+ */
+class MemoryMappedFile final {
+public:
+  enum class Mode { read_only, read_write };
+
+  explicit MemoryMappedFile(std::filesystem::path path, Mode mode = Mode::read_only);
+  MemoryMappedFile(const MemoryMappedFile&) = delete;
+  MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+  ~MemoryMappedFile();
+
+  [[nodiscard]] bool is_open() const noexcept { return open_; }
+  explicit operator bool() const noexcept { return open_; }
+
+  [[nodiscard]] const uint8_t* data() const noexcept { return data_; }
+  /** Returns the writable mapping, or nullptr if opened read_only. */
+  [[nodiscard]] uint8_t* mutable_data() noexcept;
+  [[nodiscard]] size_t size() const noexcept { return size_; }
+  [[nodiscard]] std::string_view view() const noexcept;
+  [[nodiscard]] const std::filesystem::path& path() const noexcept { return path_; }
+
+  /** Writes any modified pages back to disk. */
+  bool flush();
+  /** Unmaps the file, flushing first if writable. */
+  void close();
+
+private:
+  bool open();
+
+  const std::filesystem::path path_;
+  const Mode mode_;
+  uint8_t* data_{nullptr};
+  size_t size_{0};
+  bool open_{false};
+  // Native handles.
+  int fd_{-1};
+  void* file_handle_{nullptr};
+  void* mapping_handle_{nullptr};
+  // Used when memory mapping is not available.
+  std::string buffer_;
+};
+
+} // namespace wwiv::core
+
+#endif
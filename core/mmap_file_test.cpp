@@ -0,0 +1,66 @@
+/**************************************************************************/
+/*                                                                        */
+/*                          WWIV Version 5.x                              */
+/*           Copyright (C)2022, WWIV Software Services                    */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/**************************************************************************/
+#include "gtest/gtest.h"
+
+#include "core/file.h"
+#include "core/mmap_file.h"
+#include "core/test/file_helper.h"
+#include <string>
+
+using namespace wwiv::core;
+using namespace wwiv::core::test;
+
+TEST(MemoryMappedFileTest, ReadOnly) {
+  FileHelper helper;
+  const auto path = helper.CreateTempFile("mmap", "Hello World");
+  MemoryMappedFile f(path);
+  ASSERT_TRUE(f);
+  EXPECT_EQ(11u, f.size());
+  EXPECT_EQ("Hello World", f.view());
+  EXPECT_EQ(nullptr, f.mutable_data());
+}
+
+TEST(MemoryMappedFileTest, Missing) {
+  FileHelper helper;
+  MemoryMappedFile f(FilePath(helper.TempDir(), "missing"));
+  EXPECT_FALSE(f);
+  EXPECT_TRUE(f.view().empty());
+}
+
+TEST(MemoryMappedFileTest, Empty) {
+  FileHelper helper;
+  const auto path = helper.CreateTempFile("empty", "");
+  MemoryMappedFile f(path);
+  ASSERT_TRUE(f);
+  EXPECT_EQ(0u, f.size());
+  EXPECT_TRUE(f.view().empty());
+}
+
+TEST(MemoryMappedFileTest, ReadWrite) {
+  FileHelper helper;
+  const auto path = helper.CreateTempFile("mmap", "Hello World");
+  {
+    MemoryMappedFile f(path, MemoryMappedFile::Mode::read_write);
+    ASSERT_TRUE(f);
+    auto* p = f.mutable_data();
+    ASSERT_NE(nullptr, p);
+    p[0] = 'J';
+    EXPECT_TRUE(f.flush());
+  }
+  EXPECT_EQ("Jello World", helper.ReadFile(path));
+}
@@ -55,7 +55,7 @@ static std::shared_ptr<FsedView> create_frame(MessageEditorData& data, bool file
 bool fsed(Context& ctx, const std::filesystem::path& path) {
   MessageEditorData data("<<NO USERNAME>>"); // anonymous username
   data.title = path.string();
-  FsedModel ed(1000);
+  FsedModel ed(10000);
   auto file_lines = read_file(path, ed.maxli());
   if (!file_lines.empty()) {
     ed.set_lines(std::move(file_lines));
@@ -137,3 +137,49 @@ TEST_F(FsedModelWithViewTest, BackSpace_Color) {
   // Now 0 since we went to the end.
   EXPECT_EQ(0, ed.curline().wwiv_color());
 }
+
+TEST_F(FsedModelWithViewTest, WordWrap) {
+  ed.set_max_line_len(20);
+  add("Hello World This Is A Test");
+  EXPECT_EQ(2, wwiv::stl::ssize(ed));
+  EXPECT_EQ("Hello World This Is ", ed.line(0).to_colored_text(0));
+  EXPECT_TRUE(ed.line(0).wrapped());
+  EXPECT_EQ("A Test", ed.line(1).to_colored_text(0));
+  EXPECT_EQ(1, ed.curli);
+  EXPECT_EQ(6, ed.cx);
+}
+
+TEST_F(FsedModelWithViewTest, WordWrap_ReflowsParagraph) {
+  ed.set_max_line_len(20);
+  add("aaaa bbbb cccc dddd eeee ffff gggg hhhh iiii\nNext");
+  ASSERT_EQ(4, wwiv::stl::ssize(ed));
+
+  // Type at the end of the first line, the new word wraps onto the start
+  // of the second line of the paragraph, which pushes a word onto the third.
+  ed.curli = 0;
+  ed.cy = 0;
+  ed.cx = size_int(ed.line(0));
+  add("xx");
+  ASSERT_EQ(4, wwiv::stl::ssize(ed));
+  EXPECT_EQ("aaaa bbbb cccc dddd ", ed.line(0).to_colored_text(0));
+  EXPECT_EQ("xx eeee ffff gggg ", ed.line(1).to_colored_text(0));
+  EXPECT_EQ("hhhh iiii", ed.line(2).to_colored_text(0));
+  EXPECT_EQ("Next", ed.line(3).to_colored_text(0));
+  EXPECT_EQ(1, ed.curli);
+  EXPECT_EQ(2, ed.cx);
+}
+
+TEST_F(FsedModelWithViewTest, InsertLines_Many) {
+  std::vector<std::string> lines;
+  for (auto i = 0; i < 200; i++) {
+    lines.push_back(fmt::format("Line {}", i));
+  }
+  wwiv::fsed::FsedModel big{5000};
+  big.set_view(view);
+  big.insert_lines(lines);
+  // A blank line first, then the quoted lines and then a blank line to
+  // start typing on.
+  EXPECT_EQ(202, wwiv::stl::ssize(big));
+  EXPECT_EQ("Line 0", big.line(1).to_colored_text(0));
+  EXPECT_EQ("Line 199", big.line(200).to_colored_text(0));
+}
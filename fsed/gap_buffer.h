@@ -0,0 +1,144 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*              Copyright (C)2020-2022, WWIV Software Services            */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/**************************************************************************/
+#ifndef INCLUDED_FSED_GAP_BUFFER_H
+#define INCLUDED_FSED_GAP_BUFFER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace wwiv::fsed {
+
+/**
+ * A sequence of T which keeps the unused space as a gap at the position of
+ * the last insert or erase.  Edits near the previous one (typing, word wrap,
+ * inserting a block of quoted lines) only move the elements between the two
+ * positions instead of every element after the edit as std::vector does.
+ */
+template <typename T> class gap_buffer {
+public:
+  gap_buffer() = default;
+  explicit gap_buffer(std::vector<T>&& v) { assign(std::move(v)); }
+
+  [[nodiscard]] std::size_t size() const noexcept { return buf_.size() - gap_size(); }
+  [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+
+  /** Gets the element at position n, throws std::out_of_range if n is invalid */
+  [[nodiscard]] T& at(std::size_t n) {
+    if (n >= size()) {
+      throw std::out_of_range("gap_buffer::at: " + std::to_string(n));
+    }
+    return (*this)[n];
+  }
+
+  [[nodiscard]] const T& at(std::size_t n) const {
+    if (n >= size()) {
+      throw std::out_of_range("gap_buffer::at: " + std::to_string(n));
+    }
+    return (*this)[n];
+  }
+
+  [[nodiscard]] T& operator[](std::size_t n) { return buf_[n < gap_start_ ? n : n + gap_size()]; }
+  [[nodiscard]] const T& operator[](std::size_t n) const {
+    return buf_[n < gap_start_ ? n : n + gap_size()];
+  }
+
+  /** Inserts t before position pos, returning false if pos is invalid */
+  bool insert(std::size_t pos, T t) {
+    if (pos > size()) {
+      return false;
+    }
+    if (gap_size() == 0) {
+      grow();
+    }
+    move_gap(pos);
+    buf_[gap_start_++] = std::move(t);
+    return true;
+  }
+
+  /** Removes the element at position pos, returning false if pos is invalid */
+  bool erase(std::size_t pos) {
+    if (pos >= size()) {
+      return false;
+    }
+    move_gap(pos);
+    // Release anything held by the removed element.
+    buf_[gap_end_++] = T();
+    return true;
+  }
+
+  void emplace_back(T t) { insert(size(), std::move(t)); }
+
+  /** Replaces the contents with v */
+  void assign(std::vector<T>&& v) {
+    buf_ = std::move(v);
+    gap_start_ = gap_end_ = buf_.size();
+  }
+
+  void clear() {
+    buf_.clear();
+    gap_start_ = gap_end_ = 0;
+  }
+
+private:
+  [[nodiscard]] std::size_t gap_size() const noexcept { return gap_end_ - gap_start_; }
+
+  // Moves the gap so that it starts at pos.
+  void move_gap(std::size_t pos) {
+    if (gap_size() == 0) {
+      // Nothing to move, and moving elements onto themselves would empty them.
+      gap_start_ = gap_end_ = pos;
+    } else if (pos < gap_start_) {
+      const auto b = std::begin(buf_);
+      std::move_backward(b + pos, b + gap_start_, b + gap_end_);
+      gap_end_ -= gap_start_ - pos;
+      gap_start_ = pos;
+    } else if (pos > gap_start_) {
+      const auto b = std::begin(buf_);
+      const auto count = pos - gap_start_;
+      std::move(b + gap_end_, b + gap_end_ + count, b + gap_start_);
+      gap_start_ += count;
+      gap_end_ += count;
+    }
+  }
+
+  // Doubles the space available, keeping the gap at the same position.
+  void grow() {
+    const auto tail = buf_.size() - gap_end_;
+    const auto capacity = std::max<std::size_t>(16, buf_.size() * 2);
+    std::vector<T> n(capacity);
+    const auto b = std::begin(buf_);
+    std::move(b, b + gap_start_, std::begin(n));
+    std::move(b + gap_end_, std::end(buf_), std::end(n) - tail);
+    buf_ = std::move(n);
+    gap_end_ = capacity - tail;
+  }
+
+  std::vector<T> buf_;
+  // The gap is the unused space [gap_start_, gap_end_) within buf_.
+  std::size_t gap_start_{0};
+  std::size_t gap_end_{0};
+};
+
+} // namespace wwiv::fsed
+
+#endif
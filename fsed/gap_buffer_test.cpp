@@ -0,0 +1,106 @@
+/**************************************************************************/
+/*                                                                        */
+/*                              WWIV Version 5.x                          */
+/*               Copyright (C)2014-2022, WWIV Software Services           */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/*                                                                        */
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include "fsed/gap_buffer.h"
+#include <string>
+#include <vector>
+
+using namespace wwiv::fsed;
+using namespace testing;
+
+static std::vector<std::string> to_vector(const gap_buffer<std::string>& b) {
+  std::vector<std::string> v;
+  for (std::size_t i = 0; i < b.size(); i++) {
+    v.push_back(b[i]);
+  }
+  return v;
+}
+
+TEST(GapBufferTest, Empty) {
+  const gap_buffer<std::string> b;
+  EXPECT_TRUE(b.empty());
+  EXPECT_EQ(0u, b.size());
+  EXPECT_THROW((void) b.at(0), std::out_of_range);
+}
+
+TEST(GapBufferTest, EmplaceBack) {
+  gap_buffer<std::string> b;
+  b.emplace_back("a");
+  b.emplace_back("b");
+  b.emplace_back("c");
+  EXPECT_THAT(to_vector(b), ElementsAre("a", "b", "c"));
+}
+
+TEST(GapBufferTest, Insert_Middle) {
+  gap_buffer<std::string> b(std::vector<std::string>{"a", "b", "c"});
+  EXPECT_TRUE(b.insert(1, "x"));
+  EXPECT_TRUE(b.insert(2, "y"));
+  EXPECT_TRUE(b.insert(0, "z"));
+  EXPECT_THAT(to_vector(b), ElementsAre("z", "a", "x", "y", "b", "c"));
+  EXPECT_EQ("c", b.at(5));
+}
+
+TEST(GapBufferTest, Insert_Invalid) {
+  gap_buffer<std::string> b;
+  EXPECT_FALSE(b.insert(1, "x"));
+  EXPECT_TRUE(b.insert(0, "x"));
+  EXPECT_THAT(to_vector(b), ElementsAre("x"));
+}
+
+TEST(GapBufferTest, Erase) {
+  gap_buffer<std::string> b(std::vector<std::string>{"a", "b", "c", "d"});
+  EXPECT_TRUE(b.erase(1));
+  EXPECT_THAT(to_vector(b), ElementsAre("a", "c", "d"));
+  EXPECT_TRUE(b.erase(2));
+  EXPECT_THAT(to_vector(b), ElementsAre("a", "c"));
+  EXPECT_TRUE(b.erase(0));
+  EXPECT_THAT(to_vector(b), ElementsAre("c"));
+  EXPECT_FALSE(b.erase(1));
+}
+
+TEST(GapBufferTest, InsertAndErase_MovesGap) {
+  gap_buffer<int> b;
+  std::vector<int> expected;
+  // Insert in a pattern that moves the gap both ways and grows it a few times.
+  for (auto i = 0; i < 200; i++) {
+    const auto pos = (i * 7) % (expected.size() + 1);
+    b.insert(pos, i);
+    expected.insert(expected.begin() + pos, i);
+    if (i % 5 == 0) {
+      const auto e = (i * 3) % expected.size();
+      b.erase(e);
+      expected.erase(expected.begin() + e);
+    }
+  }
+  ASSERT_EQ(expected.size(), b.size());
+  for (std::size_t i = 0; i < expected.size(); i++) {
+    EXPECT_EQ(expected[i], b[i]) << i;
+  }
+}
+
+TEST(GapBufferTest, Assign) {
+  gap_buffer<std::string> b;
+  b.emplace_back("x");
+  b.assign(std::vector<std::string>{"a", "b"});
+  b.insert(1, "c");
+  EXPECT_THAT(to_vector(b), ElementsAre("a", "c", "b"));
+  b.clear();
+  EXPECT_TRUE(b.empty());
+}
@@ -40,6 +40,8 @@ public:
   line_t() : line_t(false, "") {}
   line_t(bool wrapped, std::string text);
   explicit line_t(std::string text) : line_t(false, std::move(text)) {}
+  line_t(const line_t&) = default;
+  line_t(line_t&&) noexcept = default;
 
   line_add_result_t add(int x, char c, ins_ovr_mode_t mode);
   line_add_result_t del(int x, ins_ovr_mode_t mode);
@@ -58,6 +60,7 @@ public:
 
   // operators
   line_t& operator=(const line_t& o);
+  line_t& operator=(line_t&&) noexcept = default;
 
   void assign(const std::vector<cell_t>& cells);
   void append(const std::vector<cell_t>& cells);
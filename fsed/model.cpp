@@ -51,7 +51,7 @@ void FsedModel::set_view(const std::shared_ptr<editor_viewport_t>& view) { view_
 line_t& FsedModel::curline() const {
   // TODO: insert return statement here
   while (curli >= size_int(lines_)) {
-    lines_.emplace_back();
+    lines_.emplace_back(line_t());
   }
   try {
     return lines_.at(curli);
@@ -73,17 +73,17 @@ line_t& FsedModel::line(int n) const {
 }
 
 bool FsedModel::set_lines(std::vector<line_t>&& n) {
-  lines_ = n;
+  lines_.assign(std::move(n));
   return true;
 }
 
-void FsedModel::emplace_back(line_t&& n) { lines_.emplace_back(n); }
+void FsedModel::emplace_back(line_t&& n) { lines_.emplace_back(std::move(n)); }
 
 bool FsedModel::insert_line() {
   if (size_int(lines_) >= maxli()) {
     return false;
   }
-  return wwiv::stl::insert_at(lines_, curli, line_t());
+  return curli >= 0 && lines_.insert(curli, line_t());
 }
 
 bool FsedModel::insert_lines(std::vector<std::string>& lines) {
@@ -107,7 +107,7 @@ bool FsedModel::remove_line() {
   if (lines_.empty()) {
     return false;
   }
-  return wwiv::stl::erase_at(lines_, curli);
+  return curli >= 0 && lines_.erase(curli);
 }
 
 editor_add_result_t FsedModel::add(char c) {
@@ -126,18 +126,37 @@ editor_add_result_t FsedModel::add(char c) {
     return editor_add_result_t::added;
   }
   const auto last_space = line.last_space_before(size_int(line));
+  // True if this line already continues onto the next one.
+  const auto continues = line.wrapped() && curli + 1 < size_int(lines_);
   line.wrapped(true);
   const auto wwiv_color = line.wwiv_color();
+  auto end_line = curli + 1;
   if (last_space != -1 && (max_line_len_ - last_space) < (max_line_len_ / 2)) {
     // Word Wrap at the position after the last space. That way the space
     // end up on the previous line
     const auto wrap_position = last_space + 1;
-    const auto nline = line.substr(wrap_position);
+    auto nline = line.substr(wrap_position);
     line.assign(line.substr(0, wrap_position));
     ++curli;
-    insert_line();
-    curline().assign(nline);
-    cx = size_int(curline());
+    cx = size_int(nline);
+    if (continues) {
+      // Move the word onto the start of the next line of this paragraph
+      // and re-wrap just the rest of the paragraph.
+      auto& next = curline();
+      if (!next.cells().empty() && !nline.empty() && nline.back().ch != ' ') {
+        nline.emplace_back(nline.back().wwiv_color, ' ');
+      }
+      nline.insert(std::end(nline), std::begin(next.cells()), std::end(next.cells()));
+      next.assign(nline);
+      end_line = reflow_paragraph(curli);
+    } else {
+      insert_line();
+      curline().assign(nline);
+      if (curli + 1 < size_int(lines_)) {
+        // The lines after this one have moved down.
+        end_line = size_int(lines_) - 1;
+      }
+    }
   } else {
     // Character wrap.
     ++curli;
@@ -147,7 +166,7 @@ editor_add_result_t FsedModel::add(char c) {
   // line or character).
   curline().set_wwiv_color(wwiv_color);
 
-  invalidate_range(start_line, curli);
+  invalidate_range(start_line, std::max(curli, end_line));
   advance_cy(*this, *view_);
   return editor_add_result_t::wrapped;
 }
@@ -463,6 +482,41 @@ void FsedModel::invalidate_range(int start_line, int end_line) {
   }
 }
 
+int FsedModel::reflow_paragraph(int n) {
+  for (; n < size_int(lines_); n++) {
+    auto& l = line(n);
+    if (size_int(l) <= max_line_len_) {
+      return n;
+    }
+    const auto space = l.last_space_before(max_line_len_);
+    const auto split = space > 0 ? space + 1 : max_line_len_;
+    auto tail = l.substr(split);
+    l.assign(l.substr(0, split));
+    if (l.wrapped() && n + 1 < size_int(lines_)) {
+      // Push the words that don't fit onto the next line of the paragraph.
+      auto& next = line(n + 1);
+      if (!next.cells().empty() && tail.back().ch != ' ') {
+        tail.emplace_back(tail.back().wwiv_color, ' ');
+      }
+      tail.insert(std::end(tail), std::begin(next.cells()), std::end(next.cells()));
+      next.assign(tail);
+      continue;
+    }
+    if (size_int(lines_) >= maxli()) {
+      // No room for another line, so leave this one long.
+      l.append(tail);
+      return n;
+    }
+    // This was the last line of the paragraph, so the rest starts a new
+    // line and everything after it moves down.
+    l.wrapped(true);
+    lines_.insert(n + 1, line_t());
+    line(n + 1).assign(tail);
+    return size_int(lines_) - 1;
+  }
+  return size_int(lines_) - 1;
+}
+
 void FsedModel::current_line_dirty(int previous_line) {
   for (auto& c : line_callbacks_) {
     c(*this, previous_line);
@@ -472,7 +526,8 @@ void FsedModel::current_line_dirty(int previous_line) {
 std::vector<std::string> FsedModel::to_lines(bool wrap) {
   std::vector<std::string> out;
   std::string curline;
-  for (const auto& l : lines_) {
+  for (auto i = 0; i < size_int(lines_); i++) {
+    const auto& l = lines_[i];
     if (!curline.empty() && curline.back() != ' ') {
       curline.push_back(' ');
     }
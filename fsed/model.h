@@ -18,6 +18,7 @@
 #ifndef INCLUDED_FSED_MODEL_H
 #define INCLUDED_FSED_MODEL_H
 
+#include "fsed/gap_buffer.h"
 #include "fsed/line.h"
 #include <functional>
 #include <vector>
@@ -165,6 +166,14 @@ public:
   void invalidate_range(int start_line, int end_line);
   void current_line_dirty(int previous_line);
 
+  /**
+   * Re-wraps the paragraph starting at line n so that no line is longer than
+   * max_line_len, moving the words that don't fit onto the following lines of
+   * the paragraph, and adding a line at the end of it if needed.
+   * Returns the last line that needs to be redrawn.
+   */
+  int reflow_paragraph(int n);
+
   //
   // Public values
   //
@@ -180,8 +189,10 @@ private:
   // Max number of lines allowed
   int maxli_{255};
   // Lines of text.  mark mutable so we can add the current line
-  // into the array and stay logically const.
-  mutable std::vector<line_t> lines_;
+  // into the array and stay logically const.  This is a gap buffer
+  // so that inserting or removing lines near the cursor doesn't move
+  // every line after it.
+  mutable gap_buffer<line_t> lines_;
   // Insert or Overwrite mode
   ins_ovr_mode_t mode_{ins_ovr_mode_t::ins};
   // Max number of lines allowed.
@@ -28,16 +28,19 @@
 #include "core/textfile.h"
 #include "fmt/format.h"
 #include "local_io/keycodes.h"
+#include "sdk/ansi/ansi.h"
 
 using namespace wwiv::common;
 using namespace wwiv::local::io;
+using namespace wwiv::sdk::ansi;
 using namespace wwiv::stl;
 using namespace wwiv::strings;
 
 namespace wwiv::fsed {
 
 FsedView::FsedView(const FullScreenView& fs, MessageEditorData& data, bool file)
-    : fs_(fs), bout_(fs_.out()), bin_(fs_.in()), data_(data), file_(file) {
+    : fs_(fs), bout_(fs_.out()), bin_(fs_.in()), data_(data), file_(file),
+      screen_(fs.screen_width(), fs.message_height()) {
   max_view_lines_ = fs.message_height() - 1;
   max_view_columns_ = fs.screen_width();
 }
@@ -46,6 +49,8 @@ FullScreenView& FsedView::fs() { return fs_; }
 
 void FsedView::gotoxy(const FsedModel& ed) {
   bout_.goxy(ed.cx + 1, ed.cy + fs_.lines_start()); // - top_line() 
+  cursor_x_ = ed.cx;
+  cursor_y_ = ed.cy;
 }
 
 void FsedView::ClearCommandLine() { 
@@ -66,77 +71,85 @@ void FsedView::macro(Context& ctx, int cc) {
 
 }
 
+void FsedView::draw_line(const line_t& line, int y, bool colored_text) {
+  if (y < 0 || y >= screen_.rows()) {
+    return;
+  }
+  const auto& user = bout_.user();
+  screen_.gotoxy(0, y);
+  screen_.curatr(user.color(0));
+  if (colored_text) {
+    Ansi ansi(&screen_, {}, user.color(0));
+    HeartAndPipeCodeFilter heart(&ansi, user.colors());
+    for (const auto c : line.to_colored_text(-1)) {
+      heart.write(c);
+    }
+  } else {
+    // Draw char by char for the current line so we don't display
+    // color codes where we are editing.
+    for (const auto& c : line.cells()) {
+      screen_.curatr(user.color(c.wwiv_color));
+      screen_.write(c.ch);
+    }
+  }
+  screen_.clear_eol();
+}
+
+void FsedView::update_screen() {
+  bout_.write_ansi(screen_.delta(1, fs_.lines_start(), static_cast<uint8_t>(bout_.curatr())));
+}
+
 void FsedView::draw_current_line(FsedModel& ed, int previous_line) { 
   if (previous_line != ed.curli) {
-    const auto py = previous_line - top_line() + fs_.lines_start();
-    bout_.goxy(0, py);
+    const auto py = previous_line - top_line();
     if (previous_line < size_int(ed)) {
-      bout_.outstr(ed.line(previous_line).to_colored_text(-1));
+      draw_line(ed.line(previous_line), py, true);
+    } else if (py >= 0 && py < screen_.rows()) {
+      screen_.gotoxy(0, py);
+      screen_.clear_eol();
     }
-    bout_.clreol();
   }
 
-  const auto y = ed.curli - top_line() + fs_.lines_start(); 
-  bout_.goxy(0, y);
-  bout_.ansic(0);
-  for (const auto& c : ed.curline().cells()) {
-    // Draw char by char for the current line so we don't display
-    // color codes where we are editing.
-    bout_.ansic(c.wwiv_color);
-    bout_.outchr(c.ch);
-  }
-  bout_.clreol();
+  draw_line(ed.curline(), ed.curli - top_line(), false);
+  update_screen();
   gotoxy(ed);
 }
 
 void FsedView::handle_editor_invalidate(FsedModel& e, editor_range_t t) {
-  // TODO: optimize for first line
-
   // Never go below top line.
   const auto start_line = std::max<int>(t.start.line, top_line());
-  auto last_color = -1;
 
   for (auto i = start_line; i <= t.end.line; i++) {
-    auto y = i - top_line() + fs_.lines_start();
-    if (y >= fs_.lines_end()) {
+    const auto y = i - top_line();
+    if (y >= screen_.rows()) {
       break;
     }
     if (i >= size_int(e)) {
       break;
     }
-    bout_.goxy(0, y);
-    auto& rl = e.line(i);
-    if (i == e.curli) {
-      for (const auto& c : rl.cells()) {
-        // Draw char by char for the current line so we don't display
-        // color codes where we are editing.
-        if (c.wwiv_color != last_color) {
-          last_color = c.wwiv_color;
-          bout_.ansic(c.wwiv_color);
-        }
-        bout_.outchr(c.ch);
-      }
-    } else {
-      bout_.outstr(rl.to_colored_text(-1));
-    }
-    bout_.clreol();
+    draw_line(e.line(i), y, i != e.curli);
   }
 
   // Clean up the bottom.
   // clear the current and then remaining
   if (size_int(e) == t.end.line + 1) {
-    for (auto z = size_int(e) - top_line() + fs_.lines_start(); z < fs_.lines_end(); z++) {
-      bout_.goxy(0, z);
-      bout_.clreol();
+    screen_.curatr(bout_.user().color(0));
+    for (auto y = size_int(e) - top_line(); y < screen_.rows(); y++) {
+      screen_.gotoxy(0, y);
+      screen_.clear_eol();
     }
   }
 
+  // Only the cells that changed are sent, so scrolling the editor doesn't
+  // resend every visible line.
+  update_screen();
   gotoxy(e);
 }
 
 void FsedView::draw_header() {
   const auto oldcuratr = bout_.curatr();
   bout_.cls();
+  screen_.invalidate();
   const auto to = data_.to_name.empty() ? "All" : data_.to_name;
   bout_.print("|#7From: |#2{}\r\n", data_.from_name);
   bout_.print("|#7To:   |#2{}\r\n", to);
@@ -219,9 +232,17 @@ int FsedView::bgetch(FsedModel& ed) {
 void FsedView::outchr(int color, char ch) {
   bout_.ansic(color);
   bout_.outchr(ch);
+  if (cursor_x_ < screen_.cols()) {
+    screen_.displayed(cursor_y_ * screen_.cols() + cursor_x_, ch,
+                      static_cast<uint8_t>(bout_.curatr()));
+  }
+  ++cursor_x_;
 }
 
-void FsedView::cls() { bout_.cls(); }
+void FsedView::cls() {
+  bout_.cls();
+  screen_.invalidate();
+}
 
 void FsedView::ansic(int c) { bout_.ansic(c); }
 
@@ -21,6 +21,7 @@
 #include "common/full_screen.h"
 #include "common/message_editor_data.h"
 #include "fsed/model.h"
+#include "sdk/ansi/framebuffer.h"
 
 namespace wwiv {
 namespace common {
@@ -63,6 +64,12 @@ public:
   bool debug{false};
 
 private:
+  // Draws line into row y of screen_, using the colors as heart codes when
+  // colored_text is true, otherwise using each cell's color.
+  void draw_line(const line_t& line, int y, bool colored_text);
+  // Sends the changes to the editor area to the remote.
+  void update_screen();
+
   common::FullScreenView fs_;
   common::Output& bout_;
   common::Input& bin_;
@@ -70,6 +77,12 @@ private:
   int max_view_columns_;
   common::MessageEditorData& data_;
   bool file_{false};
+  // What is displayed in the editor area, used to only send changes.
+  sdk::ansi::DeltaFrameBuffer screen_;
+  // Cursor position in the editor area, used to track characters echoed
+  // by outchr.
+  int cursor_x_{0};
+  int cursor_y_{0};
   //  Saved positions for the bottom bar caching.
   int sx{-1};
   int sy{-1};
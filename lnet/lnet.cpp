@@ -35,6 +35,7 @@
 #include "sdk/net/packets.h"
 #include "sdk/status.h"
 
+#include <algorithm>
 #include <string>
 
 using namespace wwiv::core;
@@ -145,6 +146,8 @@ W - Write message to new file.
 ] - 10 messages forward.
 } - 50 messages forward.
 ' - 500 messages forward
+[ - 10 messages back.
+{ - 50 messages back.
 X - Truncate file (used for bad messages)
 Q - Quit.
 
@@ -179,16 +182,12 @@ void LNet::show_header(const net_header_rec& nh, int current, double percent) {
   }
 }
 
-static int skip_messages(NetMailFile& file, int num_to_skip) {
-  int skipped = 0;
-  while (--num_to_skip >= 0) {
-    auto [packet, resp] = file.Read();
-    if (resp != ReadNetPacketResponse::OK) {
-      return skipped;
-    }
-    ++skipped;
-  }
-  return skipped;
+// Moves current, the index of the next packet to read, num_to_skip packets.
+// num_to_skip may be negative.  Returns the offset of the new current packet.
+static File::size_type skip_messages(MappedNetMailFile& file, int& current, int num_to_skip) {
+  const auto& idx = file.index();
+  current = std::clamp(current + num_to_skip, 0, size_int(idx));
+  return current < size_int(idx) ? idx.at(current).offset : file.size();
 }
 
 void LNet::pausescr() { 
@@ -204,26 +203,28 @@ void LNet::pausescr() {
 
 int LNet::Run() {
   const std::filesystem::path filename = net_cmdline_.cmdline().remaining().front();
-  NetMailFile file(filename, true, true);
+  MappedNetMailFile file(filename, true, true);
   if (!file) {
-    LOG(ERROR) << "Unable to open file: " << filename << "; error: " << file.file().last_error();
+    LOG(ERROR) << "Unable to open file: " << filename;
     return 1;
   }
 
   auto current{0};
   bool packet_modified{false};
-  const auto file_length = file.file().length();
+  const auto file_length = file.size();
+  File::size_type offset{0};
   for (;;) {
     io->Cls();
-    auto [packet, response] = file.Read();
+    auto [packet, response] = file.Read(offset);
     if (response == ReadNetPacketResponse::END_OF_FILE) {
       return 0;
     } else if (response != ReadNetPacketResponse::OK) {
       return 1;
     }
+    offset = packet.end_offset();
     ++current;
     const auto percent = static_cast<double>(packet.offset() / file_length);
-    show_header(packet.nh, current, std::floor(percent * 100));
+    show_header(packet.nh(), current, std::floor(percent * 100));
 
     auto prompt_done = false;
     while (!prompt_done) {
@@ -236,32 +237,35 @@ int LNet::Run() {
         show_help();
       } break;
       case ']':
-        current += skip_messages(file, 9);
+        offset = skip_messages(file, current, 9);
         prompt_done = true;
         break;
       case '}':
-        current += skip_messages(file, 49);
+        offset = skip_messages(file, current, 49);
         prompt_done = true;
         break;
       case '\'':
-        current += skip_messages(file, 499);
+        offset = skip_messages(file, current, 499);
+        prompt_done = true;
+        break;
+      case '[':
+        offset = skip_messages(file, current, -11);
+        prompt_done = true;
+        break;
+      case '{':
+        offset = skip_messages(file, current, -51);
         prompt_done = true;
         break;
       case 'D': {
-        // TODO: Mark message 65536
-        auto saved_position = packet.offset();
-        file.file().Seek(saved_position, wwiv::core::File::Whence::begin);
-        packet.nh.main_type = 65535; // Mark this packet deleted.
-        const auto num = file.file().Write(&packet.nh, sizeof(net_header_rec));
-        if (num != sizeof(net_header_rec)) {
+        // Mark this packet deleted.
+        if (!file.Delete(packet)) {
           // Let's fail now since we didn't write this right.
-          LOG(ERROR) << "Error deleting packet; num written (" << num
-                     << ") != net_header_rec size.";
+          LOG(ERROR) << "Error deleting packet at offset: " << packet.offset();
           io->GetChar();
           prompt_done = true;
           break;
         }
-        file.file().Seek(saved_position, wwiv::core::File::Whence::begin);
+        offset = packet.offset();
         --current;
         prompt_done = true;
         packet_modified = true;
@@ -279,7 +283,7 @@ int LNet::Run() {
         return 0;
       } break;
       case 'R': {
-        if (packet.nh.length) {
+        if (!packet.text().empty()) {
           io->Cr();
           io->Lf();
           ++curli_;
@@ -292,7 +296,7 @@ int LNet::Run() {
       } break;
       case 'T': {
         // Reread message
-        file.file().Seek(packet.offset(), wwiv::core::File::Whence::begin);
+        offset = packet.offset();
         --current;
         prompt_done = true;
       } break;
@@ -300,7 +304,7 @@ int LNet::Run() {
         // Write message to new file.
 
         // Back up.
-        file.file().Seek(packet.offset(), wwiv::core::File::Whence::begin);
+        offset = packet.offset();
         --current;
         prompt_done = true;
         std::string fn;
@@ -313,7 +317,7 @@ int LNet::Run() {
           break;
         }
         const auto dir = filename.parent_path();
-        write_wwivnet_packet(FilePath(dir, fn), packet);
+        write_wwivnet_packet(FilePath(dir, fn), packet.ToNetPacket());
  
       } break;
       }
@@ -96,6 +96,8 @@ public:
    * Note that x and y are zero based and (0, 0) is the top left corner of the screen.
    */
   virtual void PutsXYA(int x, int y, int attr, const std::string& text) = 0;
+  /** Updates the physical screen with any output that is still pending */
+  virtual void Flush() {}
   virtual void set_protect(int l) = 0;
   virtual void savescreen() = 0;
   virtual void restorescreen() = 0;
@@ -62,6 +62,8 @@ CursesLocalIO::CursesLocalIO(int num_lines, int num_cols) {
   auto* w = std::any_cast<WINDOW*>(window_->window());
   scrollok(w, true);
   window_->Clear();
+  // Coalesce screen updates, the window is flushed before waiting for input.
+  window_->set_batch_refresh(true);
 }
 
 CursesLocalIO::~CursesLocalIO() {
@@ -143,8 +145,21 @@ void CursesLocalIO::Putch(unsigned char ch) {
 }
 
 void CursesLocalIO::Puts(const std::string& s) {
-  for (auto ch : s) {
-    Putch(ch);
+  // Write runs of printable characters at once, only control characters
+  // need to go through Putch.
+  auto start = std::cbegin(s);
+  for (auto it = start; it != std::cend(s); ++it) {
+    if (static_cast<unsigned char>(*it) > 31) {
+      continue;
+    }
+    if (start != it) {
+      FastPuts(std::string(start, it));
+    }
+    Putch(*it);
+    start = std::next(it);
+  }
+  if (start != std::cend(s)) {
+    FastPuts(std::string(start, std::cend(s)));
   }
 }
 
@@ -173,6 +188,8 @@ void CursesLocalIO::FastPuts(const std::string& text) {
 #endif
 }
 
+void CursesLocalIO::Flush() { window_->Flush(); }
+
 void CursesLocalIO::set_protect(int l) { SetTopLine(l); }
 
 static std::vector<chtype*> saved_screen;
@@ -204,6 +221,8 @@ void CursesLocalIO::restorescreen() {
 static int last_key_pressed = ERR;
 
 bool CursesLocalIO::KeyPressed() {
+  // Callers poll this while idle, so show anything still pending.
+  window_->Flush();
   if (last_key_pressed != ERR) {
     return true;
   }
@@ -578,7 +597,10 @@ void CursesLocalIO::UpdateNativeTitleBar([[maybe_unused]] const std::string& sys
 // ReSharper disable once CppMemberFunctionMayBeStatic
 void CursesLocalIO::ResetColors() { InitPairs(); }
 
-void CursesLocalIO::DisableLocalIO() { endwin(); }
+void CursesLocalIO::DisableLocalIO() {
+  window_->Flush();
+  endwin();
+}
 
 void CursesLocalIO::ReenableLocalIO() {
   refresh();
@@ -50,6 +50,7 @@ public:
   void Puts(const std::string&) override;
   void PutsXY(int x, int y, const std::string& text) override;
   void PutsXYA(int x, int y, int a, const std::string& text) override;
+  void Flush() override;
   void set_protect(int l) override;
   void savescreen() override;
   void restorescreen() override;
@@ -0,0 +1,143 @@
+/**************************************************************************/
+/*                                                                        */
+/*                          WWIV Version 5.x                              */
+/*           Copyright (C)2022, WWIV Software Services                    */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/**************************************************************************/
+// Replays ANSI through CursesLocalIO under a null terminal.
+//
+// Usage: local_io_benchmarks [benchmark flags] [file.ans ...]
+//
+// Any ANSI files named on the commandline are replayed in addition to a
+// generated screen. Curses output goes to the null device so the results
+// are written to stderr.
+#include "benchmark/benchmark.h"
+
+#include "core/textfile.h"
+#include "local_io/local_io_curses.h"
+#include "localui/curses_io.h"
+#include "localui/curses_win.h"
+#include "localui/wwiv_curses.h"
+#include "sdk/ansi/ansi.h"
+#include "sdk/ansi/localio_screen.h"
+#include "fmt/format.h"
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+
+using namespace wwiv::core;
+using namespace wwiv::local::io;
+using namespace wwiv::local::ui;
+using namespace wwiv::sdk::ansi;
+
+namespace {
+
+// Generates a screen of colored text with cursor movement.
+std::string generated_ansi() {
+  std::string s = "\x1b[2J\x1b[H";
+  for (auto line = 0; line < 200; line++) {
+    s.append(fmt::format("\x1b[{};3{}m", line % 2, line % 8));
+    s.append(fmt::format("{:>4}: ", line));
+    for (auto word = 0; word < 8; word++) {
+      s.append(fmt::format("\x1b[3{}mWWIV\xb0\xb1\xb2 ", (line + word) % 8));
+    }
+    s.append("\x1b[0m\x1b[K\r\n");
+  }
+  return s;
+}
+
+CursesLocalIO& local_io() {
+  static auto* io = new CursesLocalIO(25, 80);
+  return *io;
+}
+
+void BM_ReplayAnsi(benchmark::State& state, const std::string& text) {
+  auto& io = local_io();
+  LocalIOScreen screen(&io, 80);
+  for (auto _ : state) {
+    Ansi ansi(&screen, {}, 0x07);
+    ansi.write(text);
+    io.Flush();
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(text.size()));
+}
+
+void BM_Puts(benchmark::State& state) {
+  auto& io = local_io();
+  const std::string line(79, 'W');
+  for (auto _ : state) {
+    for (auto i = 0; i < 25; i++) {
+      io.Puts(line);
+      io.Puts("\r\n");
+    }
+    io.Flush();
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * 25 * 81);
+}
+BENCHMARK(BM_Puts);
+
+// Compares writing a screen a character at a time with and without batching.
+void BM_CursesWindow_Putch(benchmark::State& state) {
+  CursesWindow win(nullptr, curses_out->color_scheme(), 25, 80, 0, 0);
+  scrollok(std::any_cast<WINDOW*>(win.window()), true);
+  win.set_batch_refresh(state.range(0) != 0);
+  for (auto _ : state) {
+    for (auto i = 0; i < 25 * 80; i++) {
+      win.Putch(static_cast<uint32_t>('A' + i % 26));
+    }
+    win.Flush();
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * 25 * 80);
+}
+BENCHMARK(BM_CursesWindow_Putch)->ArgName("batch")->Arg(0)->Arg(1);
+
+} // namespace
+
+int main(int argc, char** argv) {
+  constexpr auto null_device = "/dev/null";
+  if (!std::freopen(null_device, "w", stdout)) {
+    std::cerr << "Unable to open: " << null_device << std::endl;
+    return 1;
+  }
+  // The null device has no size, so give curses one.
+  setenv("LINES", "25", 0);
+  setenv("COLUMNS", "80", 0);
+  if (!std::getenv("TERM")) {
+    setenv("TERM", "xterm", 1);
+  }
+  CursesIO::Init("WWIV LocalIO Benchmarks");
+
+  benchmark::Initialize(&argc, argv);
+  benchmark::RegisterBenchmark("BM_ReplayAnsi/generated", BM_ReplayAnsi, generated_ansi());
+  for (auto i = 1; i < argc; i++) {
+    TextFile f(argv[i], "rb");
+    if (!f) {
+      std::cerr << "Unable to open: " << argv[i] << std::endl;
+      return 1;
+    }
+    const auto name = fmt::format("BM_ReplayAnsi/{}", argv[i]);
+    benchmark::RegisterBenchmark(name.c_str(), BM_ReplayAnsi, f.ReadFileIntoString());
+  }
+
+  benchmark::ConsoleReporter reporter;
+  reporter.SetOutputStream(&std::cerr);
+  reporter.SetErrorStream(&std::cerr);
+  benchmark::RunSpecifiedBenchmarks(&reporter);
+  benchmark::Shutdown();
+  endwin();
+  return 0;
+}
@@ -109,7 +109,10 @@ void CursesWindow::SetTitle(const std::string& title) {
 void CursesWindow::Bkgd(uint32_t ch) { wbkgd(std::any_cast<WINDOW*>(window_), ch); }
 int CursesWindow::RedrawWin() { return redrawwin(std::any_cast<WINDOW*>(window_)); }
 int CursesWindow::TouchWin() { return touchwin(std::any_cast<WINDOW*>(window_)); }
-int CursesWindow::Refresh() { return wrefresh(std::any_cast<WINDOW*>(window_)); }
+int CursesWindow::Refresh() {
+  dirty_ = false;
+  return wrefresh(std::any_cast<WINDOW*>(window_));
+}
 int CursesWindow::Move(int y, int x) { return wmove(std::any_cast<WINDOW*>(window_), y, x); }
 int CursesWindow::GetcurX() const { return getcurx(std::any_cast<WINDOW*>(window_)); }
 int CursesWindow::GetcurY() const { return getcury(std::any_cast<WINDOW*>(window_)); }
@@ -129,8 +132,44 @@ int CursesWindow::Box(uint32_t vert_ch, uint32_t horiz_ch) {
   return box(std::any_cast<WINDOW*>(window_), vert_ch, horiz_ch);
 }
 
+void CursesWindow::set_batch_refresh(bool b) {
+  if (!b) {
+    Flush();
+  }
+  batch_refresh_ = b;
+}
+
+void CursesWindow::Flush() const {
+  if (!dirty_) {
+    return;
+  }
+  wnoutrefresh(std::any_cast<WINDOW*>(window_));
+  doupdate();
+  dirty_ = false;
+  last_update_ = steady_clock::now();
+}
+
+void CursesWindow::Touched() {
+  if (!batch_refresh_) {
+    Refresh();
+    return;
+  }
+  if (!dirty_) {
+    // Start the interval from the first pending write so that a long run of
+    // output is still shown every kBatchRefreshInterval.
+    dirty_ = true;
+    last_update_ = steady_clock::now();
+    return;
+  }
+  if (steady_clock::now() - last_update_ >= kBatchRefreshInterval) {
+    Flush();
+  }
+}
+
 int CursesWindow::GetChar(duration<double> timeout) const {
   auto* window = std::any_cast<WINDOW*>(window_);
+  // Make sure everything written is visible before waiting for input.
+  Flush();
   const auto timeout_ms =  duration_cast<milliseconds>(timeout);
   const auto start = system_clock::now();
   const auto end = start + timeout_ms;
@@ -215,22 +254,22 @@ void CursesWindow::GotoXY(int x, int y) {
   y = std::min<int>(y, GetMaxY() - 1);
 
   Move(y, x);
-  Refresh();
+  Touched();
 }
 
 void CursesWindow::Putch(uint32_t ch) {
   waddch(std::any_cast<WINDOW*>(window_), ch);
-  Refresh();
+  Touched();
 }
 
 void CursesWindow::Puts(const std::string& text) {
   waddstr(std::any_cast<WINDOW*>(window_), text.c_str());
-  Refresh();
+  Touched();
 }
 
 void CursesWindow::PutsXY(int x, int y, const std::string& text) {
   mvwaddstr(std::any_cast<WINDOW*>(window_), y, x, text.c_str());
-  Refresh();
+  Touched();
 }
 
 void CursesWindow::PutchW(wchar_t ch) {
@@ -238,17 +277,17 @@ void CursesWindow::PutchW(wchar_t ch) {
   wchar_t c[2] = {ch, 0};
   waddwstr(std::any_cast<WINDOW*>(window_), c);
 
-  Refresh();
+  Touched();
 }
 
 void CursesWindow::PutsW(const std::wstring& text) {
   waddwstr(std::any_cast<WINDOW*>(window_), text.c_str());
-  Refresh();
+  Touched();
 }
 
 void CursesWindow::PutsXYW(int x, int y, const std::wstring& text) {
   mvwaddwstr(std::any_cast<WINDOW*>(window_), y, x, text.c_str());
-  Refresh();
+  Touched();
 }
 
 void CursesWindow::SetColor(SchemeId id) {
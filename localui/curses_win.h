@@ -76,10 +76,29 @@ public:
 
   [[nodiscard]] bool IsGUI() const override;
 
+  /**
+   * When batch refresh is enabled, writes only mark the window as dirty and
+   * the physical screen is updated by Flush(), before waiting for input, or
+   * at most every kBatchRefreshInterval while output is being written.
+   */
+  void set_batch_refresh(bool b);
+  [[nodiscard]] bool batch_refresh() const noexcept { return batch_refresh_; }
+
+  /** Updates the physical screen if any writes are pending. */
+  void Flush() const;
+
+  static constexpr std::chrono::milliseconds kBatchRefreshInterval{16};
+
 private:
+  // Refreshes the window now, or marks it dirty when batching.
+  void Touched();
+
   std::any window_;
   CursesWindow* parent_;
   ColorScheme* color_scheme_;
+  bool batch_refresh_{false};
+  mutable bool dirty_{false};
+  mutable std::chrono::steady_clock::time_point last_update_{};
 };
 
 }
@@ -21,9 +21,12 @@
 #include "core/file.h"
 #include "core/inifile.h"
 #include "core/log.h"
+#include "core/metrics.h"
 #include "core/stl.h"
 #include "core/strings.h"
 #include "core/version.h"
+#include "sdk/filenames.h"
+#include "sdk/net/contact.h"
 #include "sdk/net/packets.h"
 #include <filesystem>
 #include <iomanip>
@@ -114,8 +117,34 @@ static std::string network_cmd_name(char net_cmd) {
   return (net_cmd == '\0') ? "network" : StrCat("network", net_cmd);
 }
 
+std::filesystem::path network_semaphore_path(const Network& net, char net_cmd) {
+  return FilePath(net.dir, StrCat(network_cmd_name(net_cmd), ".bsy"));
+}
+
+bool write_network_metrics(const sdk::Config& config, const sdk::Networks& networks) {
+  for (const auto& net : networks.networks()) {
+    if (!File::Exists(FilePath(net.dir, CONTACT_NET))) {
+      continue;
+    }
+    int64_t bytes_waiting = 0;
+    for (const auto& [_, c] : sdk::Contact(net).contacts()) {
+      bytes_waiting += c.bytes_waiting();
+    }
+    metrics()
+        .gauge("network_bytes_waiting", "Bytes waiting to be sent, from contact.net.",
+               {{"network", net.name}})
+        .set(bytes_waiting);
+  }
+  const auto path = FilePath(FilePath(config.datadir(), METRICS_DIR), "network.prom");
+  if (!metrics().Accumulate(path)) {
+    LOG(WARNING) << "Unable to write metrics to: " << path;
+    return false;
+  }
+  return true;
+}
+
 std::filesystem::path NetworkCommandLine::semaphore_path() const noexcept {
-  return FilePath(network_.dir, StrCat(network_cmd_name(net_cmd_), ".bsy"));
+  return network_semaphore_path(network_, net_cmd_);
 }
 
 // ReSharper disable once CppMemberFunctionMayBeConst
@@ -137,6 +166,7 @@ bool NetworkCommandLine::LoadNetIni(char net_cmd, const std::string& bbsdir) {
   SetNewIntDefault(cmdline_, *ini, "semaphore_timeout");
   SetNewIntDefault(cmdline_, *ini, "v", [](int v) { Logger::set_cmdline_verbosity(v); });
   SetNewBooleanDefault(cmdline_, *ini, "skip_delete");
+  SetNewIntDefault(cmdline_, *ini, "msgdupe_retention_days");
   SetNewStringDefault(cmdline_, *ini, "configdir");
   SetNewStringDefault(cmdline_, *ini, "bindir");
   SetNewStringDefault(cmdline_, *ini, "logdir");
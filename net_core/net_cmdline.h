@@ -31,6 +31,21 @@ namespace wwiv::net {
 
 void AddStandardNetworkArgs(core::CommandLine& cmdline);
 
+/**
+ * Returns the path to the semaphore file held while running the network
+ * command net_cmd (i.e. '1' for network1) for the network net.
+ */
+std::filesystem::path network_semaphore_path(const sdk::net::Network& net, char net_cmd);
+
+/**
+ * Adds the metrics for this process to METRICS_DIR/network.prom under the
+ * datadir, which wwivd serves along with its own metrics.  The file is shared
+ * by all of the network programs, so counters are summed across runs,
+ * programs and networks, and this may be called more than once.  Also sets
+ * the bytes waiting to be sent for each network from its contact.net.
+ */
+bool write_network_metrics(const sdk::Config& config, const sdk::Networks& networks);
+
 /**
  * Wrapper class that augments CommandLine to specialize it for the network commands.
  */
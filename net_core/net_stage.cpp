@@ -0,0 +1,74 @@
+/**************************************************************************/
+/*                                                                        */
+/*                          WWIV Version 5.x                              */
+/*           Copyright (C)2022, WWIV Software Services                    */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/**************************************************************************/
+#include "net_core/net_stage.h"
+
+#include "core/log.h"
+#include "core/strings.h"
+#include "net_core/net_cmdline.h"
+#include <utility>
+
+using namespace wwiv::sdk;
+using namespace wwiv::strings;
+
+namespace wwiv::net {
+
+SharedNetworkData::SharedNetworkData(const Config& config, const Networks& networks)
+    : config_(config), networks_(networks) {}
+
+SharedNetworkData::~SharedNetworkData() = default;
+
+Subs& SharedNetworkData::subs() {
+  if (!subs_) {
+    subs_ = std::make_unique<Subs>(config_.datadir(), networks_.networks());
+    subs_loaded_ = subs_->Load();
+  }
+  return *subs_;
+}
+
+bool SharedNetworkData::subs_loaded() {
+  (void) subs();
+  return subs_loaded_;
+}
+
+network_stage_options_t network_stage_options(const NetworkCommandLine& net_cmdline) {
+  network_stage_options_t opts{};
+  opts.bindir = net_cmdline.cmdline().bindir();
+  opts.skip_delete = net_cmdline.skip_delete();
+  opts.quiet = net_cmdline.quiet();
+  return opts;
+}
+
+NetworkStageContext::NetworkStageContext(SharedNetworkData& shared, int network_number,
+                                         network_stage_options_t opts)
+    : shared_(shared), network_number_(network_number),
+      network_(shared.networks()[network_number]),
+      network_name_(ToStringLowerCase(network_.name)), opts_(std::move(opts)) {}
+
+NetworkStageContext::~NetworkStageContext() = default;
+
+const BbsListNet& NetworkStageContext::bbslist() {
+  if (!bbslist_) {
+    VLOG(3) << "Reading bbsdata.net for " << network_name_;
+    bbslist_.emplace(BbsListNet::ReadBbsDataNet(network_.dir));
+  }
+  return bbslist_.value();
+}
+
+void NetworkStageContext::reset_bbslist() { bbslist_.reset(); }
+
+} // namespace wwiv::net
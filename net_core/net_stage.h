@@ -0,0 +1,135 @@
+/**************************************************************************/
+/*                                                                        */
+/*                          WWIV Version 5.x                              */
+/*           Copyright (C)2022, WWIV Software Services                    */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/**************************************************************************/
+#ifndef INCLUDED_NET_CORE_NET_STAGE_H
+#define INCLUDED_NET_CORE_NET_STAGE_H
+
+#include "sdk/bbslist.h"
+#include "sdk/config.h"
+#include "sdk/subxtr.h"
+#include "sdk/net/ftn_msgdupe.h"
+#include "sdk/net/net.h"
+#include "sdk/net/networks.h"
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace wwiv::net {
+
+class NetworkCommandLine;
+
+/**
+ * Data shared by every network stage (network1, network2, network3, networkf
+ * and networkt) run by one process.  The stand alone stage executables own
+ * one of these for their single network, networkc shares one between all of
+ * the networks that it processes.
+ */
+class SharedNetworkData final {
+public:
+  SharedNetworkData(const sdk::Config& config, const sdk::Networks& networks);
+  SharedNetworkData(const SharedNetworkData&) = delete;
+  SharedNetworkData& operator=(const SharedNetworkData&) = delete;
+  ~SharedNetworkData();
+
+  [[nodiscard]] const sdk::Config& config() const noexcept { return config_; }
+  [[nodiscard]] const sdk::Networks& networks() const noexcept { return networks_; }
+
+  /**
+   * The subs, read from subs.json on first use. Only use while holding
+   * mutex(), since network2 and network3 for different networks share them.
+   */
+  [[nodiscard]] sdk::Subs& subs();
+
+  /** True if subs() were read successfully. */
+  [[nodiscard]] bool subs_loaded();
+
+  /**
+   * Held by the stages while they write to data that is shared by all
+   * networks: the message and file areas, subs, status.dat, the FTN dupe
+   * database and the netdat logs in gfiles.
+   */
+  [[nodiscard]] std::mutex& mutex() noexcept { return mu_; }
+
+private:
+  const sdk::Config& config_;
+  const sdk::Networks& networks_;
+  std::unique_ptr<sdk::Subs> subs_;
+  bool subs_loaded_{false};
+  std::mutex mu_;
+};
+
+/** Options for the network stages, set from the command line or by networkc. */
+struct network_stage_options_t {
+  std::filesystem::path bindir;
+  // Don't delete packets, move to save area.
+  bool skip_delete{false};
+  bool quiet{false};
+  // network3: Send feedback to the network coordinator.
+  bool feedback{false};
+  // networkt: Save TIC files, do not delete TIC and archives.
+  bool save_tic_files{false};
+  // networkf: Days to remember FTN message ids for dupe detection, 0 for forever.
+  int msgdupe_retention_days{sdk::FtnMessageDupe::kDefaultRetentionDays};
+};
+
+/** Returns the options common to all stages from the command line. */
+network_stage_options_t network_stage_options(const NetworkCommandLine& net_cmdline);
+
+/**
+ * What a network stage needs to process a single network. Each stage only
+ * reads the per network data from here, so that networkc can run all of the
+ * stages in process without loading the config, networks and bbsdata.net
+ * for every stage.
+ */
+class NetworkStageContext final {
+public:
+  NetworkStageContext(SharedNetworkData& shared, int network_number,
+                      network_stage_options_t opts);
+  NetworkStageContext(const NetworkStageContext&) = delete;
+  NetworkStageContext& operator=(const NetworkStageContext&) = delete;
+  ~NetworkStageContext();
+
+  [[nodiscard]] SharedNetworkData& shared() const noexcept { return shared_; }
+  [[nodiscard]] const sdk::Config& config() const noexcept { return shared_.config(); }
+  [[nodiscard]] const sdk::Networks& networks() const noexcept { return shared_.networks(); }
+  [[nodiscard]] int network_number() const noexcept { return network_number_; }
+  [[nodiscard]] const sdk::net::Network& network() const noexcept { return network_; }
+  [[nodiscard]] std::string network_name() const noexcept { return network_name_; }
+  [[nodiscard]] const network_stage_options_t& options() const noexcept { return opts_; }
+  [[nodiscard]] bool skip_delete() const noexcept { return opts_.skip_delete; }
+  [[nodiscard]] bool quiet() const noexcept { return opts_.quiet; }
+
+  /** bbsdata.net for this network, read on first use. */
+  [[nodiscard]] const sdk::BbsListNet& bbslist();
+
+  /** Forgets bbsdata.net so the next call to bbslist() rereads it. */
+  void reset_bbslist();
+
+private:
+  SharedNetworkData& shared_;
+  const int network_number_;
+  const sdk::net::Network network_;
+  const std::string network_name_;
+  const network_stage_options_t opts_;
+  std::optional<sdk::BbsListNet> bbslist_;
+};
+
+} // namespace wwiv::net
+
+#endif
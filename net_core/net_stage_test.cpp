@@ -0,0 +1,88 @@
+/**************************************************************************/
+/*                                                                        */
+/*                          WWIV Version 5.x                              */
+/*           Copyright (C)2022, WWIV Software Services                    */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/**************************************************************************/
+#include "gtest/gtest.h"
+
+#include "core/datafile.h"
+#include "core/file.h"
+#include "net_core/net_stage.h"
+#include "sdk/filenames.h"
+#include "sdk/sdk_helper.h"
+#include "sdk/net/legacy_net.h"
+#include "sdk/net/networks.h"
+
+using namespace wwiv::core;
+using namespace wwiv::net;
+using namespace wwiv::sdk;
+using namespace wwiv::sdk::net;
+
+class NetworkStageTest : public testing::Test {
+public:
+  NetworkStageTest()
+      : net_(helper.CreateTestNetwork(network_type_t::wwivnet)), networks_({net_}),
+        shared_(helper.config(), networks_) {}
+
+  [[nodiscard]] bool WriteBbsDataNet(uint16_t sysnum) const {
+    DataFile<net_system_list_rec> file(FilePath(net_.dir, BBSDATA_NET),
+                                       File::modeBinary | File::modeReadWrite |
+                                           File::modeCreateFile | File::modeTruncate);
+    if (!file) {
+      return false;
+    }
+    net_system_list_rec r{};
+    r.sysnum = sysnum;
+    return file.Write(&r);
+  }
+
+  SdkHelper helper;
+  Network net_;
+  Networks networks_;
+  SharedNetworkData shared_;
+};
+
+TEST_F(NetworkStageTest, Network) {
+  network_stage_options_t opts{};
+  opts.skip_delete = true;
+  NetworkStageContext ctx(shared_, 0, opts);
+  EXPECT_EQ(0, ctx.network_number());
+  EXPECT_EQ("TestNET", ctx.network().name);
+  EXPECT_EQ("testnet", ctx.network_name());
+  EXPECT_TRUE(ctx.skip_delete());
+  EXPECT_FALSE(ctx.quiet());
+  EXPECT_EQ(&helper.config(), &ctx.config());
+}
+
+TEST_F(NetworkStageTest, BbsList_ReadOnce) {
+  NetworkStageContext ctx(shared_, 0, {});
+  ASSERT_TRUE(WriteBbsDataNet(1));
+  EXPECT_TRUE(ctx.bbslist().node_config_for(1));
+
+  // Still cached until it is reset, like after network3 rewrites it.
+  ASSERT_TRUE(WriteBbsDataNet(2));
+  EXPECT_TRUE(ctx.bbslist().node_config_for(1));
+  EXPECT_FALSE(ctx.bbslist().node_config_for(2));
+
+  ctx.reset_bbslist();
+  EXPECT_FALSE(ctx.bbslist().node_config_for(1));
+  EXPECT_TRUE(ctx.bbslist().node_config_for(2));
+}
+
+TEST_F(NetworkStageTest, Subs_Shared) {
+  NetworkStageContext one(shared_, 0, {});
+  NetworkStageContext two(shared_, 0, {});
+  EXPECT_EQ(&one.shared().subs(), &two.shared().subs());
+}
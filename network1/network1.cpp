@@ -17,19 +17,17 @@
 /**************************************************************************/
 
 // WWIV5 Network1
-#include "network1.h"
+#include "network1/network1.h"
 
 #include "core/clock.h"
-#include "core/command_line.h"
 #include "core/file.h"
 #include "core/findfiles.h"
 #include "core/log.h"
+#include "core/metrics.h"
 #include "core/os.h"
-#include "core/scope_exit.h"
-#include "core/semaphore_file.h"
 #include "core/stl.h"
 #include "core/strings.h"
-#include "net_core/net_cmdline.h"
+#include "net_core/net_stage.h"
 #include "sdk/bbslist.h"
 #include "sdk/filenames.h"
 #include "sdk/net/contact.h"
@@ -38,6 +36,7 @@
 #include <cstdlib>
 #include <iostream>
 #include <map>
+#include <mutex>
 #include <set>
 #include <string>
 #include <vector>
@@ -50,26 +49,21 @@ using namespace wwiv::sdk::net;
 using namespace wwiv::stl;
 using namespace wwiv::os;
 
-static void ShowHelp(const NetworkCommandLine& cmdline) {
-  std::cout << cmdline.GetHelp() << std::endl;
-  exit(1);
-}
-
 int NetworkStat::k() const {
   return bytes == 0 ? 0 : (bytes + 1023) / 1024;
 }
 
-Network1::Network1(const NetworkCommandLine& cmdline, const BbsListNet& bbslist,
+Network1::Network1(const NetworkStageContext& ctx, const BbsListNet& bbslist,
                    wwiv::core::Clock& clock)
-    : net_cmdline_(cmdline), bbslist_(bbslist), clock_(clock), net_(net_cmdline_.network()),
-      netdat_(net_cmdline_.config().gfilesdir(),
-        net_cmdline_.config().logdir(), 
-        net_, net_cmdline_.net_cmd(), clock_) {}
+    : ctx_(ctx), bbslist_(bbslist), clock_(clock), net_(ctx_.network()),
+      netdat_(ctx_.config().gfilesdir(),
+        ctx_.config().logdir(), 
+        net_, '1', clock_) {}
 
 
 /**
  * Determines the filename for each of the nodes in list to forward to
- * and writes packets (calling write_wwivnet_packet) to each of them.
+ * and writes packets (to sink_) to each of them.
  */
 bool Network1::write_multiple_wwivnet_packets(const net_header_rec& orig_header,
                                               const std::vector<uint16_t>& list,
@@ -100,7 +94,7 @@ bool Network1::write_multiple_wwivnet_packets(const net_header_rec& orig_header,
     }
     const auto forsys = fa.first;
     netdat_.add_file_bytes(forsys, np.length());
-    if (!write_wwivnet_packet(NetPacket::wwivnet_packet_path(net_, forsys), np)) {
+    if (!sink_.Write(NetPacket::wwivnet_packet_path(net_, forsys), np)) {
       result = false;
     }
   }
@@ -123,52 +117,69 @@ bool Network1::handle_packet(NetPacket& p) {
   if (p.nh.tosys == net_.sysnum) {
     // Local Packet.
     netdat_.add_file_bytes(net_.sysnum, p.length());
-    return write_wwivnet_packet(FilePath(net_.dir, LOCAL_NET), p);
+    return sink_.Write(FilePath(net_.dir, LOCAL_NET), p);
   }
   if (p.list.empty()) {
     // Network packet, single destination
     const auto forsys = get_forsys(bbslist_, p.nh.tosys);
     netdat_.add_file_bytes(forsys, p.length());
-    return write_wwivnet_packet(NetPacket::wwivnet_packet_path(net_, forsys), p);
+    return sink_.Write(NetPacket::wwivnet_packet_path(net_, forsys), p);
   }
   // Network packet, multiple destinations.
   return write_multiple_wwivnet_packets(p.nh, p.list, p.text());
 }
 
 bool Network1::handle_file(const std::string& name) {
-  File f(FilePath(net_.dir, name));
-  if (!f.Open(File::modeBinary | File::modeReadOnly)) {
+  MappedNetMailFile file(FilePath(net_.dir, name), false);
+  if (!file) {
     LOG(ERROR) << "Unable to open file: " << net_.dir << name;
     return false;
   }
 
-  for (;;) {
-    auto [packet, response] = read_packet(f, false);
-    if (response == ReadNetPacketResponse::END_OF_FILE) {
-      return true;
-    }
-    if (response == ReadNetPacketResponse::ERROR) {
-      return false;
+  auto& packets = metrics().counter("network1_packets_total", "Packets routed by network1.",
+                                    {{"network", net_.name}});
+  auto& errors = metrics().counter("network1_packet_errors_total",
+                                   "Packets network1 was unable to route.",
+                                   {{"network", net_.name}});
+  for (const auto& view : file) {
+    // Deleted packets are skipped without copying their text.
+    if (view.deleted()) {
+      LOG(INFO) << "Skipping deleted message at offset: " << view.offset();
+      continue;
     }
+    auto packet = view.ToNetPacket();
+    packets.inc();
     if (!handle_packet(packet)) {
       LOG(ERROR) << "error handing packet: type: " << packet.nh.main_type;
+      errors.inc();
     }
   }
+  return file.last_read_response() == ReadNetPacketResponse::END_OF_FILE;
 }
 
 bool Network1::Run() {
   try {
     LOG(INFO) << " * Analyzing " << net_.name << " pending files...";
     FindFiles ff(FilePath(net_.dir, "p*.net"), FindFiles::FindFilesType::files);
+    std::vector<std::string> handled;
     for (const auto& f : ff) {
       VLOG(1) << "Processing: " << net_.dir.string() << f.name;
       if (handle_file(f.name)) {
-        VLOG(1) << "Deleting: " << net_.dir.string() << f.name;
-        if (net_cmdline_.skip_delete()) {
-          backup_file(FilePath(net_.dir, f.name));
-        }
-        File::Remove(FilePath(net_.dir, f.name));
+        handled.push_back(f.name);
+      }
+    }
+
+    // Only remove the pending files once everything routed from them is on disk.
+    if (!sink_.Close()) {
+      LOG(ERROR) << "Error writing routed packets, leaving pending files in place.";
+      handled.clear();
+    }
+    for (const auto& name : handled) {
+      VLOG(1) << "Deleting: " << net_.dir.string() << name;
+      if (ctx_.skip_delete()) {
+        backup_file(FilePath(net_.dir, name));
       }
+      File::Remove(FilePath(net_.dir, name));
     }
 
     // Update contact record.
@@ -188,7 +199,9 @@ bool Network1::Run() {
       DCHECK(c);
       VLOG(1) << "Updating contact entry for node: @" << sn;
       const auto outbound_fn = FilePath(net_.dir, StrCat("s", it->second.systemnumber(), ".net"));
-      if (File::Exists(outbound_fn)) {
+      if (const auto size = sink_.file_size(outbound_fn)) {
+        c->set_bytes_waiting(static_cast<int32_t>(*size));
+      } else if (File::Exists(outbound_fn)) {
         File of(outbound_fn);
         c->set_bytes_waiting(static_cast<int32_t>(of.length()));
       } else {
@@ -202,6 +215,7 @@ bool Network1::Run() {
       return true;
     }
 
+    std::lock_guard lock(ctx_.shared().mutex());
     LOG(INFO) << netdat_.ToDebugString();
     netdat_.WriteStats();
     return true;
@@ -211,36 +225,26 @@ bool Network1::Run() {
   return false;
 }
 
-int main(int argc, char** argv) { 
-  LoggerConfig config(LogDirFromConfig);
-  Logger::Init(argc, argv, config);
+namespace wwiv::net::network1 {
 
-  auto at_exit = finally(Logger::ExitLogger);
-  CommandLine cmdline(argc, argv, "net");
-  const NetworkCommandLine net_cmdline(cmdline, '1');
-  if (!net_cmdline.IsInitialized() || net_cmdline.cmdline().help_requested()) {
-    ShowHelp(net_cmdline);
-    return 1;
-  }
-
-
-  VLOG(3) << "Reading bbsdata.net..";
-  const auto& net = net_cmdline.network();
-  const auto b = BbsListNet::ReadBbsDataNet(net.dir);
+int network1_main(NetworkStageContext& ctx) {
+  const auto& b = ctx.bbslist();
   if (b.empty()) {
     LOG(ERROR) << "ERROR: Unable to read bbsdata.net.";
     LOG(ERROR) << "       You likely need to run network3?";
     return 1;
   }
 
-  try {
-    auto semaphore = SemaphoreFile::try_acquire(net_cmdline.semaphore_path(),
-                                                net_cmdline.semaphore_timeout());
-    SystemClock clock;
-    Network1 n1(net_cmdline, b, clock);
-    return n1.Run() ? 0 : 2;
-  } catch (const semaphore_not_acquired& e) {
-    LOG(ERROR) << "ERROR: [network" << net_cmdline.net_cmd()
-               << "]: Unable to Acquire Network Semaphore: " << e.what();
-  }
-}
\ No newline at end of file
+  SystemClock clock;
+  // The netdat logs in gfiles are shared by all networks, so only roll them
+  // over and write to them while holding the shared data lock. Routing the
+  // packets only touches this network's directory.
+  std::unique_lock lock(ctx.shared().mutex());
+  Network1 n1(ctx, b, clock);
+  lock.unlock();
+  const auto ok = n1.Run();
+  lock.lock();
+  return ok ? 0 : 2;
+}
+
+} // namespace wwiv::net::network1
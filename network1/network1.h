@@ -19,7 +19,7 @@
 #define INCLUDED_NET_NETWORK1_H
 
 #include "core/clock.h"
-#include "net_core/net_cmdline.h"
+#include "net_core/net_stage.h"
 #include "net_core/netdat.h"
 #include "sdk/net/packets.h"
 #include <string>
@@ -32,7 +32,7 @@ class BbsListNet;
 
 class Network1 final {
 public:
-  Network1(const wwiv::net::NetworkCommandLine& cmdline, 
+  Network1(const wwiv::net::NetworkStageContext& ctx,
            const wwiv::sdk::BbsListNet& bbslist,
            wwiv::core::Clock& clock);
   ~Network1() = default;
@@ -44,11 +44,23 @@ private:
                                       const std::string& text);
   bool handle_packet(wwiv::sdk::net::NetPacket& p);
   bool handle_file(const std::string& name);
-  const wwiv::net::NetworkCommandLine& net_cmdline_;
+  const wwiv::net::NetworkStageContext& ctx_;
   const wwiv::sdk::BbsListNet& bbslist_;
   wwiv::core::Clock& clock_;
   const wwiv::sdk::net::Network& net_;
   wwiv::net::NetDat netdat_;
+  // Outbound s*.net and local.net files written to during this run.
+  wwiv::sdk::net::PacketSink sink_;
 };
 
+namespace wwiv::net::network1 {
+
+/**
+ * Runs network1 for the network in ctx, routing the pending p*.net files into
+ * the s*.net files for each node and local.net.
+ */
+int network1_main(NetworkStageContext& ctx);
+
+} // namespace wwiv::net::network1
+
 #endif // INCLUDED_NET_NETWORK1_H
\ No newline at end of file
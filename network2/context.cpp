@@ -23,10 +23,8 @@ namespace wwiv::net::network2 {
 using namespace wwiv::sdk::net;
 
 Context::Context(const sdk::Config& c, const Network& n, sdk::UserManager& u,
-                 const std::vector<Network>& ns, NetDat& netdat)
-  : config(c), net(n), user_manager(u), subs(c.datadir(), ns), networks_(ns), netdat_(netdat), ssm(c, u) {
-  subs_initialized = subs.Load();
-}
+                 const std::vector<Network>& ns, sdk::Subs& s, NetDat& netdat)
+  : config(c), net(n), user_manager(u), subs(s), networks_(ns), netdat_(netdat), ssm(c, u) {}
 
 void Context::set_api(int type, std::unique_ptr<sdk::msgapi::MessageApi>&& a) {
   msgapis_[type] = std::move(a);
@@ -47,7 +47,7 @@ class Context {
 
 public:
   Context(const sdk::Config& c, const sdk::net::Network& n, sdk::UserManager& u,
-          const std::vector<sdk::net::Network>& ns, NetDat& netdat);
+          const std::vector<sdk::net::Network>& ns, sdk::Subs& s, NetDat& netdat);
 
   void set_api(int type, std::unique_ptr<sdk::msgapi::MessageApi>&& a);
 
@@ -67,11 +67,13 @@ public:
   std::unique_ptr<sdk::msgapi::WWIVMessageApi> email_api_;
   // network number like network 0 (.0) is the 1st network in WWIVconfig.
   int network_number{0};
-  sdk::Subs subs;
+  sdk::Subs& subs;
   const std::vector<sdk::net::Network> networks_;
   NetDat& netdat_;
   bool verbose{false};
-  bool subs_initialized{false};
+  // Set when email or posts were added, to update the filechange in status.dat.
+  bool email_changed{false};
+  bool posts_changed{false};
   sdk::SSM ssm;
   std::unique_ptr<std::vector<external_programs_t>> external_programs;
   std::set<int> external_programs_saved;
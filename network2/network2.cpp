@@ -17,21 +17,21 @@
 /**************************************************************************/
 
 // WWIV5 Network2
-#include "core/command_line.h"
 #include "core/datafile.h"
 #include "core/file.h"
 #include "core/log.h"
+#include "core/metrics.h"
 #include "core/os.h"
 #include "core/scope_exit.h"
-#include "core/semaphore_file.h"
 #include "core/stl.h"
 #include "core/strings.h"
 #include "network2/context.h"
 #include "network2/email.h"
+#include "network2/network2.h"
 #include "network2/post.h"
 #include "network2/subs.h"
 #include "net_core/netdat.h"
-#include "net_core/net_cmdline.h"
+#include "net_core/net_stage.h"
 #include "sdk/config.h"
 #include "sdk/filenames.h"
 #include "sdk/ssm.h"
@@ -45,6 +45,7 @@
 #include <cstdlib>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 
@@ -58,9 +59,6 @@ using namespace wwiv::sdk::net;
 using namespace wwiv::stl;
 using namespace wwiv::strings;
 
-static bool email_changed = false;
-static bool posts_changed = false;
-
 static void update_filechange_status_dat(const std::filesystem::path& datadir, bool email, bool posts) {
   StatusMgr sm(datadir);
   sm.Run([=](Status& s)
@@ -74,11 +72,6 @@ static void update_filechange_status_dat(const std::filesystem::path& datadir, b
   });
 }
 
-static void ShowHelp(const NetworkCommandLine& cmdline) {
-  std::cout << cmdline.GetHelp() << std::endl;
-  exit(1);
-}
-
 static bool handle_ssm(Context& context, NetPacket& p) {
   auto at_exit =
       finally(
@@ -218,7 +211,7 @@ static bool handle_packet(Context& context, NetPacket& p) {
     if (p.nh.minor_type == 0) {
       // Feedback to sysop from the NC.
       // This is sent to the #1 account as source verified email.
-      email_changed = true;
+      context.email_changed = true;
       return handle_email(context, 1, p);
     }
     return handle_net_info_file(context, context.net, p);
@@ -226,16 +219,16 @@ static bool handle_packet(Context& context, NetPacket& p) {
   case main_type_email:
     // This is regular email sent to a user number at this system.
     // Email has no minor type, so minor_type will always be zero.
-    email_changed = true;
+    context.email_changed = true;
     return handle_email(context, p.nh.touser, p);
   case main_type_email_name:
     // The other email type.  The "touser" field is zero, and the name is found at
     // the beginning of the message text, followed by a NUL character.
     // Minor_type will always be zero.
-    email_changed = true;
+    context.email_changed = true;
     return handle_email_byname(context, p);
   case main_type_new_post: {
-    posts_changed = true;
+    context.posts_changed = true;
     if (!handle_inbound_post(context, p)) {
       LOG(ERROR) << "Error on handle_inbound_post";
       return false;
@@ -321,31 +314,47 @@ static bool handle_local_net(Context& context) {
   // Handle epreproc.net 1st before we open and process the local.net packet
   handle_epreproc_net(context);
 
-  NetMailFile packets(context.net.dir / LOCAL_NET, true, true);
+  MappedNetMailFile packets(context.net.dir / LOCAL_NET, true, true);
   if (!packets) {
     return false;
   }
-  for (auto packet : packets) {
+  auto& processed = metrics().counter("network2_packets_total", "Packets processed by network2.",
+                                      {{"network", context.net.name}});
+  auto& errors = metrics().counter("network2_packet_errors_total",
+                                   "Packets network2 was unable to process.",
+                                   {{"network", context.net.name}});
+  for (const auto& view : packets) {
+    if (view.deleted()) {
+      // Already handled, nothing to do.
+      continue;
+    }
+    auto packet = view.ToNetPacket();
+    processed.inc();
     if (!handle_packet(context, packet)) {
       LOG(ERROR) << "Error handing packet: type: " << packet.nh.main_type;
-    } else if (packet.source() == NetPacketSource::DISK) {
-      // Seek to start of packet and mark it deleted.
-      delete_packet(packets.file(), packet);
+      errors.inc();
+    } else {
+      // Mark it deleted in local.net.
+      packets.Delete(view);
     }
   }
   return true;
 }
 
-int network2_main(const NetworkCommandLine& net_cmdline) {
+namespace wwiv::net::network2 {
+
+int network2_main(NetworkStageContext& ctx) {
   try {
-    const auto& net = net_cmdline.network();
+    const auto& net = ctx.network();
     if (!File::Exists(net.dir / LOCAL_NET)) {
       LOG(INFO) << "No local.net exists. exiting.";
       return 0;
     }
 
-    const auto& config = net_cmdline.config();
-    const auto& networks = net_cmdline.networks();
+    // network2 adds to the message bases, email and subs shared by all networks.
+    std::lock_guard lock(ctx.shared().mutex());
+    const auto& config = ctx.config();
+    const auto& networks = ctx.networks();
     // TODO(rushfan): Load sub data here;
     // TODO(rushfan): Create the right API type for the right message area.
     MessageApiOptions options{};
@@ -354,10 +363,10 @@ int network2_main(const NetworkCommandLine& net_cmdline) {
 
     const auto user_manager = std::make_unique<UserManager>(config);
     SystemClock clock{};
-    NetDat netdat(config.gfilesdir(), config.logdir(), net, net_cmdline.net_cmd(), clock);
+    NetDat netdat(config.gfilesdir(), config.logdir(), net, '2', clock);
 
-    Context context(config, net, *user_manager, networks.networks(), netdat);
-    context.network_number = net_cmdline.network_number();
+    Context context(config, net, *user_manager, networks.networks(), ctx.shared().subs(), netdat);
+    context.network_number = ctx.network_number();
     context.set_email_api(
         std::make_unique<WWIVMessageApi>(options, config, networks.networks(), new NullLastReadImpl()));
     context.set_api(2, std::make_unique<WWIVMessageApi>(options, config, networks.networks(),
@@ -365,14 +374,15 @@ int network2_main(const NetworkCommandLine& net_cmdline) {
 
     VLOG(1) << "Processing: " << net.dir.string() << LOCAL_NET;
     if (handle_local_net(context)) {
-      if (net_cmdline.skip_delete()) {
+      if (ctx.skip_delete()) {
         backup_file(net.dir / LOCAL_NET);
       }
       VLOG(1) << "Deleting: " << net.dir.string() << LOCAL_NET;
       if (!File::Remove(net.dir / LOCAL_NET)) {
         LOG(ERROR) << "ERROR: Unable to delete " << net.dir << LOCAL_NET;
       }
-      update_filechange_status_dat(context.config.datadir(), email_changed, posts_changed);
+      update_filechange_status_dat(context.config.datadir(), context.email_changed,
+                                   context.posts_changed);
       return 0;
     }
     LOG(ERROR) << "ERROR: handle_local_net returned false";
@@ -384,23 +394,4 @@ int network2_main(const NetworkCommandLine& net_cmdline) {
   return 255;
 }
 
-int main(int argc, char** argv) {
-  LoggerConfig config(LogDirFromConfig);
-  Logger::Init(argc, argv, config);
-  auto at_exit = finally(Logger::ExitLogger);
-  CommandLine cmdline(argc, argv, "net");
-  const NetworkCommandLine net_cmdline(cmdline, '2');
-  if (!net_cmdline.IsInitialized() || net_cmdline.cmdline().help_requested()) {
-    ShowHelp(net_cmdline);
-    return 1;
-  }
-
-  try {
-    const auto semaphore =
-        SemaphoreFile::try_acquire(net_cmdline.semaphore_path(), net_cmdline.semaphore_timeout());
-    return network2_main(net_cmdline);
-  } catch (const semaphore_not_acquired& e) {
-    LOG(ERROR) << "ERROR: [network" << net_cmdline.net_cmd()
-               << "]: Unable to Acquire Network Semaphore: " << e.what();
-  }
-}
+} // namespace wwiv::net::network2
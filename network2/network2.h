@@ -1,7 +1,7 @@
 /**************************************************************************/
 /*                                                                        */
 /*                          WWIV Version 5.x                              */
-/*            Copyright (C)2016-2022, WWIV Software Services              */
+/*             Copyright (C)2016-2022, WWIV Software Services             */
 /*                                                                        */
 /*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
 /*    you may not use this  file  except in compliance with the License.  */
@@ -15,17 +15,19 @@
 /*    either  express  or implied.  See  the  License for  the specific   */
 /*    language governing permissions and limitations under the License.   */
 /**************************************************************************/
-#ifndef INCLUDED_CORE_CRC32_H
-#define INCLUDED_CORE_CRC32_H
+#ifndef INCLUDED_NETWORK2_NETWORK2_H
+#define INCLUDED_NETWORK2_NETWORK2_H
 
-#include <filesystem>
-#include <string>
+#include "net_core/net_stage.h"
 
-namespace wwiv::core {
+namespace wwiv::net::network2 {
 
-[[nodiscard]] uint32_t crc32file(const std::filesystem::path& path);
-[[nodiscard]] uint32_t crc32string(const std::string& contents);
+/**
+ * Runs network2 for the network in ctx, delivering the email and posts in
+ * local.net to this system.
+ */
+int network2_main(NetworkStageContext& ctx);
 
-}
+} // namespace wwiv::net::network2
 
-#endif
\ No newline at end of file
+#endif
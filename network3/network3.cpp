@@ -15,16 +15,15 @@
 /*    either  express  or implied.  See  the  License for  the specific   */
 /*    language governing permissions and limitations under the License.   */
 /**************************************************************************/
+#include "network3/network3.h"
+
 #include "binkp/binkp_config.h"
-#include "core/command_line.h"
 #include "core/datafile.h"
 #include "core/datetime.h"
 #include "core/file.h"
 #include "core/findfiles.h"
 #include "core/log.h"
 #include "core/os.h"
-#include "core/scope_exit.h"
-#include "core/semaphore_file.h"
 #include "core/stl.h"
 #include "core/strings.h"
 #include "core/textfile.h"
@@ -32,7 +31,7 @@
 #include "fmt/format.h"
 #include "fmt/printf.h"
 #include "net_core/netdat.h"
-#include "net_core/net_cmdline.h"
+#include "net_core/net_stage.h"
 #include "sdk/bbslist.h"
 #include "sdk/config.h"
 #include "sdk/filenames.h"
@@ -54,6 +53,7 @@
 #include <filesystem>
 #include <iostream>
 #include <map>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -67,25 +67,19 @@ using namespace wwiv::sdk::net;
 using namespace wwiv::stl;
 using namespace wwiv::os;
 
-static void ShowHelp(const NetworkCommandLine& cmdline) {
-  std::cout << cmdline.GetHelp() << std::endl;
-  exit(1);
-}
-
 static bool check_wwivnet_host_networks(
-  const wwiv::sdk::Config& config, 
-  const wwiv::sdk::Networks& network,
+  SharedNetworkData& shared,
   const BbsListNet& b,
   int network_number,
   std::ostringstream& text) {
   
-  wwiv::sdk::Subs subs(config.datadir(), network.networks());
-  if (!subs.Load()) {
+  const auto& subs = shared.subs();
+  if (!shared.subs_loaded()) {
     LOG(ERROR) << "Unable to load subs (.dat and .xtr)";
     return false;
   }
 
- const auto& net = network.networks()[network_number];
+ const auto& net = shared.networks()[network_number];
 
   for (const auto& x : subs.subs()) {
     for (const auto& n : x.nets) {
@@ -114,14 +108,13 @@ static bool check_wwivnet_host_networks(
 }
 
 static bool check_fido_host_networks(
-  const Config& config,
-  const Networks& network,
+  SharedNetworkData& shared,
   const Network& net,
   int network_number,
   std::ostringstream& text) {
 
-  Subs subs(config.datadir(), network.networks());
-  if (!subs.Load()) {
+  const auto& subs = shared.subs();
+  if (!shared.subs_loaded()) {
     LOG(ERROR) << "Unable to load subs (.dat and .xtr)";
     text << "Unable to load subs (.dat and .xtr)\r\n";
     return false;
@@ -402,30 +395,18 @@ static void ensure_contact_net_entries(const Callout& callout, const Network& ne
   }
 }
 
-static bool need_to_send_feedback(const CommandLine& cmdline) {
-  if (cmdline.barg("feedback")) {
-    return true;
-  }
-  for (const auto& s : cmdline.remaining()) {
-    if (s == "Y" || s == "y") {
-      return true;
-    }
-  }
-  return false;
-}
-
-static int network3_fido(const NetworkCommandLine& net_cmdline) {
+static int network3_fido(const NetworkStageContext& ctx) {
   VLOG(2) << "network3_fido";
-  const auto& net = net_cmdline.network();
+  const auto& net = ctx.network();
   std::ostringstream text;
   add_feedback_header(net.dir, text);
   LOG(INFO) << "Sending Feedback.";
 
   std::vector<net_system_list_rec> bbsdata_data;
-  auto phone = net_cmdline.config().system_phone();
+  auto phone = ctx.config().system_phone();
   {
     net_system_list_rec n1{};
-    to_char_array(n1.name, net_cmdline.config().system_name());
+    to_char_array(n1.name, ctx.config().system_name());
     to_char_array(n1.phone, phone);
     n1.forsys = FTN_FAKE_OUTBOUND_NODE;
     n1.group = 0;
@@ -460,7 +441,7 @@ static int network3_fido(const NetworkCommandLine& net_cmdline) {
   // create bbsdata.reg
   {
     std::vector<int32_t> bbsdata_reg_data;
-    bbsdata_reg_data.push_back(net_cmdline.config().wwiv_reg_number());
+    bbsdata_reg_data.push_back(ctx.config().wwiv_reg_number());
     bbsdata_reg_data.push_back(0);
     DataFile<int32_t> bbsdata_reg_file(FilePath(net.dir, BBSDATA_REG),
                                        File::modeBinary |
@@ -477,7 +458,7 @@ static int network3_fido(const NetworkCommandLine& net_cmdline) {
     text << "Unable to parse your address of: " << net.fido.fido_address << "\r\n";
     text << " ** Please fix it.\r\n\n";
   }
-  FtnDirectories dirs(net_cmdline.cmdline().bindir(), net);
+  FtnDirectories dirs(ctx.options().bindir, net);
   text << "Inbound dir:             " << dirs.inbound_dir() << "\r\n";
   text << "Outbound dir:            " << dirs.outbound_dir() << "\r\n";
   text << "Temporary Inbound dir:   " << dirs.temp_inbound_dir() << "\r\n";
@@ -488,13 +469,12 @@ static int network3_fido(const NetworkCommandLine& net_cmdline) {
   if (!File::Exists(FilePath(dirs.net_dir(), FIDO_CALLOUT_JSON))) {
     text << " ** fido_callout.json file DOES NOT EXIST.\r\n\n";
   }
-  FidoCallout callout(net_cmdline.config().root_directory(), net_cmdline.config().max_backups(),
+  FidoCallout callout(ctx.config().root_directory(), ctx.config().max_backups(),
                       net);
   if (!callout.IsInitialized()) {
     text << " ** Unable to read fido_callout.json\r\n\n";
   } else {
-    check_fido_host_networks(net_cmdline.config(), net_cmdline.networks(), net,
-                             net_cmdline.network_number(), text);
+    check_fido_host_networks(ctx.shared(), net, ctx.network_number(), text);
   }
 
   text << "Using nodelist base:     " << net.fido.nodelist_base << "\r\n";
@@ -532,20 +512,19 @@ static int network3_fido(const NetworkCommandLine& net_cmdline) {
 
   text << "\r\nBest,\r\n\r\n" << net.name << "@" << net.sysnum << "\r\n\r\n";
 
-  if (need_to_send_feedback(net_cmdline.cmdline())) {
+  if (ctx.options().feedback) {
     send_feedback_email(net, text.str());
   }
 
   return 0;
 }
 
-static int network3_wwivnet(const NetworkCommandLine& net_cmdline) {
+static int network3_wwivnet(const NetworkStageContext& ctx) {
   VLOG(2) << "Reading bbslist.net..";
-  const auto& net = net_cmdline.network();
+  const auto& net = ctx.network();
   const auto b = BbsListNet::ParseBbsListNet(net.sysnum, net.dir);
   SystemClock clock;
-  NetDat netdat(net_cmdline.config().gfilesdir(), net_cmdline.config().logdir(),
-                net_cmdline.network(), net_cmdline.net_cmd(), clock);
+  NetDat netdat(ctx.config().gfilesdir(), ctx.config().logdir(), ctx.network(), '3', clock);
   if (b.empty()) {
     LOG(ERROR) << "ERROR: bbslist.net didn't parse.";
     return 1;
@@ -564,21 +543,21 @@ static int network3_wwivnet(const NetworkCommandLine& net_cmdline) {
   write_bbsdata_reg_file(b, net.dir);
 
   VLOG(2) << "Reading callout.net...";
-  const Callout callout(net, net_cmdline.config().max_backups());
+  const Callout callout(net, ctx.config().max_backups());
   ensure_contact_net_entries(callout, net);
-  update_filechange_status_dat(net_cmdline.config().datadir());
+  update_filechange_status_dat(ctx.config().datadir());
   rename_pending_files(net.dir);
 
-  if (need_to_send_feedback(net_cmdline.cmdline()) || is_nc) {
+  if (ctx.options().feedback || is_nc) {
     std::ostringstream text;
     add_feedback_header(net.dir, text);
     LOG(INFO) << "Sending Feedback.";
     add_feedback_general_info(callout, net, bbsdata_data, text);
-    check_wwivnet_host_networks(net_cmdline.config(), net_cmdline.networks(), b, net_cmdline.network_number(), text);
+    check_wwivnet_host_networks(ctx.shared(), b, ctx.network_number(), text);
 
     if (is_nc) {
       // We should always send feedback to the NCs.
-      const BinkConfig bink_config(net_cmdline.network_name(), net_cmdline.config(), net_cmdline.networks());
+      const BinkConfig bink_config(ctx.network_name(), ctx.config(), ctx.networks());
       check_binkp_net(b, bink_config, text);
       check_connect_net(b, net, text);
     }
@@ -591,10 +570,14 @@ static int network3_wwivnet(const NetworkCommandLine& net_cmdline) {
   return 0;
 }
 
-int network3_main(const NetworkCommandLine& net_cmdline) {
+namespace wwiv::net::network3 {
+
+int network3_main(NetworkStageContext& ctx) {
   try {
-    const auto& net = net_cmdline.network();
-    update_net_ver_status_dat(net_cmdline.config().datadir());
+    // network3 updates status.dat and reads the subs shared by all networks.
+    std::lock_guard lock(ctx.shared().mutex());
+    const auto& net = ctx.network();
+    update_net_ver_status_dat(ctx.config().datadir());
 
     if (!File::Exists(net.dir)) {
       LOG(ERROR) << "Network directory '" << net.dir << "' does not exist.";
@@ -602,37 +585,17 @@ int network3_main(const NetworkCommandLine& net_cmdline) {
       return 1;
     }
 
+    // bbsdata.net is rewritten below, so make the next stage reread it.
+    ctx.reset_bbslist();
     // Only run the net fido type network3 for 5.x
-    if (net_cmdline.config().is_5xx_or_later() && net.type == network_type_t::ftn) {
-      return network3_fido(net_cmdline);
+    if (ctx.config().is_5xx_or_later() && net.type == network_type_t::ftn) {
+      return network3_fido(ctx);
     }
-    return network3_wwivnet(net_cmdline);
+    return network3_wwivnet(ctx);
   } catch (const std::exception& e) {
     LOG(ERROR) << "ERROR: [network]: " << e.what();
   }
   return 2;
 }
 
-
-int main(int argc, char** argv) {
-  LoggerConfig config(LogDirFromConfig);
-  Logger::Init(argc, argv, config);
-
-  auto at_exit = finally(Logger::ExitLogger);
-  CommandLine cmdline(argc, argv, "net");
-  cmdline.add_argument(BooleanCommandLineArgument("feedback", 'y', "Sends feedback.", false));
-  const NetworkCommandLine net_cmdline(cmdline, '3');
-  if (!net_cmdline.IsInitialized() || net_cmdline.cmdline().help_requested()) {
-    ShowHelp(net_cmdline);
-    return 1;
-  }
-
-  try {
-    auto semaphore = SemaphoreFile::try_acquire(net_cmdline.semaphore_path(),
-                                                net_cmdline.semaphore_timeout());
-    return network3_main(net_cmdline);
-  } catch (const semaphore_not_acquired& e) {
-    LOG(ERROR) << "ERROR: [network" << net_cmdline.net_cmd()
-               << "]: Unable to Acquire Network Semaphore: " << e.what();
-  }
-}
+} // namespace wwiv::net::network3
@@ -1,7 +1,7 @@
 /**************************************************************************/
 /*                                                                        */
-/*                              WWIV Version 5.x                          */
-/*               Copyright (C)2014-2022, WWIV Software Services           */
+/*                          WWIV Version 5.x                              */
+/*             Copyright (C)2016-2022, WWIV Software Services             */
 /*                                                                        */
 /*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
 /*    you may not use this  file  except in compliance with the License.  */
@@ -14,26 +14,20 @@
 /*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
 /*    either  express  or implied.  See  the  License for  the specific   */
 /*    language governing permissions and limitations under the License.   */
-/*                                                                        */
 /**************************************************************************/
-#include "gtest/gtest.h"
-#include "core/crc32.h"
-#include "core/file.h"
-#include "core/test/file_helper.h"
-#include <string>
-#include <vector>
+#ifndef INCLUDED_NETWORK3_NETWORK3_H
+#define INCLUDED_NETWORK3_NETWORK3_H
 
-using namespace wwiv::core;
+#include "net_core/net_stage.h"
 
-TEST(Crc32Test, Simple) {
-  wwiv::core::test::FileHelper file;
-  const auto path = file.CreateTempFile("helloworld.txt", "Hello World");
+namespace wwiv::net::network3 {
 
-  ASSERT_TRUE(File::Exists(path));
+/**
+ * Runs network3 for the network in ctx, rebuilding bbsdata.* from the
+ * network's node lists and sending feedback when requested.
+ */
+int network3_main(NetworkStageContext& ctx);
 
-  const auto crc = crc32file(path);
-  const uint32_t expected = 0x4a17b156;
+} // namespace wwiv::net::network3
 
-  // use wwiv/scripts/crc32.py to generate golden values as needed.
-  EXPECT_EQ(expected, crc) << " was " << std::hex << crc;
-}
+#endif
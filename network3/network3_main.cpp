@@ -0,0 +1,78 @@
+/**************************************************************************/
+/*                                                                        */
+/*                          WWIV Version 5.x                              */
+/*             Copyright (C)2016-2022, WWIV Software Services             */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/**************************************************************************/
+// WWIV5 Network3
+#include "network3/network3.h"
+
+#include "core/command_line.h"
+#include "core/log.h"
+#include "core/scope_exit.h"
+#include "core/semaphore_file.h"
+#include "net_core/net_cmdline.h"
+#include "net_core/net_stage.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace wwiv::core;
+using namespace wwiv::net;
+using namespace wwiv::sdk;
+
+static void ShowHelp(const NetworkCommandLine& cmdline) {
+  std::cout << cmdline.GetHelp() << std::endl;
+  exit(1);
+}
+
+static bool need_to_send_feedback(const CommandLine& cmdline) {
+  if (cmdline.barg("feedback")) {
+    return true;
+  }
+  for (const auto& s : cmdline.remaining()) {
+    if (s == "Y" || s == "y") {
+      return true;
+    }
+  }
+  return false;
+}
+
+int main(int argc, char** argv) {
+  LoggerConfig config(LogDirFromConfig);
+  Logger::Init(argc, argv, config);
+
+  auto at_exit = finally(Logger::ExitLogger);
+  CommandLine cmdline(argc, argv, "net");
+  cmdline.add_argument(BooleanCommandLineArgument("feedback", 'y', "Sends feedback.", false));
+  const NetworkCommandLine net_cmdline(cmdline, '3');
+  if (!net_cmdline.IsInitialized() || net_cmdline.cmdline().help_requested()) {
+    ShowHelp(net_cmdline);
+    return 1;
+  }
+
+  try {
+    auto semaphore = SemaphoreFile::try_acquire(net_cmdline.semaphore_path(),
+                                                net_cmdline.semaphore_timeout());
+    SharedNetworkData shared(net_cmdline.config(), net_cmdline.networks());
+    auto opts = network_stage_options(net_cmdline);
+    opts.feedback = need_to_send_feedback(net_cmdline.cmdline());
+    NetworkStageContext ctx(shared, net_cmdline.network_number(), opts);
+    return network3::network3_main(ctx);
+  } catch (const semaphore_not_acquired& e) {
+    LOG(ERROR) << "ERROR: [network" << net_cmdline.net_cmd()
+               << "]: Unable to Acquire Network Semaphore: " << e.what();
+  }
+}
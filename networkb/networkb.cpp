@@ -106,6 +106,7 @@ static bool Receive(const CommandLine& cmdline, BinkConfig& bink_config, int por
       };
       BinkP binkp(c.get(), &bink_config, side, "0", factory);
       binkp.Run(cmdline);
+      write_network_metrics(bink_config.config(), bink_config.networks());
     } catch (const connection_error& e) {
       LOG(ERROR) << "CONNECTION ERROR: [networkb]: " << e.what();
     } catch (const socket_error& e) {
@@ -162,6 +163,7 @@ static bool Send(const CommandLine& cmdline, BinkConfig& bink_config, const std:
   }
   BinkP binkp(c.get(), &bink_config, BinkSide::ORIGINATING, sendto_ftn_node, factory);
   binkp.Run(cmdline);
+  write_network_metrics(bink_config.config(), bink_config.networks());
   return true;
 }
 
@@ -29,6 +29,12 @@
 #include "core/version.h"
 #include "fmt/printf.h"
 #include "net_core/net_cmdline.h"
+#include "net_core/net_stage.h"
+#include "network1/network1.h"
+#include "network2/network2.h"
+#include "network3/network3.h"
+#include "networkf/networkf.h"
+#include "networkt/networkt.h"
 #include "sdk/config.h"
 #include "sdk/filenames.h"
 #include "sdk/status.h"
@@ -36,12 +42,17 @@
 #include "sdk/fido/fido_util.h"
 #include "sdk/net/packets.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstdlib>
 #include <ctime>
+#include <functional>
 #include <iostream>
 #include <memory>
-#include <sstream>
 #include <string>
+#include <thread>
+#include <vector>
 
 #ifndef _WIN32
 #include <signal.h>
@@ -72,34 +83,28 @@ static void rename_bbs_instance_files(const std::filesystem::path& dir, int inst
   }
 }
 
-std::string create_network_cmdline(const NetworkCommandLine& net_cmdline, char num, const std::string& cmd) {
-  const auto path = FilePath(net_cmdline.cmdline().bindir(), StrCat("network", num));
-
-  std::ostringstream ss;
-  ss << path;
-#ifdef _WIN32
-  ss << ".exe";
-#endif
-  ss << " --v=" << net_cmdline.cmdline().verbose();
-  if (net_cmdline.quiet()) {
-    ss << " --quiet";
-  }
-  ss << " --bbsdir=" << net_cmdline.cmdline().bbsdir();
-  ss << " --bindir=" << net_cmdline.cmdline().bindir();
-  ss << " --configdir=" << net_cmdline.cmdline().configdir();
-  ss << " ." << net_cmdline.network_number();
-  if (num == '3') {
-    ss << " Y";
-  }
-  if (!cmd.empty()) {
-    ss << " " << cmd;
+struct networkc_options_t {
+  // Also process pending files for this BBS instance number, if > 0.
+  int process_instance{0};
+  // The net_version from status.dat when networkc started.
+  int status_net_version{0};
+  std::chrono::duration<double> semaphore_timeout{30};
+};
+
+// Runs the stage net_cmd in process while holding the same semaphore as the
+// stand alone executable for the stage, so the two never run at once.
+static int run_stage(const NetworkStageContext& ctx, char net_cmd,
+                     const networkc_options_t& opts, const std::function<int()>& fn) {
+  try {
+    auto semaphore = SemaphoreFile::try_acquire(network_semaphore_path(ctx.network(), net_cmd),
+                                                opts.semaphore_timeout);
+    VLOG(1) << "Running network" << net_cmd << " for " << ctx.network_name();
+    return fn();
+  } catch (const semaphore_not_acquired& e) {
+    LOG(ERROR) << "ERROR: [network" << net_cmd
+               << "]: Unable to Acquire Network Semaphore: " << e.what();
   }
-  return ss.str();
-}
-
-static int System(const std::string& cmd) {
-  VLOG(1) << "Command: " << cmd;
-  return system(cmd.c_str());
+  return 2;
 }
 
 static bool checkup2(const time_t tFileTime, const std::filesystem::path& dir, const std::string& filename) {
@@ -161,45 +166,39 @@ static bool need_network3(const Network& net, int network_version) {
          checkup2(bbsdata_time, dir, CALLOUT_NET);
 }
 
-int networkc_main(const NetworkCommandLine& net_cmdline) {
-#ifndef _WIN32
-  // Set this to the default handling, since when wwivd invokes
-  // this (and wwivd ignores SIGCHLD).
-  signal(SIGCHLD, SIG_DFL);
-#endif // !_WIN32
-
+// Processes everything pending for the network in ctx by running each of the
+// stages that have work until nothing is left (or 3 tries).
+static int networkc_network(NetworkStageContext& ctx, const networkc_options_t& opts) {
   try {
-    const auto process_instance = net_cmdline.cmdline().iarg("process_instance");
-    const auto& net = net_cmdline.network();
-
-    StatusMgr sm(net_cmdline.config().datadir(), [](int) {});
-    const auto status = sm.get_status();
+    const auto& net = ctx.network();
+    auto semaphore =
+        SemaphoreFile::try_acquire(network_semaphore_path(net, 'c'), opts.semaphore_timeout);
 
     auto num_tries = 0;
     bool found;
     do {
       found = false;
-      if (process_instance > 0) {
-        VLOG(1) << "Processing instance for #" << process_instance << "; net: " << net.dir;
+      if (opts.process_instance > 0) {
+        VLOG(1) << "Processing instance for #" << opts.process_instance << "; net: " << net.dir;
         // We need to process pending bbs instance file, these are
         // of the form p1.###.  These will get renamed into p*.net
-        rename_bbs_instance_files(net.dir, process_instance, net_cmdline.quiet());
+        rename_bbs_instance_files(net.dir, opts.process_instance, ctx.quiet());
       }
 
       // Pending files, call network1 to put them into s* or local.net.
       if (File::ExistsWildcard(FilePath(net.dir, "p*.net"))) {
         VLOG(2) << "Found p*.net";
-        System(create_network_cmdline(net_cmdline, '1', ""));
+        run_stage(ctx, '1', opts, [&] { return network1::network1_main(ctx); });
         found = true;
       }
 
       // If the network type is a FTN network.
       if (net.type == network_type_t::ftn) {
-        FtnDirectories dirs(net_cmdline.config().root_directory(), net);
+        FtnDirectories dirs(ctx.config().root_directory(), net);
         // Import everything into local.net
         if (File::ExistsWildcard(FilePath(dirs.inbound_dir(), "*.*"))) {
           VLOG(2) << "Trying to FTN import";
-          System(create_network_cmdline(net_cmdline, 'f', "import"));
+          run_stage(ctx, 'f', opts, [&] { return networkf::networkf_main(ctx, {"import"}); });
         }
 
         // Check to see if TIC files exist.
@@ -207,51 +206,92 @@ int networkc_main(const NetworkCommandLine& net_cmdline) {
         const auto tic_file_exist = File::ExistsWildcard(FilePath(dirs.tic_dir(), "*.tic"));
         if (process_tic && tic_file_exist) {
           VLOG(2) << "Trying to process TIC files";
-          System(create_network_cmdline(net_cmdline, 't', ""));
+          run_stage(ctx, 't', opts, [&] { return networkt::networkt_main(ctx); });
         }
 
-        if (exists_bundle(net_cmdline.config(), net)) {
+        if (exists_bundle(ctx.config(), net)) {
           VLOG(2) << "Trying to FTN export";
-          System(create_network_cmdline(net_cmdline, 'f', "export"));
+          run_stage(ctx, 'f', opts, [&] { return networkf::networkf_main(ctx, {"export"}); });
         }
 
         // Export everything to FTN bundles
         const auto fido_out = StrCat("s", FTN_FAKE_OUTBOUND_NODE, ".net");
         if (File::Exists(FilePath(net.dir, fido_out))) {
           VLOG(2) << "Found s" << FTN_FAKE_OUTBOUND_NODE << ".net; trying to export";
-          System(create_network_cmdline(net_cmdline, 'f', "export"));
+          run_stage(ctx, 'f', opts, [&] { return networkf::networkf_main(ctx, {"export"}); });
         }
       }
 
       // Process local mail with network2.
       if (File::Exists(FilePath(net.dir, LOCAL_NET))) {
         VLOG(2) << "Found: " << LOCAL_NET;
-        System(create_network_cmdline(net_cmdline, '2', ""));
+        run_stage(ctx, '2', opts, [&] { return network2::network2_main(ctx); });
         found = true;
       }
 
       // If our network files have changed, run network3 and send feedback.
-      if (need_network3(net, status->status_net_version())) {
+      if (need_network3(net, opts.status_net_version)) {
         VLOG(2) << "Need to run network3";
-        System(create_network_cmdline(net_cmdline, '3', ""));
+        run_stage(ctx, '3', opts, [&] { return network3::network3_main(ctx); });
         found = true;
       }
     } while (found && ++num_tries < 3);
 
     return 0;
+  } catch (const semaphore_not_acquired& e) {
+    LOG(ERROR) << "ERROR: [networkc]: Unable to Acquire Network Semaphore: " << e.what();
   } catch (const std::exception& e) {
-    LOG(ERROR) << "ERROR: [network" << net_cmdline.net_cmd() << "]: " << e.what();
+    LOG(ERROR) << "ERROR: [networkc]: " << e.what();
   }
   return 2;
 }
 
+// Processes the networks on up to max_threads threads.  Each network is only
+// ever processed by one thread, the stages lock SharedNetworkData while they
+// write to anything shared with the other networks.
+static int networkc_main(SharedNetworkData& shared, const std::vector<int>& network_numbers,
+                         const network_stage_options_t& stage_opts,
+                         const networkc_options_t& opts, int max_threads) {
+  std::atomic<std::size_t> next{0};
+  std::atomic<int> result{0};
+  auto worker = [&] {
+    for (auto i = next++; i < network_numbers.size(); i = next++) {
+      NetworkStageContext ctx(shared, network_numbers[i], stage_opts);
+      if (const auto r = networkc_network(ctx, opts); r != 0) {
+        result = r;
+      }
+    }
+  };
+  const auto num_threads =
+      std::min<std::size_t>(std::max(1, max_threads), network_numbers.size());
+  std::vector<std::thread> threads;
+  for (std::size_t i = 1; i < num_threads; i++) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& t : threads) {
+    t.join();
+  }
+  return result;
+}
+
 int main(int argc, char** argv) {
+#ifndef _WIN32
+  // Set this to the default handling, since when wwivd invokes
+  // this (and wwivd ignores SIGCHLD).
+  signal(SIGCHLD, SIG_DFL);
+#endif // !_WIN32
+
   LoggerConfig config(LogDirFromConfig);
   Logger::Init(argc, argv, config);
 
   auto at_exit = finally(Logger::ExitLogger);
   CommandLine cmdline(argc, argv, "net");
   cmdline.add_argument({"process_instance", "Also process pending files for BBS instance #", "0"});
+  cmdline.add_argument(BooleanCommandLineArgument(
+      "all_networks", "Process all networks, not just the one given by --net", false));
+  cmdline.add_argument({"max_threads", "Maximum number of networks to process at the same time.",
+                        "4"});
 
   const NetworkCommandLine net_cmdline(cmdline, 'c');
   if (!net_cmdline.IsInitialized() || net_cmdline.cmdline().help_requested()) {
@@ -259,11 +299,32 @@ int main(int argc, char** argv) {
     return 1;
   }
   try {
-    auto semaphore = SemaphoreFile::try_acquire(net_cmdline.semaphore_path(),
-                                                net_cmdline.semaphore_timeout());
-    return networkc_main(net_cmdline);
-  } catch (const semaphore_not_acquired& e) {
-    LOG(ERROR) << "ERROR: [network" << net_cmdline.net_cmd()
-               << "]: Unable to Acquire Network Semaphore: " << e.what();
+    networkc_options_t opts{};
+    opts.process_instance = net_cmdline.cmdline().iarg("process_instance");
+    opts.semaphore_timeout = net_cmdline.semaphore_timeout();
+    StatusMgr sm(net_cmdline.config().datadir(), [](int) {});
+    opts.status_net_version = sm.get_status()->status_net_version();
+
+    // networkc always runs network3 with feedback, like "network3 Y".
+    auto stage_opts = network_stage_options(net_cmdline);
+    stage_opts.feedback = true;
+
+    std::vector<int> network_numbers;
+    if (net_cmdline.cmdline().barg("all_networks")) {
+      for (auto i = 0; i < size_int(net_cmdline.networks().networks()); i++) {
+        network_numbers.push_back(i);
+      }
+    } else {
+      network_numbers.push_back(net_cmdline.network_number());
+    }
+
+    SharedNetworkData shared(net_cmdline.config(), net_cmdline.networks());
+    const auto result = networkc_main(shared, network_numbers, stage_opts, opts,
+                                      net_cmdline.cmdline().iarg("max_threads"));
+    write_network_metrics(net_cmdline.config(), net_cmdline.networks());
+    return result;
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "ERROR: [networkc]: " << e.what();
   }
-}
\ No newline at end of file
+  return 2;
+}
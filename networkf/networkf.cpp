@@ -31,6 +31,7 @@
 #include "core/version.h"
 #include "fmt/format.h"
 #include "net_core/net_cmdline.h"
+#include "net_core/net_stage.h"
 #include "sdk/bbslist.h"
 #include "sdk/config.h"
 #include "sdk/fido/fido_address.h"
@@ -40,6 +41,7 @@
 #include "sdk/fido/fido_util.h"
 #include "sdk/filenames.h"
 #include "sdk/files/arc.h"
+#include "sdk/files/zip.h"
 #include "sdk/net/ftn_msgdupe.h"
 #include "sdk/net/packets.h"
 #include "sdk/net/subscribers.h"
@@ -47,6 +49,7 @@
 #include <ctime>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <sstream>
 #include <string>
@@ -141,12 +144,11 @@ int ftn_date_days_old(const Clock& clock, const std::string& ftn_date) {
 
 bool NetworkF::import_packet_file(const std::filesystem::path& path) {
   LOG(INFO) << "Importing Packet: " << path.string();
-  auto o = FidoPacket::Open(path);
-  if (!o) {
+  FtnPacketReader packet(path);
+  if (!packet) {
     LOG(INFO) << "Unable to open file: " << path.string();
     return false;
   }
-  auto& packet = o.value();
 
   FidoAddress address(packet.header().orig_zone, packet.header().orig_net,
                       packet.header().orig_node, packet.header().orig_point, "");
@@ -165,27 +167,25 @@ bool NetworkF::import_packet_file(const std::filesystem::path& path) {
     return false;
   }
 
-  while (true) {
-    auto [response, msg] = packet.Read();
-    if (response != ReadNetPacketResponse::OK) {
-      return true;
-    }
-
-    const auto is_email = (msg.nh.attribute & MSGPRIVATE) != 0;
+  fido_packed_message_view_t view;
+  while (packet.Next(view) == ReadNetPacketResponse::OK) {
+    // Check everything that may skip this message using the view into the
+    // packet, only messages that are imported are copied.
+    const auto is_email = (view.nh.attribute & MSGPRIVATE) != 0;
     if (!is_email) {
 
       // Only check age for echomail, not email
       const auto max_days = net().fido.max_echomail_age_days;
       if (!is_email && max_days > 0) {
         // Only check if max_days > 0, otherwise 0 means unlimited.
-        const auto days_old = ftn_date_days_old(clock_, msg.vh.date_time);
+        const auto days_old = ftn_date_days_old(clock_, std::string(view.date_time));
         if (days_old > max_days) {
           // Packet is too old, skip it.
-          const auto msgid = FtnMessageDupe::GetMessageIDFromText(msg.vh.text);
+          const auto msgid = FtnMessageDupe::GetMessageIDFromText(view.text);
           const auto logmsg = fmt::format("Too old FTN message ({} days): msgid:{}; '{}'", days_old,
-            msgid, msg.vh.subject);
+            msgid, view.subject);
           LOG(ERROR) << logmsg;
-          LOG(ERROR) << "Text: " << msg.vh.text;
+          LOG(ERROR) << "Text: " << view.text;
           // TODO(rushfan): move this or write out saved copy?
           continue;
         }
@@ -194,17 +194,21 @@ bool NetworkF::import_packet_file(const std::filesystem::path& path) {
 
       // Don't check for dupes in emails since we certainly won't have a MSGID and also
       // likely the header may match for automated responses split over multiple messages (#1395)
-      if (dupe().is_dupe(msg)) {
-        const auto msgid = FtnMessageDupe::GetMessageIDFromText(msg.vh.text);
-        LOG(ERROR) << "Skipping duplicate FTN message: '" << msg.vh.subject << "' msgid: (" << msgid
+      uint32_t header_crc32 = 0;
+      uint32_t msgid_crc32 = 0;
+      FtnMessageDupe::GetMessageCrc32s(view, header_crc32, msgid_crc32);
+      if (dupe().is_dupe(header_crc32, msgid_crc32)) {
+        const auto msgid = FtnMessageDupe::GetMessageIDFromText(view.text);
+        LOG(ERROR) << "Skipping duplicate FTN message: '" << view.subject << "' msgid: (" << msgid
                    << ")";
-        LOG(ERROR) << "Text: " << msg.vh.text;
+        LOG(ERROR) << "Text: " << view.text;
         // TODO(rushfan): move this or write out saved copy?
         continue;
       }
-      dupe().add(msg);
+      dupe().add(header_crc32, msgid_crc32);
     }
 
+    const auto msg = view.to_message();
     const auto ftn_packet_daten = fido_to_daten(msg.vh.date_time);
     net_header_rec nh{};
     nh.daten = static_cast<uint32_t>(ftn_packet_daten);
@@ -291,6 +295,17 @@ bool NetworkF::import_bundle_file(const std::filesystem::path& path) {
     }
   }
 
+  if (files::determine_arc_extension(path).value_or("") == "ZIP") {
+    // ZIP bundles are extracted in process, no need for the external archiver.
+    const files::ZipReader zip(path);
+    if (!zip || !zip.ExtractAll(dirs_.temp_inbound_dir())) {
+      LOG(ERROR) << "Failed extracting ZIP bundle: " << path.string();
+      return false;
+    }
+    import_packets(dirs_.temp_inbound_dir(), "*.pkt");
+    return true;
+  }
+
   const auto saved_dir = File::current_directory();
   auto at_exit = finally([=] { File::set_current_directory(saved_dir); });
   File::set_current_directory(dirs_.temp_inbound_dir());
@@ -381,12 +396,6 @@ static std::string rename_fido_packet(const std::filesystem::path& dir, const st
 
 std::optional<std::string> NetworkF::create_ftn_bundle(const FidoAddress& route_to,
                                                        const std::string& fido_packet_name) {
-  // were in the temp dir now.
-  auto arcs = files::read_arcs(datadir_);
-  if (arcs.empty()) {
-    LOG(ERROR) << "No archivers defined!";
-    return std::nullopt;
-  }
   const auto now = clock_.Now();
   const auto dow = now.dow();
 
@@ -413,6 +422,14 @@ std::optional<std::string> NetworkF::create_ftn_bundle(const FidoAddress& route_
     return fido_packet_name;
   }
 
+  // ZIP bundles are created in process, no need for the external archivers.
+  const auto in_process_zip = iequals(ctype, "ZIP");
+  const auto arcs = in_process_zip ? std::vector<arcrec>{} : files::read_arcs(datadir_);
+  if (!in_process_zip && arcs.empty()) {
+    LOG(ERROR) << "No archivers defined!";
+    return std::nullopt;
+  }
+
   FidoAddress orig(net_.fido.fido_address);
   for (auto i = 0; i < 35; i++) {
     const auto bname = bundle_name(orig, route_to, dow, i);
@@ -422,6 +439,20 @@ std::optional<std::string> NetworkF::create_ftn_bundle(const FidoAddress& route_
       VLOG(1) << "Skipping candidate bundle: " << full_bundle_path.string();
       continue;
     }
+    if (in_process_zip) {
+      const auto packet_path = FilePath(dirs_.temp_outbound_dir(), fido_packet_name);
+      files::ZipWriter zip(full_bundle_path);
+      if (!zip.AddFile(packet_path) || !zip.Close()) {
+        LOG(ERROR) << "Failed creating ZIP bundle: " << full_bundle_path.string();
+        File::Remove(full_bundle_path);
+        return std::nullopt;
+      }
+      LOG(INFO) << "Created bundle: " << full_bundle_path.string();
+      if (!File::Remove(packet_path)) {
+        LOG(ERROR) << "Error removing packet: " << packet_path;
+      }
+      return bname;
+    }
     // We should actually change to the temp outbound dir so that we won't add paths.
     File::set_current_directory(dirs_.temp_outbound_dir());
     LOG(INFO) << "Changed directory to: " << dirs_.temp_outbound_dir();
@@ -530,205 +561,238 @@ static std::string remove_fido_addr(std::string to_user) {
   return to_user_new;
 }
 
-std::optional<std::string> NetworkF::create_ftn_packet(const FidoAddress& dest,
-                                                       const FidoAddress& route_to,
-                                                       const NetPacket& wwivnet_packet) {
-
-  VLOG(1) << "create_ftn_packet: dest: " << dest << "; route: " << route_to;
+std::optional<FidoPackedMessage> NetworkF::create_ftn_message(const FidoAddress& dest,
+                                                              const NetPacket& wwivnet_packet) {
+  VLOG(1) << "create_ftn_message: dest: " << dest;
 
   FidoAddress from_address(net_.fido.fido_address);
-  std::string pw = fido_callout_.packet_config_for(route_to).packet_password;
-  for (auto tries = 0; tries < 10; tries++) {
-    auto now = clock_.Now().now();
-    File file(FilePath(dirs_.temp_outbound_dir(), packet_name(now)));
-    if (!file.Open(File::modeCreateFile | File::modeExclusive | File::modeReadWrite |
-                       File::modeBinary,
-                   File::shareDenyReadWrite)) {
-      LOG(INFO) << "Will try again: Unable to create packet file: " << file;
-      clock_.SleepFor(std::chrono::seconds(1));
-      continue;
-    }
-
-    auto header = CreateType2PlusPacketHeader(from_address, route_to, now, pw);
+  auto is_email = wwivnet_packet.nh.main_type == main_type_email ||
+                  wwivnet_packet.nh.main_type == main_type_email_name;
+  const auto raw_text = wwivnet_packet.text();
+  auto iter = raw_text.cbegin();
+
+  std::string subtype;
+  std::string to_user_name;
+  // or we can put code in for email here??
+
+  if (is_email) {
+    to_user_name = get_message_field(raw_text, iter, {'\0', '\r', '\n'}, 80);
+    CleanupWWIVName(to_user_name);
+  } else {
+    subtype = get_message_field(raw_text, iter, {'\0', '\r', '\n'}, 80);
+  }
+  auto title = get_message_field(raw_text, iter, {'\0', '\r', '\n'}, 80);
+  auto sender_name = get_message_field(raw_text, iter, {'\0', '\r', '\n'}, 80);
+  auto date_string = get_message_field(raw_text, iter, {'\0', '\r', '\n'}, 80);
+
+  // TODO(rushfan: These next 2 here should be done differently. We should
+  // split the message here and look for these in all lines.  For the By:
+  // line we just want to remove it since it's useless.
+  if (!is_email) {
+    to_user_name = get_fido_addr(raw_text, iter, {'\0', '\r', '\n'}, 80);
+  }
 
-    if (!write_fido_packet_header(file, header)) {
-      LOG(ERROR) << "Error writing packet header.";
-      return std::nullopt;
-    }
+  if (!is_email && iter_starts_with(raw_text, iter, "BY: ")) {
+    // Skip BY line.
+    get_message_field(raw_text, iter, {'\r', '\n'}, 80);
+  }
 
-    auto is_email = wwivnet_packet.nh.main_type == main_type_email ||
-                    wwivnet_packet.nh.main_type == main_type_email_name;
-    const auto raw_text = wwivnet_packet.text();
-    auto iter = raw_text.cbegin();
+  fido_variable_length_header_t vh{};
+  vh.date_time = daten_to_fido(wwivnet_packet.nh.daten);
+  // Clean up sender name.
+  CleanupWWIVName(sender_name);
+  vh.from_user_name = sender_name;
+  vh.subject = title;
+  if (!to_user_name.empty()) {
+    const auto username_only = remove_fido_addr(to_user_name);
+    vh.to_user_name = properize(username_only);
+  } else {
+    vh.to_user_name = "All";
+  }
 
-    std::string subtype;
-    std::string to_user_name;
-    // or we can put code in for email here??
+  auto msgid = FtnMessageDupe::GetMessageIDFromWWIVText(raw_text);
+  auto needs_msgid = false;
+  if (msgid.empty()) {
+    // Create a new MSGID if the BBS didn't put one in there already.
+    // We'll do this for emails too since Mystic needs this for a proper
+    // reply to address. Otherwise we'd just do it for conference mail.
+    msgid = dupe().CreateMessageID(from_address);
+    needs_msgid = true;
+  }
 
-    if (is_email) {
-      to_user_name = get_message_field(raw_text, iter, {'\0', '\r', '\n'}, 80);
-      CleanupWWIVName(to_user_name);
-    } else {
-      subtype = get_message_field(raw_text, iter, {'\0', '\r', '\n'}, 80);
+  // TODO(rushfan): need to add in INTL for netmails, and all that nonsense.
+  // We probably have other stuff we need to add for echomail too.
+  std::ostringstream text;
+  if (is_email) {
+    text << "\001"
+         << "INTL " << dest.as_string(false, false) << " "
+         << from_address.as_string(false, false) << "\r";
+    if (from_address.point()) {
+      // FMPT (FROM POINT) just has the point address
+      text << "\001" << "FMPT " << from_address.point() << "\r";
     }
-    auto title = get_message_field(raw_text, iter, {'\0', '\r', '\n'}, 80);
-    auto sender_name = get_message_field(raw_text, iter, {'\0', '\r', '\n'}, 80);
-    auto date_string = get_message_field(raw_text, iter, {'\0', '\r', '\n'}, 80);
-
-    // TODO(rushfan: These next 2 here should be done differently. We should
-    // split the message here and look for these in all lines.  For the By:
-    // line we just want to remove it since it's useless.
-    if (!is_email) {
-      to_user_name = get_fido_addr(raw_text, iter, {'\0', '\r', '\n'}, 80);
+    if (dest.point()) {
+      // TOPT (TO POINT) just has the point address
+      text << "\001" << "TOPT " << dest.point() << "\r";
     }
+  } else {
+    text << "AREA:" << subtype << "\r";
+  }
+  // As of 5.3, the PID is added by the BBS software.
+  // text << "\001PID: WWIV " << full_version() << "\r";
+  text << "\001TID: WWIV NET" << full_version() << "\r";
+  if (needs_msgid && !is_email) {
+    text << "\001MSGID: " << msgid << "\r";
+  }
+  // Implement FTS-5003. [http://ftsc.org/docs/fts-5003.001]
+  // All outbound WWIV messages are always CP437.
+  text << "\001CHRS: CP437 2\r";
+
+  // Implement FRL-1004. [http://ftsc.org/docs/frl-1004.002]
+  text << "\001TZUTC: " << tz_offset_from_utc(clock_.Now()) << "\r";
+
+  // TODO(rushfan): We should rip through the bbs_text here.
+  // and add in any special kludges like ^AREPLY here.
+  // Add the text from the message (as entered from the BBS).
+  wwiv_to_fido_options opts{};
+  opts.colors = colors_;
+  opts.wwiv_heart_color_codes = net_.fido.wwiv_heart_color_codes;
+  opts.wwiv_pipe_color_codes = net_.fido.wwiv_pipe_color_codes;
+  opts.allow_any_pipe_codes = net_.fido.allow_any_pipe_codes;
+  auto bbs_text = WWIVToFidoText(std::string(iter, raw_text.end()), opts);
+  text << bbs_text;
+
+  // Now we need tear + origin lines
+  auto origin_line = net_.fido.origin_line;
+  if (origin_line.empty()) {
+    // default origin line to system name if it doesn't exist.
+    origin_line = opts_.system_name;
+  }
 
-    if (!is_email && iter_starts_with(raw_text, iter, "BY: ")) {
-      // Skip BY line.
-      get_message_field(raw_text, iter, {'\r', '\n'}, 80);
-    }
+  if (from_address.point() == 0) {
+    text << "\r"
+         << "--- WWIV " << full_version() << "[" << os_version_string() << "]\r"
+         << " * Origin: " << origin_line << " (" << to_zone_net_node(from_address) << ")\r";
+  } else {
+    text << "\r"
+         << "--- WWIV " << full_version() << "\r"
+         << " * Origin: " << origin_line << " (" << to_zone_net_node_point(from_address) << ")\r";
+  }
+  // Finally we need SEEN-BY and PATH lines for routing.
+  if (!is_email) {
+    // TODO(rushfan): Add the nodes we are exporting this to.
+    text << "SEEN-BY: " << to_net_node(from_address) << "\r\r";
+    // Also we need to add a ^APATH: line here, starting with us.
+  }
 
-    fido_variable_length_header_t vh{};
-    vh.date_time = daten_to_fido(wwivnet_packet.nh.daten);
-    // Clean up sender name.
-    CleanupWWIVName(sender_name);
-    vh.from_user_name = sender_name;
-    vh.subject = title;
-    if (!to_user_name.empty()) {
-      const auto username_only = remove_fido_addr(to_user_name);
-      vh.to_user_name = properize(username_only);
-    } else {
-      vh.to_user_name = "All";
-    }
+  vh.text = text.str();
 
-    FtnMessageDupe dupe(datadir_, true);
-    auto msgid = FtnMessageDupe::GetMessageIDFromWWIVText(raw_text);
-    auto needs_msgid = false;
-    if (msgid.empty()) {
-      // Create a new MSGID if the BBS didn't put one in there already.
-      // We'll do this for emails too since Mystic needs this for a proper
-      // reply to address. Otherwise we'd just do it for conference mail.
-      msgid = dupe.CreateMessageID(from_address);
-      needs_msgid = true;
-    }
+  fido_packed_message_t nh{};
+  nh.message_type = 2;
+  nh.attribute = 0;
+  nh.cost = 0;
+  nh.orig_net = from_address.net();
+  nh.orig_node = from_address.node();
+  nh.dest_net = dest.net();
+  nh.dest_node = dest.node();
+  nh.attribute = MSGLOCAL;
 
-    // TODO(rushfan): need to add in INTL for netmails, and all that nonsense.
-    // We probably have other stuff we need to add for echomail too.
-    std::ostringstream text;
-    if (is_email) {
-      text << "\001"
-           << "INTL " << dest.as_string(false, false) << " "
-           << from_address.as_string(false, false) << "\r";
-      if (from_address.point()) {
-        // FMPT (FROM POINT) just has the point address
-        text << "\001" << "FMPT " << from_address.point() << "\r";
-      }
-      if (dest.point()) {
-        // TOPT (TO POINT) just has the point address
-        text << "\001" << "TOPT " << dest.point() << "\r";
-      }
-    } else {
-      text << "AREA:" << subtype << "\r";
-    }
-    // As of 5.3, the PID is added by the BBS software.
-    // text << "\001PID: WWIV " << full_version() << "\r";
-    text << "\001TID: WWIV NET" << full_version() << "\r";
-    if (needs_msgid && !is_email) {
-      text << "\001MSGID: " << msgid << "\r";
-    }
-    // Implement FTS-5003. [http://ftsc.org/docs/fts-5003.001]
-    // All outbound WWIV messages are always CP437.
-    text << "\001CHRS: CP437 2\r";
-
-    // Implement FRL-1004. [http://ftsc.org/docs/frl-1004.002]
-    text << "\001TZUTC: " << tz_offset_from_utc(clock_.Now()) << "\r";
-
-    // TODO(rushfan): We should rip through the bbs_text here.
-    // and add in any special kludges like ^AREPLY here.
-    // Add the text from the message (as entered from the BBS).
-    wwiv_to_fido_options opts{};
-    opts.colors = colors_;
-    opts.wwiv_heart_color_codes = net_.fido.wwiv_heart_color_codes;
-    opts.wwiv_pipe_color_codes = net_.fido.wwiv_pipe_color_codes;
-    opts.allow_any_pipe_codes = net_.fido.allow_any_pipe_codes;
-    auto bbs_text = WWIVToFidoText(std::string(iter, raw_text.end()), opts);
-    text << bbs_text;
-
-    // Now we need tear + origin lines
-    auto origin_line = net_.fido.origin_line;
-    if (origin_line.empty()) {
-      // default origin line to system name if it doesn't exist.
-      origin_line = opts_.system_name;
-    }
-
-    if (from_address.point() == 0) {
-      text << "\r"
-           << "--- WWIV " << full_version() << "[" << os_version_string() << "]\r"
-           << " * Origin: " << origin_line << " (" << to_zone_net_node(from_address) << ")\r";
-    } else {
-      text << "\r"
-           << "--- WWIV " << full_version() << "\r"
-           << " * Origin: " << origin_line << " (" << to_zone_net_node_point(from_address) << ")\r";
-    }
-    // Finally we need SEEN-BY and PATH lines for routing.
-    if (!is_email) {
-      // TODO(rushfan): Add the nodes we are exporting this to.
-      text << "SEEN-BY: " << to_net_node(from_address) << "\r\r";
-      // Also we need to add a ^APATH: line here, starting with us.
-    }
-
-    vh.text = text.str();
+  if (wwivnet_packet.nh.main_type == main_type_email_name) {
+    nh.attribute |= MSGPRIVATE;
+  }
 
-    fido_packed_message_t nh{};
-    nh.message_type = 2;
-    nh.attribute = 0;
-    nh.cost = 0;
-    nh.orig_net = from_address.net();
-    nh.orig_node = from_address.node();
-    nh.dest_net = dest.net();
-    nh.dest_node = dest.node();
-    nh.attribute = MSGLOCAL;
+  return FidoPackedMessage(nh, vh);
+}
 
-    if (wwivnet_packet.nh.main_type == main_type_email_name) {
-      nh.attribute |= MSGPRIVATE;
-    }
+ftn_outbound_packet_t* NetworkF::open_ftn_packet(const ftn_route_t& route) {
+  const auto& route_to = route.route_to;
+  const auto& pw = route.packet_password;
+  const auto key = std::make_pair(route_to, pw);
+  if (auto it = outbound_packets_.find(key); it != std::end(outbound_packets_)) {
+    return &it->second;
+  }
 
-    FidoPackedMessage p(nh, vh);
-    if (!write_packed_message(file, p)) {
-      LOG(ERROR) << "Error writing packed message.";
-      return std::nullopt;
+  const FidoAddress from_address(net_.fido.fido_address);
+  const auto now = clock_.Now();
+  for (auto tries = 0; tries < 60; tries++) {
+    // Packet names are based on the time, so step forward a second at a time
+    // past any other packets open in this run rather than sleeping.
+    const auto name = packet_name(now + std::chrono::seconds(tries));
+    File file(FilePath(dirs_.temp_outbound_dir(), name));
+    if (!file.Open(File::modeCreateFile | File::modeExclusive | File::modeReadWrite |
+                       File::modeBinary,
+                   File::shareDenyReadWrite)) {
+      VLOG(1) << "Will try again: Unable to create packet file: " << file;
+      continue;
     }
 
-    // Since we wrote the packed message, let's add it to the
-    // duplicate message database if it's a post.
-    if (!is_email) {
-      dupe.add(p);
+    const auto header = CreateType2PlusPacketHeader(from_address, route_to, now, pw);
+    if (!write_fido_packet_header(file, header)) {
+      LOG(ERROR) << "Error writing packet header.";
+      file.Close();
+      File::Remove(FilePath(dirs_.temp_outbound_dir(), name));
+      return nullptr;
     }
-    return file.path().filename().string();
+    LOG(INFO) << "Created packet: " << file << "; route_to: " << route_to;
+    auto [it, _] =
+        outbound_packets_.emplace(key, ftn_outbound_packet_t{route_to, name, std::move(file), {}});
+    return &it->second;
   }
-  return std::nullopt;
+  LOG(ERROR) << "Unable to create packet file in: " << dirs_.temp_outbound_dir();
+  return nullptr;
 }
 
-std::optional<std::string> NetworkF::create_ftn_packet_and_bundle(const FidoAddress& dest,
-                                                                  const FidoAddress& route_to,
-                                                                  NetPacket& p) {
-  LOG(INFO) << "Creating packet for subscriber: " << dest << "; route_to: " << route_to;
+bool NetworkF::add_to_ftn_packet(const ftn_route_t& route, const std::shared_ptr<NetPacket>& p) {
+  const auto& dest = route.dest;
+  VLOG(1) << "Adding message for: " << dest << "; route_to: " << route.route_to;
   // TODO(rushfan): Really this shouldn't go to dead.net since the wwivnet side exported it
   // already, not really sure what to do here.
-  auto fido_packet_name = create_ftn_packet(dest, route_to, p);
-  if (!fido_packet_name) {
+  auto* packet = open_ftn_packet(route);
+  if (!packet) {
     LOG(ERROR) << "    ! ERROR Failed to create FTN packet; writing to dead.net";
-    write_deadnet_packet(net_.dir, p);
-    return std::nullopt;
+    write_deadnet_packet(net_.dir, *p);
+    return false;
+  }
+  const auto msg = create_ftn_message(dest, *p);
+  if (!msg || !write_packed_message(packet->file, msg.value())) {
+    LOG(ERROR) << "    ! ERROR Failed to write FTN message; writing to dead.net";
+    write_deadnet_packet(net_.dir, *p);
+    return false;
   }
-  LOG(INFO) << "Created packet: " << FilePath(dirs_.temp_outbound_dir(), fido_packet_name.value());
+  packet->sources.push_back(p);
 
-  const auto bundlename = create_ftn_bundle(route_to, fido_packet_name.value());
-  if (!bundlename) {
-    LOG(ERROR) << "    ! ERROR Failed to create FTN bundle; writing to dead.net";
-    write_deadnet_packet(net_.dir, p);
-    return std::nullopt;
+  // Since we wrote the packed message, let's add it to the
+  // duplicate message database if it's a post.
+  if (p->nh.main_type == main_type_new_post) {
+    dupe().add(msg.value());
+  }
+  return true;
+}
+
+bool NetworkF::close_ftn_packets() {
+  auto result = true;
+  for (auto& [key, packet] : outbound_packets_) {
+    const auto& route_to = packet.route_to;
+    const auto ok = write_fido_packet_trailer(packet.file);
+    packet.file.Close();
+    LOG(INFO) << "Closed packet: " << packet.name << " with " << packet.sources.size()
+              << " messages for: " << route_to;
+
+    const auto bundlename = ok ? create_ftn_bundle(route_to, packet.name) : std::nullopt;
+    if (!bundlename) {
+      LOG(ERROR) << "    ! ERROR Failed to create FTN bundle; writing to dead.net";
+      for (const auto& p : packet.sources) {
+        write_deadnet_packet(net_.dir, *p);
+      }
+      File::Remove(FilePath(dirs_.temp_outbound_dir(), packet.name));
+      result = false;
+      continue;
+    }
+    const auto packet_config = fido_callout_.packet_config_for(route_to);
+    CreateNetmailAttachOrFloFile(route_to, bundlename.value(), packet_config);
   }
-  return bundlename;
+  outbound_packets_.clear();
+  return result;
 }
 
 static std::string NextNetmailFilePath(const std::filesystem::path& path) {
@@ -889,37 +953,47 @@ static FidoAddress find_route_to(const FidoAddress& dest, const FidoCallout& cal
   return dest;
 }
 
-bool NetworkF::export_main_type_new_post(std::set<std::string>& bundles, NetPacket& p) {
-  // Lame implementation that creates 1 file per message.
-  auto subtype = get_subtype_from_packet_text(p.text());
-  LOG(INFO) << "Creating packet for subtype: " << subtype;
+ftn_route_t NetworkF::route_for(const FidoAddress& dest) const {
+  const auto packet_config = fido_callout_.packet_config_for(dest);
+  auto route_to = find_route_to(dest, fido_callout_, packet_config);
+  auto pw = fido_callout_.packet_config_for(route_to).packet_password;
+  return ftn_route_t{dest, std::move(route_to), std::move(pw)};
+}
 
-  auto subscribers = ReadFidoSubcriberFile(FilePath(net_.dir, StrCat("n", subtype, ".net")));
-  if (subscribers.empty()) {
+const std::vector<ftn_route_t>& NetworkF::echo_routes(const std::string& subtype) {
+  if (const auto it = echo_routes_.find(subtype); it != std::end(echo_routes_)) {
+    return it->second;
+  }
+  const auto subscribers =
+      subscriber_cache_.fido_subscribers(FilePath(net_.dir, StrCat("n", subtype, ".net")));
+  std::vector<ftn_route_t> routes;
+  routes.reserve(subscribers->size());
+  for (const auto& sub : *subscribers) {
+    routes.emplace_back(route_for(sub));
+  }
+  auto [it, _] = echo_routes_.emplace(subtype, std::move(routes));
+  return it->second;
+}
+
+bool NetworkF::export_main_type_new_post(const std::shared_ptr<NetPacket>& p) {
+  auto subtype = get_subtype_from_packet_text(p->text());
+  LOG(INFO) << "Adding message to packets for subtype: " << subtype;
+
+  const auto& routes = echo_routes(subtype);
+  if (routes.empty()) {
     LOG(INFO) << "There are no subscribers on echo: '" << subtype << "'. Nothing to do!";
   }
-  for (const auto& sub : subscribers) {
-    const auto packet_config = fido_callout_.packet_config_for(sub);
-    const auto route_to = find_route_to(sub, fido_callout_, packet_config);
-    if (auto bundlename = create_ftn_packet_and_bundle(sub, route_to, p)) {
-      if (!contains(bundles, bundlename.value())) {
-        // We only want to attach the bundle (or add it to the flo file)
-        // one time, so skip ones that have already been done.
-        bundles.insert(bundlename.value());
-        auto route_packet_config = fido_callout_.packet_config_for(route_to);
-        CreateNetmailAttachOrFloFile(route_to, bundlename.value(), route_packet_config);
-      }
-    }
+  for (const auto& route : routes) {
+    add_to_ftn_packet(route, p);
   }
   return true;
 }
 
-bool NetworkF::export_main_type_email_name(std::set<std::string>& bundles, NetPacket& p) {
-  // Lame implementation that creates 1 file per message.
-  LOG(INFO) << "Creating packet for netmail.";
+bool NetworkF::export_main_type_email_name(const std::shared_ptr<NetPacket>& p) {
+  LOG(INFO) << "Adding netmail to packets.";
 
-  auto it = std::begin(p.text());
-  const auto to = get_message_field(p.text(), it, {0}, 80);
+  auto it = std::begin(p->text());
+  const auto to = get_message_field(p->text(), it, {0}, 80);
   const auto odest = get_address_from_single_line(to);
   if (!odest.has_value()) {
     LOG(ERROR) << "Unable to get address from to line: " << to;
@@ -929,22 +1003,13 @@ bool NetworkF::export_main_type_email_name(std::set<std::string>& bundles, NetPa
 
   // todo - actually we need a new way of making the ftn packet that works
   // right with net mail
-  const auto packet_config = fido_callout_.packet_config_for(dest);
-  const FidoAddress route_to = find_route_to(dest, fido_callout_, packet_config);
-  if (auto bundlename = create_ftn_packet_and_bundle(dest, route_to, p)) {
-    if (!contains(bundles, bundlename.value())) {
-      // We only want to attach the bundle (or add it to the flo file)
-      // one time, so skip ones that have already been done.
-      bundles.insert(bundlename.value());
-      CreateNetmailAttachOrFloFile(route_to, bundlename.value(), packet_config);
-    }
-  }
-  return true;
+  return add_to_ftn_packet(route_for(dest), p);
 }
 
 sdk::FtnMessageDupe& NetworkF::dupe() {
   if (!dupe_) {
-    dupe_ = std::make_unique<wwiv::sdk::FtnMessageDupe>(datadir_, true);
+    dupe_ = std::make_unique<wwiv::sdk::FtnMessageDupe>(datadir_, true,
+                                                        opts_.msgdupe_retention_days, clock_);
   }
   return *dupe_;
 }
@@ -977,18 +1042,19 @@ bool NetworkF::DoExport() {
     return false;
   }
 
-  std::set<std::string> bundles;
+  // Subscribers may have changed since the last export.
+  echo_routes_.clear();
   auto num_packets_processed = 0;
   for (auto p : file) {
     // If we got here, we had a packet to process.
     ++num_packets_processed;
 
     if (p.nh.main_type == main_type_new_post) {
-      if (!export_main_type_new_post(bundles, p)) {
+      if (!export_main_type_new_post(std::make_shared<NetPacket>(std::move(p)))) {
         LOG(ERROR) << "Error exporting post.";
       }
     } else if (p.nh.main_type == main_type_email_name) {
-      if (!export_main_type_email_name(bundles, p)) {
+      if (!export_main_type_email_name(std::make_shared<NetPacket>(std::move(p)))) {
         LOG(ERROR) << "Error exporting email.";
       }
     } else {
@@ -1001,6 +1067,11 @@ bool NetworkF::DoExport() {
     }
   }
 
+  // All of the messages are in packets now, so bundle them up.
+  if (!close_ftn_packets()) {
+    LOG(ERROR) << "Error creating FTN bundles.";
+  }
+
   // Delete the packet.
   file.Close();
   if (opts_.skip_delete) {
@@ -1036,4 +1107,44 @@ bool NetworkF::Run(std::vector<std::string> cmds) {
   }
 }
 
+int networkf_main(NetworkStageContext& ctx, const std::vector<std::string>& cmds) {
+  try {
+    const auto& net = ctx.network();
+    if (net.type != network_type_t::ftn) {
+      LOG(ERROR) << "NETWORKF is only for use on FTN type networks.";
+      return 1;
+    }
+
+    const auto& bbslist = ctx.bbslist();
+    if (bbslist.empty()) {
+      LOG(ERROR) << "ERROR: Unable to read bbsdata.net_.";
+      LOG(ERROR) << "       Do you need to run network3?";
+      return 3;
+    }
+
+    const auto fake_ftn_node = bbslist.node_config_for(FTN_FAKE_OUTBOUND_NODE);
+    if (!fake_ftn_node) {
+      LOG(ERROR) << "Can not find node for outbound FTN address.";
+      LOG(ERROR) << "       Do you need to run network3?";
+      return 2;
+    }
+
+    // networkf changes the current directory while bundling and shares the
+    // message dupe database in datadir with all of the other FTN networks.
+    std::lock_guard lock(ctx.shared().mutex());
+    SystemClock clock{};
+
+    networkf_options_t opts{};
+    opts.max_backups = ctx.config().max_backups();
+    opts.skip_delete = ctx.skip_delete();
+    opts.system_name = ctx.config().system_name();
+    opts.msgdupe_retention_days = ctx.options().msgdupe_retention_days;
+    NetworkF nf(ctx.config(), opts, net, bbslist, clock);
+    return nf.Run(cmds) ? 0 : 2;
+  } catch (const std::exception& e) {
+    LOG(ERROR) << "ERROR: [networkf]: " << e.what();
+  }
+  return 2;
+}
+
 } // namespace wwiv::net::networkf
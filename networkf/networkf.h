@@ -19,15 +19,24 @@
 #define INCLUDED_NETWORKF_NETWORKF_H
 
 #include "core/clock.h"
+#include "core/file.h"
 #include "net_core/net_cmdline.h"
+#include "net_core/net_stage.h"
 #include "net_core/netdat.h"
 #include "sdk/bbslist.h"
+#include "sdk/fido/fido_address.h"
 #include "sdk/fido/fido_callout.h"
 #include "sdk/fido/fido_directories.h"
+#include "sdk/fido/fido_packets.h"
 #include "sdk/net/ftn_msgdupe.h"
 #include "sdk/net/packets.h"
+#include "sdk/net/subscribers.h"
+#include <map>
+#include <memory>
 #include <optional>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace wwiv::net::networkf {
 
@@ -36,6 +45,35 @@ struct networkf_options_t {
   bool skip_delete{false};
   char net_cmd{'f'};
   std::string system_name;
+  // Days to remember FTN message ids for dupe detection, 0 for forever.
+  int msgdupe_retention_days{sdk::FtnMessageDupe::kDefaultRetentionDays};
+};
+
+/**
+ * How a message for one FTN destination leaves this system.  These are
+ * computed once per export for each echo, so adding a message for a
+ * subscriber does no lookups or file I/O.
+ */
+struct ftn_route_t {
+  // The final destination of the message.
+  sdk::fido::FidoAddress dest;
+  // The system the message is packed and bundled for.
+  sdk::fido::FidoAddress route_to;
+  // The packet password for route_to.
+  std::string packet_password;
+};
+
+/**
+ * A FTN packet being written during export.  All of the messages for a
+ * route_to system are added to one packet, which is closed and bundled at
+ * the end of the export.
+ */
+struct ftn_outbound_packet_t {
+  sdk::fido::FidoAddress route_to;
+  std::string name;
+  core::File file;
+  // The WWIVnet packets in this FTN packet, written to dead.net if bundling fails.
+  std::vector<std::shared_ptr<sdk::net::NetPacket>> sources;
 };
 
 class NetworkF final {
@@ -77,22 +115,35 @@ private:
                                                const std::string& fido_packet_name);
 
   /**
-   * Creates a FTN packet from the contents of the WWIVnet style packet.
-   *
-   * Returns the name of the fido packet on success.
+   * Creates a FTN packed message for dest from the contents of the WWIVnet
+   * style packet.
    */
-  std::optional<std::string> create_ftn_packet(const sdk::fido::FidoAddress& dest,
-                                               const sdk::fido::FidoAddress& route_to,
-                                               const sdk::net::NetPacket& wwivnet_packet);
+  std::optional<sdk::fido::FidoPackedMessage>
+  create_ftn_message(const sdk::fido::FidoAddress& dest, const sdk::net::NetPacket& wwivnet_packet);
 
   /**
-   * Creates a FTN packet and bundle from the contents of the WWIVnet style packet.
-   *
-   * Returns the name of the fido packet on success.
+   * Returns the open outbound FTN packet for route.route_to, creating it in the
+   * temp outbound directory if this is the first message for route_to.
    */
-  std::optional<std::string> create_ftn_packet_and_bundle(const sdk::fido::FidoAddress& dest,
-                                                          const sdk::fido::FidoAddress& route_to,
-                                                          sdk::net::NetPacket& p);
+  ftn_outbound_packet_t* open_ftn_packet(const ftn_route_t& route);
+
+  /**
+   * Appends the contents of the WWIVnet style packet to the outbound FTN packet
+   * for route.route_to, writing it to dead.net on failure.
+   */
+  bool add_to_ftn_packet(const ftn_route_t& route, const std::shared_ptr<sdk::net::NetPacket>& p);
+
+  /** Returns the route used for messages to dest. */
+  ftn_route_t route_for(const sdk::fido::FidoAddress& dest) const;
+
+  /** Returns the routes for all of the subscribers of the echo subtype. */
+  const std::vector<ftn_route_t>& echo_routes(const std::string& subtype);
+
+  /**
+   * Closes all of the outbound FTN packets, bundling each one and attaching the
+   * bundle for the route_to system.
+   */
+  bool close_ftn_packets();
 
   /** Create a FLO file, returning the name generated or nullopt */
   std::optional<std::string> CreateFloFile(const wwiv::sdk::fido::FidoAddress& dest,
@@ -109,9 +160,9 @@ private:
   CreateNetmailAttachOrFloFile(const sdk::fido::FidoAddress& dest, const std::string& bundlename,
                                const sdk::net::fido_packet_config_t& packet_config);
 
-  bool export_main_type_new_post(std::set<std::string>& bundles, sdk::net::NetPacket& p);
+  bool export_main_type_new_post(const std::shared_ptr<sdk::net::NetPacket>& p);
 
-  bool export_main_type_email_name(std::set<std::string>& bundles, sdk::net::NetPacket& p);
+  bool export_main_type_email_name(const std::shared_ptr<sdk::net::NetPacket>& p);
 
   sdk::FtnMessageDupe& dupe();
 
@@ -126,11 +177,22 @@ private:
 
 
   std::unique_ptr<sdk::FtnMessageDupe> dupe_;
+  // Outbound FTN packets for this run, keyed by route_to address and password.
+  std::map<std::pair<sdk::fido::FidoAddress, std::string>, ftn_outbound_packet_t> outbound_packets_;
+  sdk::SubscriberCache subscriber_cache_;
+  // Routes for each echo subtype exported in this run.
+  std::map<std::string, std::vector<ftn_route_t>> echo_routes_;
   std::vector<int> colors_{7, 11, 14, 5, 31, 2, 12, 9, 6, 3};
 };
 
 void ShowNetworkfHelp(const NetworkCommandLine& cmdline);
 
+/**
+ * Runs networkf for the FTN network in ctx, using cmds for the subcommands
+ * (i.e. import or export).
+ */
+int networkf_main(NetworkStageContext& ctx, const std::vector<std::string>& cmds);
+
 // Returns the difference in days between now (according to clock) and the date
 // specified in ftn format by ftn_date.
 int ftn_date_days_old(const core::Clock& clock, const std::string& ftn_date);
@@ -32,6 +32,7 @@
 #include "core/version.h"
 #include "fmt/format.h"
 #include "net_core/net_cmdline.h"
+#include "net_core/net_stage.h"
 #include "sdk/bbslist.h"
 #include "sdk/config.h"
 #include "sdk/fido/fido_address.h"
@@ -80,6 +81,9 @@ int main(int argc, char** argv) {
   Logger::Init(argc, argv, config);
 
   CommandLine cmdline(argc, argv, "net");
+  cmdline.add_argument({"msgdupe_retention_days",
+                        "Days to remember FTN message ids for dupe detection (0 = forever).",
+                        std::to_string(FtnMessageDupe::kDefaultRetentionDays)});
   const NetworkCommandLine net_cmdline(cmdline, 'f');
   try {
     auto at_exit = finally(Logger::ExitLogger);
@@ -94,29 +98,13 @@ int main(int argc, char** argv) {
       return 1;
     }
 
-    VLOG(3) << "Reading bbsdata.net_..";
-    auto bbslist = BbsListNet::ReadBbsDataNet(net.dir);
-    if (bbslist.empty()) {
-      LOG(ERROR) << "ERROR: Unable to read bbsdata.net_.";
-      LOG(ERROR) << "       Do you need to run network3?";
-      return 3;
-    }
-
-    const auto fake_ftn_node = bbslist.node_config_for(FTN_FAKE_OUTBOUND_NODE);
-    if (!fake_ftn_node) {
-      LOG(ERROR) << "Can not find node for outbound FTN address.";
-      LOG(ERROR) << "       Do you need to run network3?";
-      return 2;
-    }
-
     auto semaphore =
         SemaphoreFile::try_acquire(net_cmdline.semaphore_path(), net_cmdline.semaphore_timeout());
-    SystemClock clock{};
-
-    networkf_options_t opts{net_cmdline.config().max_backups(), net_cmdline.skip_delete()};
-    opts.system_name = net_cmdline.config().system_name();
-    NetworkF nf(net_cmdline.config(), opts, net, bbslist, clock);
-    return nf.Run(net_cmdline.cmdline().remaining()) ? 0 : 2;
+    SharedNetworkData shared(net_cmdline.config(), net_cmdline.networks());
+    auto opts = network_stage_options(net_cmdline);
+    opts.msgdupe_retention_days = net_cmdline.cmdline().iarg("msgdupe_retention_days");
+    NetworkStageContext ctx(shared, net_cmdline.network_number(), opts);
+    return networkf_main(ctx, net_cmdline.cmdline().remaining());
   } catch (const semaphore_not_acquired& e) {
     LOG(ERROR) << "ERROR: [network" << net_cmdline.net_cmd()
                << "]: Unable to Acquire Network Semaphore: " << e.what();
@@ -16,18 +16,18 @@
 /*    language governing permissions and limitations under the License.   */
 /**************************************************************************/
 
-// WWIV5 NetworkC
-#include "core/command_line.h"
+// WWIV5 NetworkT
+#include "networkt/networkt.h"
+
+#include "core/crc.h"
 #include "core/file.h"
 #include "core/findfiles.h"
 #include "core/log.h"
 #include "core/os.h"
-#include "core/scope_exit.h"
-#include "core/semaphore_file.h"
 #include "core/stl.h"
 #include "core/strings.h"
 #include "fmt/printf.h"
-#include "net_core/net_cmdline.h"
+#include "net_core/net_stage.h"
 #include "sdk/net/callout.h"
 #include "sdk/config.h"
 #include "sdk/status.h"
@@ -36,10 +36,17 @@
 #include "sdk/files/files.h"
 #include "sdk/files/tic.h"
 #include "sdk/net/packets.h"
+#include <algorithm>
+#include <atomic>
 #include <cstdlib>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
 
 using namespace wwiv::core;
 using namespace wwiv::net;
@@ -51,51 +58,57 @@ using namespace wwiv::stl;
 using namespace wwiv::os;
 using namespace wwiv::sdk::fido;
 
-static void ShowHelp(const NetworkCommandLine& cmdline) {
-  std::cout << cmdline.GetHelp() << std::endl;
-  exit(1);
-}
+// A TIC file waiting to be added to a file area.
+struct pending_tic_t {
+  // Name of the TIC file.
+  std::string name;
+  files::Tic tic;
+};
 
-bool process_ftn_tic(const Config& config, const Network& net, bool save_tic_files, bool skip_delete) {
-  if (!net.fido.process_tic) {
-    LOG(WARNING) << "TIC processing disabled for network: " << net.name;
-    return false;
+// Maximum number of threads used to check the CRCs of incoming files.
+static constexpr unsigned kMaxCrcThreads = 4;
+
+// Computes the CRC32 of the file for each tic on a small pool of threads, since
+// checking a hatch of many large files is bound by reading them.  Files that do
+// not exist get a CRC of 0 and fail validation later.
+static std::vector<uint32_t> compute_tic_crcs(const std::vector<pending_tic_t>& tics) {
+  std::vector<uint32_t> crcs(tics.size());
+  std::atomic<std::size_t> next{0};
+  auto worker = [&] {
+    for (auto i = next++; i < tics.size(); i = next++) {
+      if (const auto& t = tics[i].tic; t.exists()) {
+        crcs[i] = crc32file(t.fpath());
+      }
+    }
+  };
+  const auto num_threads =
+      std::min<std::size_t>({std::max(1u, std::thread::hardware_concurrency()), kMaxCrcThreads,
+                             tics.size()});
+  std::vector<std::thread> threads;
+  for (std::size_t i = 1; i < num_threads; i++) {
+    threads.emplace_back(worker);
   }
-  const FtnDirectories ftn_directories(config.root_directory(), net);
-  files::Dirs dirs(config.datadir(), 0);
-  if (!dirs.Load()) {
-    LOG(ERROR) << "Unable to load directories.";
-    return false;
+  worker();
+  for (auto& t : threads) {
+    t.join();
   }
-  files::FileApi api(config.datadir());
+  return crcs;
+}
 
-  FindFiles ff(FilePath(ftn_directories.tic_dir(), "*.tic"), FindFiles::FindFilesType::files);
-  auto first = true;
-  const files::TicParser parser(ftn_directories.tic_dir());
-  for (const auto& f : ff) {
-    auto ot = parser.parse(f.name);
-    if (!ot) {
-      continue;
-    }
-    auto t = ot.value();
-    if (!t.IsValid()) {
-      continue;
-    }
-    auto od = FindFileAreaForTic(dirs, t, net);
-    if (!od) {
-      LOG(ERROR) << "Unable to find AREA_TAG for tic file: TAG: " << t.area << "; file; " << f.name;
-      continue;
-    }
-    auto d = od.value();
-    auto fa = api.CreateOrOpen(d);
-    if (!fa) {
-      LOG(ERROR) << "Unable to open file area: " << d.filename;
-      continue;
-    }
-    if (first) {
-      LOG(INFO) << "------------------------------------------------------------------------------";
-      first = false;
-    }
+// Adds all of the tics for the file area d, saving the area once at the end.
+static void process_tics_for_area(files::FileApi& api, const files::directory_t& d,
+                                  const std::vector<pending_tic_t>& tics,
+                                  const FtnDirectories& ftn_directories, bool save_tic_files,
+                                  bool skip_delete) {
+  auto fa = api.CreateOrOpen(d);
+  if (!fa) {
+    LOG(ERROR) << "Unable to open file area: " << d.filename;
+    return;
+  }
+
+  // Source, tic file, and destination of the files to move once the area is saved.
+  std::vector<std::tuple<std::filesystem::path, std::filesystem::path, std::filesystem::path>> moves;
+  for (const auto& [name, t] : tics) {
     files::FileName fn(t.file);
     auto op = fa->FindFile(fn);
     files::FileRecord r;
@@ -109,11 +122,6 @@ bool process_ftn_tic(const Config& config, const Network& net, bool save_tic_fil
     r.set_actual_date(DateTime::from_time_t(actual_t));
     const auto ext_desc = JoinStrings(t.ldesc, "\r\n");
 
-    if (!net.fido.process_tic) {
-      LOG(INFO) << "Skipping processing file. process_tic is not enabled. file: " << t.file;
-      continue;
-    }
-
     if (op.has_value()) {
       LOG(INFO) << "File already exists in file area";
       LOG(INFO) << "** Updating: "  << r;
@@ -127,10 +135,6 @@ bool process_ftn_tic(const Config& config, const Network& net, bool save_tic_fil
         LOG(ERROR) << "Error adding file: " << r;
         continue;
       }
-      if (!fa->Save()) {
-        LOG(ERROR) << "Error saving file area: " << d.filename;
-        continue;
-      }
     }
     // Display information about the file;
     LOG(INFO) << "Area Name  : " << t.area;
@@ -145,10 +149,16 @@ bool process_ftn_tic(const Config& config, const Network& net, bool save_tic_fil
     LOG(INFO) << "------------------------------------------------------------------------------";
     // Use t.file not r here since r will be the unaligned and lower-case filename,
     // and we have to match the exact case specified. So use t.file.
-    const auto src = FilePath(ftn_directories.tic_dir(), t.file);
-    // f.name is the name of the TIC file
-    const auto tic = FilePath(ftn_directories.tic_dir(), f.name);
-    const auto dest = FilePath(d.path, r);
+    // name is the name of the TIC file
+    moves.emplace_back(FilePath(ftn_directories.tic_dir(), t.file),
+                       FilePath(ftn_directories.tic_dir(), name), FilePath(d.path, r));
+  }
+
+  if (!fa->Save()) {
+    LOG(ERROR) << "Error saving file area: " << d.filename;
+    return;
+  }
+  for (const auto& [src, tic, dest] : moves) {
     if (save_tic_files) {
       LOG(INFO) << "Not moving file, just copy, --save_tic_files == true";
       File::Copy(src, dest);
@@ -160,21 +170,73 @@ bool process_ftn_tic(const Config& config, const Network& net, bool save_tic_fil
       }
     }
   }
+}
+
+bool process_ftn_tic(const Config& config, const Network& net, bool save_tic_files, bool skip_delete) {
+  if (!net.fido.process_tic) {
+    LOG(WARNING) << "TIC processing disabled for network: " << net.name;
+    return false;
+  }
+  const FtnDirectories ftn_directories(config.root_directory(), net);
+  files::Dirs dirs(config.datadir(), 0);
+  if (!dirs.Load()) {
+    LOG(ERROR) << "Unable to load directories.";
+    return false;
+  }
+  files::FileApi api(config.datadir());
+
+  FindFiles ff(FilePath(ftn_directories.tic_dir(), "*.tic"), FindFiles::FindFilesType::files);
+  const files::TicParser parser(ftn_directories.tic_dir());
+  std::vector<pending_tic_t> tics;
+  for (const auto& f : ff) {
+    if (auto ot = parser.parse(f.name)) {
+      tics.push_back({f.name, std::move(ot.value())});
+    }
+  }
+  const auto crcs = compute_tic_crcs(tics);
+
+  // Group the tic files by file area, so each area is opened and saved once.
+  const files::TicAreaIndex area_index(dirs, net);
+  std::map<int, std::vector<pending_tic_t>> tics_by_area;
+  for (std::size_t i = 0; i < tics.size(); i++) {
+    const auto& [name, t] = tics[i];
+    if (!t.IsValid(crcs[i])) {
+      continue;
+    }
+    const auto dir_num = area_index.dir_num_for(t);
+    if (!dir_num) {
+      LOG(ERROR) << "Unable to find AREA_TAG for tic file: TAG: " << t.area << "; file; " << name;
+      continue;
+    }
+    tics_by_area[dir_num.value()].push_back(tics[i]);
+  }
+
+  if (!tics_by_area.empty()) {
+    LOG(INFO) << "------------------------------------------------------------------------------";
+  }
+  for (const auto& [dir_num, area_tics] : tics_by_area) {
+    process_tics_for_area(api, dirs[dir_num], area_tics, ftn_directories, save_tic_files,
+                          skip_delete);
+  }
   return true;
 }
 
-int networkt_main(const NetworkCommandLine& net_cmdline) {
+namespace wwiv::net::networkt {
+
+int networkt_main(NetworkStageContext& ctx) {
   try {
-    const auto& net = net_cmdline.network();
+    // networkt adds files to the file areas shared by all networks.
+    std::lock_guard lock(ctx.shared().mutex());
+    const auto& net = ctx.network();
 
-    StatusMgr sm(net_cmdline.config().datadir(), [](int) {});
+    StatusMgr sm(ctx.config().datadir(), [](int) {});
     const auto status = sm.get_status();
 
     switch (net.type) {
     case network_type_t::ftn: {
-      const auto save_tic_files = net_cmdline.cmdline().barg("save_tic_files");
-      const auto skip_delete = net_cmdline.skip_delete();
-      if (!process_ftn_tic(net_cmdline.config(), net, save_tic_files, skip_delete)) {
+      const auto save_tic_files = ctx.options().save_tic_files;
+      const auto skip_delete = ctx.skip_delete();
+      if (!process_ftn_tic(ctx.config(), net, save_tic_files, skip_delete)) {
         return 1;
       }
     } break;
@@ -194,32 +256,9 @@ int networkt_main(const NetworkCommandLine& net_cmdline) {
 
     return 0;
   } catch (const std::exception& e) {
-    LOG(ERROR) << "ERROR: [network" << net_cmdline.net_cmd() << "]: " << e.what();
+    LOG(ERROR) << "ERROR: [networkt]: " << e.what();
   }
   return 2;
 }
 
-int main(int argc, char** argv) {
-  LoggerConfig config(LogDirFromConfig);
-  Logger::Init(argc, argv, config);
-
-  auto at_exit = finally(Logger::ExitLogger);
-  CommandLine cmdline(argc, argv, "net");
-  cmdline.add_argument({"process_instance", "Also process pending files for BBS instance #", "0"});
-  cmdline.add_argument(BooleanCommandLineArgument{
-      "save_tic_files", 'S', "Save TIC files, do not delete TIC and archives", false});
-
-  const NetworkCommandLine net_cmdline(cmdline, 't');
-  if (!net_cmdline.IsInitialized() || net_cmdline.cmdline().help_requested()) {
-    ShowHelp(net_cmdline);
-    return 1;
-  }
-  try {
-    auto semaphore = SemaphoreFile::try_acquire(net_cmdline.semaphore_path(),
-                                                net_cmdline.semaphore_timeout());
-    return networkt_main(net_cmdline);
-  } catch (const semaphore_not_acquired& e) {
-    LOG(ERROR) << "ERROR: [network" << net_cmdline.net_cmd()
-               << "]: Unable to Acquire Network Semaphore: " << e.what();
-  }
-}
\ No newline at end of file
+} // namespace wwiv::net::networkt
@@ -0,0 +1,33 @@
+/**************************************************************************/
+/*                                                                        */
+/*                          WWIV Version 5.x                              */
+/*         Copyright (C)2020-2022, WWIV Software Services                 */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/**************************************************************************/
+#ifndef INCLUDED_NETWORKT_NETWORKT_H
+#define INCLUDED_NETWORKT_NETWORKT_H
+
+#include "net_core/net_stage.h"
+
+namespace wwiv::net::networkt {
+
+/**
+ * Runs networkt for the network in ctx, adding the files from the inbound
+ * TIC files to their file areas.
+ */
+int networkt_main(NetworkStageContext& ctx);
+
+} // namespace wwiv::net::networkt
+
+#endif
@@ -183,4 +183,180 @@ std::vector<std::string> FrameBuffer::to_screen_as_lines() const {
 }
 
 
+DeltaFrameBuffer::DeltaFrameBuffer(int cols, int rows)
+    : VScreen(), cols_(cols), rows_(rows),
+      b_(cols * rows, FrameBufferCell(' ', FRAMEBUFFER_DEFAULT_ATTRIBUTE)), sent_(b_),
+      dirty_rows_(rows, false) {}
+
+bool DeltaFrameBuffer::gotoxy(int x, int y) {
+  const auto xx = std::max(x, 0);
+  const auto yy = std::max(y, 0);
+  pos_ = (yy * cols_) + xx;
+  return pos_ < size_int(b_);
+}
+
+bool DeltaFrameBuffer::clear() {
+  for (auto i = 0; i < size_int(b_); i++) {
+    put(i, ' ', a_);
+  }
+  pos_ = 0;
+  return true;
+}
+
+bool DeltaFrameBuffer::clear_eol() {
+  const auto end = std::min((y() + 1) * cols_, size_int(b_));
+  for (auto i = pos_; i < end; i++) {
+    put(i, ' ', a_);
+  }
+  return true;
+}
+
+bool DeltaFrameBuffer::put(int pos, char c, uint8_t a) {
+  if (pos < 0 || pos >= size_int(b_)) {
+    return false;
+  }
+  auto& b = b_[pos];
+  // Empty cells are displayed as spaces, store them that way so they
+  // compare equal.
+  b.c(c == 0 ? ' ' : c);
+  b.a(a);
+  dirty_rows_[pos / cols_] = true;
+  return true;
+}
+
+bool DeltaFrameBuffer::write(char c, uint8_t a) {
+  switch (c) {
+  case 0: // NOP
+    break;
+  case '\r': {
+    const auto line = y();
+    return gotoxy(0, line);
+  }
+  case '\n': {
+    const auto line = y() + 1;
+    return gotoxy(0, line);
+  }
+  default: {
+    return put(pos_++, c, a);
+  }
+  }
+
+  return true;
+}
+
+bool DeltaFrameBuffer::displayed(int pos, char c, uint8_t a) {
+  if (!put(pos, c, a)) {
+    return false;
+  }
+  sent_[pos] = b_[pos];
+  return true;
+}
+
+void DeltaFrameBuffer::invalidate() {
+  invalidated_ = true;
+}
+
+bool DeltaFrameBuffer::dirty() const {
+  if (invalidated_) {
+    return true;
+  }
+  for (auto i = 0; i < size_int(b_); i++) {
+    if (b_[i].w() != sent_[i].w()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Gaps of up to this many unchanged cells are sent again rather than moving
+// the cursor over them, since that is no larger than the cursor movement.
+static constexpr int kMaxResendGap = 4;
+
+// Blank rows are only cleared with EL when at least this many cells would be
+// cleared, otherwise just writing the spaces is as small.
+static constexpr int kMinClearToEol = 4;
+
+std::string DeltaFrameBuffer::delta(int x, int y, uint8_t current_attr) {
+  std::string out;
+  auto attr = current_attr;
+  // Where the remote cursor is within this screen, -1 if unknown.
+  auto cx = -1;
+  auto cy = -1;
+
+  const auto set_attr = [&](uint8_t a) {
+    out.append(makeansi(a, attr));
+    attr = a;
+  };
+
+  for (auto row = 0; row < rows_; row++) {
+    if (!invalidated_ && !dirty_rows_[row]) {
+      continue;
+    }
+    const auto start = row * cols_;
+    for (auto col = 0; col < cols_; col++) {
+      const auto& cell = b_[start + col];
+      if (!invalidated_ && cell.w() == sent_[start + col].w()) {
+        continue;
+      }
+
+      // Move the cursor to the changed cell.
+      if (cy == row && cx < col) {
+        const auto gap = col - cx;
+        auto resend = gap <= kMaxResendGap;
+        for (auto i = cx; resend && i < col; i++) {
+          resend = b_[start + i].a() == attr;
+        }
+        if (resend) {
+          for (; cx < col; cx++) {
+            out.push_back(b_[start + cx].c());
+          }
+        } else {
+          out.append("\x1b[").append(std::to_string(gap)).append("C");
+        }
+      } else if (cy != row || cx != col) {
+        out.append("\x1b[")
+            .append(std::to_string(y + row))
+            .append(";")
+            .append(std::to_string(x + col))
+            .append("H");
+      }
+      cx = col;
+      cy = row;
+
+      // If the rest of the row is blank using the same attribute, clear it.
+      if (cell.c() == ' ' && cols_ - col >= kMinClearToEol) {
+        auto blank = true;
+        for (auto i = start + col + 1; blank && i < start + cols_; i++) {
+          blank = b_[i].w() == cell.w();
+        }
+        if (blank) {
+          set_attr(cell.a());
+          out.append("\x1b[K");
+          break;
+        }
+      }
+
+      set_attr(cell.a());
+      out.push_back(cell.c());
+      ++cx;
+    }
+  }
+
+  sent_ = b_;
+  std::fill(std::begin(dirty_rows_), std::end(dirty_rows_), false);
+  invalidated_ = false;
+  return out;
+}
+
+std::string DeltaFrameBuffer::row_as_text(int row) const {
+  std::string s;
+  s.reserve(cols_);
+  for (auto i = row * cols_; i < (row + 1) * cols_; i++) {
+    s.push_back(b_[i].c());
+  }
+  const auto last = s.find_last_not_of(' ');
+  s.resize(last == std::string::npos ? 0 : last + 1);
+  return s;
+}
+
 } // namespace wwiv
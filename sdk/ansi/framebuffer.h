@@ -93,6 +93,86 @@ private:
   bool open_{true};
 };
 
+/**
+ * A fixed size screen that remembers what was last sent to the remote
+ * terminal.  Callers draw the whole screen (or just the rows that may have
+ * changed) and then call delta() to get the ANSI needed to bring the terminal
+ * up to date, which only contains cursor movement and runs of text for the
+ * cells that have changed since the previous call.
+ */
+class DeltaFrameBuffer final : public VScreen {
+public:
+  DeltaFrameBuffer(int cols, int rows);
+  /** Writes c using a, handles \r and \n */
+  bool write(char c, uint8_t a) override;
+  /** Moves the cursor to x,y */
+  bool gotoxy(int x, int y) override;
+  // Clears every cell to a space using the current attribute.
+  bool clear() override;
+  // clears from current position to the end of line.
+  bool clear_eol() override;
+  // Nothing to finalize, the size of this screen is fixed.
+  void close() override {}
+
+  /**
+   * Puts c using a at cursor position pos.
+   * Does not handle movement chars like \r or \n
+   */
+  bool put(int pos, char c, uint8_t a) override;
+
+  bool write(char c) override { return write(c, a_); }
+  void curatr(uint8_t a) override { a_ = a; }
+
+  [[nodiscard]] int cols() const noexcept override { return cols_; }
+  [[nodiscard]] int pos() const noexcept override { return pos_; }
+  [[nodiscard]] uint8_t curatr() const noexcept override { return a_; }
+  [[nodiscard]] int x() const noexcept override { return pos_ % cols_; }
+  [[nodiscard]] int y() const noexcept override { return pos_ / cols_; }
+  [[nodiscard]] int rows() const noexcept { return rows_; }
+
+  /**
+   * Forgets what is on the remote terminal, so the next call to delta() will
+   * redraw every cell.  Use this after anything else has drawn over this
+   * screen, such as a CLS or help screen.
+   */
+  void invalidate();
+
+  /**
+   * Records that c using a was already displayed at pos by writing directly
+   * to the terminal, so that the next delta neither resends it nor leaves it
+   * on the screen when the cell changes again.
+   */
+  bool displayed(int pos, char c, uint8_t a);
+
+  // True if any cell differs from what was last returned by delta()
+  [[nodiscard]] bool dirty() const;
+
+  /**
+   * Returns the ANSI sequences to update the remote terminal from the last
+   * delta to the current contents, marking the current contents as sent.
+   * The top left cell of this screen is at terminal position x,y (1 based
+   * as used by ANSI) and current_attr is the attribute in use by the remote
+   * terminal. The cursor position afterwards is not specified.
+   */
+  [[nodiscard]] std::string delta(int x, int y, uint8_t current_attr);
+
+  // The raw text (without attributes) for row # 'row'
+  [[nodiscard]] std::string row_as_text(int row) const;
+
+private:
+  const int cols_;
+  const int rows_;
+  // What the cells should contain.
+  std::vector<FrameBufferCell> b_;
+  // What the cells contained after the last call to delta.
+  std::vector<FrameBufferCell> sent_;
+  // Rows which have been written to since the last delta.
+  std::vector<bool> dirty_rows_;
+  bool invalidated_{true};
+  uint8_t a_{7};
+  int pos_{0};
+};
+
 } // namespace ansi
 } // namespace sdk
 } // namespace wwiv
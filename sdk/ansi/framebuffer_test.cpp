@@ -81,3 +81,117 @@ TEST_F(FrameBufferTest, Goto) {
   EXPECT_EQ((8 << 8) | 'l', ca[3]);
   EXPECT_EQ((8 << 8) | 'o', ca[4]);
 }
+
+class DeltaFrameBufferTest : public testing::Test {};
+
+static void write(DeltaFrameBuffer& b, const std::string s) {
+  for (const auto c : s) {
+    b.write(c);
+  }
+}
+
+TEST_F(DeltaFrameBufferTest, Initial_RedrawsEverything) {
+  DeltaFrameBuffer b{10, 2};
+  write(b, "Hello");
+  EXPECT_TRUE(b.dirty());
+  EXPECT_EQ("\x1b[1;1HHello\x1b[K\x1b[2;1H\x1b[K", b.delta(1, 1, 7));
+  EXPECT_FALSE(b.dirty());
+  EXPECT_EQ("", b.delta(1, 1, 7));
+}
+
+TEST_F(DeltaFrameBufferTest, OnlyChangedCells) {
+  DeltaFrameBuffer b{20, 3};
+  write(b, "Hello World");
+  (void) b.delta(1, 5, 7);
+
+  b.gotoxy(0, 0);
+  write(b, "Hello There");
+  EXPECT_EQ("\x1b[5;7HThere", b.delta(1, 5, 7));
+  EXPECT_EQ("Hello There", b.row_as_text(0));
+}
+
+TEST_F(DeltaFrameBufferTest, Unchanged_RewrittenRow) {
+  DeltaFrameBuffer b{20, 3};
+  write(b, "Hello World");
+  (void) b.delta(1, 1, 7);
+
+  b.gotoxy(0, 0);
+  write(b, "Hello World");
+  b.clear_eol();
+  EXPECT_FALSE(b.dirty());
+  EXPECT_EQ("", b.delta(1, 1, 7));
+}
+
+TEST_F(DeltaFrameBufferTest, SmallGap_Resent) {
+  DeltaFrameBuffer b{20, 1};
+  write(b, "abcdefghijkl");
+  (void) b.delta(1, 1, 7);
+
+  b.gotoxy(0, 0);
+  write(b, "Xbc");
+  b.gotoxy(3, 0);
+  write(b, "D");
+  b.gotoxy(10, 0);
+  write(b, "K");
+  // bc is sent again rather than moving the cursor, the gap from D to K
+  // is larger so the cursor is moved forward.
+  EXPECT_EQ("\x1b[1;1HXbcD\x1b[6CK", b.delta(1, 1, 7));
+}
+
+TEST_F(DeltaFrameBufferTest, Attributes) {
+  DeltaFrameBuffer b{20, 1};
+  (void) b.delta(1, 1, 7);
+
+  b.curatr(0x0e);
+  write(b, "AB");
+  b.curatr(0x07);
+  write(b, "C");
+  EXPECT_EQ("\x1b[1;1H\x1b[0;33;40;1mAB\x1b[0;37;40mC", b.delta(1, 1, 7));
+}
+
+TEST_F(DeltaFrameBufferTest, ClearsToEndOfLine) {
+  DeltaFrameBuffer b{20, 2};
+  write(b, "Hello World");
+  (void) b.delta(1, 1, 7);
+
+  b.gotoxy(0, 0);
+  write(b, "Hi");
+  b.clear_eol();
+  EXPECT_EQ("\x1b[1;2Hi\x1b[K", b.delta(1, 1, 7));
+  EXPECT_EQ("Hi", b.row_as_text(0));
+}
+
+TEST_F(DeltaFrameBufferTest, Scroll) {
+  DeltaFrameBuffer b{10, 3};
+  write(b, "one\ntwo\nthree");
+  (void) b.delta(1, 1, 7);
+
+  // Scrolling down a line only sends what differs between the lines.
+  b.clear();
+  write(b, "two\nthree\nfour");
+  EXPECT_EQ("\x1b[1;1Htwo\x1b[2;2Hhree\x1b[3;1Hfour\x1b[K", b.delta(1, 1, 7));
+}
+
+TEST_F(DeltaFrameBufferTest, Invalidate) {
+  DeltaFrameBuffer b{10, 1};
+  write(b, "Hello");
+  (void) b.delta(1, 1, 7);
+  b.invalidate();
+  EXPECT_TRUE(b.dirty());
+  EXPECT_EQ("\x1b[1;1HHello\x1b[K", b.delta(1, 1, 7));
+}
+
+TEST_F(DeltaFrameBufferTest, Displayed) {
+  DeltaFrameBuffer b{10, 1};
+  write(b, "Hell");
+  (void) b.delta(1, 1, 7);
+
+  // The 'o' was echoed directly, so doesn't need to be sent.
+  b.displayed(4, 'o', 7);
+  EXPECT_FALSE(b.dirty());
+  EXPECT_EQ("Hello", b.row_as_text(0));
+
+  // Removing it again needs to be sent.
+  b.put(4, ' ', 7);
+  EXPECT_EQ("\x1b[1;5H\x1b[K", b.delta(1, 1, 7));
+}
@@ -0,0 +1,309 @@
+/**************************************************************************/
+/*                                                                        */
+/*                          WWIV Version 5.x                              */
+/*           Copyright (C)2022, WWIV Software Services                    */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/**************************************************************************/
+#include "sdk/chat_bus.h"
+
+#include "core/datetime.h"
+#include "core/file.h"
+#include "core/log.h"
+#include "core/strings.h"
+#include "sdk/filenames.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <system_error>
+
+using namespace wwiv::core;
+using namespace wwiv::strings;
+
+namespace wwiv::sdk {
+
+namespace {
+
+constexpr char kSignature[8] = {'W', 'W', 'I', 'V', 'C', 'H', 'T', '\x1A'};
+constexpr uint32_t kVersion = 1;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "chatbus.dat needs lock free 64-bit atomics to be shared between processes");
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t));
+
+// The sequence numbers in chatbus.dat are shared with the other instances,
+// so are only ever accessed atomically.
+std::atomic<uint64_t>& atomic_of(uint64_t& v) {
+  return *reinterpret_cast<std::atomic<uint64_t>*>(&v);
+}
+
+size_t bus_size() {
+  return sizeof(chat_bus_header_t) + ChatBus::kMaxInstances * sizeof(chat_bus_member_t) +
+         ChatBus::kNumSlots * sizeof(chat_bus_slot_t);
+}
+
+bool is_valid_bus(std::string_view v) {
+  if (v.size() != bus_size()) {
+    return false;
+  }
+  const auto* h = reinterpret_cast<const chat_bus_header_t*>(v.data());
+  return memcmp(h->signature, kSignature, sizeof(kSignature)) == 0 && h->version == kVersion &&
+         h->num_slots == ChatBus::kNumSlots && h->max_instances == ChatBus::kMaxInstances;
+}
+
+/**
+ * Creates chatbus.dat unless another instance beat us to it.  The file is
+ * written in full under a temporary name and then linked into place, so no
+ * instance ever maps a partially written bus.
+ */
+bool create_bus(const std::filesystem::path& path, int instance_num) {
+  const auto tmp_path = FilePath(path.parent_path(), StrCat(CHATBUS_DAT, ".", instance_num));
+  std::string contents(bus_size(), '\0');
+  auto* h = reinterpret_cast<chat_bus_header_t*>(contents.data());
+  memcpy(h->signature, kSignature, sizeof(kSignature));
+  h->version = kVersion;
+  h->num_slots = ChatBus::kNumSlots;
+  h->max_instances = ChatBus::kMaxInstances;
+  {
+    File f(tmp_path);
+    if (!f.Open(File::modeBinary | File::modeReadWrite | File::modeCreateFile |
+                File::modeTruncate)) {
+      return false;
+    }
+    if (f.Write(contents.data(), contents.size()) !=
+        static_cast<File::size_type>(contents.size())) {
+      f.Close();
+      File::Remove(tmp_path);
+      return false;
+    }
+  }
+  std::error_code ec;
+  std::filesystem::create_hard_link(tmp_path, path, ec);
+  File::Remove(tmp_path);
+  // If it already exists, another instance created it first.
+  return !ec || File::Exists(path);
+}
+
+} // namespace
+
+ChatBus::ChatBus(const std::filesystem::path& datadir, int instance_num)
+    : instance_num_(instance_num) {
+#ifdef __OS2__
+  // Without shared memory mappings the bus can't be shared between instances.
+  VLOG(1) << "ChatBus is not available on this platform.";
+#else
+  if (instance_num < 1 || instance_num > kMaxInstances) {
+    LOG(WARNING) << "ChatBus is not available for instance: " << instance_num;
+    return;
+  }
+  const auto path = FilePath(datadir, CHATBUS_DAT);
+  if (!Open(path)) {
+    LOG(ERROR) << "Unable to open chat bus: " << path.string();
+  }
+#endif
+}
+
+ChatBus::~ChatBus() {
+  if (is_open()) {
+    Leave();
+  }
+}
+
+bool ChatBus::Open(const std::filesystem::path& path) {
+  for (auto tries = 0; tries < 2; tries++) {
+    if (!File::Exists(path) && !create_bus(path, instance_num_)) {
+      return false;
+    }
+    auto f = std::make_unique<MemoryMappedFile>(path, MemoryMappedFile::Mode::read_write);
+    if (f->is_open() && is_valid_bus(f->view())) {
+      file_ = std::move(f);
+      read_seq_ = atomic_of(header()->next_seq).load(std::memory_order_acquire);
+      return true;
+    }
+    f.reset();
+    LOG(WARNING) << "Recreating invalid chat bus: " << path.string();
+    File::Remove(path);
+  }
+  return false;
+}
+
+chat_bus_header_t* ChatBus::header() const {
+  return reinterpret_cast<chat_bus_header_t*>(file_->mutable_data());
+}
+
+chat_bus_member_t* ChatBus::member(int instance_num) const {
+  auto* members = reinterpret_cast<chat_bus_member_t*>(file_->mutable_data() +
+                                                       sizeof(chat_bus_header_t));
+  return &members[instance_num - 1];
+}
+
+chat_bus_slot_t* ChatBus::slot(uint64_t seq) const {
+  auto* slots = reinterpret_cast<chat_bus_slot_t*>(
+      file_->mutable_data() + sizeof(chat_bus_header_t) + kMaxInstances * sizeof(chat_bus_member_t));
+  return &slots[seq % kNumSlots];
+}
+
+void ChatBus::Join(int loc) {
+  if (!is_open()) {
+    return;
+  }
+  auto* m = member(instance_num_);
+  if (m->loc != loc) {
+    // Don't replay what was said before we got here.
+    read_seq_ = atomic_of(header()->next_seq).load(std::memory_order_acquire);
+  }
+  m->loc = static_cast<uint16_t>(loc);
+  m->updated = static_cast<uint32_t>(daten_t_now());
+}
+
+void ChatBus::Leave() { Join(0); }
+
+void ChatBus::touch() {
+  auto* m = member(instance_num_);
+  if (m->loc == 0) {
+    return;
+  }
+  // Only write when needed, so we don't dirty the shared page on every check.
+  const auto now = static_cast<uint32_t>(daten_t_now());
+  if (now - m->updated >= kMemberTimeoutSeconds / 2) {
+    m->updated = now;
+  }
+}
+
+int ChatBus::loc() const { return is_open() ? member(instance_num_)->loc : 0; }
+
+std::vector<int> ChatBus::members(int loc) const {
+  std::vector<int> result;
+  if (!is_open() || loc == 0) {
+    return result;
+  }
+  const auto now = static_cast<uint32_t>(daten_t_now());
+  for (auto i = 1; i <= kMaxInstances; i++) {
+    if (const auto* m = member(i); m->loc == loc && now - m->updated <= kMemberTimeoutSeconds) {
+      result.push_back(i);
+    }
+  }
+  return result;
+}
+
+bool ChatBus::Send(int loc, int from_user, const std::string& text, int exclude_instance) {
+  if (!is_open()) {
+    return false;
+  }
+  const auto seq = atomic_of(header()->next_seq).fetch_add(1, std::memory_order_acq_rel);
+  auto* s = slot(seq);
+  auto& slot_seq = atomic_of(s->seq);
+  // Mark the slot as being written so readers don't see a partial line.
+  slot_seq.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  s->loc = static_cast<uint16_t>(loc);
+  s->from_instance = static_cast<uint16_t>(instance_num_);
+  s->exclude_instance = static_cast<uint16_t>(exclude_instance);
+  s->from_user = static_cast<uint16_t>(from_user);
+  s->daten = static_cast<uint32_t>(daten_t_now());
+  const auto len = std::min<size_t>(text.size(), sizeof(s->text));
+  s->len = static_cast<uint16_t>(len);
+  memcpy(s->text, text.data(), len);
+  slot_seq.store(seq + 1, std::memory_order_release);
+  return true;
+}
+
+bool ChatBus::pending() {
+  if (!is_open()) {
+    return false;
+  }
+  const auto my_loc = loc();
+  if (my_loc == 0) {
+    return false;
+  }
+  touch();
+  const auto next = atomic_of(header()->next_seq).load(std::memory_order_acquire);
+  // Lines older than the ring are left for Receive to count as dropped.
+  for (auto seq = std::max(read_seq_, next > kNumSlots ? next - kNumSlots : 0); seq < next;
+       seq++) {
+    const auto* s = slot(seq);
+    auto& slot_seq = atomic_of(const_cast<chat_bus_slot_t*>(s)->seq);
+    const auto written = slot_seq.load(std::memory_order_acquire);
+    if (written < seq + 1) {
+      // Still being written, try again next time.
+      return false;
+    }
+    if (written == seq + 1) {
+      const auto line_loc = s->loc;
+      const auto from_instance = s->from_instance;
+      const auto exclude_instance = s->exclude_instance;
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (slot_seq.load(std::memory_order_relaxed) == written && line_loc == my_loc &&
+          from_instance != instance_num_ && exclude_instance != instance_num_) {
+        return true;
+      }
+    }
+    // Not for us, so Receive doesn't need to look at it again.
+    if (seq == read_seq_) {
+      read_seq_++;
+    }
+  }
+  return false;
+}
+
+std::vector<instance_message_t> ChatBus::Receive() {
+  std::vector<instance_message_t> result;
+  if (!is_open()) {
+    return result;
+  }
+  touch();
+  const auto my_loc = loc();
+  const auto next = atomic_of(header()->next_seq).load(std::memory_order_acquire);
+  if (next - read_seq_ > kNumSlots) {
+    VLOG(1) << "ChatBus dropped " << (next - read_seq_ - kNumSlots) << " lines.";
+    read_seq_ = next - kNumSlots;
+  }
+  while (read_seq_ < next) {
+    const auto* s = slot(read_seq_);
+    auto& slot_seq = atomic_of(const_cast<chat_bus_slot_t*>(s)->seq);
+    const auto seq = slot_seq.load(std::memory_order_acquire);
+    if (seq < read_seq_ + 1) {
+      // Still being written, try again next time.
+      break;
+    }
+    if (seq > read_seq_ + 1) {
+      // Overwritten by a newer line.
+      read_seq_++;
+      continue;
+    }
+    chat_bus_slot_t copy;
+    memcpy(&copy, s, sizeof(chat_bus_slot_t));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    read_seq_++;
+    if (slot_seq.load(std::memory_order_relaxed) != seq) {
+      // Overwritten while we were copying it.
+      continue;
+    }
+    if (copy.loc != my_loc || copy.from_instance == instance_num_ ||
+        copy.exclude_instance == instance_num_) {
+      continue;
+    }
+    instance_message_t m{};
+    m.message_type = instance_message_type_t::user;
+    m.from_instance = copy.from_instance;
+    m.from_user = copy.from_user;
+    m.dest_inst = instance_num_;
+    m.daten = copy.daten;
+    m.message.assign(copy.text, std::min<size_t>(copy.len, sizeof(copy.text)));
+    result.push_back(std::move(m));
+  }
+  return result;
+}
+
+} // namespace wwiv::sdk
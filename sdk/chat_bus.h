@@ -0,0 +1,145 @@
+/**************************************************************************/
+/*                                                                        */
+/*                          WWIV Version 5.x                              */
+/*           Copyright (C)2022, WWIV Software Services                    */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/**************************************************************************/
+#ifndef INCLUDED_SDK_CHAT_BUS_H
+#define INCLUDED_SDK_CHAT_BUS_H
+
+#include "core/mmap_file.h"
+#include "sdk/instance_message.h"
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace wwiv::sdk {
+
+#pragma pack(push, 1)
+/**
+ * Header of chatbus.dat.  The header is followed by max_instances
+ * chat_bus_member_t entries and then num_slots chat_bus_slot_t entries.
+ */
+struct chat_bus_header_t {
+  // "WWIVCHT\x1A"
+  char signature[8];
+  uint32_t version;
+  uint32_t num_slots;
+  uint32_t max_instances;
+  uint32_t reserved1;
+  // Sequence number of the next line to be sent, updated atomically.
+  uint64_t next_seq;
+  uint8_t reserved[32];
+};
+
+/** The chat channel an instance is in, 0 if none. */
+struct chat_bus_member_t {
+  uint16_t loc;
+  uint16_t reserved;
+  // daten_t of when loc was last changed or confirmed by the instance.
+  uint32_t updated;
+};
+
+/** One line of chat in the chatbus.dat ring buffer. */
+struct chat_bus_slot_t {
+  // seq + 1 of the line in this slot once it has been written, 0 while being written.
+  uint64_t seq;
+  uint16_t loc;
+  uint16_t from_instance;
+  // Instance in loc which should not receive this line, 0 for none.
+  uint16_t exclude_instance;
+  uint16_t from_user;
+  uint32_t daten;
+  uint16_t len;
+  uint16_t reserved;
+  char text[1000];
+};
+#pragma pack(pop)
+
+static_assert(sizeof(chat_bus_header_t) == 64, "chat_bus_header_t must be 64 bytes");
+static_assert(sizeof(chat_bus_member_t) == 8, "chat_bus_member_t must be 8 bytes");
+static_assert(sizeof(chat_bus_slot_t) == 1024, "chat_bus_slot_t must be 1024 bytes");
+
+/**
+ * Multicasts chat lines to all of the instances in a chat channel.
+ *
+ * DATA/chatbus.dat is memory mapped by every instance and holds the chat
+ * channel each instance is in, along with a ring buffer of the most recent
+ * lines.  Sending a line is a single write into shared memory, and checking
+ * for new lines is a single read, so the chatroom no longer needs a message
+ * file per recipient or to reread instance.dat for every line.
+ *
+ * Lines which are overwritten before an instance reads them are dropped.
+ *
+ * An instance in a channel confirms its membership while it checks for new
+ * lines, so members which haven't done that for kMemberTimeoutSeconds (i.e.
+ * because the instance crashed) are no longer listed.
+ */
+class ChatBus final {
+public:
+  static constexpr int kMaxInstances = 256;
+  static constexpr int kNumSlots = 256;
+  static constexpr int kMemberTimeoutSeconds = 10 * 60;
+
+  ChatBus(const std::filesystem::path& datadir, int instance_num);
+  ChatBus(const ChatBus&) = delete;
+  ChatBus& operator=(const ChatBus&) = delete;
+  ~ChatBus();
+
+  [[nodiscard]] bool is_open() const noexcept { return file_ != nullptr; }
+  explicit operator bool() const noexcept { return is_open(); }
+
+  /** Enters chat channel loc, only lines sent after this are received. */
+  void Join(int loc);
+  /** Leaves the current chat channel. */
+  void Leave();
+  /** The chat channel this instance is in, 0 if none. */
+  [[nodiscard]] int loc() const;
+  /** The instances in chat channel loc which have been active recently. */
+  [[nodiscard]] std::vector<int> members(int loc) const;
+
+  /**
+   * Sends text to the other instances in chat channel loc, except for
+   * exclude_instance.
+   */
+  bool Send(int loc, int from_user, const std::string& text, int exclude_instance = 0);
+
+  /**
+   * Returns true if any lines for this instance's channel have been sent by
+   * another instance since the last Receive.
+   */
+  [[nodiscard]] bool pending();
+
+  /** Returns the lines sent to this instance's chat channel since the last Receive. */
+  [[nodiscard]] std::vector<instance_message_t> Receive();
+
+private:
+  bool Open(const std::filesystem::path& path);
+  [[nodiscard]] chat_bus_header_t* header() const;
+  [[nodiscard]] chat_bus_member_t* member(int instance_num) const;
+  [[nodiscard]] chat_bus_slot_t* slot(uint64_t seq) const;
+  // Refreshes the time of our membership if we are in a channel.
+  void touch();
+
+  const int instance_num_;
+  std::unique_ptr<core::MemoryMappedFile> file_;
+  // Sequence number of the next line to read.
+  uint64_t read_seq_{0};
+};
+
+} // namespace wwiv::sdk
+
+#endif
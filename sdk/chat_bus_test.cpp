@@ -0,0 +1,168 @@
+/**************************************************************************/
+/*                                                                        */
+/*                          WWIV Version 5.x                              */
+/*           Copyright (C)2022, WWIV Software Services                    */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/**************************************************************************/
+#include "gtest/gtest.h"
+
+#include "core/file.h"
+#include "core/mmap_file.h"
+#include "sdk/chat_bus.h"
+#include "sdk/filenames.h"
+#include "sdk/instance.h"
+#include "sdk/sdk_helper.h"
+#include <string>
+
+using namespace wwiv::core;
+using namespace wwiv::sdk;
+
+class ChatBusTest : public testing::Test {
+public:
+  ChatBusTest() : one(helper.config().datadir(), 1), two(helper.config().datadir(), 2) {}
+
+  SdkHelper helper;
+  ChatBus one;
+  ChatBus two;
+};
+
+TEST_F(ChatBusTest, Smoke) {
+  ASSERT_TRUE(one);
+  ASSERT_TRUE(two);
+  one.Join(INST_LOC_CH1);
+  two.Join(INST_LOC_CH1);
+
+  ASSERT_TRUE(one.Send(INST_LOC_CH1, 1, "hello"));
+  EXPECT_TRUE(two.pending());
+  const auto m = two.Receive();
+  ASSERT_EQ(1u, m.size());
+  EXPECT_EQ("hello", m.front().message);
+  EXPECT_EQ(1, m.front().from_instance);
+  EXPECT_EQ(1, m.front().from_user);
+  EXPECT_EQ(2, m.front().dest_inst);
+  EXPECT_FALSE(two.pending());
+
+  // The sender doesn't hear itself.
+  EXPECT_TRUE(one.Receive().empty());
+}
+
+TEST_F(ChatBusTest, Members_Stale) {
+  one.Join(INST_LOC_CH1);
+  two.Join(INST_LOC_CH1);
+  {
+    // Make it look like instance 2 crashed long ago while in the channel.
+    MemoryMappedFile f(FilePath(helper.config().datadir(), CHATBUS_DAT),
+                       MemoryMappedFile::Mode::read_write);
+    ASSERT_TRUE(f.is_open());
+    auto* members = reinterpret_cast<chat_bus_member_t*>(f.mutable_data() +
+                                                         sizeof(chat_bus_header_t));
+    members[1].updated -= ChatBus::kMemberTimeoutSeconds + 1;
+  }
+  EXPECT_EQ(std::vector<int>{1}, one.members(INST_LOC_CH1));
+
+  // Checking for lines confirms that instance 2 is still there.
+  EXPECT_FALSE(two.pending());
+  EXPECT_EQ((std::vector<int>{1, 2}), one.members(INST_LOC_CH1));
+}
+
+TEST_F(ChatBusTest, Members) {
+  one.Join(INST_LOC_CH1);
+  two.Join(INST_LOC_CH2);
+  EXPECT_EQ(std::vector<int>{1}, one.members(INST_LOC_CH1));
+  EXPECT_EQ(std::vector<int>{2}, one.members(INST_LOC_CH2));
+  EXPECT_EQ(INST_LOC_CH2, two.loc());
+
+  two.Leave();
+  EXPECT_EQ(0, two.loc());
+  EXPECT_TRUE(one.members(INST_LOC_CH2).empty());
+}
+
+TEST_F(ChatBusTest, OtherChannel) {
+  one.Join(INST_LOC_CH1);
+  two.Join(INST_LOC_CH2);
+  one.Send(INST_LOC_CH1, 1, "hello");
+  EXPECT_TRUE(two.Receive().empty());
+}
+
+TEST_F(ChatBusTest, Pending_OnlyForOurChannel) {
+  ChatBus three(helper.config().datadir(), 3);
+  one.Join(INST_LOC_CH1);
+  two.Join(INST_LOC_CH2);
+  three.Join(INST_LOC_CH1);
+  one.Send(INST_LOC_CH1, 1, "hello", 3);
+  // Our own line, another channel, and a line that excludes us.
+  EXPECT_FALSE(one.pending());
+  EXPECT_FALSE(two.pending());
+  EXPECT_FALSE(three.pending());
+
+  two.Send(INST_LOC_CH1, 2, "hi");
+  EXPECT_TRUE(one.pending());
+  EXPECT_TRUE(three.pending());
+  ASSERT_EQ(1u, three.Receive().size());
+  EXPECT_FALSE(three.pending());
+}
+
+TEST_F(ChatBusTest, Exclude) {
+  ChatBus three(helper.config().datadir(), 3);
+  one.Join(INST_LOC_CH1);
+  two.Join(INST_LOC_CH1);
+  three.Join(INST_LOC_CH1);
+  one.Send(INST_LOC_CH1, 1, "hello", 2);
+  EXPECT_TRUE(two.Receive().empty());
+  EXPECT_EQ(1u, three.Receive().size());
+}
+
+TEST_F(ChatBusTest, JoinSkipsEarlierLines) {
+  one.Join(INST_LOC_CH1);
+  one.Send(INST_LOC_CH1, 1, "before");
+  two.Join(INST_LOC_CH1);
+  one.Send(INST_LOC_CH1, 1, "after");
+  const auto m = two.Receive();
+  ASSERT_EQ(1u, m.size());
+  EXPECT_EQ("after", m.front().message);
+}
+
+TEST_F(ChatBusTest, Overrun) {
+  one.Join(INST_LOC_CH1);
+  two.Join(INST_LOC_CH1);
+  for (auto i = 0; i < ChatBus::kNumSlots + 10; i++) {
+    one.Send(INST_LOC_CH1, 1, std::to_string(i));
+  }
+  const auto m = two.Receive();
+  ASSERT_EQ(static_cast<size_t>(ChatBus::kNumSlots), m.size());
+  EXPECT_EQ("10", m.front().message);
+  EXPECT_EQ(std::to_string(ChatBus::kNumSlots + 9), m.back().message);
+}
+
+TEST_F(ChatBusTest, LongLine) {
+  one.Join(INST_LOC_CH1);
+  two.Join(INST_LOC_CH1);
+  one.Send(INST_LOC_CH1, 1, std::string(2000, 'x'));
+  const auto m = two.Receive();
+  ASSERT_EQ(1u, m.size());
+  EXPECT_EQ(sizeof(chat_bus_slot_t::text), m.front().message.size());
+}
+
+TEST(ChatBusInvalidTest, InvalidBus_IsRecreated) {
+  SdkHelper helper;
+  const auto path = FilePath(helper.config().datadir(), CHATBUS_DAT);
+  {
+    File f(path);
+    ASSERT_TRUE(f.Open(File::modeBinary | File::modeReadWrite | File::modeCreateFile |
+                       File::modeTruncate));
+    f.Write("garbage", 7);
+  }
+  ChatBus bus(helper.config().datadir(), 1);
+  EXPECT_TRUE(bus);
+}
@@ -25,6 +25,7 @@
 #include "sdk/fido/fido_util.h"
 #include "sdk/net/packets.h"
 #include <algorithm>
+#include <cstring>
 #include <optional>
 #include <string>
 
@@ -86,6 +87,27 @@ static std::string ReadVariableLengthField(File& f, int max_len) {
   return s;
 }
 
+// Gets the packet password from header as a UPPER case string.
+static std::string password_from_header(const packet_header_2p_t& header) {
+  // Do this dance to ensure that if there's no trailing null on header.password, we add one.
+  char temp[9];
+  memset(temp, 0, sizeof(temp));
+  strncpy(temp, header.password, 8);
+  temp[8] = '\0';
+  std::string actual = temp;
+  return ToStringUpperCase(actual);
+}
+
+FidoPackedMessage fido_packed_message_view_t::to_message() const {
+  fido_variable_length_header_t vh;
+  vh.date_time = std::string(date_time);
+  vh.to_user_name = std::string(to_user_name);
+  vh.from_user_name = std::string(from_user_name);
+  vh.subject = std::string(subject);
+  vh.text = std::string(text);
+  return FidoPackedMessage(nh, std::move(vh));
+}
+
 FidoStoredMessage::~FidoStoredMessage()  = default;
 
 bool write_fido_packet_header(File& f, const packet_header_2p_t& header) {
@@ -115,11 +137,14 @@ bool write_packed_message(File& f, const FidoPackedMessage& packet) {
   f.Write("\0", 1);
   f.Write(packet.vh.text);
   f.Write("\0", 1);
-  // End of packet.
-  f.Write("\0\0", 2);
   return true;
 }
 
+bool write_fido_packet_trailer(File& f) {
+  // End of packet.
+  return f.Write("\0\0", 2) == 2;
+}
+
 bool write_stored_message(File& f, FidoStoredMessage& packet) {
   if (const auto num = f.Write(&packet.nh, sizeof(fido_stored_message_t));
       num != sizeof(fido_stored_message_t)) {
@@ -225,7 +250,7 @@ std::optional<FidoPacket> FidoPacket::Open(const std::filesystem::path& path) {
     return std::nullopt;
   }
 
-  FidoPacket packet(std::move(f), true);
+  FidoPacket packet(std::move(f), false);
   auto num_header_read = packet.file_.Read(&packet.header_, sizeof(packet_header_2p_t));
   if (num_header_read < static_cast<int>(sizeof(packet_header_2p_t))) {
     LOG(ERROR) << "Read less than packet header";
@@ -284,20 +309,118 @@ bool FidoPacket::Write(const FidoPackedMessage& packet) {
   return write_packed_message(file_, packet);
 }
 
+void FidoPacket::Close() {
+  if (writable_ && file_.IsOpen()) {
+    write_fido_packet_trailer(file_);
+  }
+  file_.Close();
+}
+
 std::tuple<wwiv::sdk::net::ReadNetPacketResponse, FidoPackedMessage> FidoPacket::Read() {
   FidoPackedMessage msg;
   auto response = read_packed_message(file_, msg);
   return std::make_tuple(response, msg);
 }
 
-std::string FidoPacket::password() const {
-  // Do this dance to ensure that if there's no trailing null on header.password, we add one.
-  char temp[9];
-  memset(temp, 0, sizeof(temp));
-  strncpy(temp, header_.password, 8);
-  temp[8] = '\0';
-  std::string actual = temp;
-  return ToStringUpperCase(actual);
+std::string FidoPacket::password() const { return password_from_header(header_); }
+
+// FtnPacketReader
+
+FtnPacketReader::FtnPacketReader(const std::filesystem::path& path)
+    : file_(std::make_unique<MemoryMappedFile>(path)) {
+  if (file_->is_open()) {
+    data_ = file_->view();
+    open_ = Open();
+  } else {
+    VLOG(2) << "Unable to open file: " << path.string();
+  }
+}
+
+FtnPacketReader::FtnPacketReader(std::string contents) : memory_(std::move(contents)) {
+  data_ = memory_;
+  open_ = Open();
+}
+
+FtnPacketReader::~FtnPacketReader() = default;
+
+bool FtnPacketReader::Open() {
+  if (data_.size() < sizeof(packet_header_2p_t)) {
+    LOG(ERROR) << "Read less than packet header";
+    return false;
+  }
+  memcpy(&header_, data_.data(), sizeof(packet_header_2p_t));
+  pos_ = sizeof(packet_header_2p_t);
+  return true;
+}
+
+std::string FtnPacketReader::password() const { return password_from_header(header_); }
+
+void FtnPacketReader::Close() {
+  file_.reset();
+  memory_.clear();
+  data_ = {};
+  pos_ = 0;
+  open_ = false;
+}
+
+/**
+ * Reads a field of length {len}.  Will trim the field to  remove
+ * any trailing nulls.
+ */
+std::string_view FtnPacketReader::ReadFixedLengthField(size_t len) {
+  auto s = data_.substr(pos_, len);
+  pos_ += s.size();
+  while (!s.empty() && s.back() == '\0') {
+    s.remove_suffix(1);
+  }
+  return s;
+}
+
+/**
+ * Reads a null-terminated field of up to length {len} or the first null
+ * character.
+ */
+std::string_view FtnPacketReader::ReadVariableLengthField(size_t max_len) {
+  const auto s = data_.substr(pos_, max_len);
+  if (const auto* nul = static_cast<const char*>(memchr(s.data(), 0, s.size()))) {
+    const auto len = static_cast<size_t>(nul - s.data());
+    pos_ += len + 1;
+    return s.substr(0, len);
+  }
+  pos_ += s.size();
+  return s;
+}
+
+ReadNetPacketResponse FtnPacketReader::Next(fido_packed_message_view_t& msg) {
+  if (!open_) {
+    return ReadNetPacketResponse::ERROR;
+  }
+  const auto remaining = data_.size() - pos_;
+  if (remaining == 0) {
+    // at the end of the packet.
+    return ReadNetPacketResponse::END_OF_FILE;
+  }
+  if (remaining >= 2 && data_[pos_] == 0 && data_[pos_ + 1] == 0) {
+    // FIDO packets have 2 bytes of NULL at the end;
+    return ReadNetPacketResponse::END_OF_FILE;
+  }
+  if (remaining < sizeof(fido_packed_message_t)) {
+    LOG(INFO) << "error reading header, got short read of size: " << remaining
+              << "; expected: " << sizeof(fido_packed_message_t);
+    return ReadNetPacketResponse::ERROR;
+  }
+
+  memcpy(&msg.nh, data_.data() + pos_, sizeof(fido_packed_message_t));
+  pos_ += sizeof(fido_packed_message_t);
+  if (msg.nh.message_type != 2) {
+    LOG(INFO) << "invalid message_type: " << msg.nh.message_type << "; expected: 2";
+  }
+  msg.date_time = ReadFixedLengthField(20);
+  msg.to_user_name = ReadVariableLengthField(36);
+  msg.from_user_name = ReadVariableLengthField(36);
+  msg.subject = ReadVariableLengthField(72);
+  msg.text = ReadVariableLengthField(256 * 1024);
+  return ReadNetPacketResponse::OK;
 }
 
 } // namespace wwiv
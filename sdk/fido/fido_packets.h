@@ -21,11 +21,15 @@
 #include "core/clock.h"
 #include "core/datetime.h"
 #include "core/file.h"
+#include "core/mmap_file.h"
 #include "sdk/config.h"
 #include "sdk/net/packets.h"
 #include <cstdint>
+#include <filesystem>
+#include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <tuple>
 #include <utility>
 
@@ -217,6 +221,22 @@ public:
   fido_variable_length_header_t vh;
 };
 
+/**
+ * A packed message read by FtnPacketReader.  The fields are views into the
+ * packet and are only valid while the FtnPacketReader is.
+ */
+struct fido_packed_message_view_t {
+  fido_packed_message_t nh{};
+  std::string_view date_time;
+  std::string_view to_user_name;
+  std::string_view from_user_name;
+  std::string_view subject;
+  std::string_view text;
+
+  /** Returns a copy of this message which owns the fields. */
+  [[nodiscard]] FidoPackedMessage to_message() const;
+};
+
 /**
  * Represents a .MSG file in FidoNET.
  */
@@ -254,8 +274,8 @@ public:
   // Gets the packet password as a UPPER case string.
   [[nodiscard]] std::string password() const;
 
-  // Close the packet
-  void Close() { file_.Close(); }
+  // Close the packet, writing the end of packet marker if writable.
+  void Close();
 
 private:
   bool write_fido_packet_header();
@@ -264,8 +284,54 @@ private:
   packet_header_2p_t header_{};
 };
   
+/**
+ * Reads the packed messages in a .PKT file from memory, rather than issuing
+ * a read for every byte of the variable length fields like FidoPacket.
+ *
+ * Example:
+ *   FtnPacketReader reader(path);
+ *   if (!reader) { return false; }
+ *   fido_packed_message_view_t msg;
+ *   while (reader.Next(msg) == ReadNetPacketResponse::OK) { ... }
+ */
+class FtnPacketReader final {
+public:
+  explicit FtnPacketReader(const std::filesystem::path& path);
+  explicit FtnPacketReader(std::string contents);
+  FtnPacketReader(const FtnPacketReader&) = delete;
+  FtnPacketReader& operator=(const FtnPacketReader&) = delete;
+  ~FtnPacketReader();
+
+  [[nodiscard]] bool is_open() const noexcept { return open_; }
+  explicit operator bool() const noexcept { return open_; }
+
+  [[nodiscard]] const packet_header_2p_t& header() const noexcept { return header_; }
+  // Gets the packet password as a UPPER case string.
+  [[nodiscard]] std::string password() const;
+
+  /** Reads the next packed message into msg. */
+  [[nodiscard]] wwiv::sdk::net::ReadNetPacketResponse Next(fido_packed_message_view_t& msg);
+
+  /** Releases the packet, invalidating any views returned by Next. */
+  void Close();
+
+private:
+  bool Open();
+  std::string_view ReadFixedLengthField(size_t len);
+  std::string_view ReadVariableLengthField(size_t max_len);
+
+  std::unique_ptr<wwiv::core::MemoryMappedFile> file_;
+  std::string memory_;
+  std::string_view data_;
+  size_t pos_{0};
+  packet_header_2p_t header_{};
+  bool open_{false};
+};
+
 bool write_fido_packet_header(wwiv::core::File& f, const packet_header_2p_t& header);
 bool write_packed_message(wwiv::core::File& f, const FidoPackedMessage& packet);
+// Writes the end of packet marker, after the last packed message.
+bool write_fido_packet_trailer(wwiv::core::File& f);
 bool write_stored_message(wwiv::core::File& f, FidoStoredMessage& packet);
 
 wwiv::sdk::net::ReadNetPacketResponse read_packed_message(wwiv::core::File& file,
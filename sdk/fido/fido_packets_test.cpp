@@ -15,10 +15,13 @@
 /*    language governing permissions and limitations under the License.   */
 /**************************************************************************/
 
+#include "core/fake_clock.h"
 #include "core/file.h"
 #include "core/test/file_helper.h"
 #include "core/test/wwivtest.h"
+#include "sdk/fido/fido_address.h"
 #include "sdk/fido/fido_packets.h"
+#include "sdk/fido/fido_util.h"
 #include "gtest/gtest.h"
 
 class FidoPacketsTestDataTest : public wwiv::core::test::TestDataTest {};
@@ -97,4 +100,123 @@ TEST_F(FidoPacketsTestDataTest, ThreeMessages) {
     auto [result, msg] = packet.Read();
     ASSERT_EQ(ReadNetPacketResponse::END_OF_FILE, result);
   }
-}
\ No newline at end of file
+}
+TEST(FidoPacketsTest, WriteMultipleMessages) {
+  FileHelper helper;
+  FakeClock clock(DateTime::now());
+  const auto header = CreateType2PlusPacketHeader(FidoAddress("1:2/3"), FidoAddress("1:2/4"),
+                                                  clock.Now(), "PW");
+  auto o = FidoPacket::Create(helper.TempDir(), header, clock);
+  ASSERT_TRUE(o.has_value());
+  auto& packet = o.value();
+
+  for (const auto& subject : {"one", "two"}) {
+    fido_packed_message_t nh{};
+    nh.message_type = 2;
+    fido_variable_length_header_t vh{};
+    vh.date_time = "01 Jan 21  12:00:00";
+    vh.to_user_name = "All";
+    vh.from_user_name = "Sysop";
+    vh.subject = subject;
+    vh.text = "Hello\r";
+    ASSERT_TRUE(packet.Write(FidoPackedMessage(nh, vh)));
+  }
+  packet.Close();
+
+  const auto path = FilePath(helper.TempDir(), packet_name(clock.Now()));
+  auto r = FidoPacket::Open(path);
+  ASSERT_TRUE(r.has_value()) << path;
+  {
+    auto [result, msg] = r->Read();
+    ASSERT_EQ(ReadNetPacketResponse::OK, result);
+    EXPECT_EQ("one", msg.vh.subject);
+  }
+  {
+    auto [result, msg] = r->Read();
+    ASSERT_EQ(ReadNetPacketResponse::OK, result);
+    EXPECT_EQ("two", msg.vh.subject);
+    EXPECT_EQ("Hello\r", msg.vh.text);
+  }
+  {
+    auto [result, msg] = r->Read();
+    ASSERT_EQ(ReadNetPacketResponse::END_OF_FILE, result);
+  }
+}
+
+TEST_F(FidoPacketsTestDataTest, Reader_ThreeMessages) {
+  const auto path = FilePath(FileHelper::TestData(), "fido/0e7c5b69.pkt");
+  FtnPacketReader reader(path);
+  ASSERT_TRUE(reader);
+  EXPECT_EQ(reader.header().orig_zone, 21);
+  EXPECT_EQ(reader.header().orig_net, 1);
+  EXPECT_EQ(reader.header().orig_node, 2);
+
+  auto o = FidoPacket::Open(path);
+  ASSERT_TRUE(o.has_value());
+  EXPECT_EQ(o->password(), reader.password());
+
+  fido_packed_message_view_t view;
+  for (const auto* subject : {"test5", "test 6", "test 7"}) {
+    ASSERT_EQ(ReadNetPacketResponse::OK, reader.Next(view));
+    auto [result, msg] = o->Read();
+    ASSERT_EQ(ReadNetPacketResponse::OK, result);
+    EXPECT_EQ(subject, view.subject);
+    EXPECT_EQ(msg.vh.date_time, view.date_time);
+    EXPECT_EQ(msg.vh.to_user_name, view.to_user_name);
+    EXPECT_EQ(msg.vh.from_user_name, view.from_user_name);
+    EXPECT_EQ(msg.vh.text, view.text);
+  }
+  EXPECT_EQ(ReadNetPacketResponse::END_OF_FILE, reader.Next(view));
+}
+
+TEST(FidoPacketsTest, Reader_FromMemory) {
+  const packet_header_2p_t header{};
+  std::string s(reinterpret_cast<const char*>(&header), sizeof(packet_header_2p_t));
+  fido_packed_message_t nh{};
+  nh.message_type = 2;
+  nh.orig_node = 3;
+  s.append(reinterpret_cast<const char*>(&nh), sizeof(fido_packed_message_t));
+  s.append("01 Jan 21  12:00:00");
+  s.push_back('\0');
+  s.append("All");
+  s.push_back('\0');
+  s.append("Sysop");
+  s.push_back('\0');
+  s.append("Subject");
+  s.push_back('\0');
+  s.append("Hello\r");
+  s.push_back('\0');
+  s.append(2, '\0');
+
+  FtnPacketReader reader(s);
+  ASSERT_TRUE(reader);
+  fido_packed_message_view_t view;
+  ASSERT_EQ(ReadNetPacketResponse::OK, reader.Next(view));
+  EXPECT_EQ(3, view.nh.orig_node);
+  EXPECT_EQ("01 Jan 21  12:00:00", view.date_time);
+  EXPECT_EQ("All", view.to_user_name);
+  EXPECT_EQ("Sysop", view.from_user_name);
+  EXPECT_EQ("Subject", view.subject);
+  EXPECT_EQ("Hello\r", view.text);
+
+  const auto msg = view.to_message();
+  EXPECT_EQ("Subject", msg.vh.subject);
+  EXPECT_EQ("Hello\r", msg.vh.text);
+  EXPECT_EQ(ReadNetPacketResponse::END_OF_FILE, reader.Next(view));
+}
+
+TEST(FidoPacketsTest, Reader_Truncated) {
+  const packet_header_2p_t header{};
+  std::string s(reinterpret_cast<const char*>(&header), sizeof(packet_header_2p_t));
+  s.append("\x02\0\x01", 3);
+
+  FtnPacketReader reader(s);
+  ASSERT_TRUE(reader);
+  fido_packed_message_view_t view;
+  EXPECT_EQ(ReadNetPacketResponse::ERROR, reader.Next(view));
+}
+
+TEST(FidoPacketsTest, Reader_ShortHeader) {
+  FtnPacketReader reader(std::string("short"));
+  EXPECT_FALSE(reader);
+}
@@ -23,7 +23,9 @@
 #include "core/stl.h"
 #include "core/strings.h"
 #include "core/textfile.h"
+#include "core/log.h"
 #include "fmt/printf.h"
+#include "sdk/fido/nodelist_index.h"
 #include <set>
 #include <string>
 #include <utility>
@@ -164,6 +166,8 @@ Nodelist::Nodelist(const std::filesystem::path& path, std::string domain)
 Nodelist::Nodelist(const std::vector<std::string>& lines, std::string domain) 
   : domain_(std::move(domain)), initialized_(Load(lines)) {}
 
+Nodelist::~Nodelist() = default;
+
 bool Nodelist::AddEntry(uint16_t zone, uint16_t net, NodelistEntry& e) {
   if (zone == 0 || net == 0) {
     // skip malformed entries.
@@ -224,12 +228,55 @@ bool Nodelist::HandleLine(const std::string& line, uint16_t& zone, uint16_t& reg
 }
 
 bool Nodelist::Load(const std::filesystem::path& path) {
+  if (!File::Exists(path)) {
+    return false;
+  }
+  const auto source_mtime = static_cast<int64_t>(File::last_write_time(path));
+  const auto source_size = static_cast<uint64_t>(File(path).length());
+  const auto index_path = NodelistIndex::IndexPath(path);
+  if (File::Exists(index_path)) {
+    auto index = std::make_unique<NodelistIndex>(index_path);
+    if (index->is_current(source_mtime, source_size)) {
+      index_ = std::move(index);
+      return true;
+    }
+    VLOG(1) << "Nodelist index is out of date: " << index_path;
+  }
+
   TextFile f(path, "rt");
   if (!f) {
     return false;
   }
   const auto lines = f.ReadFileIntoVector();
-  return Load(lines);
+  f.Close();
+  if (!Load(lines)) {
+    return false;
+  }
+
+  // Save the compiled index for next time, and remove the ones for
+  // older nodelists.
+  const auto data = NodelistIndex::Compile(entries_, source_mtime, source_size);
+  // From here on entries_ is only a cache of entries read from the index.
+  entries_.clear();
+  all_entries_loaded_ = false;
+  const auto stem = path.stem().string();
+  FindFiles ff(FilePath(path.parent_path(), StrCat(stem, "_*.nlx")), FindFiles::FindFilesType::files);
+  for (const auto& old : ff) {
+    const auto old_path = FilePath(path.parent_path(), old.name);
+    if (!iequals(old_path.filename().string(), index_path.filename().string())) {
+      File::Remove(old_path);
+    }
+  }
+  // Other processes may have the old index mapped, so never rewrite it in place.
+  if (File::WriteAtomically(index_path, data.data(), static_cast<File::size_type>(data.size()))) {
+    if (auto index = std::make_unique<NodelistIndex>(index_path); index->initialized()) {
+      index_ = std::move(index);
+      return true;
+    }
+  }
+  LOG(WARNING) << "Unable to write nodelist index: " << index_path << "; using it from memory.";
+  index_ = std::make_unique<NodelistIndex>(data);
+  return index_->initialized();
 }
 
 bool Nodelist::Load(const std::vector<std::string>& lines) {
@@ -241,21 +288,35 @@ bool Nodelist::Load(const std::vector<std::string>& lines) {
     auto line = StringTrim(raw_line);
     HandleLine(line, zone, region, net, hub);
   }
+  // We already have everything parsed, so use these as the cache too.
+  index_ = std::make_unique<NodelistIndex>(NodelistIndex::Compile(entries_, 0, 0));
+  all_entries_loaded_ = true;
   return true;
 }
 
-const NodelistEntry& Nodelist::entry(const FidoAddress& a) const {
-  if (stl::contains(entries_, a)) {
-    return at(entries_, a);
+std::optional<size_t> Nodelist::find(const FidoAddress& a) const {
+  if (!index_) {
+    return std::nullopt;
   }
-  if (a.has_domain()) {
-    if (stl::contains(entries_, a.without_domain())) {
-      return at(entries_, a.without_domain());
-    }
-  } else {
-    if (stl::contains(entries_, a.with_domain(domain_))) {
-      return at(entries_, a.with_domain(domain_));
-    }
+  // Addresses without a domain match any domain, as does a nodelist
+  // without a domain.
+  if (a.has_domain() && !domain_.empty() && a.domain() != domain_) {
+    return std::nullopt;
+  }
+  return index_->find(a.zone(), a.net(), a.node(), std::max<int16_t>(0, a.point()));
+}
+
+const NodelistEntry& Nodelist::cached_entry(size_t pos) const {
+  const auto a = index_->address(pos, domain_);
+  if (const auto it = entries_.find(a); it != std::end(entries_)) {
+    return it->second;
+  }
+  return entries_.emplace(a, index_->entry(pos, domain_)).first->second;
+}
+
+const NodelistEntry& Nodelist::entry(const FidoAddress& a) const {
+  if (const auto pos = find(a)) {
+    return cached_entry(pos.value());
   }
   const auto s = fmt::format("Nodelist::entry: key missing: {} ", a.as_string(true, true));
   DLOG(FATAL) << s << ": at: \r\n" << os::stacktrace();
@@ -263,88 +324,90 @@ const NodelistEntry& Nodelist::entry(const FidoAddress& a) const {
 }
 
 bool Nodelist::contains(const FidoAddress& a) const {
-  if (stl::contains(entries_, a)) {
-    return true;
-  }
-  if (a.has_domain()) {
-    if (stl::contains(entries_, a.without_domain())) {
-      return true;
-    }
-  } else {
-    if (stl::contains(entries_, a.with_domain(domain_))) {
-      return true;
+  return find(a).has_value();
+}
+
+const std::map<FidoAddress, NodelistEntry>& Nodelist::entries() const {
+  if (!all_entries_loaded_ && index_) {
+    for (size_t i = 0; i < index_->size(); i++) {
+      cached_entry(i);
     }
+    all_entries_loaded_ = true;
   }
-  return false;
+  return entries_;
 }
 
 std::vector<NodelistEntry> Nodelist::entries(uint16_t zone, uint16_t net) const {
   std::vector<NodelistEntry> entries;
-  for (const auto& e : entries_) {
-    if (e.first.zone() == zone && e.first.net() == net) {
-      entries.push_back(e.second);
-    }
+  if (!index_) {
+    return entries;
+  }
+  const auto [first, last] = index_->range(zone, net);
+  for (auto i = first; i < last; i++) {
+    entries.push_back(cached_entry(i));
   }
   return entries;
 }
 
 std::vector<NodelistEntry> Nodelist::entries(uint16_t zone) const {
   std::vector<NodelistEntry> entries;
-  for (const auto& e : entries_) {
-    if (e.first.zone() == zone) {
-      entries.push_back(e.second);
-    }
+  if (!index_) {
+    return entries;
+  }
+  const auto [first, last] = index_->range(zone);
+  for (auto i = first; i < last; i++) {
+    entries.push_back(cached_entry(i));
   }
   return entries;
 }
 
 std::vector<uint16_t> Nodelist::zones() const {
-  std::set<uint16_t> s;
-  for (const auto& e : entries_) {
-    s.emplace(e.first.zone());
+  if (!index_) {
+    return {};
   }
-  std::vector<uint16_t> zones;
-  for (const auto& n : s) {
-    zones.emplace_back(n);
-  }
-  return zones;
+  return index_->zones();
 }
 
 std::vector<uint16_t> Nodelist::nets(uint16_t zone) const {
-  std::set<uint16_t> s;
-  for (const auto& e : entries_) {
-    if (e.first.zone() == zone) {
-      s.emplace(e.first.net());
-    }
+  if (!index_) {
+    return {};
   }
-  std::vector<uint16_t> nets;
-  for (const auto& n : s) {
-    nets.emplace_back(n);
-  }
-  return nets;
+  return index_->nets(zone);
 }
 
 std::vector<uint16_t> Nodelist::nodes(uint16_t zone, uint16_t net) const {
   std::vector<uint16_t> nodes;
-  for (const auto& e : entries_) {
-    if (e.first.zone() == zone && e.first.net() == net) {
-      nodes.emplace_back(e.first.node());
-    }
+  if (!index_) {
+    return nodes;
+  }
+  const auto [first, last] = index_->range(zone, net);
+  for (auto i = first; i < last; i++) {
+    nodes.emplace_back(index_->record(i).node);
   }
   return nodes;
 }
 
 const NodelistEntry* Nodelist::entry(uint16_t zone, uint16_t net, uint16_t node) {
-  const FidoAddress a(zone, net, node, 0, "");
-  if (!stl::contains(entries_, a)) {
+  if (!index_) {
     return nullptr;
   }
-  return &wwiv::stl::at(entries_, a);
+  const auto pos = index_->find(zone, net, node, 0);
+  if (!pos) {
+    return nullptr;
+  }
+  return &cached_entry(pos.value());
 }
 
 bool Nodelist::has_zone(int zone) const noexcept {
-  return std::any_of(std::begin(entries_), std::end(entries_), 
-    [zone](const auto& p) { return p.first.zone() == zone; });
+  if (!index_) {
+    return false;
+  }
+  const auto [first, last] = index_->range(zone);
+  return first != last;
+}
+
+size_t Nodelist::size() const noexcept {
+  return index_ ? index_->size() : 0;
 }
 
 static int year_of(time_t t) {
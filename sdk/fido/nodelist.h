@@ -22,6 +22,8 @@
 #include <cstdint>
 #include <filesystem>
 #include <map>
+#include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -34,6 +36,8 @@
 
 namespace wwiv::sdk::fido {
 
+class NodelistIndex;
+
 // The 1st entry of the 8 mandatory ones is the keyword.
 enum class NodelistKeyword {
   zone, region, host, hub, pvt, down, node
@@ -82,6 +86,8 @@ public:
   [[nodiscard]] std::string vmodem_hostname() const { return vmodem_hostname_; }
 
 private:
+  friend class NodelistIndex;
+
   FidoAddress address_;
   NodelistKeyword keyword_ = NodelistKeyword::node;
   uint16_t number_ = 0;
@@ -131,20 +137,29 @@ private:
 
 /**
  * Represents a FidoNet NodeList as defined in FRL-1003.
+ *
+ * When loaded from a file, the parsed nodelist is compiled into a binary
+ * index (see NodelistIndex) next to the nodelist, and later loads just map
+ * that index.  The index is rebuilt whenever the nodelist changes, or when
+ * a newer nodelist (i.e. a new day number) is used.
  */
 class Nodelist final {
 public:
   /** Parses address.  If it fails, throws bad_fidonet_address. */
   Nodelist(const std::filesystem::path& path, std::string domain);
   Nodelist(const std::vector<std::string>& lines, std::string domain);
-  ~Nodelist() = default;
+  ~Nodelist();
 
   [[nodiscard]] bool initialized() const { return initialized_; }
   explicit operator bool() const { return initialized_; }
 
   [[nodiscard]] const NodelistEntry& entry(const FidoAddress& a) const;
   [[nodiscard]] bool contains(const FidoAddress& a) const;
-  [[nodiscard]] const std::map<FidoAddress, NodelistEntry>& entries() const { return entries_; }
+  /**
+   * Returns all entries.  Note that this has to materialize every entry in
+   * the nodelist, so prefer the zone and net specific versions.
+   */
+  [[nodiscard]] const std::map<FidoAddress, NodelistEntry>& entries() const;
   [[nodiscard]] std::vector<NodelistEntry> entries(uint16_t zone, uint16_t net) const;
   [[nodiscard]] std::vector<NodelistEntry> entries(uint16_t zone) const;
   [[nodiscard]] std::vector<uint16_t> zones() const;
@@ -152,6 +167,8 @@ public:
   [[nodiscard]] std::vector<uint16_t> nodes(uint16_t zone, uint16_t net) const;
   [[nodiscard]] const NodelistEntry* entry(uint16_t zone, uint16_t net, uint16_t node);
   [[nodiscard]] bool has_zone(int zone) const noexcept;
+  [[nodiscard]] size_t size() const noexcept;
+  [[nodiscard]] bool empty() const noexcept { return size() == 0; }
 
   static std::string FindLatestNodelist(const std::filesystem::path& dir, const std::string& base);
 
@@ -161,8 +178,14 @@ private:
 
   bool AddEntry(uint16_t zone, uint16_t net, NodelistEntry& e);
   bool HandleLine(const std::string& line, uint16_t& zone, uint16_t& region, uint16_t& net, uint16_t& hub );
-  
-  std::map<FidoAddress, NodelistEntry> entries_;
+  [[nodiscard]] std::optional<size_t> find(const FidoAddress& a) const;
+  const NodelistEntry& cached_entry(size_t pos) const;
+
+  // Only populated while parsing, and as a cache of entries looked up
+  // from index_.
+  mutable std::map<FidoAddress, NodelistEntry> entries_;
+  mutable bool all_entries_loaded_{false};
+  std::unique_ptr<NodelistIndex> index_;
   std::string domain_;
   bool initialized_{false};
 };
@@ -0,0 +1,310 @@
+/**************************************************************************/
+/*                                                                        */
+/*                          WWIV Version 5.x                              */
+/*           Copyright (C)2022, WWIV Software Services                    */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/**************************************************************************/
+#include "sdk/fido/nodelist_index.h"
+
+#include "core/file.h"
+#include "core/log.h"
+#include "core/strings.h"
+#include "sdk/fido/nodelist.h"
+#include <algorithm>
+#include <cstring>
+#include <tuple>
+
+using namespace wwiv::core;
+using namespace wwiv::strings;
+
+namespace wwiv::sdk::fido {
+
+static constexpr char kSignature[] = "WWIVNLX\x1A";
+
+enum nodelist_index_flags : uint16_t {
+  nodelist_index_flag_cm = 0x0001,
+  nodelist_index_flag_icm = 0x0002,
+  nodelist_index_flag_mo = 0x0004,
+  nodelist_index_flag_lo = 0x0008,
+  nodelist_index_flag_mn = 0x0010,
+  nodelist_index_flag_bark_file = 0x0020,
+  nodelist_index_flag_bark_update = 0x0040,
+  nodelist_index_flag_wazoo_file = 0x0080,
+  nodelist_index_flag_wazoo_update = 0x0100,
+  nodelist_index_flag_binkp = 0x0200,
+  nodelist_index_flag_telnet = 0x0400,
+  nodelist_index_flag_vmodem = 0x0800,
+};
+
+static auto key_of(const nodelist_index_rec_t& r) {
+  return std::make_tuple(r.zone, r.net, r.node, r.point);
+}
+
+namespace {
+// Builds up the string pool, sharing storage for duplicate strings
+// (there are a lot of "-Unpublished-" phone numbers).
+class StringPool {
+public:
+  nodelist_index_string_t add(const std::string& s) {
+    if (s.empty()) {
+      return {0, 0};
+    }
+    if (const auto it = offsets_.find(s); it != std::end(offsets_)) {
+      return {it->second, static_cast<uint16_t>(std::min<size_t>(s.size(), UINT16_MAX))};
+    }
+    const auto offset = static_cast<uint32_t>(pool_.size());
+    pool_.append(s);
+    offsets_.emplace(s, offset);
+    return {offset, static_cast<uint16_t>(std::min<size_t>(s.size(), UINT16_MAX))};
+  }
+  [[nodiscard]] const std::string& pool() const { return pool_; }
+
+private:
+  std::string pool_;
+  std::map<std::string, uint32_t> offsets_;
+};
+} // namespace
+
+// static
+std::string NodelistIndex::Compile(const std::map<FidoAddress, NodelistEntry>& entries,
+                                   int64_t source_mtime, uint64_t source_size) {
+  StringPool pool;
+  std::vector<nodelist_index_rec_t> records;
+  records.reserve(entries.size());
+  for (const auto& [a, e] : entries) {
+    nodelist_index_rec_t r{};
+    r.zone = a.zone();
+    r.net = a.net();
+    r.node = a.node();
+    r.point = std::max<int16_t>(0, a.point());
+    r.keyword = static_cast<uint8_t>(e.keyword());
+    uint16_t f = 0;
+    if (e.cm()) f |= nodelist_index_flag_cm;
+    if (e.icm()) f |= nodelist_index_flag_icm;
+    if (e.mo()) f |= nodelist_index_flag_mo;
+    if (e.lo()) f |= nodelist_index_flag_lo;
+    if (e.mn()) f |= nodelist_index_flag_mn;
+    if (e.bark_file()) f |= nodelist_index_flag_bark_file;
+    if (e.bark_update()) f |= nodelist_index_flag_bark_update;
+    if (e.wazoo_file()) f |= nodelist_index_flag_wazoo_file;
+    if (e.wazoo_update()) f |= nodelist_index_flag_wazoo_update;
+    if (e.binkp()) f |= nodelist_index_flag_binkp;
+    if (e.telnet()) f |= nodelist_index_flag_telnet;
+    if (e.vmodem()) f |= nodelist_index_flag_vmodem;
+    r.flags = f;
+    r.baud_rate = e.baud_rate();
+    r.number = e.number();
+    r.binkp_port = static_cast<uint16_t>(e.binkp_port());
+    r.telnet_port = static_cast<uint16_t>(e.telnet_port());
+    r.vmodem_port = static_cast<uint16_t>(e.vmodem_port());
+    r.name = pool.add(e.name());
+    r.location = pool.add(e.location());
+    r.sysop_name = pool.add(e.sysop_name());
+    r.phone_number = pool.add(e.phone_number());
+    r.hostname = pool.add(e.hostname());
+    r.binkp_hostname = pool.add(e.binkp_hostname());
+    r.telnet_hostname = pool.add(e.telnet_hostname());
+    r.vmodem_hostname = pool.add(e.vmodem_hostname());
+    records.push_back(r);
+  }
+  std::sort(std::begin(records), std::end(records),
+            [](const auto& l, const auto& r) { return key_of(l) < key_of(r); });
+
+  std::vector<nodelist_index_net_t> nets;
+  for (uint32_t i = 0; i < records.size(); i++) {
+    const auto& r = records[i];
+    if (nets.empty() || nets.back().zone != r.zone || nets.back().net != r.net) {
+      nets.push_back({r.zone, r.net, i, 0});
+    }
+    ++nets.back().count;
+  }
+
+  nodelist_index_header_t h{};
+  memcpy(h.signature, kSignature, sizeof(h.signature));
+  h.version = kVersion;
+  h.num_records = static_cast<uint32_t>(records.size());
+  h.num_nets = static_cast<uint32_t>(nets.size());
+  h.strings_size = static_cast<uint32_t>(pool.pool().size());
+  h.source_mtime = source_mtime;
+  h.source_size = source_size;
+
+  std::string out;
+  out.reserve(sizeof(h) + records.size() * sizeof(nodelist_index_rec_t) +
+              nets.size() * sizeof(nodelist_index_net_t) + pool.pool().size());
+  out.append(reinterpret_cast<const char*>(&h), sizeof(h));
+  if (!records.empty()) {
+    out.append(reinterpret_cast<const char*>(records.data()),
+               records.size() * sizeof(nodelist_index_rec_t));
+  }
+  if (!nets.empty()) {
+    out.append(reinterpret_cast<const char*>(nets.data()), nets.size() * sizeof(nodelist_index_net_t));
+  }
+  out.append(pool.pool());
+  return out;
+}
+
+// static
+std::filesystem::path NodelistIndex::IndexPath(const std::filesystem::path& nodelist_path) {
+  // Use NODELIST_123.nlx for NODELIST.123 so that this never matches the
+  // NODELIST.* wildcard used by Nodelist::FindLatestNodelist.
+  auto fn = nodelist_path.filename().string();
+  std::replace(std::begin(fn), std::end(fn), '.', '_');
+  return nodelist_path.parent_path() / StrCat(fn, ".nlx");
+}
+
+NodelistIndex::NodelistIndex(const std::filesystem::path& path)
+    : file_(std::make_unique<MemoryMappedFile>(path)) {
+  if (!*file_) {
+    return;
+  }
+  initialized_ = Initialize(file_->view());
+}
+
+NodelistIndex::NodelistIndex(std::string data) : buffer_(std::move(data)) {
+  initialized_ = Initialize(buffer_);
+}
+
+bool NodelistIndex::Initialize(std::string_view data) {
+  if (data.size() < sizeof(nodelist_index_header_t)) {
+    return false;
+  }
+  header_ = reinterpret_cast<const nodelist_index_header_t*>(data.data());
+  if (memcmp(header_->signature, kSignature, sizeof(header_->signature)) != 0 ||
+      header_->version != kVersion) {
+    VLOG(1) << "Invalid nodelist index signature or version.";
+    return false;
+  }
+  const auto records_size = static_cast<size_t>(header_->num_records) * sizeof(nodelist_index_rec_t);
+  const auto nets_size = static_cast<size_t>(header_->num_nets) * sizeof(nodelist_index_net_t);
+  const auto expected = sizeof(nodelist_index_header_t) + records_size + nets_size + header_->strings_size;
+  if (data.size() != expected) {
+    LOG(WARNING) << "Nodelist index is truncated or corrupt; size: " << data.size()
+                 << "; expected: " << expected;
+    return false;
+  }
+  const auto* p = data.data() + sizeof(nodelist_index_header_t);
+  records_ = reinterpret_cast<const nodelist_index_rec_t*>(p);
+  nets_ = reinterpret_cast<const nodelist_index_net_t*>(p + records_size);
+  strings_ = p + records_size + nets_size;
+  num_records_ = header_->num_records;
+  num_nets_ = header_->num_nets;
+  return true;
+}
+
+bool NodelistIndex::is_current(int64_t source_mtime, uint64_t source_size) const noexcept {
+  return initialized_ && header_->source_mtime == source_mtime && header_->source_size == source_size;
+}
+
+std::optional<size_t> NodelistIndex::find(int zone, int net, int node, int point) const {
+  const auto key = std::make_tuple(zone, net, node, point);
+  const auto* end = records_ + num_records_;
+  const auto* it = std::lower_bound(records_, end, key, [](const auto& r, const auto& k) {
+    return std::make_tuple<int, int, int, int>(r.zone, r.net, r.node, r.point) < k;
+  });
+  if (it == end || std::make_tuple<int, int, int, int>(it->zone, it->net, it->node, it->point) != key) {
+    return std::nullopt;
+  }
+  return static_cast<size_t>(it - records_);
+}
+
+std::pair<size_t, size_t> NodelistIndex::range(int zone) const {
+  const auto* end = nets_ + num_nets_;
+  const auto* lo = std::lower_bound(nets_, end, zone, [](const auto& n, int z) { return n.zone < z; });
+  const auto* hi = std::upper_bound(lo, end, zone, [](int z, const auto& n) { return z < n.zone; });
+  if (lo == hi) {
+    return {0, 0};
+  }
+  const auto* last = hi - 1;
+  return {lo->first, last->first + last->count};
+}
+
+std::pair<size_t, size_t> NodelistIndex::range(int zone, int net) const {
+  const auto key = std::make_pair(zone, net);
+  const auto* end = nets_ + num_nets_;
+  const auto* it = std::lower_bound(nets_, end, key, [](const auto& n, const auto& k) {
+    return std::make_pair<int, int>(n.zone, n.net) < k;
+  });
+  if (it == end || it->zone != zone || it->net != net) {
+    return {0, 0};
+  }
+  return {it->first, it->first + it->count};
+}
+
+std::string NodelistIndex::str(const nodelist_index_string_t& s) const {
+  if (s.len == 0 || s.offset + s.len > header_->strings_size) {
+    return {};
+  }
+  return std::string(strings_ + s.offset, s.len);
+}
+
+FidoAddress NodelistIndex::address(size_t pos, const std::string& domain) const {
+  const auto& r = records_[pos];
+  return FidoAddress(r.zone, r.net, r.node, r.point, domain);
+}
+
+NodelistEntry NodelistIndex::entry(size_t pos, const std::string& domain) const {
+  const auto& r = records_[pos];
+  NodelistEntry e{};
+  e.address_ = address(pos, domain);
+  e.keyword_ = static_cast<NodelistKeyword>(r.keyword);
+  e.number_ = r.number;
+  e.name_ = str(r.name);
+  e.location_ = str(r.location);
+  e.sysop_name_ = str(r.sysop_name);
+  e.phone_number_ = str(r.phone_number);
+  e.baud_rate_ = r.baud_rate;
+  e.cm_ = r.flags & nodelist_index_flag_cm;
+  e.icm_ = r.flags & nodelist_index_flag_icm;
+  e.mo_ = r.flags & nodelist_index_flag_mo;
+  e.lo_ = r.flags & nodelist_index_flag_lo;
+  e.mn_ = r.flags & nodelist_index_flag_mn;
+  e.bark_file_ = r.flags & nodelist_index_flag_bark_file;
+  e.bark_update_ = r.flags & nodelist_index_flag_bark_update;
+  e.wazoo_file_ = r.flags & nodelist_index_flag_wazoo_file;
+  e.wazoo_update_ = r.flags & nodelist_index_flag_wazoo_update;
+  e.hostname_ = str(r.hostname);
+  e.binkp_ = r.flags & nodelist_index_flag_binkp;
+  e.binkp_port_ = r.binkp_port;
+  e.binkp_hostname_ = str(r.binkp_hostname);
+  e.telnet_ = r.flags & nodelist_index_flag_telnet;
+  e.telnet_port_ = r.telnet_port;
+  e.telnet_hostname_ = str(r.telnet_hostname);
+  e.vmodem_ = r.flags & nodelist_index_flag_vmodem;
+  e.vmodem_port_ = r.vmodem_port;
+  e.vmodem_hostname_ = str(r.vmodem_hostname);
+  return e;
+}
+
+std::vector<uint16_t> NodelistIndex::zones() const {
+  std::vector<uint16_t> zones;
+  for (size_t i = 0; i < num_nets_; i++) {
+    const auto z = static_cast<uint16_t>(nets_[i].zone);
+    if (zones.empty() || zones.back() != z) {
+      zones.push_back(z);
+    }
+  }
+  return zones;
+}
+
+std::vector<uint16_t> NodelistIndex::nets(int zone) const {
+  std::vector<uint16_t> nets;
+  const auto* end = nets_ + num_nets_;
+  for (const auto* it = std::lower_bound(nets_, end, zone, [](const auto& n, int z) { return n.zone < z; });
+       it != end && it->zone == zone; ++it) {
+    nets.push_back(static_cast<uint16_t>(it->net));
+  }
+  return nets;
+}
+
+} // namespace wwiv::sdk::fido
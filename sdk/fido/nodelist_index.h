@@ -0,0 +1,171 @@
+/**************************************************************************/
+/*                                                                        */
+/*                          WWIV Version 5.x                              */
+/*           Copyright (C)2022, WWIV Software Services                    */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/**************************************************************************/
+#ifndef INCLUDED_SDK_FIDO_NODELIST_INDEX_H
+#define INCLUDED_SDK_FIDO_NODELIST_INDEX_H
+
+#include "core/mmap_file.h"
+#include "sdk/fido/fido_address.h"
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * Compiled binary index of a FidoNet nodelist.
+ *
+ * The format is:
+ *
+ * nodelist_index_header_t
+ * nodelist_index_rec_t[num_records]   sorted by zone, net, node, point
+ * nodelist_index_net_t[num_nets]      sorted by zone, net
+ * string pool                         names, flags, hostnames, etc.
+ *
+ * The index is memory mapped, so looking up a single node is a binary search
+ * over the records, and listing a zone or net is a binary search over the
+ * nets table followed by a walk of a contiguous run of records.
+ */
+
+namespace wwiv::sdk::fido {
+
+class NodelistEntry;
+
+#pragma pack(push, 1)
+struct nodelist_index_header_t {
+  // "WWIVNLX^Z"
+  char signature[8];
+  uint32_t version;
+  uint32_t num_records;
+  uint32_t num_nets;
+  uint32_t strings_size;
+  // Last write time and size of the nodelist this was compiled from.
+  int64_t source_mtime;
+  uint64_t source_size;
+  uint8_t padding[8];
+};
+
+struct nodelist_index_string_t {
+  uint32_t offset;
+  uint16_t len;
+};
+
+struct nodelist_index_rec_t {
+  int16_t zone;
+  int16_t net;
+  int16_t node;
+  int16_t point;
+  // NodelistKeyword
+  uint8_t keyword;
+  uint8_t padding;
+  // nodelist_index_flag_xxx
+  uint16_t flags;
+  uint32_t baud_rate;
+  uint16_t number;
+  uint16_t binkp_port;
+  uint16_t telnet_port;
+  uint16_t vmodem_port;
+  nodelist_index_string_t name;
+  nodelist_index_string_t location;
+  nodelist_index_string_t sysop_name;
+  nodelist_index_string_t phone_number;
+  nodelist_index_string_t hostname;
+  nodelist_index_string_t binkp_hostname;
+  nodelist_index_string_t telnet_hostname;
+  nodelist_index_string_t vmodem_hostname;
+};
+
+struct nodelist_index_net_t {
+  int16_t zone;
+  int16_t net;
+  // Index of the first record in this net.
+  uint32_t first;
+  // Number of records in this net.
+  uint32_t count;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(nodelist_index_header_t) == 48, "nodelist_index_header_t == 48");
+static_assert(sizeof(nodelist_index_rec_t) == 72, "nodelist_index_rec_t == 72");
+static_assert(sizeof(nodelist_index_net_t) == 12, "nodelist_index_net_t == 12");
+
+class NodelistIndex final {
+public:
+  static constexpr uint32_t kVersion = 1;
+
+  /** Maps the compiled index at path. */
+  explicit NodelistIndex(const std::filesystem::path& path);
+  /** Uses an in memory compiled index, as returned by Compile. */
+  explicit NodelistIndex(std::string data);
+  ~NodelistIndex() = default;
+
+  /**
+   * Compiles entries into the binary index format.  source_mtime and
+   * source_size identify the nodelist the entries were parsed from.
+   */
+  static std::string Compile(const std::map<FidoAddress, NodelistEntry>& entries,
+                             int64_t source_mtime, uint64_t source_size);
+
+  /** Returns the path of the index file to use for the nodelist at nodelist_path. */
+  static std::filesystem::path IndexPath(const std::filesystem::path& nodelist_path);
+
+  [[nodiscard]] bool initialized() const noexcept { return initialized_; }
+  explicit operator bool() const noexcept { return initialized_; }
+
+  /** True if this index was compiled from a nodelist with this mtime and size. */
+  [[nodiscard]] bool is_current(int64_t source_mtime, uint64_t source_size) const noexcept;
+
+  [[nodiscard]] size_t size() const noexcept { return num_records_; }
+  [[nodiscard]] bool empty() const noexcept { return num_records_ == 0; }
+
+  /** Returns the position of zone:net/node.point, if present. */
+  [[nodiscard]] std::optional<size_t> find(int zone, int net, int node, int point = 0) const;
+  /** Returns the [first, last) range of records in zone. */
+  [[nodiscard]] std::pair<size_t, size_t> range(int zone) const;
+  /** Returns the [first, last) range of records in zone:net. */
+  [[nodiscard]] std::pair<size_t, size_t> range(int zone, int net) const;
+
+  [[nodiscard]] const nodelist_index_rec_t& record(size_t pos) const { return records_[pos]; }
+  [[nodiscard]] FidoAddress address(size_t pos, const std::string& domain) const;
+  /** Materializes the NodelistEntry at pos. */
+  [[nodiscard]] NodelistEntry entry(size_t pos, const std::string& domain) const;
+
+  [[nodiscard]] std::vector<uint16_t> zones() const;
+  [[nodiscard]] std::vector<uint16_t> nets(int zone) const;
+
+private:
+  bool Initialize(std::string_view data);
+  [[nodiscard]] std::string str(const nodelist_index_string_t& s) const;
+
+  std::unique_ptr<core::MemoryMappedFile> file_;
+  std::string buffer_;
+  const nodelist_index_header_t* header_{nullptr};
+  const nodelist_index_rec_t* records_{nullptr};
+  const nodelist_index_net_t* nets_{nullptr};
+  const char* strings_{nullptr};
+  size_t num_records_{0};
+  size_t num_nets_{0};
+  bool initialized_{false};
+};
+
+} // namespace wwiv::sdk::fido
+
+#endif
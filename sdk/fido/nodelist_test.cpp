@@ -19,11 +19,16 @@
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
 
+#include "core/file.h"
 #include "core/stl.h"
 #include "core/strings.h"
+#include "core/test/file_helper.h"
 #include "sdk/fido/nodelist.h"
+#include "sdk/fido/nodelist_index.h"
 #include <type_traits>
 
+using namespace wwiv::core;
+using namespace wwiv::core::test;
 using namespace wwiv::sdk;
 using namespace wwiv::stl;
 using namespace wwiv::strings;
@@ -167,4 +172,79 @@ TEST(NodelistTest, Nodes_261) {
 
   const auto nets = nl.nodes(1, 261);
   EXPECT_THAT(nets, testing::ElementsAre(1, 1300));
-}
\ No newline at end of file
+}
+TEST(NodelistTest, Domain) {
+  const auto lines = SplitString(raw, "\n");
+  const Nodelist nl(lines, "fidonet");
+  ASSERT_TRUE(nl);
+
+  EXPECT_TRUE(nl.contains(FidoAddress("1:261/1")));
+  EXPECT_TRUE(nl.contains(FidoAddress("1:261/1@fidonet")));
+  EXPECT_FALSE(nl.contains(FidoAddress("1:261/1@othernet")));
+  EXPECT_EQ("fidonet", nl.entry(FidoAddress("1:261/1")).address().domain());
+}
+
+TEST(NodelistTest, Entries_All) {
+  const auto lines = SplitString(raw, "\n");
+  const Nodelist nl(lines, "");
+  ASSERT_TRUE(nl);
+
+  EXPECT_EQ(nl.size(), nl.entries().size());
+  EXPECT_EQ(nl.entries(1).size() + nl.entries(42).size(), nl.size());
+}
+
+TEST(NodelistTest, Index_WrittenAndReused) {
+  FileHelper helper;
+  const auto path = helper.CreateTempFile("NODELIST.123", raw);
+  const auto index_path = NodelistIndex::IndexPath(path);
+  EXPECT_EQ("NODELIST_123.nlx", index_path.filename().string());
+
+  {
+    const Nodelist nl(path, "");
+    ASSERT_TRUE(nl);
+    ASSERT_TRUE(File::Exists(index_path));
+  }
+  const auto written_size = File(index_path).length();
+
+  const Nodelist nl(path, "");
+  ASSERT_TRUE(nl);
+  EXPECT_EQ(written_size, File(index_path).length());
+  const auto& e = nl.entry(FidoAddress("1:261/1300"));
+  EXPECT_EQ("Weather Station BBS (Mystic)", e.name());
+  EXPECT_EQ(24557u, e.binkp_port());
+}
+
+TEST(NodelistTest, Entries_AfterIndexBuilt) {
+  FileHelper helper;
+  const auto path = helper.CreateTempFile("NODELIST.123", raw);
+  ASSERT_FALSE(File::Exists(NodelistIndex::IndexPath(path)));
+
+  const Nodelist nl(path, "");
+  ASSERT_TRUE(nl);
+  ASSERT_TRUE(File::Exists(NodelistIndex::IndexPath(path)));
+  EXPECT_EQ(nl.size(), nl.entries().size());
+  EXPECT_EQ(1u, nl.entries().count(FidoAddress("1:261/1300")));
+}
+
+TEST(NodelistTest, Index_RebuiltForNewNodelist) {
+  FileHelper helper;
+  const auto path = helper.CreateTempFile("NODELIST.123", raw);
+  {
+    const Nodelist nl(path, "");
+    ASSERT_TRUE(nl);
+  }
+  const auto newer = helper.CreateTempFile("NODELIST.130", "Zone,2,Zone_2,Somewhere,Sysop,-Unpublished-,300\r\n"
+                                                           "Host,5,Net_5,Somewhere,Sysop,-Unpublished-,300\r\n"
+                                                           ",7,Node_7,Somewhere,Sysop,-Unpublished-,300\r\n");
+  const Nodelist nl(newer, "");
+  ASSERT_TRUE(nl);
+  EXPECT_TRUE(File::Exists(NodelistIndex::IndexPath(newer)));
+  EXPECT_FALSE(File::Exists(NodelistIndex::IndexPath(path)));
+  EXPECT_EQ(1u, nl.size());
+  EXPECT_TRUE(nl.contains(FidoAddress("2:5/7")));
+}
+
+TEST(NodelistIndexTest, Corrupt) {
+  NodelistIndex idx(std::string("WWIVNLX\x1A garbage"));
+  EXPECT_FALSE(idx);
+}
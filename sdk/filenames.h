@@ -53,6 +53,7 @@ constexpr auto CHAINS_JSON = "chains.json";
 #define CHAINS_NOEXT "chains"
 
 #define CHAT_INI "chat.ini"
+#define CHATBUS_DAT "chatbus.dat"
 #define CHECK_NET "check.net"
 
 #define CONFIG_DAT "config.dat"
@@ -87,6 +88,8 @@ constexpr auto CHAINS_JSON = "chains.json";
 #define FEDIT_INF "fedit.inf"
 #define FEEDBACK_NOEXT "feedback"
 #define FIDO_CALLOUT_JSON "fido_callout.json"
+#define FILECAT_DAT "filecat.dat"
+#define FILEKW_DAT "filekw.dat"
 #define FILESDL_NOEXT "filesdl"
 #define FILESUL_NOEXT "filesul"
 #define FILE_ID_DIZ "FILE_ID.DIZ"
@@ -125,10 +128,13 @@ constexpr auto CHAINS_JSON = "chains.json";
 
 #define MENUWEL_NOEXT "menuwel"
 #define MEXTRACT_NOEXT "mextract"
+// Directory under datadir for the metrics of programs run by wwivd.
+#define METRICS_DIR "metrics"
 #define MMAIL_NOEXT "mmail"
 
 // FTN style message IDs
 #define MSGDUPE_DAT "msgdupe.dat"
+#define MSGDUPE_IDX "msgdupe.idx"
 #define MSGID_DAT "msgid.dat"
 
 // Used by QBBS style editors.
@@ -176,6 +182,7 @@ constexpr auto CHAINS_JSON = "chains.json";
 #define SUBS_LST "subs.lst"
 #define SUBS_NOEXT "subs"
 #define SUBS_XTR "subs.xtr"
+#define SUBSTATS_DAT "substats.dat"
 #define SWFC_NOEXT "swfc"
 #define SYSTEM_NOEXT "system"
 
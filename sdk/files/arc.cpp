@@ -22,6 +22,7 @@
 #include "core/log.h"
 #include "core/strings.h"
 #include "sdk/filenames.h"
+#include "sdk/files/zip.h"
 #include "sdk/vardec.h"
 
 #include <string>
@@ -55,127 +56,23 @@ static time_t dos2time_t(uint16_t dos_date, uint16_t dos_time) {
 // https://www.hanshq.net/zip.html
 
 
-// .ZIP structures and defines
-static constexpr uint32_t ZIP_LOCAL_SIG = 0x04034b50;
-static constexpr uint32_t ZIP_CENT_START_SIG = 0x02014b50;
-static constexpr uint32_t ZIP_CENT_END_SIG = 0x06054b50;
-
-#pragma pack(push, 1)
-struct zip_local_header {
-  uint32_t signature; // 0x04034b50
-  uint16_t extract_ver;
-  uint16_t flags;
-  uint16_t comp_meth;
-  uint16_t mod_time;
-  uint16_t mod_date;
-  uint32_t crc_32;
-  uint32_t comp_size;
-  uint32_t uncomp_size;
-  uint16_t filename_len;
-  uint16_t extra_length;
-};
-
-struct zip_central_dir {
-  uint32_t signature; // 0x02014b50
-  uint16_t made_ver;
-  uint16_t extract_ver;
-  uint16_t flags;
-  uint16_t comp_meth;
-  uint16_t mod_time;
-  uint16_t mod_date;
-  uint32_t crc_32;
-  uint32_t comp_size;
-  uint32_t uncomp_size;
-  uint16_t filename_len;
-  uint16_t extra_len;
-  uint16_t comment_len;
-  uint16_t disk_start;
-  uint16_t int_attr;
-  uint32_t ext_attr;
-  uint32_t rel_ofs_header;
-};
-
-struct zip_end_dir {
-  uint32_t signature; // 0x06054b50
-  uint16_t disk_num;
-  uint16_t cent_dir_disk_num;
-  uint16_t total_entries_this_disk;
-  uint16_t total_entries_total;
-  uint32_t central_dir_size;
-  uint32_t ofs_cent_dir;
-  uint16_t comment_len;
-};
-#pragma pack(pop)
-
-archive_method_t zip_method(int z) {
-  if (z == 0) {
-    return archive_method_t::ZIP_STORED;
-  }
-  if (z == 8) {
-    return archive_method_t::ZIP_DEFLATED;
-  }
-  return archive_method_t::UNKNOWN;
-}
-
-template <typename Z> archive_entry_t create_archive_entry(const Z& z, const char* fn) { 
-  archive_entry_t a;
-  a.filename =  StringTrim(fn);
-  a.crc32 = z.crc_32;
-  a.dt = dos2time_t(z.mod_date, z.mod_time);
-  a.compress_size = z.comp_size;
-  a.uncompress_size = z.uncomp_size;
-  a.method = zip_method(z.comp_meth);
-  return a;
-}
-
 static std::optional<std::vector<archive_entry_t>>
 list_archive_zip(const std::filesystem::path& path) {
-  std::vector<archive_entry_t> files;
-
-  File file(path);
-  if (!file.Open(File::modeBinary | File::modeReadOnly)) {
+  const ZipReader zip(path);
+  if (!zip) {
     return std::nullopt;
   }
-  long l = 0;
-  const auto len = file.length();
-  bool done = false;
-  while (l < len && !done) {
-    long sig = 0;
-    file.Seek(l, File::Whence::begin);
-    file.Read(&sig, 4);
-    file.Seek(l, File::Whence::begin);
-    switch (sig) {
-    case ZIP_LOCAL_SIG: {
-      zip_local_header zl{};
-      char s[1024];
-      file.Read(&zl, sizeof(zl));
-      file.Read(s, zl.filename_len);
-      s[zl.filename_len] = '\0';
-      // Since zip_central_dir and zip_local_header both have the same
-      // information, don't add it here.
-      // files.emplace_back(create_archive_entry(zl, s));
-      // VLOG(1) << "ZIP_LOCAL_SIG: " << s;
-      l += static_cast<long>(sizeof(zl)) + zl.comp_size + zl.filename_len + zl.extra_length;
-    } break;
-    case ZIP_CENT_START_SIG: {
-      zip_central_dir zc{};
-      char s[1024];
-      file.Read(&zc, sizeof(zc));
-      file.Read(s, zc.filename_len);
-      s[zc.filename_len] = '\0';
-      VLOG(1) << "ZIP_CENT_START_SIG: " << s;
-      files.emplace_back(create_archive_entry(zc, s));
-      l += sizeof(zc);
-      l += zc.filename_len + zc.extra_len;
-    } break;
-    case ZIP_CENT_END_SIG:
-      [[fallthrough]];
-    default: 
-      done = true;
-      break;
-    }
+  std::vector<archive_entry_t> files;
+  for (const auto& z : zip.entries()) {
+    archive_entry_t a{};
+    a.filename = StringTrim(z.filename);
+    a.crc32 = z.crc32;
+    a.dt = z.dt;
+    a.compress_size = static_cast<int32_t>(z.compress_size);
+    a.uncompress_size = static_cast<int32_t>(z.uncompress_size);
+    a.method = z.method;
+    files.emplace_back(a);
   }
-  file.Close();
   return {files};
 }
 
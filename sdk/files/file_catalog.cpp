@@ -0,0 +1,288 @@
+/**************************************************************************/
+/*                                                                        */
+/*                          WWIV Version 5.x                              */
+/*           Copyright (C)2022, WWIV Software Services                    */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/**************************************************************************/
+#include "sdk/files/file_catalog.h"
+
+#include "core/file.h"
+#include "core/log.h"
+#include "core/stl.h"
+#include "core/strings.h"
+#include "sdk/filenames.h"
+#include "sdk/files/files.h"
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+using namespace wwiv::core;
+using namespace wwiv::strings;
+
+namespace wwiv::sdk::files {
+
+static const char kSignature[8] = {'W', 'W', 'I', 'V', 'C', 'A', 'T', '\x1A'};
+
+static bool entry_less(const file_catalog_entry_t& l, const file_catalog_entry_t& r) {
+  if (l.daten != r.daten) {
+    return l.daten < r.daten;
+  }
+  if (l.area != r.area) {
+    return l.area < r.area;
+  }
+  return l.record < r.record;
+}
+
+static std::string_view aligned_name(const file_catalog_entry_t& e) {
+  return std::string_view(e.aligned_name, sizeof(e.aligned_name));
+}
+
+static std::filesystem::path dir_path(const std::filesystem::path& data_directory,
+                                      const std::string& filename) {
+  return core::FilePath(data_directory, StrCat(filename, ".dir"));
+}
+
+FileCatalog::FileCatalog(std::filesystem::path data_directory)
+    : data_directory_(std::move(data_directory)) {}
+
+std::filesystem::path FileCatalog::path() const {
+  return core::FilePath(data_directory_, FILECAT_DAT);
+}
+
+bool FileCatalog::Load() {
+  areas_.clear();
+  area_numbers_.clear();
+  entries_.clear();
+  by_name_valid_ = false;
+  dirty_ = false;
+
+  File file(path());
+  if (!file.Open(File::modeBinary | File::modeReadOnly)) {
+    return false;
+  }
+  auto lock = file.lock(FileLockType::read_lock);
+  file_catalog_header_t h{};
+  if (file.Read(&h, sizeof(h)) != static_cast<File::size_type>(sizeof(h)) ||
+      memcmp(h.signature, kSignature, sizeof(kSignature)) != 0 || h.version != kVersion) {
+    LOG(WARNING) << "Ignoring invalid file catalog: " << path();
+    return false;
+  }
+  const auto expected = sizeof(h) + h.num_areas * sizeof(file_catalog_area_t) +
+                        h.num_entries * sizeof(file_catalog_entry_t);
+  if (static_cast<size_t>(file.length()) != expected) {
+    LOG(WARNING) << "Ignoring truncated file catalog: " << path();
+    return false;
+  }
+  std::vector<file_catalog_area_t> areas(h.num_areas);
+  std::vector<file_catalog_entry_t> entries(h.num_entries);
+  const auto areas_size = static_cast<File::size_type>(areas.size() * sizeof(file_catalog_area_t));
+  const auto entries_size =
+      static_cast<File::size_type>(entries.size() * sizeof(file_catalog_entry_t));
+  if (file.Read(areas.data(), areas_size) != areas_size ||
+      file.Read(entries.data(), entries_size) != entries_size) {
+    LOG(WARNING) << "Error reading file catalog: " << path();
+    return false;
+  }
+  for (auto i = 0; i < stl::size_int(areas); i++) {
+    auto& a = areas[i];
+    a.filename[sizeof(a.filename) - 1] = '\0';
+    area_numbers_.emplace(a.filename, static_cast<uint16_t>(i));
+  }
+  areas_ = std::move(areas);
+  entries_ = std::move(entries);
+  return true;
+}
+
+bool FileCatalog::Save() {
+  file_catalog_header_t h{};
+  memcpy(h.signature, kSignature, sizeof(kSignature));
+  h.version = kVersion;
+  h.num_areas = static_cast<uint32_t>(areas_.size());
+  h.num_entries = static_cast<uint32_t>(entries_.size());
+  std::string b;
+  b.append(reinterpret_cast<const char*>(&h), sizeof(h));
+  b.append(reinterpret_cast<const char*>(areas_.data()),
+           areas_.size() * sizeof(file_catalog_area_t));
+  b.append(reinterpret_cast<const char*>(entries_.data()),
+           entries_.size() * sizeof(file_catalog_entry_t));
+  if (!File::WriteAtomically(path(), b.data(), stl::ssize(b))) {
+    LOG(ERROR) << "Error writing file catalog: " << path();
+    return false;
+  }
+  dirty_ = false;
+  return true;
+}
+
+uint16_t FileCatalog::area_number(const std::string& filename) {
+  if (const auto it = area_numbers_.find(filename); it != std::end(area_numbers_)) {
+    return it->second;
+  }
+  file_catalog_area_t a{};
+  to_char_array(a.filename, filename);
+  const auto num = static_cast<uint16_t>(areas_.size());
+  areas_.push_back(a);
+  area_numbers_.emplace(filename, num);
+  return num;
+}
+
+void FileCatalog::UpdateArea(const std::string& filename, const std::vector<uploadsrec>& files) {
+  const auto area = area_number(filename);
+  entries_.erase(std::remove_if(std::begin(entries_), std::end(entries_),
+                                [area](const auto& e) { return e.area == area; }),
+                 std::end(entries_));
+
+  const auto num_existing = entries_.size();
+  // Record 0 is the area header.
+  for (auto i = 1; i < stl::size_int(files); i++) {
+    const auto& u = files[i];
+    file_catalog_entry_t e{};
+    e.area = area;
+    e.record = static_cast<uint32_t>(i);
+    e.daten = u.daten;
+    e.numbytes = u.numbytes;
+    memcpy(e.aligned_name, u.filename, sizeof(e.aligned_name));
+    entries_.push_back(e);
+  }
+  const auto mid = std::begin(entries_) + num_existing;
+  std::sort(mid, std::end(entries_), entry_less);
+  std::inplace_merge(std::begin(entries_), mid, std::end(entries_), entry_less);
+
+  const auto dir = dir_path(data_directory_, filename);
+  std::error_code ec;
+  auto& a = areas_.at(area);
+  a.generation = files.empty() ? 0 : FileAreaHeader(files.front()).generation();
+  a.dir_mtime = File::Exists(dir) ? File::last_write_time(dir) : 0;
+  a.dir_size = std::filesystem::file_size(dir, ec);
+  if (ec) {
+    a.dir_size = 0;
+  }
+  by_name_valid_ = false;
+  dirty_ = true;
+}
+
+bool FileCatalog::IsCurrent(const std::string& filename) const {
+  const auto it = area_numbers_.find(filename);
+  if (it == std::end(area_numbers_)) {
+    return false;
+  }
+  const auto& a = areas_.at(it->second);
+  const auto dir = dir_path(data_directory_, filename);
+  std::error_code ec;
+  const auto mtime = File::Exists(dir) ? File::last_write_time(dir) : 0;
+  auto size = std::filesystem::file_size(dir, ec);
+  if (ec) {
+    size = 0;
+  }
+  return a.dir_mtime == mtime && a.dir_size == size &&
+         a.generation == FileAreaHeader::ReadGeneration(dir);
+}
+
+int FileCatalog::Refresh(FileApi& api, const std::vector<std::string>& filenames) {
+  auto num = 0;
+  for (const auto& filename : filenames) {
+    if (IsCurrent(filename)) {
+      continue;
+    }
+    VLOG(2) << "Indexing file area: " << filename;
+    if (auto area = api.Open(filename)) {
+      UpdateArea(filename, area->raw_files());
+    } else {
+      UpdateArea(filename, {});
+    }
+    ++num;
+  }
+  if (dirty_) {
+    Save();
+  }
+  return num;
+}
+
+void FileCatalog::build_name_index() const {
+  if (by_name_valid_) {
+    return;
+  }
+  by_name_.resize(entries_.size());
+  for (auto i = 0; i < stl::size_int(by_name_); i++) {
+    by_name_[i] = static_cast<uint32_t>(i);
+  }
+  std::sort(std::begin(by_name_), std::end(by_name_), [this](uint32_t l, uint32_t r) {
+    return aligned_name(entries_[l]) < aligned_name(entries_[r]);
+  });
+  by_name_valid_ = true;
+}
+
+std::vector<file_catalog_entry_t> FileCatalog::Find(daten_t since,
+                                                    const std::string& aligned_mask) const {
+  const auto first = std::lower_bound(
+      std::begin(entries_), std::end(entries_), since,
+      [](const file_catalog_entry_t& e, daten_t d) { return e.daten < d; });
+  const auto num_by_date = std::distance(first, std::end(entries_));
+
+  std::vector<file_catalog_entry_t> result;
+  if (aligned_mask.size() != sizeof(file_catalog_entry_t::aligned_name)) {
+    if (!aligned_mask.empty()) {
+      LOG(WARNING) << "Ignoring invalid aligned mask: '" << aligned_mask << "'";
+    }
+    result.assign(first, std::end(entries_));
+    return result;
+  }
+
+  // Only entries starting with the mask up to the first wildcard can match.
+  const std::string_view mask{aligned_mask};
+  const auto prefix = mask.substr(0, mask.find('?'));
+  if (!prefix.empty()) {
+    build_name_index();
+    const auto name_first = std::lower_bound(
+        std::begin(by_name_), std::end(by_name_), prefix, [this](uint32_t i, std::string_view p) {
+          return aligned_name(entries_[i]).substr(0, p.size()) < p;
+        });
+    const auto name_last = std::upper_bound(
+        name_first, std::end(by_name_), prefix, [this](std::string_view p, uint32_t i) {
+          return p < aligned_name(entries_[i]).substr(0, p.size());
+        });
+    if (std::distance(name_first, name_last) < num_by_date) {
+      for (auto it = name_first; it != name_last; ++it) {
+        const auto& e = entries_[*it];
+        if (e.daten >= since && aligned_wildcard_match(aligned_mask, std::string(aligned_name(e)))) {
+          result.push_back(e);
+        }
+      }
+      std::sort(std::begin(result), std::end(result), entry_less);
+      return result;
+    }
+  }
+
+  for (auto it = first; it != std::end(entries_); ++it) {
+    if (aligned_wildcard_match(aligned_mask, std::string(aligned_name(*it)))) {
+      result.push_back(*it);
+    }
+  }
+  return result;
+}
+
+std::string FileCatalog::area_filename(uint16_t area) const {
+  if (area >= areas_.size()) {
+    return {};
+  }
+  return areas_[area].filename;
+}
+
+int FileCatalog::size() const noexcept {
+  return stl::size_int(entries_);
+}
+
+} // namespace wwiv::sdk::files
@@ -0,0 +1,153 @@
+/**************************************************************************/
+/*                                                                        */
+/*                          WWIV Version 5.x                              */
+/*           Copyright (C)2022, WWIV Software Services                    */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/**************************************************************************/
+#ifndef INCLUDED_SDK_FILES_FILE_CATALOG_H
+#define INCLUDED_SDK_FILES_FILE_CATALOG_H
+
+#include "sdk/vardec.h"
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace wwiv::sdk::files {
+
+class FileApi;
+
+#pragma pack(push, 1)
+
+/** Header of filecat.dat */
+struct file_catalog_header_t {
+  // "WWIVCAT" followed by ^Z
+  char signature[8];
+  uint32_t version;
+  uint32_t num_areas;
+  uint32_t num_entries;
+  uint8_t reserved[12];
+};
+static_assert(sizeof(file_catalog_header_t) == 32, "file_catalog_header_t == 32");
+
+/** A file area in filecat.dat */
+struct file_catalog_area_t {
+  // Name of the area's .dir file without the extension.
+  char filename[64];
+  // Size and modification time of the .dir file when it was indexed.
+  uint64_t dir_size;
+  int64_t dir_mtime;
+  // Generation from the header of the .dir file when it was indexed.
+  uint32_t generation;
+  uint8_t reserved[4];
+};
+static_assert(sizeof(file_catalog_area_t) == 88, "file_catalog_area_t == 88");
+
+/** A file in filecat.dat */
+struct file_catalog_entry_t {
+  // Index of the area in the catalog.
+  uint16_t area;
+  // Record number of the file in the area, as used by FileArea::ReadFile.
+  uint32_t record;
+  // Upload date of the file.
+  daten_t daten;
+  uint32_t numbytes;
+  // Aligned filename, i.e. "FOO     .ZIP" (not NUL terminated).
+  char aligned_name[12];
+};
+static_assert(sizeof(file_catalog_entry_t) == 26, "file_catalog_entry_t == 26");
+
+#pragma pack(pop)
+
+/**
+ * A catalog of the files in every file area, kept in filecat.dat in the data
+ * directory, so that new file scans and filename searches across all areas
+ * only need to open the areas which contain a matching file.
+ *
+ * Entries are kept sorted by upload date, so finding the files newer than a
+ * date is a binary search, and an index sorted by aligned filename is used to
+ * find files matching a mask without a leading wildcard.
+ *
+ * The catalog remembers the generation from the header of each area's .dir
+ * file (along with its size and modification time, for tools that don't
+ * update the generation), and areas changed outside of the FileApi used to
+ * load the catalog are indexed again by Refresh.  filecat.dat is replaced
+ * atomically when saved, so other processes never read a partial catalog.
+ */
+class FileCatalog final {
+public:
+  explicit FileCatalog(std::filesystem::path data_directory);
+  FileCatalog() = delete;
+  ~FileCatalog() = default;
+
+  static constexpr uint32_t kVersion = 2;
+
+  /** Loads filecat.dat, returning false (with an empty catalog) if it is missing or invalid. */
+  bool Load();
+  /** Writes filecat.dat */
+  bool Save();
+  [[nodiscard]] bool dirty() const noexcept { return dirty_; }
+
+  /**
+   * Replaces the entries for the area named filename with files (the raw
+   * records of the area including the header at index 0) and remembers the
+   * generation from the header along with the current size and modification
+   * time of the area's .dir file.
+   */
+  void UpdateArea(const std::string& filename, const std::vector<uploadsrec>& files);
+
+  /** True if the entries for the area named filename match its .dir file. */
+  [[nodiscard]] bool IsCurrent(const std::string& filename) const;
+
+  /**
+   * Indexes again each of the areas in filenames which are not current and
+   * saves the catalog if anything changed.  Returns the number of areas
+   * indexed.
+   */
+  int Refresh(FileApi& api, const std::vector<std::string>& filenames);
+
+  /**
+   * Returns the entries uploaded on or after since, whose filename matches
+   * the aligned wildcard mask (i.e. "FOO?????.ZIP").  An empty mask matches
+   * every file, as does an invalid mask.  Entries are returned in upload
+   * date order.
+   */
+  [[nodiscard]] std::vector<file_catalog_entry_t> Find(daten_t since,
+                                                       const std::string& aligned_mask) const;
+
+  /** Returns the filename of the area numbered area in this catalog. */
+  [[nodiscard]] std::string area_filename(uint16_t area) const;
+
+  [[nodiscard]] int size() const noexcept;
+  [[nodiscard]] std::filesystem::path path() const;
+
+private:
+  uint16_t area_number(const std::string& filename);
+  void build_name_index() const;
+
+  const std::filesystem::path data_directory_;
+  std::vector<file_catalog_area_t> areas_;
+  std::unordered_map<std::string, uint16_t> area_numbers_;
+  // Sorted by daten, area, record.
+  std::vector<file_catalog_entry_t> entries_;
+  // Indexes into entries_ sorted by aligned_name, built on first use.
+  mutable std::vector<uint32_t> by_name_;
+  mutable bool by_name_valid_{false};
+  bool dirty_{false};
+};
+
+} // namespace wwiv::sdk::files
+
+#endif
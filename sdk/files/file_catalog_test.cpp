@@ -0,0 +1,169 @@
+/**************************************************************************/
+/*                                                                        */
+/*                          WWIV Version 5.x                              */
+/*           Copyright (C)2022, WWIV Software Services                    */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/**************************************************************************/
+#include "gtest/gtest.h"
+
+#include "core/file.h"
+#include "core/strings.h"
+#include "sdk/filenames.h"
+#include "sdk/sdk_helper.h"
+#include "sdk/files/file_catalog.h"
+#include "sdk/files/files.h"
+#include "sdk/files/filesapi_helper.h"
+#include <string>
+#include <vector>
+
+using namespace wwiv::core;
+using namespace wwiv::sdk;
+using namespace wwiv::sdk::files;
+using namespace wwiv::strings;
+
+class FileCatalogTest : public testing::Test {
+public:
+  FileCatalogTest() : api_(helper.datadir()), api_helper_(&api_) {}
+
+  void SetUp() override { helper.SetUp(); }
+
+  static std::vector<std::string> names(const std::vector<file_catalog_entry_t>& entries) {
+    std::vector<std::string> v;
+    for (const auto& e : entries) {
+      v.emplace_back(e.aligned_name, sizeof(e.aligned_name));
+    }
+    return v;
+  }
+
+  SdkHelper helper;
+  FileApi api_;
+  FilesApiHelper api_helper_;
+};
+
+TEST_F(FileCatalogTest, Find_Since) {
+  FileCatalog cat(helper.datadir());
+  std::vector<uploadsrec> files{uploadsrec{}, ul("NEW.ZIP", "", 1, 300), ul("OLD.ZIP", "", 1, 100),
+                                ul("MID.ZIP", "", 1, 200)};
+  cat.UpdateArea("one", files);
+
+  EXPECT_EQ(3, cat.size());
+  EXPECT_EQ(std::vector<std::string>({"MID     .ZIP", "NEW     .ZIP"}), names(cat.Find(200, "")));
+  EXPECT_TRUE(cat.Find(301, "").empty());
+}
+
+TEST_F(FileCatalogTest, Find_Mask) {
+  FileCatalog cat(helper.datadir());
+  cat.UpdateArea("one", {uploadsrec{}, ul("FOO1.ZIP", "", 1, 100), ul("BAR.ZIP", "", 1, 100)});
+  cat.UpdateArea("two", {uploadsrec{}, ul("FOO2.TXT", "", 1, 200), ul("FOO3.ZIP", "", 1, 50)});
+
+  const auto r = cat.Find(0, "FOO?????.ZIP");
+  ASSERT_EQ(2u, r.size());
+  EXPECT_EQ(std::vector<std::string>({"FOO3    .ZIP", "FOO1    .ZIP"}), names(r));
+  EXPECT_EQ("two", cat.area_filename(r[0].area));
+  EXPECT_EQ(2u, r[0].record);
+  EXPECT_EQ("one", cat.area_filename(r[1].area));
+  EXPECT_EQ(1u, r[1].record);
+
+  EXPECT_EQ(std::vector<std::string>({"FOO3    .ZIP", "FOO1    .ZIP", "BAR     .ZIP"}),
+            names(cat.Find(0, "????????.ZIP")));
+  EXPECT_EQ(std::vector<std::string>({"FOO1    .ZIP"}), names(cat.Find(60, "FOO?????.ZIP")));
+}
+
+TEST_F(FileCatalogTest, UpdateArea_Replaces) {
+  FileCatalog cat(helper.datadir());
+  cat.UpdateArea("one", {uploadsrec{}, ul("FOO1.ZIP", "", 1, 100), ul("BAR.ZIP", "", 1, 100)});
+  cat.UpdateArea("one", {uploadsrec{}, ul("BAZ.ZIP", "", 1, 100)});
+
+  EXPECT_EQ(std::vector<std::string>({"BAZ     .ZIP"}), names(cat.Find(0, "")));
+}
+
+TEST_F(FileCatalogTest, SaveAndLoad) {
+  {
+    FileCatalog cat(helper.datadir());
+    cat.UpdateArea("one", {uploadsrec{}, ul("FOO1.ZIP", "", 1, 100)});
+    cat.UpdateArea("two", {uploadsrec{}, ul("FOO2.ZIP", "", 1, 200)});
+    ASSERT_TRUE(cat.Save());
+    EXPECT_FALSE(cat.dirty());
+  }
+
+  FileCatalog cat(helper.datadir());
+  ASSERT_TRUE(cat.Load());
+  const auto r = cat.Find(0, "FOO?????.ZIP");
+  EXPECT_EQ(std::vector<std::string>({"FOO1    .ZIP", "FOO2    .ZIP"}), names(r));
+  EXPECT_EQ("two", cat.area_filename(r.at(1).area));
+}
+
+TEST_F(FileCatalogTest, Load_Invalid) {
+  {
+    File f(FilePath(helper.datadir(), FILECAT_DAT));
+    ASSERT_TRUE(f.Open(File::modeBinary | File::modeWriteOnly | File::modeCreateFile));
+    f.Write("not a catalog");
+  }
+  FileCatalog cat(helper.datadir());
+  EXPECT_FALSE(cat.Load());
+  EXPECT_EQ(0, cat.size());
+}
+
+TEST_F(FileCatalogTest, FileArea_Save_UpdatesCatalog) {
+  auto& cat = api_.catalog();
+  auto area = api_helper_.CreateAndPopulate("one", {FileRecord{ul("FOO1.ZIP", "", 1, 100)}});
+  ASSERT_TRUE(area);
+  EXPECT_TRUE(cat.IsCurrent("one"));
+  EXPECT_EQ(std::vector<std::string>({"FOO1    .ZIP"}), names(cat.Find(0, "")));
+
+  ASSERT_TRUE(area->AddFile(FileRecord{ul("FOO2.ZIP", "", 1, 200)}));
+  ASSERT_TRUE(area->Save());
+  EXPECT_EQ(std::vector<std::string>({"FOO1    .ZIP", "FOO2    .ZIP"}), names(cat.Find(0, "")));
+}
+
+TEST_F(FileCatalogTest, Refresh) {
+  {
+    FileApi api(helper.datadir());
+    auto area = FilesApiHelper(&api).CreateAndPopulate(
+        "one", {FileRecord{ul("FOO1.ZIP", "", 1, 100)}, FileRecord{ul("FOO2.ZIP", "", 1, 200)}});
+    ASSERT_TRUE(area);
+  }
+
+  FileCatalog cat(helper.datadir());
+  EXPECT_FALSE(cat.IsCurrent("one"));
+  EXPECT_EQ(1, cat.Refresh(api_, {"one"}));
+  EXPECT_TRUE(cat.IsCurrent("one"));
+  EXPECT_EQ(0, cat.Refresh(api_, {"one"}));
+  EXPECT_EQ(std::vector<std::string>({"FOO2    .ZIP"}), names(cat.Find(150, "")));
+
+  FileCatalog loaded(helper.datadir());
+  ASSERT_TRUE(loaded.Load());
+  EXPECT_TRUE(loaded.IsCurrent("one"));
+  EXPECT_EQ(2, loaded.size());
+}
+
+TEST_F(FileCatalogTest, IsCurrent_SameSizeSaveByOther) {
+  auto& cat = api_.catalog();
+  ASSERT_TRUE(api_helper_.CreateAndPopulate("one", {FileRecord{ul("FOO1.ZIP", "", 1, 100)}}));
+  ASSERT_TRUE(cat.IsCurrent("one"));
+
+  {
+    // Another process replaces the file with one of the same size, likely
+    // within the same second.
+    FileApi other(helper.datadir());
+    auto area = other.Open("one");
+    ASSERT_TRUE(area);
+    ASSERT_TRUE(area->DeleteFile(1));
+    ASSERT_TRUE(area->AddFile(FileRecord{ul("BAR1.ZIP", "", 1, 100)}));
+    ASSERT_TRUE(area->Save());
+  }
+  EXPECT_FALSE(cat.IsCurrent("one"));
+  EXPECT_EQ(1, cat.Refresh(api_, {"one"}));
+  EXPECT_EQ(std::vector<std::string>({"BAR1    .ZIP"}), names(cat.Find(0, "")));
+}
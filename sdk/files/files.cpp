@@ -27,6 +27,8 @@
 #include "sdk/vardec.h"
 #include "sdk/files/files_ext.h"
 #include <algorithm>
+#include <cstring>
+#include <numeric>
 #include <string>
 #include <utility>
 
@@ -40,6 +42,15 @@ FileApi::FileApi(const std::filesystem::path& data_directory)
   clock_ = std::make_unique<SystemClock>();
 };
 
+FileApi::~FileApi() {
+  if (catalog_ && catalog_->dirty()) {
+    catalog_->Save();
+  }
+  if (keywords_ && keywords_->dirty()) {
+    keywords_->Save();
+  }
+}
+
 bool FileApi::Exist(const std::string& filename) const {
   return File::Exists(::FilePath(data_directory_, StrCat(filename, ".dir")));
 }
@@ -97,6 +108,31 @@ void FileApi::set_clock(std::unique_ptr<Clock> clock) {
   clock_ = std::move(clock);
 }
 
+FileCatalog& FileApi::catalog() {
+  if (!catalog_) {
+    catalog_ = std::make_unique<FileCatalog>(data_directory_);
+    catalog_->Load();
+  }
+  return *catalog_;
+}
+
+KeywordIndex& FileApi::keywords() {
+  if (!keywords_) {
+    keywords_ = std::make_unique<KeywordIndex>(data_directory_);
+    keywords_->Load();
+  }
+  return *keywords_;
+}
+
+void FileApi::area_saved(const std::string& filename, FileArea& area) {
+  if (catalog_) {
+    catalog_->UpdateArea(filename, area.raw_files());
+  }
+  if (keywords_) {
+    keywords_->UpdateArea(filename, area);
+  }
+}
+
 FileAreaHeader::FileAreaHeader(const uploadsrec& u) : u_(u) {}
 
 bool FileAreaHeader::FixHeader(const Clock& clock, uint32_t num_files) {
@@ -118,6 +154,28 @@ daten_t FileAreaHeader::daten() const {
   return u_.daten;
 }
 
+// The description of the header record is otherwise unused, so the
+// generation is kept in its first 4 bytes.
+uint32_t FileAreaHeader::generation() const {
+  uint32_t g;
+  memcpy(&g, u_.description, sizeof(g));
+  return g;
+}
+
+void FileAreaHeader::set_generation(uint32_t g) {
+  memcpy(u_.description, &g, sizeof(g));
+}
+
+// static
+uint32_t FileAreaHeader::ReadGeneration(const std::filesystem::path& path) {
+  DataFile<uploadsrec> file(path, File::modeReadOnly | File::modeBinary);
+  uploadsrec u{};
+  if (!file || !file.Read(0, &u)) {
+    return 0;
+  }
+  return FileAreaHeader(u).generation();
+}
+
 // Delegates to other constructor
 FileArea::FileArea(FileApi* api, const std::filesystem::path& data_directory, const directory_t& dir)
     : FileArea(api, data_directory, dir.filename) {
@@ -158,9 +216,22 @@ bool FileArea::Load() {
   }
   header_ = std::make_unique<FileAreaHeader>(files_.front());
   header_->FixHeader(*api_->clock(), files_.empty() ? 0 : stl::size_uint32(files_) - 1);
+  reset_origins();
   return open_;
 }
 
+void FileArea::reset_origins() {
+  origins_.resize(files_.size());
+  std::iota(std::begin(origins_), std::end(origins_), 0u);
+  base_generation_ = header_->generation();
+}
+
+void FileArea::mark_changed(const std::string& aligned_name) {
+  if (const auto num = FindFile(aligned_name); num && *num < stl::ssize(origins_)) {
+    origins_.at(*num) = 0;
+  }
+}
+
 bool FileArea::Close() {
   if (open_ && dirty_) {
     const auto r = Save();
@@ -215,7 +286,22 @@ bool FileArea::Sort(FileAreaSortType type) {
   const auto compare_funcs = CreateSortFunctions();
   // stl::at didn't work
   const auto& f = compare_funcs.at(type);
-  std::sort(std::begin(files_) + 1, std::end(files_), f);
+  // Sort the positions so the record origins can follow the files.
+  std::vector<size_t> order(files_.size());
+  std::iota(std::begin(order), std::end(order), size_t{0});
+  std::sort(std::begin(order) + 1, std::end(order),
+            [&](size_t l, size_t r) { return f(files_[l], files_[r]); });
+  std::vector<uploadsrec> files;
+  std::vector<uint32_t> origins;
+  const auto track = origins_.size() == files_.size();
+  for (const auto i : order) {
+    files.push_back(files_[i]);
+    if (track) {
+      origins.push_back(origins_[i]);
+    }
+  }
+  files_ = std::move(files);
+  origins_ = std::move(origins);
   dirty_ = true;
   return true;
 }
@@ -231,6 +317,9 @@ bool FileArea::AddFile(const FileRecord& f) {
   } else {
     files_.insert(std::begin(files_) + 1, f.u());
   }
+  if (!origins_.empty()) {
+    origins_.insert(std::begin(origins_) + std::min<size_t>(origins_.size(), 1), 0);
+  }
   header_->set_num_files(stl::size_uint32(files_) - 1);
   header_->set_daten(std::max(header_->daten(), f.u().daten));
   dirty_ = true;
@@ -250,6 +339,9 @@ bool FileArea::AddFile(FileRecord& f, const std::string& ext_desc) {
 
 bool FileArea::UpdateFile(FileRecord& f, int num) {
   files_.at(num) = f.u();
+  if (num < stl::ssize(origins_)) {
+    origins_.at(num) = 0;
+  }
   header_->set_daten(std::max(header_->daten(), f.u().daten));
   dirty_ = true;
   return true;
@@ -280,6 +372,7 @@ bool FileArea::DeleteFile(int file_number) {
   if (!stl::erase_at(files_, file_number)) {
     return false;
   }
+  stl::erase_at(origins_, file_number);
   // Attempt to delete the extended descriptions if they existed.
   if (old.mask & mask_extended) {
     DeleteExtendedDescription(old.filename);
@@ -319,6 +412,7 @@ bool FileArea::AddExtendedDescription(const std::string& file_name, const std::s
   if (!o) {
     return false;
   }
+  mark_changed(file_name);
   return o.value()->AddExtended(file_name, text);
 }
 
@@ -347,6 +441,7 @@ bool FileArea::DeleteExtendedDescription(const std::string& file_name) {
   if (!o) {
     return false;
   }
+  mark_changed(file_name);
   return o.value()->DeleteExtended(file_name);
 }
 
@@ -377,9 +472,14 @@ const std::vector<uploadsrec>& FileArea::raw_files() const {
 
 bool FileArea::set_raw_files(std::vector<uploadsrec> nf) {
   files_ = std::move(nf);
+  origins_.clear();
   return true;
 }
 
+const std::vector<uint32_t>& FileArea::record_origins() const noexcept {
+  return origins_;
+}
+
 std::optional<int> FileArea::FindFile(const FileRecord& f) {
   return FindFile(f.aligned_filename());
 }
@@ -433,11 +533,22 @@ bool FileArea::Save() {
 
   // Update Header
   FixFileHeader();
+  // Another process may have saved the area since it was loaded, so move past
+  // the generation on disk.
+  uploadsrec disk{};
+  const auto disk_generation = file.Read(0, &disk) ? FileAreaHeader(disk).generation() : 0;
+  header_->set_generation(std::max(header_->generation(), disk_generation) + 1);
   files_.at(0) = header_->u();
 
-  const auto result = file.WriteVectorAndTruncate(files_);
+  const auto result = file.Seek(0) && file.WriteVectorAndTruncate(files_);
   if (result) {
     dirty_ = false;
+    // Close first so the catalog sees the final size and time of the file.
+    file.Close();
+    if (api_) {
+      api_->area_saved(base_filename_, *this);
+    }
+    reset_origins();
   }
   return result;
 }
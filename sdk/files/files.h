@@ -21,8 +21,10 @@
 #include "dirs.h"
 #include "core/clock.h"
 #include "sdk/config.h"
+#include "sdk/files/file_catalog.h"
 #include "sdk/files/file_record.h"
 #include "sdk/files/files_ext.h"
+#include "sdk/files/keyword_index.h"
 #include <filesystem>
 #include <optional>
 #include <string>
@@ -41,7 +43,7 @@ enum class FileAreaSortType {
 
 class FileApi {
 public:
-  virtual ~FileApi() = default;
+  virtual ~FileApi();
   explicit FileApi(const std::filesystem::path& data_directory);
 
   [[nodiscard]] bool Exist(const std::string& filename) const;
@@ -56,9 +58,27 @@ public:
   [[nodiscard]] const core::Clock* clock() const noexcept;
   void set_clock(std::unique_ptr<core::Clock> clock);
 
+  /**
+   * Returns the catalog of the files in all areas, loading it on first use.
+   * Once loaded, areas saved through this FileApi update the catalog, and it
+   * is saved when this FileApi is destroyed.
+   */
+  [[nodiscard]] FileCatalog& catalog();
+
+  /**
+   * Returns the keyword index of the files in all areas, loading it on first
+   * use.  Like the catalog, it is kept up to date by FileArea::Save once loaded.
+   */
+  [[nodiscard]] KeywordIndex& keywords();
+
+  /** Called by FileArea::Save to update the catalog and keyword index when loaded. */
+  void area_saved(const std::string& filename, FileArea& area);
+
 private:
   const std::filesystem::path data_directory_;
   std::unique_ptr<core::Clock> clock_;
+  std::unique_ptr<FileCatalog> catalog_;
+  std::unique_ptr<KeywordIndex> keywords_;
 };
 
 /**
@@ -81,6 +101,15 @@ public:
   uploadsrec& u() { return u_; }
   void set_daten(daten_t d);
   [[nodiscard]] daten_t daten() const;
+  /**
+   * Incremented each time the area is saved, so other processes can tell
+   * that it changed even when the size and time of the .dir file didn't.
+   */
+  [[nodiscard]] uint32_t generation() const;
+  void set_generation(uint32_t g);
+
+  /** Returns the generation from the header of the .dir file at path, or 0. */
+  [[nodiscard]] static uint32_t ReadGeneration(const std::filesystem::path& path);
 private:
   uploadsrec u_;
 };
@@ -157,11 +186,22 @@ public:
   [[nodiscard]] const std::vector<uploadsrec>& raw_files() const;
   // Sets the raw files.  Do not use unless you are doing a "fix" type tool
   [[nodiscard]] bool set_raw_files(std::vector<uploadsrec>);
+  /**
+   * For each of the raw files, the record number it had when the area was
+   * loaded or last saved, or 0 if it was added or changed since.  Empty
+   * after set_raw_files, since the records can't be tracked then.
+   */
+  [[nodiscard]] const std::vector<uint32_t>& record_origins() const noexcept;
+  /** The generation of the area when it was loaded or last saved. */
+  [[nodiscard]] uint32_t base_generation() const noexcept { return base_generation_; }
   [[nodiscard]] std::filesystem::path path() const noexcept;
   [[nodiscard]] std::filesystem::path ext_path();
 
 protected:
   bool ValidateFileNum(const FileRecord& f, int num);
+  // Marks the record for the file named aligned_name as changed.
+  void mark_changed(const std::string& aligned_name);
+  void reset_origins();
 
   // Not owned.
   FileApi* api_;
@@ -173,6 +213,8 @@ protected:
   bool dirty_{false};
   bool open_{false};
   std::vector<uploadsrec> files_;
+  std::vector<uint32_t> origins_;
+  uint32_t base_generation_{0};
 
   std::unique_ptr<FileAreaHeader> header_;
   std::unique_ptr<FileAreaExtendedDesc> ext_desc_;
@@ -18,13 +18,19 @@
 #include "sdk/files/files_ext.h"
 
 #include "core/file.h"
+#include "core/log.h"
 #include "core/stl.h"
 #include "core/strings.h"
 #include "sdk/files/file_record.h"
 #include "sdk/files/files.h"
 #include "sdk/vardec.h"
 #include <algorithm>
+#include <cstring>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <tuple>
+#include <type_traits>
 #include <utility>
 
 using namespace wwiv::core;
@@ -45,42 +51,152 @@ FileAreaExtendedDesc::FileAreaExtendedDesc(FileApi* api,
     : api_(api), data_directory_(data_directory), filename_(StrCat(filename, ".ext")),
       num_files_(std::max<int>(std::numeric_limits<int16_t>::max(), num_files)) {}
 
+static const char kIndexSignature[8] = {'W', 'W', 'I', 'V', 'E', 'X', 'I', '\x1A'};
+
+// Compact the .ext file when more than half of it, and at least this many
+// bytes, is used by deleted descriptions.
+static constexpr uint64_t kMinCompactBytes = 4096;
+
+static std::pair<uint64_t, int64_t> stat_ext(const std::filesystem::path& path) {
+  std::error_code ec;
+  const auto size = std::filesystem::file_size(path, ec);
+  return {ec ? 0 : size, File::last_write_time(path)};
+}
+
+static bool rec_less(const ext_index_rec_t& l, const ext_index_rec_t& r) {
+  if (const auto c = strcmp(l.name, r.name); c != 0) {
+    return c < 0;
+  }
+  return l.offset < r.offset;
+}
+
 bool FileAreaExtendedDesc::Load() {
   Close();
 
-  File f(path());
-  if (!f.Open(File::modeReadOnly | File::modeBinary)) {
+  if (!File::Exists(path())) {
     return false;
   }
-  const auto file_size = f.length();
-  if (!file_size) {
+  if (ReadIndex()) {
     open_ = true;
     return true;
   }
-  for (long file_pos = 0, count = 0; file_pos < file_size && count <= num_files_; count++) {
-    f.Seek(file_pos, File::Whence::begin);
+
+  File f(path());
+  if (!f.Open(File::modeReadOnly | File::modeBinary)) {
+    return false;
+  }
+  std::string contents;
+  contents.resize(f.length());
+  if (f.Read(contents.data(), stl::ssize(contents)) != stl::ssize(contents)) {
+    return false;
+  }
+  f.Close();
+  if (!RebuildIndex(contents)) {
+    return false;
+  }
+  // Also remembers the size and time of the .ext file for EnsureCurrent.
+  WriteIndex();
+  open_ = true;
+  return true;
+}
+
+bool FileAreaExtendedDesc::ReadIndex() {
+  File file(index_path());
+  if (!file.Open(File::modeBinary | File::modeReadOnly, File::shareDenyNone)) {
+    return false;
+  }
+  ext_index_header_t h{};
+  if (file.Read(&h, sizeof(h)) != static_cast<File::size_type>(sizeof(h))) {
+    return false;
+  }
+  const auto [ext_size, ext_mtime] = stat_ext(path());
+  if (memcmp(h.signature, kIndexSignature, sizeof(kIndexSignature)) != 0 ||
+      h.version != kIndexVersion || h.ext_size != ext_size || h.ext_mtime != ext_mtime ||
+      static_cast<size_t>(file.length()) !=
+          sizeof(ext_index_header_t) + h.num_records * sizeof(ext_index_rec_t)) {
+    return false;
+  }
+  std::vector<ext_index_rec_t> index(h.num_records);
+  const auto size = static_cast<File::size_type>(index.size() * sizeof(ext_index_rec_t));
+  if (file.Read(index.data(), size) != size) {
+    return false;
+  }
+  index_ = std::move(index);
+  deleted_bytes_ = h.deleted_bytes;
+  ext_size_ = ext_size;
+  ext_mtime_ = ext_mtime;
+  return true;
+}
+
+bool FileAreaExtendedDesc::RebuildIndex(const std::string& contents) {
+  index_.clear();
+  deleted_bytes_ = 0;
+  const auto file_size = contents.size();
+  size_t file_pos = 0;
+  for (auto count = 0; file_pos + sizeof(ext_desc_type) <= file_size && count <= num_files_;
+       count++) {
     ext_desc_type ed{};
-    if (const auto num_read = f.Read(&ed, sizeof(ext_desc_type)); num_read != sizeof(ext_desc_type)) {
-      // LOG ERROR? Return false here?
+    memcpy(&ed, contents.data() + file_pos, sizeof(ext_desc_type));
+    ed.name[sizeof(ed.name) - 1] = '\0';
+    if (ed.len < 0) {
+      LOG(WARNING) << "Invalid extended description at offset " << file_pos << " in: " << path();
       break;
     }
-    ext_desc_rec e{};
-    strcpy(e.name, ed.name);
-    e.offset = file_pos;
-    ext_.emplace_back(e);
+    if (ed.name[0]) {
+      ext_index_rec_t r{};
+      strcpy(r.name, ed.name);
+      r.len = static_cast<uint16_t>(ed.len);
+      r.offset = static_cast<uint32_t>(file_pos);
+      index_.push_back(r);
+    } else {
+      deleted_bytes_ += sizeof(ext_desc_type) + ed.len;
+    }
+    file_pos += sizeof(ext_desc_type) + ed.len;
+  }
+  std::sort(std::begin(index_), std::end(index_), rec_less);
+  return true;
+}
+
+bool FileAreaExtendedDesc::WriteIndex() {
+  ext_index_header_t h{};
+  memcpy(h.signature, kIndexSignature, sizeof(kIndexSignature));
+  h.version = kIndexVersion;
+  h.num_records = static_cast<uint32_t>(index_.size());
+  std::tie(h.ext_size, h.ext_mtime) = stat_ext(path());
+  h.deleted_bytes = deleted_bytes_;
+  ext_size_ = h.ext_size;
+  ext_mtime_ = h.ext_mtime;
 
-    file_pos += ed.len + static_cast<int>(sizeof(ext_desc_type));
+  std::string b;
+  b.append(reinterpret_cast<const char*>(&h), sizeof(h));
+  b.append(reinterpret_cast<const char*>(index_.data()), index_.size() * sizeof(ext_index_rec_t));
+  if (!File::WriteAtomically(index_path(), b.data(), stl::ssize(b))) {
+    LOG(WARNING) << "Unable to write extended description index: " << index_path();
+    return false;
   }
-  open_ = true;
   return true;
 }
 
+std::pair<const ext_index_rec_t*, const ext_index_rec_t*>
+FileAreaExtendedDesc::find(const std::string& file_name) const {
+  const auto* first = index_.data();
+  const auto* last = first + index_.size();
+  return std::equal_range(first, last, file_name, [](const auto& l, const auto& r) {
+    if constexpr (std::is_same_v<std::decay_t<decltype(l)>, ext_index_rec_t>) {
+      return std::string_view(l.name) < std::string_view(r);
+    } else {
+      return std::string_view(l) < std::string_view(r.name);
+    }
+  });
+}
+
 bool FileAreaExtendedDesc::Save() {
   return false;
 }
 
 bool FileAreaExtendedDesc::Close() {
-  ext_.clear();
+  index_.clear();
+  deleted_bytes_ = 0;
   open_ = false;
   return true;
 }
@@ -89,31 +205,47 @@ int FileAreaExtendedDesc::number_of_ext_descriptions() {
   if (!open_) {
     Load();
   }
-  return wwiv::stl::size_int(ext_);
+  return stl::size_int(index_);
 }
 
 bool FileAreaExtendedDesc::AddExtended(const FileRecord& f, const std::string& text) {
   return AddExtended(f.aligned_filename(), text);
 }
 
+bool FileAreaExtendedDesc::EnsureCurrent() {
+  if (open_ && stat_ext(path()) == std::make_pair(ext_size_, ext_mtime_)) {
+    return true;
+  }
+  return Load();
+}
+
 bool FileAreaExtendedDesc::AddExtended(const std::string& file_name, const std::string& text) {
-  Close();
+  EnsureCurrent();
 
   ext_desc_type ed{};
   to_char_array(ed.name, file_name);
   ed.len = static_cast<int16_t>(text.size());
 
-  {
-    File file(path());
-    if (!file.Open(File::modeReadWrite | File::modeBinary | File::modeCreateFile)) {
-      return false;
-    }
-    file.Seek(0L, File::Whence::end);
-    file.Write(&ed, sizeof(ext_desc_type));
-    file.Write(text.c_str(), ed.len);
-    file.Close();
+  File file(path());
+  if (!file.Open(File::modeReadWrite | File::modeBinary | File::modeCreateFile)) {
+    return false;
+  }
+  const auto offset = file.Seek(0L, File::Whence::end);
+  file.Write(&ed, sizeof(ext_desc_type));
+  file.Write(text.c_str(), ed.len);
+  file.Close();
+
+  if (!open_) {
+    // The index will be rebuilt the next time it is needed.
+    return true;
   }
-  return Close();
+  ext_index_rec_t r{};
+  strcpy(r.name, ed.name);
+  r.len = static_cast<uint16_t>(ed.len);
+  r.offset = static_cast<uint32_t>(offset);
+  index_.insert(std::upper_bound(std::begin(index_), std::end(index_), r, rec_less), r);
+  WriteIndex();
+  return true;
 }
 
 bool FileAreaExtendedDesc::DeleteExtended(const FileRecord& f) {
@@ -122,37 +254,83 @@ bool FileAreaExtendedDesc::DeleteExtended(const FileRecord& f) {
 }
 
 bool FileAreaExtendedDesc::DeleteExtended(const std::string& file_name) {
+  if (!EnsureCurrent()) {
+    return true;
+  }
+  const auto [first, last] = find(file_name);
+  if (first == last) {
+    return true;
+  }
 
-  ext_desc_type ed{};
+  File file(path());
+  if (!file.Open(File::modeBinary | File::modeReadWrite)) {
+    return false;
+  }
+  for (auto* r = first; r != last; ++r) {
+    file.Seek(r->offset, File::Whence::begin);
+    ext_desc_type ed{};
+    if (file.Read(&ed, sizeof(ext_desc_type)) != sizeof(ext_desc_type) || file_name != ed.name) {
+      // The index doesn't match the .ext file.
+      file.Close();
+      Close();
+      return false;
+    }
+    memset(ed.name, 0, sizeof(ed.name));
+    file.Seek(r->offset, File::Whence::begin);
+    file.Write(&ed, sizeof(ext_desc_type));
+    deleted_bytes_ += sizeof(ext_desc_type) + ed.len;
+  }
+  const auto ext_size = file.length();
+  file.Close();
+
+  const auto first_pos = first - index_.data();
+  const auto last_pos = last - index_.data();
+  index_.erase(std::begin(index_) + first_pos, std::begin(index_) + last_pos);
 
+  if (deleted_bytes_ >= kMinCompactBytes &&
+      deleted_bytes_ * 2 > static_cast<uint64_t>(ext_size)) {
+    return Compact();
+  }
+  WriteIndex();
+  return true;
+}
+
+bool FileAreaExtendedDesc::Compact() {
   File file(path());
-  if (!file.Open(File::modeBinary | File::modeCreateFile | File::modeReadWrite)) {
+  if (!file.Open(File::modeBinary | File::modeReadWrite)) {
+    return false;
+  }
+  std::string contents;
+  contents.resize(file.length());
+  if (file.Read(contents.data(), stl::ssize(contents)) != stl::ssize(contents)) {
     return false;
   }
-  const auto file_size = file.length();
-  File::size_type r = 0, w = 0;
-  while (r < file_size) {
-    file.Seek(r, File::Whence::begin);
-    file.Read(&ed, sizeof(ext_desc_type));
-    if (ed.len < 10000) {
-      std::string ss;
-      ss.resize(ed.len);
-      file.Read(&ss[0], ed.len);
-      if (file_name != ed.name) {
-        if (r != w) {
-          file.Seek(w, File::Whence::begin);
-          file.Write(&ed, sizeof(ext_desc_type));
-          file.Write(ss.data(), ed.len);
-        }
-        w += sizeof(ext_desc_type) + ed.len;
-      }
+  std::string compacted;
+  compacted.reserve(contents.size());
+  for (size_t pos = 0; pos + sizeof(ext_desc_type) <= contents.size();) {
+    ext_desc_type ed{};
+    memcpy(&ed, contents.data() + pos, sizeof(ext_desc_type));
+    if (ed.len < 0) {
+      break;
     }
-    r += sizeof(ext_desc_type) + ed.len;
+    const auto rec_size = std::min(sizeof(ext_desc_type) + ed.len, contents.size() - pos);
+    if (ed.name[0]) {
+      compacted.append(contents, pos, rec_size);
+    }
+    pos += rec_size;
   }
+  VLOG(1) << "Compacted " << path() << " from " << contents.size() << " to " << compacted.size();
+  file.Seek(0, File::Whence::begin);
+  if (file.Write(compacted.data(), stl::ssize(compacted)) != stl::ssize(compacted)) {
+    return false;
+  }
+  file.set_length(stl::ssize(compacted));
   file.Close();
-  file.set_length(w);
 
-  return Close();
+  RebuildIndex(compacted);
+  WriteIndex();
+  open_ = true;
+  return true;
 }
 
 std::optional<std::string> FileAreaExtendedDesc::ReadExtended(const FileRecord& f) {
@@ -160,34 +338,33 @@ std::optional<std::string> FileAreaExtendedDesc::ReadExtended(const FileRecord&
 }
 
 std::optional<std::string> FileAreaExtendedDesc::ReadExtended(const std::string& file_name) {
-    if (!open_) {
+  if (!open_) {
     if (!Load()) {
       return std::nullopt;
     }
   }
-  for (const auto& ext : ext_) {
-    if (file_name != ext.name) {
-      continue;
-    }
-    File file(path());
-    if (!file.Open(File::modeBinary | File::modeReadOnly)) {
-      return std::nullopt;
-    }
-    file.Seek(ext.offset, File::Whence::begin);
-    ext_desc_type ed{};
-    if (const auto num_read = file.Read(&ed, sizeof(ext_desc_type));
-        num_read != sizeof(ext_desc_type) || file_name != ed.name) {
-      Close();
-      return std::nullopt;
-    }
-    std::string ss;
-    ss.resize(ed.len);
-    file.Read(&ss[0], ed.len);
-    file.Close();
-
-    return StringTrimEnd(ss);
+  const auto [first, last] = find(file_name);
+  if (first == last) {
+    return std::nullopt;
   }
-  return std::nullopt;
+  File file(path());
+  if (!file.Open(File::modeBinary | File::modeReadOnly)) {
+    return std::nullopt;
+  }
+  file.Seek(first->offset, File::Whence::begin);
+  ext_desc_type ed{};
+  if (const auto num_read = file.Read(&ed, sizeof(ext_desc_type));
+      num_read != sizeof(ext_desc_type) || file_name != ed.name) {
+    // The .ext file was changed by someone else, reload the index next time.
+    Close();
+    return std::nullopt;
+  }
+  std::string ss;
+  ss.resize(ed.len);
+  file.Read(&ss[0], ed.len);
+  file.Close();
+
+  return StringTrimEnd(ss);
 }
 
 std::optional<std::vector<std::string>> FileAreaExtendedDesc::ReadExtendedAsLines(
@@ -216,4 +393,9 @@ std::filesystem::path FileAreaExtendedDesc::path() const noexcept {
   return ::FilePath(data_directory_, filename_);
 }
 
+std::filesystem::path FileAreaExtendedDesc::index_path() const noexcept {
+  auto p = path();
+  return p.replace_extension(".exi");
+}
+
 } // namespace wwiv::sdk::files
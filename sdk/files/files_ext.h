@@ -20,9 +20,12 @@
 
 #include "dirs.h"
 #include "sdk/files/file_record.h"
+#include <cstdint>
 #include <filesystem>
+#include <memory>
 #include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace wwiv::sdk::files {
@@ -31,6 +34,51 @@ namespace wwiv::sdk::files {
 class FileApi;
 class FileRecord;
 
+#pragma pack(push, 1)
+/**
+ * Header of the .exi file, which is an index of the descriptions in the .ext
+ * file for an area, followed by ext_index_rec_t[num_records] sorted by name
+ * and offset.
+ */
+struct ext_index_header_t {
+  // "WWIVEXI" followed by ^Z
+  char signature[8];
+  uint32_t version;
+  uint32_t num_records;
+  // Last write time and size of the .ext file this index matches.
+  int64_t ext_mtime;
+  uint64_t ext_size;
+  // Bytes used by deleted descriptions in the .ext file.
+  uint64_t deleted_bytes;
+  uint8_t padding[8];
+};
+
+struct ext_index_rec_t {
+  // Aligned filename.
+  char name[13];
+  uint8_t padding;
+  // Length of the description.
+  uint16_t len;
+  // Offset of the ext_desc_type header of the description in the .ext file.
+  uint32_t offset;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(ext_index_header_t) == 48, "ext_index_header_t == 48");
+static_assert(sizeof(ext_index_rec_t) == 20, "ext_index_rec_t == 20");
+
+/**
+ * The extended descriptions for a file area, stored in the .ext file as an
+ * ext_desc_type header followed by the text for each description.
+ *
+ * Descriptions are found using the .exi index, which is read into memory and
+ * rebuilt whenever it doesn't match the .ext file, so that reading one
+ * description doesn't read the others.  The .exi file is replaced atomically
+ * when written, since other nodes may be reading it.  New descriptions are appended to the
+ * .ext file, and deleted ones are marked by clearing the name in the header,
+ * which is also ignored by the older code that read the .ext file directly.
+ * The .ext file is compacted once more than half of it is deleted.
+ */
 class FileAreaExtendedDesc final {
 public:
 
@@ -48,7 +96,8 @@ public:
   [[nodiscard]] bool Unlock() { return true; }
   int max_number_of_files() const noexcept { return num_files_; };
   int number_of_ext_descriptions();
-  [[nodiscard]] bool Compact() { return false; }
+  // Removes the deleted descriptions from the .ext file.
+  bool Compact();
 
   // File specific
   bool AddExtended(const FileRecord& f, const std::string& text);
@@ -62,8 +111,22 @@ public:
   bool UpdateExtended(const FileRecord& f, const std::string& text);
 
   [[nodiscard]] std::filesystem::path path() const noexcept;
+  [[nodiscard]] std::filesystem::path index_path() const noexcept;
+
+  static constexpr uint32_t kIndexVersion = 1;
 
 protected:
+  // Reads the .exi index if it matches the .ext file.
+  bool ReadIndex();
+  // Rebuilds the index from the contents of the .ext file.
+  bool RebuildIndex(const std::string& contents);
+  // Writes the index to the .exi file.
+  bool WriteIndex();
+  // Loads the index again if the .ext file was changed since it was loaded.
+  bool EnsureCurrent();
+  // Returns the [first, last) range of the index for aligned filename file_name.
+  [[nodiscard]] std::pair<const ext_index_rec_t*, const ext_index_rec_t*>
+  find(const std::string& file_name) const;
 
   // Not owned.
   FileApi* api_;
@@ -73,8 +136,13 @@ protected:
 
   bool dirty_{false};
   bool open_{false};
-  std::vector<ext_desc_rec> ext_;
   int num_files_{0};
+
+  std::vector<ext_index_rec_t> index_;
+  uint64_t deleted_bytes_{0};
+  // Size and time of the .ext file when the index was loaded or written.
+  uint64_t ext_size_{0};
+  int64_t ext_mtime_{0};
 };
 
 std::string align(const std::string& file_name);
@@ -30,6 +30,7 @@
 #include "sdk/files/files.h"
 #include "sdk/files/files_ext.h"
 #include "sdk/sdk_helper.h"
+#include <fstream>
 #include <string>
 
 using namespace std;
@@ -87,3 +88,119 @@ TEST_F(FilesExtTest, Smoke) {
   EXPECT_EQ(s1, e->ReadExtended(f1).value());
   EXPECT_EQ(s2, e->ReadExtended(f2).value());
 }
+
+TEST_F(FilesExtTest, Delete) {
+  const string name = test_info_->name();
+
+  const FileRecord f1{ul("FILE0001.ZIP", "", 1234)};
+  const FileRecord f2{ul("FILE0002.ZIP", "", 1234)};
+  auto area = api_helper_.CreateAndPopulate(name, {f1, f2});
+  ASSERT_TRUE(area);
+
+  auto* e = area->ext_desc().value();
+  EXPECT_TRUE(e->AddExtended(f1, "F1"));
+  EXPECT_TRUE(e->AddExtended(f2, "F2"));
+  const auto size = std::filesystem::file_size(e->path());
+
+  EXPECT_TRUE(e->DeleteExtended(f1));
+  EXPECT_EQ(1, e->number_of_ext_descriptions());
+  EXPECT_FALSE(e->ReadExtended(f1));
+  EXPECT_EQ("F2", e->ReadExtended(f2).value());
+  // Deleted in place, without rewriting the file.
+  EXPECT_EQ(size, std::filesystem::file_size(e->path()));
+
+  // The deleted description stays deleted when the .ext file is read again.
+  e->Close();
+  ASSERT_TRUE(File::Remove(e->index_path()));
+  EXPECT_EQ(1, e->number_of_ext_descriptions());
+  EXPECT_FALSE(e->ReadExtended(f1));
+  EXPECT_EQ("F2", e->ReadExtended(f2).value());
+}
+
+TEST_F(FilesExtTest, Index) {
+  const string name = test_info_->name();
+
+  const FileRecord f1{ul("FILE0001.ZIP", "", 1234)};
+  const FileRecord f2{ul("FILE0002.ZIP", "", 1234)};
+  auto area = api_helper_.CreateAndPopulate(name, {f1, f2});
+  ASSERT_TRUE(area);
+
+  auto* e = area->ext_desc().value();
+  EXPECT_TRUE(e->AddExtended(f2, "F2"));
+  EXPECT_TRUE(e->AddExtended(f1, "F1"));
+  EXPECT_TRUE(File::Exists(e->index_path()));
+
+  FileAreaExtendedDesc e2(&api_, helper.datadir(), name, 2);
+  EXPECT_EQ("F1", e2.ReadExtended(f1).value());
+  EXPECT_EQ("F2", e2.ReadExtended(f2).value());
+
+  // Adding from somewhere else rebuilds the index.
+  {
+    File f(e->path());
+    ASSERT_TRUE(f.Open(File::modeBinary | File::modeReadWrite));
+    f.Seek(0, File::Whence::end);
+    ext_desc_type ed{};
+    to_char_array(ed.name, "FILE0003.ZIP");
+    ed.len = 2;
+    f.Write(&ed, sizeof(ed));
+    f.Write("F3");
+  }
+  FileAreaExtendedDesc e3(&api_, helper.datadir(), name, 3);
+  EXPECT_EQ(3, e3.number_of_ext_descriptions());
+  EXPECT_EQ("F3", e3.ReadExtended("FILE0003.ZIP").value());
+}
+
+TEST_F(FilesExtTest, Compact) {
+  const string name = test_info_->name();
+
+  const FileRecord f1{ul("FILE0001.ZIP", "", 1234)};
+  const FileRecord f2{ul("FILE0002.ZIP", "", 1234)};
+  auto area = api_helper_.CreateAndPopulate(name, {f1, f2});
+  ASSERT_TRUE(area);
+
+  auto* e = area->ext_desc().value();
+  EXPECT_TRUE(e->AddExtended(f1, std::string(5000, 'x')));
+  EXPECT_TRUE(e->AddExtended(f2, "F2"));
+  EXPECT_TRUE(e->DeleteExtended(f1));
+
+  // More than half of the file was deleted, so it was compacted.
+  EXPECT_EQ(sizeof(ext_desc_type) + 2, std::filesystem::file_size(e->path()));
+  EXPECT_EQ(1, e->number_of_ext_descriptions());
+  EXPECT_EQ("F2", e->ReadExtended(f2).value());
+}
+
+TEST_F(FilesExtTest, Index_ReplacedWhenWritten) {
+  const string name = test_info_->name();
+
+  const FileRecord f1{ul("FILE0001.ZIP", "", 1234)};
+  const FileRecord f2{ul("FILE0002.ZIP", "", 1234)};
+  auto area = api_helper_.CreateAndPopulate(name, {f1, f2});
+  ASSERT_TRUE(area);
+
+  auto* e = area->ext_desc().value();
+  EXPECT_TRUE(e->AddExtended(f1, "F1"));
+  // Reading builds the index.
+  EXPECT_EQ("F1", e->ReadExtended(f1).value());
+  const auto index_size = std::filesystem::file_size(e->index_path());
+
+#ifndef _WIN32
+  // Another node reading the index sees the whole of the old one.
+  std::ifstream reader(e->index_path(), std::ios::binary);
+  ASSERT_TRUE(reader);
+#endif
+
+  FileAreaExtendedDesc e2(&api_, helper.datadir(), name, 2);
+  EXPECT_TRUE(e2.AddExtended(f2, "F2"));
+  EXPECT_EQ(index_size + sizeof(ext_index_rec_t), std::filesystem::file_size(e->index_path()));
+
+#ifndef _WIN32
+  reader.seekg(0, std::ios::end);
+  EXPECT_EQ(static_cast<std::streamoff>(index_size), static_cast<std::streamoff>(reader.tellg()));
+#endif
+
+  // The first one picks up the index written by the other.
+  EXPECT_TRUE(e->DeleteExtended(f1));
+  FileAreaExtendedDesc e3(&api_, helper.datadir(), name, 2);
+  EXPECT_EQ(1, e3.number_of_ext_descriptions());
+  EXPECT_EQ("F2", e3.ReadExtended(f2).value());
+}
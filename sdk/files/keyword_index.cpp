@@ -0,0 +1,421 @@
+/**************************************************************************/
+/*                                                                        */
+/*                          WWIV Version 5.x                              */
+/*           Copyright (C)2022, WWIV Software Services                    */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/**************************************************************************/
+#include "sdk/files/keyword_index.h"
+
+#include "core/file.h"
+#include "core/log.h"
+#include "core/stl.h"
+#include "core/strings.h"
+#include "sdk/filenames.h"
+#include "sdk/vardec.h"
+#include "sdk/files/files.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <system_error>
+#include <tuple>
+#include <utility>
+
+using namespace wwiv::core;
+using namespace wwiv::strings;
+
+namespace wwiv::sdk::files {
+
+static const char kSignature[8] = {'W', 'W', 'I', 'V', 'K', 'W', 'D', '\x1A'};
+
+// Upper cases ASCII and the CP437 letters that have both cases.
+static char cp437_toupper(char ch) {
+  const auto c = static_cast<uint8_t>(ch);
+  if (c >= 'a' && c <= 'z') {
+    return static_cast<char>(c - 'a' + 'A');
+  }
+  switch (c) {
+  case 0x81: return '\x9A'; // u umlaut
+  case 0x82: return '\x90'; // e acute
+  case 0x84: return '\x8E'; // a umlaut
+  case 0x86: return '\x8F'; // a ring
+  case 0x87: return '\x80'; // c cedilla
+  case 0x91: return '\x92'; // ae
+  case 0x94: return '\x99'; // o umlaut
+  case 0xA4: return '\xA5'; // n tilde
+  default: return ch;
+  }
+}
+
+static bool is_word_separator(char ch) {
+  return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n' || ch == '\f' || ch == '\v' ||
+         ch == '\0';
+}
+
+static std::pair<uint64_t, int64_t> stat_file(const std::filesystem::path& path) {
+  std::error_code ec;
+  const auto mtime = File::Exists(path) ? File::last_write_time(path) : 0;
+  const auto size = std::filesystem::file_size(path, ec);
+  return {ec ? 0 : size, mtime};
+}
+
+KeywordIndex::KeywordIndex(std::filesystem::path data_directory)
+    : data_directory_(std::move(data_directory)) {}
+
+std::filesystem::path KeywordIndex::path() const {
+  return core::FilePath(data_directory_, FILEKW_DAT);
+}
+
+std::vector<std::string> KeywordIndex::Tokenize(const std::string& text) {
+  std::vector<std::string> words;
+  std::string word;
+  for (const auto ch : text) {
+    if (is_word_separator(ch)) {
+      if (!word.empty()) {
+        words.emplace_back(std::move(word));
+        word.clear();
+      }
+      continue;
+    }
+    word.push_back(cp437_toupper(ch));
+  }
+  if (!word.empty()) {
+    words.emplace_back(std::move(word));
+  }
+  return words;
+}
+
+bool KeywordIndex::Load() {
+  areas_.clear();
+  area_numbers_.clear();
+  keywords_.clear();
+  keyword_numbers_.clear();
+  dirty_ = false;
+
+  File file(path());
+  if (!file.Open(File::modeBinary | File::modeReadOnly)) {
+    return false;
+  }
+  auto lock = file.lock(FileLockType::read_lock);
+  std::string b;
+  b.resize(file.length());
+  if (file.Read(b.data(), stl::ssize(b)) != stl::ssize(b)) {
+    LOG(WARNING) << "Error reading keyword index: " << path();
+    return false;
+  }
+  lock.reset();
+  file.Close();
+
+  size_t pos = 0;
+  auto read = [&](void* data, size_t len) {
+    if (pos + len > b.size()) {
+      return false;
+    }
+    memcpy(data, b.data() + pos, len);
+    pos += len;
+    return true;
+  };
+
+  keyword_index_header_t h{};
+  if (!read(&h, sizeof(h)) || memcmp(h.signature, kSignature, sizeof(kSignature)) != 0 ||
+      h.version != kVersion) {
+    LOG(WARNING) << "Ignoring invalid keyword index: " << path();
+    return false;
+  }
+  std::vector<keyword_index_area_t> areas(h.num_areas);
+  if (!read(areas.data(), areas.size() * sizeof(keyword_index_area_t))) {
+    LOG(WARNING) << "Ignoring truncated keyword index: " << path();
+    return false;
+  }
+  std::vector<keyword_t> keywords;
+  keywords.reserve(h.num_keywords);
+  for (auto i = 0u; i < h.num_keywords; i++) {
+    uint16_t len{0};
+    uint32_t count{0};
+    keyword_t k;
+    if (!read(&len, sizeof(len))) {
+      LOG(WARNING) << "Ignoring truncated keyword index: " << path();
+      return false;
+    }
+    k.text.resize(len);
+    if (!read(k.text.data(), len) || !read(&count, sizeof(count))) {
+      LOG(WARNING) << "Ignoring truncated keyword index: " << path();
+      return false;
+    }
+    k.postings.resize(count);
+    if (!read(k.postings.data(), count * sizeof(keyword_posting_t))) {
+      LOG(WARNING) << "Ignoring truncated keyword index: " << path();
+      return false;
+    }
+    keywords.emplace_back(std::move(k));
+  }
+
+  for (auto i = 0; i < stl::size_int(areas); i++) {
+    auto& a = areas[i];
+    a.filename[sizeof(a.filename) - 1] = '\0';
+    area_numbers_.emplace(a.filename, static_cast<uint16_t>(i));
+  }
+  for (auto i = 0; i < stl::size_int(keywords); i++) {
+    keyword_numbers_.emplace(keywords[i].text, static_cast<uint32_t>(i));
+  }
+  areas_ = std::move(areas);
+  keywords_ = std::move(keywords);
+  return true;
+}
+
+bool KeywordIndex::Save() {
+  keyword_index_header_t h{};
+  memcpy(h.signature, kSignature, sizeof(kSignature));
+  h.version = kVersion;
+  h.num_areas = static_cast<uint32_t>(areas_.size());
+
+  std::string b;
+  auto write = [&b](const void* data, size_t len) {
+    b.append(static_cast<const char*>(data), len);
+  };
+  write(&h, sizeof(h));
+  write(areas_.data(), areas_.size() * sizeof(keyword_index_area_t));
+  for (const auto& k : keywords_) {
+    if (k.postings.empty()) {
+      continue;
+    }
+    const auto len = static_cast<uint16_t>(k.text.size());
+    const auto count = static_cast<uint32_t>(k.postings.size());
+    write(&len, sizeof(len));
+    write(k.text.data(), len);
+    write(&count, sizeof(count));
+    write(k.postings.data(), k.postings.size() * sizeof(keyword_posting_t));
+    ++h.num_keywords;
+  }
+  // Now that the number of keywords is known.
+  memcpy(b.data(), &h, sizeof(h));
+
+  if (!File::WriteAtomically(path(), b.data(), stl::ssize(b))) {
+    LOG(ERROR) << "Error writing keyword index: " << path();
+    return false;
+  }
+  dirty_ = false;
+  return true;
+}
+
+uint16_t KeywordIndex::add_area(const std::string& filename) {
+  if (const auto it = area_numbers_.find(filename); it != std::end(area_numbers_)) {
+    return it->second;
+  }
+  keyword_index_area_t a{};
+  to_char_array(a.filename, filename);
+  const auto num = static_cast<uint16_t>(areas_.size());
+  areas_.push_back(a);
+  area_numbers_.emplace(filename, num);
+  return num;
+}
+
+void KeywordIndex::stat_area(keyword_index_area_t& a) const {
+  std::tie(a.dir_size, a.dir_mtime) =
+      stat_file(core::FilePath(data_directory_, StrCat(a.filename, ".dir")));
+  std::tie(a.ext_size, a.ext_mtime) =
+      stat_file(core::FilePath(data_directory_, StrCat(a.filename, ".ext")));
+}
+
+void KeywordIndex::clear_area(uint16_t num) {
+  const keyword_posting_t first{num, 0};
+  const keyword_posting_t last{num, std::numeric_limits<uint32_t>::max()};
+  for (auto& k : keywords_) {
+    auto& p = k.postings;
+    p.erase(std::lower_bound(std::begin(p), std::end(p), first),
+            std::upper_bound(std::begin(p), std::end(p), last));
+  }
+  auto& a = areas_.at(num);
+  stat_area(a);
+  a.generation = 0;
+  dirty_ = true;
+  ++generation_;
+}
+
+void KeywordIndex::add_postings(uint16_t num, FileArea& area,
+                                const std::vector<uint32_t>& records) {
+  // New postings for each keyword, which are in record order.
+  std::unordered_map<uint32_t, std::vector<keyword_posting_t>> added;
+  const auto& files = area.raw_files();
+  for (const auto i : records) {
+    const auto& u = files.at(i);
+    auto text = StrCat(u.filename, " ", u.description);
+    if (u.mask & mask_extended) {
+      text.push_back(' ');
+      text.append(area.ReadExtendedDescriptionAsString(u.filename).value_or(""));
+    }
+    auto words = Tokenize(text);
+    std::sort(std::begin(words), std::end(words));
+    words.erase(std::unique(std::begin(words), std::end(words)), std::end(words));
+    for (auto& w : words) {
+      auto it = keyword_numbers_.find(w);
+      if (it == std::end(keyword_numbers_)) {
+        it = keyword_numbers_.emplace(w, static_cast<uint32_t>(keywords_.size())).first;
+        keywords_.push_back(keyword_t{std::move(w), {}});
+      }
+      added[it->second].push_back(keyword_posting_t{num, i});
+    }
+  }
+  const keyword_posting_t first{num, 0};
+  const keyword_posting_t last{num, std::numeric_limits<uint32_t>::max()};
+  for (const auto& [k, postings] : added) {
+    auto& p = keywords_[k].postings;
+    const auto lo = std::lower_bound(std::begin(p), std::end(p), first) - std::begin(p);
+    const auto mid = std::upper_bound(std::begin(p), std::end(p), last) - std::begin(p);
+    p.insert(std::begin(p) + mid, std::begin(postings), std::end(postings));
+    std::inplace_merge(std::begin(p) + lo, std::begin(p) + mid,
+                       std::begin(p) + mid + stl::ssize(postings));
+  }
+}
+
+void KeywordIndex::index_area(uint16_t num, FileArea& area) {
+  clear_area(num);
+  std::vector<uint32_t> records;
+  // Record 0 is the area header.
+  for (auto i = 1; i < stl::size_int(area.raw_files()); i++) {
+    records.push_back(static_cast<uint32_t>(i));
+  }
+  add_postings(num, area, records);
+  areas_.at(num).generation = area.header().generation();
+}
+
+bool KeywordIndex::update_changed(uint16_t num, FileArea& area) {
+  auto& a = areas_.at(num);
+  const auto& files = area.raw_files();
+  const auto& origins = area.record_origins();
+  // A generation of 0 is from before generations were kept, so it may not
+  // match the records the index has.
+  if (a.generation == 0 || a.generation != area.base_generation() ||
+      origins.size() != files.size()) {
+    return false;
+  }
+
+  // Where each record the index knows about is now, or 0 if it was deleted
+  // or changed.
+  std::vector<uint32_t> moved_to;
+  std::vector<uint32_t> changed;
+  auto in_order = true;
+  uint32_t last_origin = 0;
+  for (auto i = 1; i < stl::size_int(origins); i++) {
+    const auto o = origins[i];
+    if (o == 0) {
+      changed.push_back(static_cast<uint32_t>(i));
+      continue;
+    }
+    if (o >= moved_to.size()) {
+      moved_to.resize(o + 1, 0);
+    }
+    moved_to[o] = static_cast<uint32_t>(i);
+    in_order = in_order && o > last_origin;
+    last_origin = o;
+  }
+
+  const keyword_posting_t first{num, 0};
+  const keyword_posting_t last{num, std::numeric_limits<uint32_t>::max()};
+  for (auto& k : keywords_) {
+    auto& p = k.postings;
+    const auto lo = std::lower_bound(std::begin(p), std::end(p), first);
+    const auto hi = std::upper_bound(lo, std::end(p), last);
+    auto out = lo;
+    for (auto it = lo; it != hi; ++it) {
+      if (it->record < moved_to.size() && moved_to[it->record] != 0) {
+        *out++ = keyword_posting_t{num, moved_to[it->record]};
+      }
+    }
+    if (!in_order) {
+      std::sort(lo, out);
+    }
+    p.erase(out, hi);
+  }
+  add_postings(num, area, changed);
+
+  stat_area(a);
+  a.generation = area.header().generation();
+  dirty_ = true;
+  ++generation_;
+  return true;
+}
+
+void KeywordIndex::UpdateArea(const std::string& filename, FileArea& area) {
+  const auto num = add_area(filename);
+  if (!update_changed(num, area)) {
+    index_area(num, area);
+  }
+}
+
+bool KeywordIndex::IsCurrent(const std::string& filename) const {
+  const auto it = area_numbers_.find(filename);
+  if (it == std::end(area_numbers_)) {
+    return false;
+  }
+  const auto& a = areas_.at(it->second);
+  auto current = a;
+  stat_area(current);
+  const auto dir = core::FilePath(data_directory_, StrCat(a.filename, ".dir"));
+  return a.dir_size == current.dir_size && a.dir_mtime == current.dir_mtime &&
+         a.ext_size == current.ext_size && a.ext_mtime == current.ext_mtime &&
+         a.generation == FileAreaHeader::ReadGeneration(dir);
+}
+
+int KeywordIndex::Refresh(FileApi& api, const std::vector<std::string>& filenames) {
+  auto num = 0;
+  for (const auto& filename : filenames) {
+    if (IsCurrent(filename)) {
+      continue;
+    }
+    VLOG(2) << "Indexing keywords for file area: " << filename;
+    if (auto area = api.Open(filename)) {
+      index_area(add_area(filename), *area);
+    } else {
+      clear_area(add_area(filename));
+    }
+    ++num;
+  }
+  if (dirty_) {
+    Save();
+  }
+  return num;
+}
+
+std::vector<keyword_posting_t> KeywordIndex::Find(const std::string& keyword) const {
+  std::string folded;
+  for (const auto ch : keyword) {
+    if (!is_word_separator(ch)) {
+      folded.push_back(cp437_toupper(ch));
+    }
+  }
+  std::vector<keyword_posting_t> result;
+  for (const auto& k : keywords_) {
+    if (k.text.find(folded) != std::string::npos) {
+      result.insert(std::end(result), std::begin(k.postings), std::end(k.postings));
+    }
+  }
+  std::sort(std::begin(result), std::end(result));
+  result.erase(std::unique(std::begin(result), std::end(result)), std::end(result));
+  return result;
+}
+
+std::optional<uint16_t> KeywordIndex::area_number(const std::string& filename) const {
+  if (const auto it = area_numbers_.find(filename); it != std::end(area_numbers_)) {
+    return it->second;
+  }
+  return std::nullopt;
+}
+
+int KeywordIndex::size() const noexcept {
+  return static_cast<int>(std::count_if(std::begin(keywords_), std::end(keywords_),
+                                        [](const auto& k) { return !k.postings.empty(); }));
+}
+
+} // namespace wwiv::sdk::files
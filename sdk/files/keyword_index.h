@@ -0,0 +1,172 @@
+/**************************************************************************/
+/*                                                                        */
+/*                          WWIV Version 5.x                              */
+/*           Copyright (C)2022, WWIV Software Services                    */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/**************************************************************************/
+#ifndef INCLUDED_SDK_FILES_KEYWORD_INDEX_H
+#define INCLUDED_SDK_FILES_KEYWORD_INDEX_H
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace wwiv::sdk::files {
+
+class FileApi;
+class FileArea;
+
+#pragma pack(push, 1)
+
+/** Header of filekw.dat */
+struct keyword_index_header_t {
+  // "WWIVKWD" followed by ^Z
+  char signature[8];
+  uint32_t version;
+  uint32_t num_areas;
+  uint32_t num_keywords;
+  uint8_t reserved[12];
+};
+static_assert(sizeof(keyword_index_header_t) == 32, "keyword_index_header_t == 32");
+
+/** A file area in filekw.dat */
+struct keyword_index_area_t {
+  // Name of the area's .dir file without the extension.
+  char filename[64];
+  // Size and modification time of the .dir and .ext files when indexed.
+  uint64_t dir_size;
+  int64_t dir_mtime;
+  uint64_t ext_size;
+  int64_t ext_mtime;
+  // Generation from the header of the .dir file when indexed.
+  uint32_t generation;
+  uint8_t reserved[4];
+};
+static_assert(sizeof(keyword_index_area_t) == 104, "keyword_index_area_t == 104");
+
+/** A file containing a keyword. */
+struct keyword_posting_t {
+  // Index of the area in the keyword index.
+  uint16_t area;
+  // Record number of the file in the area, as used by FileArea::ReadFile.
+  uint32_t record;
+};
+static_assert(sizeof(keyword_posting_t) == 6, "keyword_posting_t == 6");
+
+#pragma pack(pop)
+
+inline bool operator<(const keyword_posting_t& l, const keyword_posting_t& r) {
+  return l.area < r.area || (l.area == r.area && l.record < r.record);
+}
+
+inline bool operator==(const keyword_posting_t& l, const keyword_posting_t& r) {
+  return l.area == r.area && l.record == r.record;
+}
+
+/**
+ * An inverted index of the words in the filename, description and extended
+ * description of every file, kept in filekw.dat in the data directory.
+ *
+ * Words are split on whitespace and upper cased (including the accented
+ * letters in CP437), and each word has a sorted list of the files that
+ * contain it.  Since the listplus keyword search matches any substring of
+ * the text, Find returns the files with any word containing the keyword, which
+ * may include files that don't match exactly (i.e. differ only in the case of
+ * an accented letter), so the text of the files found should still be checked.
+ *
+ * Like the FileCatalog, areas are updated when saved through the FileApi
+ * that loaded the index, or indexed again by Refresh when the generation of
+ * the area or the size or modification time of its .dir or .ext file changes.
+ * When an area saved through the FileApi was loaded from the generation in
+ * the index, only the records added or changed since are indexed, and the
+ * record numbers of the others are moved to where they are now.
+ */
+class KeywordIndex final {
+public:
+  explicit KeywordIndex(std::filesystem::path data_directory);
+  KeywordIndex() = delete;
+  ~KeywordIndex() = default;
+
+  static constexpr uint32_t kVersion = 2;
+
+  /** Loads filekw.dat, returning false (with an empty index) if it is missing or invalid. */
+  bool Load();
+  /** Writes filekw.dat */
+  bool Save();
+  [[nodiscard]] bool dirty() const noexcept { return dirty_; }
+  /** Changes every time an area is updated, since record numbers may have changed. */
+  [[nodiscard]] int generation() const noexcept { return generation_; }
+
+  /**
+   * Updates the words for the area named filename to those of the files in
+   * area, only reading the records changed since it was loaded when possible.
+   */
+  void UpdateArea(const std::string& filename, FileArea& area);
+
+  /** True if the words for the area named filename match its .dir and .ext files. */
+  [[nodiscard]] bool IsCurrent(const std::string& filename) const;
+
+  /**
+   * Indexes again each of the areas in filenames which are not current and
+   * saves the index if anything changed.  Returns the number of areas indexed.
+   */
+  int Refresh(FileApi& api, const std::vector<std::string>& filenames);
+
+  /** Returns the sorted list of the files with a word containing keyword. */
+  [[nodiscard]] std::vector<keyword_posting_t> Find(const std::string& keyword) const;
+
+  /** Returns the number of the area named filename, if it has been indexed. */
+  [[nodiscard]] std::optional<uint16_t> area_number(const std::string& filename) const;
+
+  /** Number of distinct words in the index. */
+  [[nodiscard]] int size() const noexcept;
+  [[nodiscard]] std::filesystem::path path() const;
+
+  /** Splits text into the upper cased words used by the index. */
+  [[nodiscard]] static std::vector<std::string> Tokenize(const std::string& text);
+
+private:
+  struct keyword_t {
+    std::string text;
+    std::vector<keyword_posting_t> postings;
+  };
+
+  uint16_t add_area(const std::string& filename);
+  // Removes the postings for area num.
+  void clear_area(uint16_t num);
+  void stat_area(keyword_index_area_t& a) const;
+  // Replaces the postings for area num with those of every file in area.
+  void index_area(uint16_t num, FileArea& area);
+  // Updates the postings for area num from the record origins of area,
+  // returning false if the index doesn't match what area was loaded from.
+  bool update_changed(uint16_t num, FileArea& area);
+  // Adds postings for the records of area in records, which must be past
+  // any existing postings for the same area and keyword or be merged in.
+  void add_postings(uint16_t num, FileArea& area, const std::vector<uint32_t>& records);
+
+  const std::filesystem::path data_directory_;
+  std::vector<keyword_index_area_t> areas_;
+  std::unordered_map<std::string, uint16_t> area_numbers_;
+  std::vector<keyword_t> keywords_;
+  std::unordered_map<std::string, uint32_t> keyword_numbers_;
+  bool dirty_{false};
+  int generation_{0};
+};
+
+} // namespace wwiv::sdk::files
+
+#endif
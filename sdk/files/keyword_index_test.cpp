@@ -0,0 +1,144 @@
+/**************************************************************************/
+/*                                                                        */
+/*                          WWIV Version 5.x                              */
+/*           Copyright (C)2022, WWIV Software Services                    */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/**************************************************************************/
+#include "gtest/gtest.h"
+
+#include "core/strings.h"
+#include "sdk/sdk_helper.h"
+#include "sdk/files/files.h"
+#include "sdk/files/filesapi_helper.h"
+#include "sdk/files/keyword_index.h"
+#include <string>
+#include <vector>
+
+using namespace wwiv::core;
+using namespace wwiv::sdk;
+using namespace wwiv::sdk::files;
+using namespace wwiv::strings;
+
+class KeywordIndexTest : public testing::Test {
+public:
+  KeywordIndexTest() : api_(helper.datadir()), api_helper_(&api_) {}
+
+  void SetUp() override { helper.SetUp(); }
+
+  static std::vector<uint32_t> records(const std::vector<keyword_posting_t>& postings) {
+    std::vector<uint32_t> v;
+    for (const auto& p : postings) {
+      v.push_back(p.record);
+    }
+    return v;
+  }
+
+  SdkHelper helper;
+  FileApi api_;
+  FilesApiHelper api_helper_;
+};
+
+TEST_F(KeywordIndexTest, Tokenize) {
+  EXPECT_EQ(std::vector<std::string>({"HELLO", "WORLD!", "\x90T\x90"}),
+            KeywordIndex::Tokenize("  hello\r\nWorld!\t\x82t\x82 "));
+  EXPECT_TRUE(KeywordIndex::Tokenize(" \r\n").empty());
+}
+
+TEST_F(KeywordIndexTest, Find) {
+  auto area = api_helper_.CreateAndPopulate(
+      "one", {FileRecord{ul("FOO.ZIP", "A game of chess", 1)},
+              FileRecord{ul("BAR.ZIP", "Chess openings", 1)}});
+  ASSERT_TRUE(area);
+  FileRecord baz{ul("BAZ.ZIP", "Checkers", 1)};
+  ASSERT_TRUE(area->AddFile(baz, "Not quite chess\r\nbut close"));
+  ASSERT_TRUE(area->Save());
+
+  KeywordIndex index(helper.datadir());
+  EXPECT_EQ(1, index.Refresh(api_, {"one"}));
+  // Files are added at the front of the area, so BAZ is 1 and FOO is 3.
+  EXPECT_EQ(std::vector<uint32_t>({1, 2, 3}), records(index.Find("chess")));
+  EXPECT_EQ(std::vector<uint32_t>({1}), records(index.Find("CLOS")));
+  EXPECT_EQ(std::vector<uint32_t>({2}), records(index.Find("open")));
+  EXPECT_EQ(std::vector<uint32_t>({3}), records(index.Find("foo")));
+  EXPECT_TRUE(index.Find("checkmate").empty());
+  EXPECT_EQ(0, index.area_number("one").value());
+  EXPECT_FALSE(index.area_number("two"));
+}
+
+TEST_F(KeywordIndexTest, SaveAndLoad) {
+  auto area = api_helper_.CreateAndPopulate("one", {FileRecord{ul("FOO.ZIP", "chess", 1)}});
+  ASSERT_TRUE(area);
+  {
+    KeywordIndex index(helper.datadir());
+    index.Refresh(api_, {"one"});
+    EXPECT_FALSE(index.dirty());
+  }
+
+  KeywordIndex index(helper.datadir());
+  ASSERT_TRUE(index.Load());
+  EXPECT_TRUE(index.IsCurrent("one"));
+  EXPECT_EQ(std::vector<uint32_t>({1}), records(index.Find("CHESS")));
+  EXPECT_EQ(0, index.Refresh(api_, {"one"}));
+}
+
+TEST_F(KeywordIndexTest, FileArea_Save_UpdatesIndex) {
+  auto& index = api_.keywords();
+  auto area = api_helper_.CreateAndPopulate("one", {FileRecord{ul("FOO.ZIP", "chess", 1)}});
+  ASSERT_TRUE(area);
+  EXPECT_TRUE(index.IsCurrent("one"));
+  EXPECT_EQ(std::vector<uint32_t>({1}), records(index.Find("chess")));
+
+  ASSERT_TRUE(area->DeleteFile(1));
+  ASSERT_TRUE(area->AddFile(FileRecord{ul("BAR.ZIP", "checkers", 1)}));
+  ASSERT_TRUE(area->Save());
+  EXPECT_TRUE(index.Find("chess").empty());
+  EXPECT_EQ(std::vector<uint32_t>({1}), records(index.Find("checkers")));
+}
+
+TEST_F(KeywordIndexTest, FileArea_Save_UpdatesChangedRecords) {
+  auto& index = api_.keywords();
+  auto area = api_helper_.CreateAndPopulate("one", {FileRecord{ul("FOO.ZIP", "chess", 1, 300)},
+                                                    FileRecord{ul("BAR.ZIP", "checkers", 1, 200)},
+                                                    FileRecord{ul("BAZ.ZIP", "go", 1, 100)}});
+  ASSERT_TRUE(area);
+  // Adding a file at the front moves the others down.
+  FileRecord qux{ul("QUX.ZIP", "poker", 1, 400)};
+  ASSERT_TRUE(area->AddFile(qux, "a chess variant"));
+  ASSERT_TRUE(area->Save());
+  EXPECT_EQ(std::vector<uint32_t>({1, 4}), records(index.Find("chess")));
+  EXPECT_EQ(std::vector<uint32_t>({2}), records(index.Find("go")));
+  EXPECT_EQ(std::vector<uint32_t>({3}), records(index.Find("checkers")));
+
+  ASSERT_TRUE(area->DeleteFile(2));
+  auto bar = area->ReadFile(2);
+  bar.set_description("backgammon");
+  ASSERT_TRUE(area->UpdateFile(bar, 2));
+  ASSERT_TRUE(area->Save());
+  EXPECT_EQ(std::vector<uint32_t>({1, 3}), records(index.Find("chess")));
+  EXPECT_EQ(std::vector<uint32_t>({2}), records(index.Find("backgammon")));
+  EXPECT_TRUE(index.Find("checkers").empty());
+  EXPECT_TRUE(index.Find("go").empty());
+
+  ASSERT_TRUE(area->Sort(FileAreaSortType::DATE_ASC));
+  ASSERT_TRUE(area->Save());
+  EXPECT_EQ(std::vector<uint32_t>({2, 3}), records(index.Find("chess")));
+  EXPECT_EQ(std::vector<uint32_t>({1}), records(index.Find("backgammon")));
+  EXPECT_TRUE(index.IsCurrent("one"));
+
+  // Matches indexing the area from scratch.
+  KeywordIndex fresh(helper.datadir());
+  EXPECT_EQ(1, fresh.Refresh(api_, {"one"}));
+  EXPECT_EQ(records(fresh.Find("chess")), records(index.Find("chess")));
+  EXPECT_EQ(records(fresh.Find("poker")), records(index.Find("poker")));
+}
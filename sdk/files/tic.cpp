@@ -17,7 +17,7 @@
 /**************************************************************************/
 #include "sdk/files/tic.h"
 
-#include "core/crc32.h"
+#include "core/crc.h"
 #include "core/log.h"
 #include "core/strings.h"
 #include "core/textfile.h"
@@ -45,9 +45,16 @@ bool Tic::IsValid() const {
   return valid_ && exists() && crc_valid() && size_valid();
 }
 
+bool Tic::IsValid(uint32_t actual_crc) const {
+  return valid_ && exists() && crc_valid(actual_crc) && size_valid();
+}
+
 bool Tic::crc_valid() const {
-  const auto actual_int = wwiv::core::crc32file(fpath());
-  const auto actual = fmt::sprintf("%8.8x", actual_int);
+  return crc_valid(wwiv::core::crc32file(fpath()));
+}
+
+bool Tic::crc_valid(uint32_t actual_crc) const {
+  const auto actual = fmt::sprintf("%8.8x", actual_crc);
 
   const auto crc_valid = iequals(crc, actual);
   if (!crc_valid) {
@@ -196,4 +203,22 @@ std::optional<directory_t> FindFileAreaForTic(const files::Dirs& dirs, const Tic
   return std::nullopt;
 }
 
+TicAreaIndex::TicAreaIndex(const files::Dirs& dirs, const Network& net) {
+  for (auto i = 0; i < dirs.size(); i++) {
+    for (const auto& dt : dirs[i].area_tags) {
+      if (dt.net_uuid == net.uuid) {
+        // emplace keeps the first match, like FindFileAreaForTic.
+        index_.emplace(ToStringLowerCase(dt.area_tag), i);
+      }
+    }
+  }
+}
+
+std::optional<int> TicAreaIndex::dir_num_for(const Tic& tic) const {
+  if (const auto it = index_.find(ToStringLowerCase(tic.area)); it != std::end(index_)) {
+    return it->second;
+  }
+  return std::nullopt;
+}
+
 } // namespace wwiv::sdk::files
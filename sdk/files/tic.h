@@ -21,9 +21,11 @@
 #include "core/datetime.h"
 #include "sdk/fido/fido_address.h"
 #include "sdk/files/dirs.h"
+#include <cstdint>
 #include <filesystem>
 #include <optional>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace wwiv::sdk::net {
@@ -40,7 +42,11 @@ public:
 
   // True if everything is valid (file exists, PW correct, and CRC matches)
   [[nodiscard]] bool IsValid() const;
+  // As IsValid, but using actual_crc as the CRC32 of the file instead of
+  // reading it.
+  [[nodiscard]] bool IsValid(uint32_t actual_crc) const;
   [[nodiscard]] bool crc_valid() const;
+  [[nodiscard]] bool crc_valid(uint32_t actual_crc) const;
   [[nodiscard]] bool size_valid() const;
   [[nodiscard]] bool exists() const;
   [[nodiscard]] int size() const;
@@ -87,6 +93,23 @@ private:
 std::optional<directory_t> FindFileAreaForTic(const files::Dirs& dirs, const Tic& tic,
                                               const sdk::net::Network& net);
 
+/**
+ * Index of the file areas in dirs by area tag for a network, to find the file
+ * area for each of many TIC files without scanning all of the dirs.  Matches
+ * the same area as FindFileAreaForTic.
+ */
+class TicAreaIndex {
+public:
+  TicAreaIndex(const files::Dirs& dirs, const sdk::net::Network& net);
+
+  // Returns the directory number of the file area for tic.
+  [[nodiscard]] std::optional<int> dir_num_for(const Tic& tic) const;
+
+private:
+  // Lower case area tag to directory number.
+  std::unordered_map<std::string, int> index_;
+};
+
 } 
 
 #endif
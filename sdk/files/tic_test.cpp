@@ -214,3 +214,35 @@ File sample.zip
   auto o = wwiv::sdk::files::FindFileAreaForTic(dirs, tic, net);
   ASSERT_FALSE(o.has_value());
 }
+
+TEST(TicTest, TicAreaIndex) {
+  wwiv::core::test::FileHelper helper;
+  const auto data = helper.Dir("data");
+  std::random_device rd{};
+  wwiv::core::uuid_generator generator(rd);
+  const auto uuid = generator.generate();
+  const auto other_uuid = generator.generate();
+
+  Network net{};
+  net.name = "foo";
+  net.uuid = uuid;
+
+  wwiv::sdk::files::directory_t d1;
+  d1.name = "d1";
+  d1.area_tags.push_back({"AREA1", other_uuid});
+  wwiv::sdk::files::directory_t d2;
+  d2.name = "d2";
+  d2.area_tags.push_back({"AREA2", uuid});
+  d2.area_tags.push_back({"area1", uuid});
+  wwiv::sdk::files::Dirs dirs(data, 0);
+  dirs.set_dirs({d1, d2});
+
+  const wwiv::sdk::files::TicAreaIndex index(dirs, net);
+  wwiv::sdk::files::Tic tic(FilePath(helper.TempDir(), "sample.tic"));
+  tic.area = "Area1";
+  EXPECT_EQ(1, index.dir_num_for(tic).value_or(-1));
+  tic.area = "AREA2";
+  EXPECT_EQ(1, index.dir_num_for(tic).value_or(-1));
+  tic.area = "AREA3";
+  EXPECT_FALSE(index.dir_num_for(tic).has_value());
+}
@@ -0,0 +1,961 @@
+/**************************************************************************/
+/*                                                                        */
+/*                          WWIV Version 5.x                              */
+/*           Copyright (C)2022, WWIV Software Services                    */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/**************************************************************************/
+#include "sdk/files/zip.h"
+
+#include "core/crc.h"
+#include "core/file.h"
+#include "core/log.h"
+#include "core/strings.h"
+#include "sdk/vardec.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <functional>
+
+using namespace wwiv::core;
+using namespace wwiv::strings;
+
+namespace wwiv::sdk::files {
+
+static constexpr uint32_t ZIP_LOCAL_SIG = 0x04034b50;
+static constexpr uint32_t ZIP_CENT_START_SIG = 0x02014b50;
+static constexpr uint32_t ZIP_CENT_END_SIG = 0x06054b50;
+static constexpr uint16_t ZIP_METHOD_STORED = 0;
+static constexpr uint16_t ZIP_METHOD_DEFLATED = 8;
+// PKZIP 2.0, MS-DOS
+static constexpr uint16_t ZIP_VERSION = 20;
+
+#pragma pack(push, 1)
+struct zip_local_header {
+  uint32_t signature; // 0x04034b50
+  uint16_t extract_ver;
+  uint16_t flags;
+  uint16_t comp_meth;
+  uint16_t mod_time;
+  uint16_t mod_date;
+  uint32_t crc_32;
+  uint32_t comp_size;
+  uint32_t uncomp_size;
+  uint16_t filename_len;
+  uint16_t extra_length;
+};
+
+struct zip_central_dir {
+  uint32_t signature; // 0x02014b50
+  uint16_t made_ver;
+  uint16_t extract_ver;
+  uint16_t flags;
+  uint16_t comp_meth;
+  uint16_t mod_time;
+  uint16_t mod_date;
+  uint32_t crc_32;
+  uint32_t comp_size;
+  uint32_t uncomp_size;
+  uint16_t filename_len;
+  uint16_t extra_len;
+  uint16_t comment_len;
+  uint16_t disk_start;
+  uint16_t int_attr;
+  uint32_t ext_attr;
+  uint32_t rel_ofs_header;
+};
+
+struct zip_end_dir {
+  uint32_t signature; // 0x06054b50
+  uint16_t disk_num;
+  uint16_t cent_dir_disk_num;
+  uint16_t total_entries_this_disk;
+  uint16_t total_entries_total;
+  uint32_t central_dir_size;
+  uint32_t ofs_cent_dir;
+  uint16_t comment_len;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(zip_local_header) == 30);
+static_assert(sizeof(zip_central_dir) == 46);
+static_assert(sizeof(zip_end_dir) == 22);
+
+/* Convert DOS date and time to time_t. */
+static time_t dos2time_t(uint16_t dos_date, uint16_t dos_time) {
+  struct tm tm{};
+
+  tm.tm_sec = (dos_time & 0x1f) * 2;  /* Bits 0--4:  Secs divided by 2. */
+  tm.tm_min = (dos_time >> 5) & 0x3f; /* Bits 5--10: Minute. */
+  tm.tm_hour = (dos_time >> 11);      /* Bits 11-15: Hour (0--23). */
+
+  tm.tm_mday = (dos_date & 0x1f);          /* Bits 0--4: Day (1--31). */
+  tm.tm_mon = ((dos_date >> 5) & 0xf) - 1; /* Bits 5--8: Month (1--12). */
+  tm.tm_year = (dos_date >> 9) + 80;       /* Bits 9--15: Year-1980. */
+
+  tm.tm_isdst = -1;
+
+  return mktime(&tm);
+}
+
+/* Convert time_t to DOS date and time. */
+static void time_t2dos(time_t t, uint16_t& dos_date, uint16_t& dos_time) {
+  const auto* tm = localtime(&t);
+  if (tm == nullptr || tm->tm_year < 80) {
+    // 1980-01-01 00:00:00 is as early as DOS dates go.
+    dos_date = (1 << 5) | 1;
+    dos_time = 0;
+    return;
+  }
+  dos_time = static_cast<uint16_t>((tm->tm_hour << 11) | (tm->tm_min << 5) | (tm->tm_sec / 2));
+  dos_date = static_cast<uint16_t>(((tm->tm_year - 80) << 9) | ((tm->tm_mon + 1) << 5) |
+                                   tm->tm_mday);
+}
+
+template <typename T> static bool read_struct(std::string_view data, size_t offset, T& t) {
+  if (offset > data.size() || data.size() - offset < sizeof(T)) {
+    return false;
+  }
+  memcpy(&t, data.data() + offset, sizeof(T));
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Inflate (RFC 1951)
+//
+// A small canonical Huffman decoder in the style of zlib's puff.c.
+
+// Base lengths and extra bits for length codes 257..285
+static constexpr std::array<uint16_t, 29> kLengthBase{
+    3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+    31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static constexpr std::array<uint8_t, 29> kLengthExtra{0, 0, 0, 0, 0, 0, 0, 0, 1, 1,
+                                                      1, 1, 2, 2, 2, 2, 3, 3, 3, 3,
+                                                      4, 4, 4, 4, 5, 5, 5, 5, 0};
+// Base offsets and extra bits for distance codes 0..29
+static constexpr std::array<uint16_t, 30> kDistBase{
+    1,   2,   3,   4,   5,   7,    9,    13,   17,   25,   33,   49,   65,    97,    129,
+    193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static constexpr std::array<uint8_t, 30> kDistExtra{0, 0, 0, 0, 1, 1, 2,  2,  3,  3,
+                                                    4, 4, 5, 5, 6, 6, 7,  7,  8,  8,
+                                                    9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+static constexpr int kMaxBits = 15;
+
+namespace {
+
+class BitReader {
+public:
+  explicit BitReader(std::string_view data) : data_(data) {}
+
+  /** Reads need bits, returning false past the end of the data. */
+  bool bits(int need, uint32_t& out) {
+    while (bit_count_ < need) {
+      if (pos_ >= data_.size()) {
+        return false;
+      }
+      bit_buf_ |= static_cast<uint32_t>(static_cast<uint8_t>(data_[pos_++])) << bit_count_;
+      bit_count_ += 8;
+    }
+    out = bit_buf_ & ((1u << need) - 1);
+    bit_buf_ >>= need;
+    bit_count_ -= need;
+    return true;
+  }
+
+  /** Discards the rest of the current byte. */
+  void align() {
+    bit_buf_ = 0;
+    bit_count_ = 0;
+  }
+
+  std::string_view bytes(size_t len) {
+    if (data_.size() - pos_ < len) {
+      return {};
+    }
+    const auto r = data_.substr(pos_, len);
+    pos_ += len;
+    return r;
+  }
+
+private:
+  std::string_view data_;
+  size_t pos_{0};
+  uint32_t bit_buf_{0};
+  int bit_count_{0};
+};
+
+/**
+ * Receives the inflated bytes.  Everything but the last 32k, which is kept for
+ * back references, is passed to sink in large chunks, so the memory used does
+ * not depend on the size of the output.
+ */
+class InflateOutput {
+public:
+  InflateOutput(size_t max_size, std::function<bool(std::string_view)> sink)
+      : max_size_(max_size), sink_(std::move(sink)) {
+    window_.reserve(kWindowSize + kChunkSize + kMaxMatch);
+  }
+
+  bool put(char c) {
+    if (size_ >= max_size_) {
+      return false;
+    }
+    window_.push_back(c);
+    ++size_;
+    return maybe_flush();
+  }
+
+  bool append(std::string_view s) {
+    if (s.size() > max_size_ - size_) {
+      return false;
+    }
+    window_.append(s);
+    size_ += s.size();
+    return maybe_flush();
+  }
+
+  /** Appends len bytes starting dist bytes back. */
+  bool copy(size_t dist, size_t len) {
+    if (dist > window_.size() || len > max_size_ - size_) {
+      return false;
+    }
+    // The source and destination may overlap, so copy a byte at a time.
+    auto from = window_.size() - dist;
+    for (size_t i = 0; i < len; i++) {
+      window_.push_back(window_[from++]);
+    }
+    size_ += len;
+    return maybe_flush();
+  }
+
+  /** Passes everything still held to the sink. */
+  bool flush() {
+    const auto ok = window_.empty() || sink_(window_);
+    window_.clear();
+    return ok;
+  }
+
+private:
+  static constexpr size_t kWindowSize = 32768;
+  static constexpr size_t kChunkSize = 65536;
+  static constexpr size_t kMaxMatch = 258;
+
+  bool maybe_flush() {
+    if (window_.size() < kWindowSize + kChunkSize) {
+      return true;
+    }
+    const auto n = window_.size() - kWindowSize;
+    if (!sink_(std::string_view(window_).substr(0, n))) {
+      return false;
+    }
+    window_.erase(0, n);
+    return true;
+  }
+
+  const size_t max_size_;
+  std::function<bool(std::string_view)> sink_;
+  std::string window_;
+  size_t size_{0};
+};
+
+struct huffman_t {
+  std::array<uint16_t, kMaxBits + 1> count{};
+  std::array<uint16_t, 288> symbol{};
+};
+
+/** Builds the decoding tables from code lengths.  Returns false if over-subscribed. */
+bool build_huffman(huffman_t& h, const uint8_t* lengths, int n) {
+  h.count.fill(0);
+  for (int i = 0; i < n; i++) {
+    h.count[lengths[i]]++;
+  }
+  if (h.count[0] == n) {
+    // No codes, complete but decoding will fail.
+    return true;
+  }
+  int left = 1;
+  for (int len = 1; len <= kMaxBits; len++) {
+    left <<= 1;
+    left -= h.count[len];
+    if (left < 0) {
+      return false;
+    }
+  }
+  std::array<uint16_t, kMaxBits + 1> offs{};
+  for (int len = 1; len < kMaxBits; len++) {
+    offs[len + 1] = offs[len] + h.count[len];
+  }
+  for (int i = 0; i < n; i++) {
+    if (lengths[i] != 0) {
+      h.symbol[offs[lengths[i]]++] = static_cast<uint16_t>(i);
+    }
+  }
+  return true;
+}
+
+/** Decodes one symbol, or returns -1 on error. */
+int decode(BitReader& in, const huffman_t& h) {
+  int code = 0;
+  int first = 0;
+  int index = 0;
+  for (int len = 1; len <= kMaxBits; len++) {
+    uint32_t bit;
+    if (!in.bits(1, bit)) {
+      return -1;
+    }
+    code |= static_cast<int>(bit);
+    const int count = h.count[len];
+    if (code - count < first) {
+      return h.symbol[index + (code - first)];
+    }
+    index += count;
+    first += count;
+    first <<= 1;
+    code <<= 1;
+  }
+  return -1;
+}
+
+bool inflate_codes(BitReader& in, InflateOutput& out, const huffman_t& lencode,
+                   const huffman_t& distcode) {
+  for (;;) {
+    const auto symbol = decode(in, lencode);
+    if (symbol < 0) {
+      return false;
+    }
+    if (symbol < 256) {
+      if (!out.put(static_cast<char>(symbol))) {
+        return false;
+      }
+      continue;
+    }
+    if (symbol == 256) {
+      return true;
+    }
+    const auto ls = symbol - 257;
+    if (ls >= static_cast<int>(kLengthBase.size())) {
+      return false;
+    }
+    uint32_t extra;
+    if (!in.bits(kLengthExtra[ls], extra)) {
+      return false;
+    }
+    const auto len = kLengthBase[ls] + extra;
+
+    const auto ds = decode(in, distcode);
+    if (ds < 0 || ds >= static_cast<int>(kDistBase.size())) {
+      return false;
+    }
+    if (!in.bits(kDistExtra[ds], extra)) {
+      return false;
+    }
+    const auto dist = kDistBase[ds] + extra;
+    if (!out.copy(dist, len)) {
+      return false;
+    }
+  }
+}
+
+bool inflate_stored(BitReader& in, InflateOutput& out) {
+  in.align();
+  const auto hdr = in.bytes(4);
+  if (hdr.size() != 4) {
+    return false;
+  }
+  const auto* p = reinterpret_cast<const uint8_t*>(hdr.data());
+  const uint16_t len = static_cast<uint16_t>(p[0] | (p[1] << 8));
+  const uint16_t nlen = static_cast<uint16_t>(p[2] | (p[3] << 8));
+  if (len != static_cast<uint16_t>(~nlen)) {
+    return false;
+  }
+  const auto b = in.bytes(len);
+  if (b.size() != len) {
+    return false;
+  }
+  return out.append(b);
+}
+
+void fixed_lengths(std::array<uint8_t, 288>& lit, std::array<uint8_t, 30>& dist) {
+  std::fill(lit.begin(), lit.begin() + 144, static_cast<uint8_t>(8));
+  std::fill(lit.begin() + 144, lit.begin() + 256, static_cast<uint8_t>(9));
+  std::fill(lit.begin() + 256, lit.begin() + 280, static_cast<uint8_t>(7));
+  std::fill(lit.begin() + 280, lit.end(), static_cast<uint8_t>(8));
+  dist.fill(5);
+}
+
+bool inflate_fixed(BitReader& in, InflateOutput& out) {
+  static const auto tables = [] {
+    std::array<uint8_t, 288> lit{};
+    std::array<uint8_t, 30> dist{};
+    fixed_lengths(lit, dist);
+    std::pair<huffman_t, huffman_t> t;
+    build_huffman(t.first, lit.data(), static_cast<int>(lit.size()));
+    build_huffman(t.second, dist.data(), static_cast<int>(dist.size()));
+    return t;
+  }();
+  return inflate_codes(in, out, tables.first, tables.second);
+}
+
+bool inflate_dynamic(BitReader& in, InflateOutput& out) {
+  static constexpr std::array<uint8_t, 19> kOrder{16, 17, 18, 0, 8,  7, 9,  6, 10, 5,
+                                                  11, 4,  12, 3, 13, 2, 14, 1, 15};
+  uint32_t nlen, ndist, ncode;
+  if (!in.bits(5, nlen) || !in.bits(5, ndist) || !in.bits(4, ncode)) {
+    return false;
+  }
+  nlen += 257;
+  ndist += 1;
+  ncode += 4;
+  if (nlen > 286 || ndist > 30) {
+    return false;
+  }
+
+  std::array<uint8_t, 320> lengths{};
+  for (uint32_t i = 0; i < ncode; i++) {
+    uint32_t len;
+    if (!in.bits(3, len)) {
+      return false;
+    }
+    lengths[kOrder[i]] = static_cast<uint8_t>(len);
+  }
+  huffman_t lencode;
+  if (!build_huffman(lencode, lengths.data(), 19)) {
+    return false;
+  }
+
+  uint32_t index = 0;
+  while (index < nlen + ndist) {
+    auto symbol = decode(in, lencode);
+    if (symbol < 0) {
+      return false;
+    }
+    if (symbol < 16) {
+      lengths[index++] = static_cast<uint8_t>(symbol);
+      continue;
+    }
+    uint8_t len = 0;
+    uint32_t repeat;
+    if (symbol == 16) {
+      if (index == 0 || !in.bits(2, repeat)) {
+        return false;
+      }
+      len = lengths[index - 1];
+      repeat += 3;
+    } else if (symbol == 17) {
+      if (!in.bits(3, repeat)) {
+        return false;
+      }
+      repeat += 3;
+    } else {
+      if (!in.bits(7, repeat)) {
+        return false;
+      }
+      repeat += 11;
+    }
+    if (index + repeat > nlen + ndist) {
+      return false;
+    }
+    while (repeat--) {
+      lengths[index++] = len;
+    }
+  }
+  if (lengths[256] == 0) {
+    // No end of block code.
+    return false;
+  }
+
+  huffman_t distcode;
+  if (!build_huffman(lencode, lengths.data(), static_cast<int>(nlen)) ||
+      !build_huffman(distcode, lengths.data() + nlen, static_cast<int>(ndist))) {
+    return false;
+  }
+  return inflate_codes(in, out, lencode, distcode);
+}
+
+bool inflate_stream(std::string_view data, InflateOutput& out) {
+  BitReader in(data);
+  uint32_t last = 0;
+  do {
+    uint32_t type;
+    if (!in.bits(1, last) || !in.bits(2, type)) {
+      return false;
+    }
+    bool ok;
+    switch (type) {
+    case 0:
+      ok = inflate_stored(in, out);
+      break;
+    case 1:
+      ok = inflate_fixed(in, out);
+      break;
+    case 2:
+      ok = inflate_dynamic(in, out);
+      break;
+    default:
+      ok = false;
+      break;
+    }
+    if (!ok) {
+      return false;
+    }
+  } while (!last);
+  return out.flush();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Deflate (RFC 1951)
+//
+// LZ77 with hash chains over a 32k window, written as a single block using
+// the fixed Huffman codes.  This gets most of the benefit of deflate on the
+// text files (packets, QWK messages) that we compress.
+
+class BitWriter {
+public:
+  explicit BitWriter(std::string& out) : out_(out) {}
+
+  void bits(uint32_t value, int count) {
+    bit_buf_ |= value << bit_count_;
+    bit_count_ += count;
+    while (bit_count_ >= 8) {
+      out_.push_back(static_cast<char>(bit_buf_ & 0xff));
+      bit_buf_ >>= 8;
+      bit_count_ -= 8;
+    }
+  }
+
+  /** Huffman codes are written most significant bit first. */
+  void code(uint32_t code, int len) {
+    uint32_t rev = 0;
+    for (int i = 0; i < len; i++) {
+      rev = (rev << 1) | ((code >> i) & 1);
+    }
+    bits(rev, len);
+  }
+
+  void flush() {
+    if (bit_count_ > 0) {
+      out_.push_back(static_cast<char>(bit_buf_ & 0xff));
+    }
+    bit_buf_ = 0;
+    bit_count_ = 0;
+  }
+
+private:
+  std::string& out_;
+  uint32_t bit_buf_{0};
+  int bit_count_{0};
+};
+
+void write_fixed_literal(BitWriter& w, int sym) {
+  if (sym < 144) {
+    w.code(0x30 + sym, 8);
+  } else if (sym < 256) {
+    w.code(0x190 + (sym - 144), 9);
+  } else if (sym < 280) {
+    w.code(sym - 256, 7);
+  } else {
+    w.code(0xc0 + (sym - 280), 8);
+  }
+}
+
+void write_match(BitWriter& w, int len, int dist) {
+  int ls = static_cast<int>(kLengthBase.size()) - 1;
+  while (kLengthBase[ls] > len) {
+    --ls;
+  }
+  write_fixed_literal(w, 257 + ls);
+  w.bits(len - kLengthBase[ls], kLengthExtra[ls]);
+
+  int ds = static_cast<int>(kDistBase.size()) - 1;
+  while (kDistBase[ds] > dist) {
+    --ds;
+  }
+  w.code(ds, 5);
+  w.bits(dist - kDistBase[ds], kDistExtra[ds]);
+}
+
+} // namespace
+
+std::optional<std::string> inflate_bytes(std::string_view data, size_t max_size) {
+  std::string result;
+  InflateOutput out(max_size, [&result](std::string_view s) {
+    result.append(s);
+    return true;
+  });
+  if (!inflate_stream(data, out)) {
+    return std::nullopt;
+  }
+  return {result};
+}
+
+std::string deflate_bytes(std::string_view data) {
+  static constexpr int kWindowSize = 32768;
+  static constexpr int kHashBits = 15;
+  static constexpr int kMinMatch = 3;
+  static constexpr int kMaxMatch = 258;
+  static constexpr int kMaxChain = 64;
+
+  std::string out;
+  out.reserve(data.size() / 2 + 16);
+  BitWriter w(out);
+  // Final block, fixed Huffman codes.
+  w.bits(1, 1);
+  w.bits(1, 2);
+
+  const auto* p = reinterpret_cast<const uint8_t*>(data.data());
+  const auto size = static_cast<int>(data.size());
+  std::vector<int> head(1 << kHashBits, -1);
+  std::vector<int> prev(kWindowSize, -1);
+  auto hash = [p](int i) {
+    return ((p[i] << 10) ^ (p[i + 1] << 5) ^ p[i + 2]) & ((1 << kHashBits) - 1);
+  };
+  auto insert = [&](int i) {
+    if (i + kMinMatch <= size) {
+      const auto h = hash(i);
+      prev[i % kWindowSize] = head[h];
+      head[h] = i;
+    }
+  };
+
+  int i = 0;
+  while (i < size) {
+    int best_len = 0;
+    int best_dist = 0;
+    if (i + kMinMatch <= size) {
+      const auto max_len = std::min(kMaxMatch, size - i);
+      auto candidate = head[hash(i)];
+      for (int chain = 0; candidate >= 0 && i - candidate <= kWindowSize - 1 && chain < kMaxChain;
+           chain++) {
+        if (p[candidate + best_len] == p[i + best_len]) {
+          int len = 0;
+          while (len < max_len && p[candidate + len] == p[i + len]) {
+            ++len;
+          }
+          if (len > best_len) {
+            best_len = len;
+            best_dist = i - candidate;
+            if (len == max_len) {
+              break;
+            }
+          }
+        }
+        candidate = prev[candidate % kWindowSize];
+      }
+    }
+    if (best_len >= kMinMatch) {
+      write_match(w, best_len, best_dist);
+      for (int j = 0; j < best_len; j++) {
+        insert(i + j);
+      }
+      i += best_len;
+    } else {
+      write_fixed_literal(w, p[i]);
+      insert(i);
+      ++i;
+    }
+  }
+  write_fixed_literal(w, 256);
+  w.flush();
+  return out;
+}
+
+bool is_zip_arcrec(const arcrec& arc) {
+  return iequals(StringTrim(std::string(arc.extension, strnlen(arc.extension, sizeof(arc.extension)))),
+                 "ZIP");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// ZipReader
+
+ZipReader::ZipReader(const std::filesystem::path& path)
+    : file_(std::make_unique<MemoryMappedFile>(path)) {
+  if (file_->is_open()) {
+    data_ = file_->view();
+    open_ = Open();
+  }
+}
+
+ZipReader::ZipReader(std::string contents) : memory_(std::move(contents)) {
+  data_ = memory_;
+  open_ = Open();
+}
+
+ZipReader::~ZipReader() = default;
+
+bool ZipReader::Open() {
+  // The end of central directory record is at the end, before an optional
+  // comment of up to 64k.
+  if (data_.size() < sizeof(zip_end_dir)) {
+    return false;
+  }
+  std::optional<zip_end_dir> end;
+  const auto min_pos = data_.size() > 0xffff + sizeof(zip_end_dir)
+                           ? data_.size() - 0xffff - sizeof(zip_end_dir)
+                           : 0;
+  for (auto pos = data_.size() - sizeof(zip_end_dir);; pos--) {
+    zip_end_dir e{};
+    if (read_struct(data_, pos, e) && e.signature == ZIP_CENT_END_SIG) {
+      end = e;
+      break;
+    }
+    if (pos == min_pos) {
+      break;
+    }
+  }
+  if (!end) {
+    VLOG(1) << "No ZIP end of central directory record found.";
+    return false;
+  }
+
+  size_t pos = end->ofs_cent_dir;
+  for (int i = 0; i < end->total_entries_total; i++) {
+    zip_central_dir zc{};
+    if (!read_struct(data_, pos, zc) || zc.signature != ZIP_CENT_START_SIG) {
+      LOG(WARNING) << "Invalid ZIP central directory entry #" << i;
+      return false;
+    }
+    pos += sizeof(zc);
+    if (data_.size() - pos < zc.filename_len) {
+      return false;
+    }
+    zip_entry_t e{};
+    e.filename = std::string(data_.substr(pos, zc.filename_len));
+    e.dt = dos2time_t(zc.mod_date, zc.mod_time);
+    e.method = zc.comp_meth == ZIP_METHOD_STORED     ? archive_method_t::ZIP_STORED
+               : zc.comp_meth == ZIP_METHOD_DEFLATED ? archive_method_t::ZIP_DEFLATED
+                                                     : archive_method_t::UNKNOWN;
+    e.compress_size = zc.comp_size;
+    e.uncompress_size = zc.uncomp_size;
+    e.crc32 = zc.crc_32;
+    e.local_header_offset = zc.rel_ofs_header;
+    entries_.emplace_back(std::move(e));
+    pos += zc.filename_len + zc.extra_len + zc.comment_len;
+  }
+  return true;
+}
+
+bool ZipReader::Extract(const zip_entry_t& e,
+                        const std::function<bool(std::string_view)>& sink) const {
+  zip_local_header zl{};
+  if (!read_struct(data_, e.local_header_offset, zl) || zl.signature != ZIP_LOCAL_SIG) {
+    LOG(WARNING) << "Invalid ZIP local header for: " << e.filename;
+    return false;
+  }
+  const size_t start = e.local_header_offset + sizeof(zl) + zl.filename_len + zl.extra_length;
+  if (start > data_.size() || data_.size() - start < e.compress_size) {
+    LOG(WARNING) << "Truncated ZIP entry: " << e.filename;
+    return false;
+  }
+  const auto compressed = data_.substr(start, e.compress_size);
+
+  Crc32 crc;
+  size_t size = 0;
+  auto checked_sink = [&](std::string_view s) {
+    crc.update(s);
+    size += s.size();
+    return sink(s);
+  };
+  bool ok;
+  switch (e.method) {
+  case archive_method_t::ZIP_STORED:
+    ok = checked_sink(compressed);
+    break;
+  case archive_method_t::ZIP_DEFLATED: {
+    // Never inflate past the size in the header, so a small crafted entry
+    // can't expand without bound.
+    InflateOutput out(e.uncompress_size, checked_sink);
+    ok = inflate_stream(compressed, out);
+  } break;
+  default:
+    LOG(WARNING) << "Unsupported ZIP compression method for: " << e.filename;
+    return false;
+  }
+  if (!ok || size != e.uncompress_size || crc.value() != e.crc32) {
+    LOG(WARNING) << "Corrupt ZIP entry: " << e.filename;
+    return false;
+  }
+  return true;
+}
+
+std::optional<std::string> ZipReader::Read(const zip_entry_t& e, size_t max_size) const {
+  if (e.uncompress_size > max_size) {
+    LOG(WARNING) << "ZIP entry: " << e.filename << " is larger than " << max_size << " bytes.";
+    return std::nullopt;
+  }
+  std::string contents;
+  if (!Extract(e, [&contents](std::string_view s) {
+        contents.append(s);
+        return true;
+      })) {
+    return std::nullopt;
+  }
+  return {contents};
+}
+
+std::optional<std::string> ZipReader::Read(const std::string& filename, size_t max_size) const {
+  for (const auto& e : entries_) {
+    if (iequals(e.filename, filename)) {
+      return Read(e, max_size);
+    }
+  }
+  return std::nullopt;
+}
+
+std::optional<std::vector<std::string>> ZipReader::ExtractAll(const std::filesystem::path& dir,
+                                                              size_t max_size) const {
+  std::vector<std::string> written;
+  for (const auto& e : entries_) {
+    // Never write outside of dir, whatever the archive claims.
+    const auto name = std::filesystem::path(e.filename).filename().string();
+    if (name.empty()) {
+      // Directory entry.
+      continue;
+    }
+    if (e.uncompress_size > max_size) {
+      LOG(WARNING) << "ZIP entry: " << e.filename << " is larger than " << max_size << " bytes.";
+      return std::nullopt;
+    }
+    File f(FilePath(dir, name));
+    if (!f.Open(File::modeBinary | File::modeReadWrite | File::modeCreateFile |
+                File::modeTruncate)) {
+      LOG(ERROR) << "Unable to create file: " << f;
+      return std::nullopt;
+    }
+    const auto extracted = Extract(e, [&f](std::string_view s) {
+      if (f.Write(s.data(), s.size()) != static_cast<File::size_type>(s.size())) {
+        LOG(ERROR) << "Short write to file: " << f;
+        return false;
+      }
+      return true;
+    });
+    f.Close();
+    if (!extracted) {
+      File::Remove(f.path());
+      return std::nullopt;
+    }
+    if (e.dt > 0 && !File::set_last_write_time(f.path(), e.dt)) {
+      VLOG(1) << "Unable to set last write time on: " << f;
+    }
+    written.push_back(name);
+  }
+  return {written};
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// ZipWriter
+
+ZipWriter::ZipWriter(const std::filesystem::path& path) : file_(path) {
+  if (!file_.Open(File::modeBinary | File::modeReadWrite | File::modeCreateFile |
+                  File::modeTruncate)) {
+    LOG(ERROR) << "Unable to create ZIP file: " << path.string();
+    ok_ = false;
+  }
+}
+
+ZipWriter::~ZipWriter() {
+  if (file_.IsOpen()) {
+    Close();
+  }
+}
+
+bool ZipWriter::Add(const std::string& filename, const std::string& contents, time_t dt) {
+  if (!ok_ || !file_.IsOpen()) {
+    return false;
+  }
+  zip_entry_t e{};
+  e.filename = filename;
+  e.dt = dt;
+  e.crc32 = crc32string(contents);
+  e.uncompress_size = static_cast<uint32_t>(contents.size());
+  e.local_header_offset = static_cast<uint32_t>(file_.current_position());
+
+  auto compressed = deflate_bytes(contents);
+  const auto stored = compressed.size() >= contents.size();
+  e.method = stored ? archive_method_t::ZIP_STORED : archive_method_t::ZIP_DEFLATED;
+  const auto& data = stored ? contents : compressed;
+  e.compress_size = static_cast<uint32_t>(data.size());
+
+  zip_local_header zl{};
+  zl.signature = ZIP_LOCAL_SIG;
+  zl.extract_ver = ZIP_VERSION;
+  zl.comp_meth = stored ? ZIP_METHOD_STORED : ZIP_METHOD_DEFLATED;
+  time_t2dos(dt, zl.mod_date, zl.mod_time);
+  zl.crc_32 = e.crc32;
+  zl.comp_size = e.compress_size;
+  zl.uncomp_size = e.uncompress_size;
+  zl.filename_len = static_cast<uint16_t>(filename.size());
+
+  if (file_.Write(&zl, sizeof(zl)) != sizeof(zl) ||
+      file_.Write(filename) != static_cast<File::size_type>(filename.size()) ||
+      file_.Write(data) != static_cast<File::size_type>(data.size())) {
+    LOG(ERROR) << "Short write to ZIP file: " << file_;
+    ok_ = false;
+    return false;
+  }
+  entries_.emplace_back(std::move(e));
+  return true;
+}
+
+bool ZipWriter::AddFile(const std::filesystem::path& path) {
+  File f(path);
+  if (!f.Open(File::modeBinary | File::modeReadOnly)) {
+    LOG(ERROR) << "Unable to open file to add to ZIP: " << path.string();
+    return false;
+  }
+  std::string contents;
+  contents.resize(f.length());
+  if (f.Read(contents.data(), contents.size()) != static_cast<File::size_type>(contents.size())) {
+    LOG(ERROR) << "Unable to read file to add to ZIP: " << path.string();
+    return false;
+  }
+  return Add(path.filename().string(), contents, f.last_write_time());
+}
+
+bool ZipWriter::Close() {
+  if (!file_.IsOpen()) {
+    return false;
+  }
+  const auto cent_dir_start = static_cast<uint32_t>(file_.current_position());
+  for (const auto& e : entries_) {
+    zip_central_dir zc{};
+    zc.signature = ZIP_CENT_START_SIG;
+    zc.made_ver = ZIP_VERSION;
+    zc.extract_ver = ZIP_VERSION;
+    zc.comp_meth =
+        e.method == archive_method_t::ZIP_STORED ? ZIP_METHOD_STORED : ZIP_METHOD_DEFLATED;
+    time_t2dos(e.dt, zc.mod_date, zc.mod_time);
+    zc.crc_32 = e.crc32;
+    zc.comp_size = e.compress_size;
+    zc.uncomp_size = e.uncompress_size;
+    zc.filename_len = static_cast<uint16_t>(e.filename.size());
+    zc.rel_ofs_header = e.local_header_offset;
+    if (file_.Write(&zc, sizeof(zc)) != sizeof(zc) ||
+        file_.Write(e.filename) != static_cast<File::size_type>(e.filename.size())) {
+      ok_ = false;
+    }
+  }
+  zip_end_dir end{};
+  end.signature = ZIP_CENT_END_SIG;
+  end.total_entries_this_disk = static_cast<uint16_t>(entries_.size());
+  end.total_entries_total = static_cast<uint16_t>(entries_.size());
+  end.central_dir_size = static_cast<uint32_t>(file_.current_position()) - cent_dir_start;
+  end.ofs_cent_dir = cent_dir_start;
+  if (file_.Write(&end, sizeof(end)) != sizeof(end)) {
+    ok_ = false;
+  }
+  file_.Close();
+  return ok_;
+}
+
+} // namespace wwiv::sdk::files
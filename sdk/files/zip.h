@@ -0,0 +1,157 @@
+/**************************************************************************/
+/*                                                                        */
+/*                          WWIV Version 5.x                              */
+/*           Copyright (C)2022, WWIV Software Services                    */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/**************************************************************************/
+#ifndef INCLUDED_SDK_FILES_ZIP_H
+#define INCLUDED_SDK_FILES_ZIP_H
+
+#include "core/file.h"
+#include "core/mmap_file.h"
+#include "sdk/files/arc.h"
+#include <cstdint>
+#include <ctime>
+#include <filesystem>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace wwiv::sdk::files {
+
+// https://www.hanshq.net/zip.html
+
+/** A file within a ZIP archive. */
+struct zip_entry_t {
+  std::string filename;
+  time_t dt{0};
+  archive_method_t method{archive_method_t::UNKNOWN};
+  uint32_t compress_size{0};
+  uint32_t uncompress_size{0};
+  uint32_t crc32{0};
+  // Offset of the local file header from the start of the archive.
+  uint32_t local_header_offset{0};
+};
+
+/**
+ * Reads a ZIP archive in process, either from a file (which is memory mapped)
+ * or from memory.  Only stored and deflated entries can be extracted, which
+ * covers everything created by PKZIP 2.x and InfoZIP.  Entries are inflated
+ * in chunks, so ExtractAll uses the same memory whatever their size.
+ *
+ * Example:
+ *   ZipReader zip(path);
+ *   for (const auto& e : zip.entries()) {
+ *     if (auto contents = zip.Read(e)) { ... }
+ *   }
+ */
+class ZipReader final {
+public:
+  explicit ZipReader(const std::filesystem::path& path);
+  explicit ZipReader(std::string contents);
+  ZipReader(const ZipReader&) = delete;
+  ZipReader& operator=(const ZipReader&) = delete;
+  ~ZipReader();
+
+  [[nodiscard]] bool is_open() const noexcept { return open_; }
+  explicit operator bool() const noexcept { return open_; }
+
+  /** The files in this archive, in central directory order. */
+  [[nodiscard]] const std::vector<zip_entry_t>& entries() const noexcept { return entries_; }
+
+  /**
+   * Returns the uncompressed contents of e, verifying the CRC.  Returns nullopt
+   * without reading anything if the archive says e is larger than max_size.
+   */
+  [[nodiscard]] std::optional<std::string>
+  Read(const zip_entry_t& e, size_t max_size = std::numeric_limits<size_t>::max()) const;
+  /** Returns the uncompressed contents of the file named filename (case insensitive). */
+  [[nodiscard]] std::optional<std::string>
+  Read(const std::string& filename, size_t max_size = std::numeric_limits<size_t>::max()) const;
+
+  /**
+   * Extracts every file into dir, without any paths stored in the archive.
+   * Returns the names of the files written, or nullopt on any error, including
+   * a file the archive says is larger than max_size.
+   */
+  std::optional<std::vector<std::string>>
+  ExtractAll(const std::filesystem::path& dir,
+             size_t max_size = std::numeric_limits<size_t>::max()) const;
+
+private:
+  bool Open();
+  // Passes the uncompressed contents of e to sink in chunks, then verifies the
+  // size and CRC.
+  bool Extract(const zip_entry_t& e, const std::function<bool(std::string_view)>& sink) const;
+
+  std::unique_ptr<core::MemoryMappedFile> file_;
+  std::string memory_;
+  std::string_view data_;
+  std::vector<zip_entry_t> entries_;
+  bool open_{false};
+};
+
+/**
+ * Writes a new ZIP archive in process.  Each file is deflated, or stored when
+ * that is no larger.  The central directory is written by Close.
+ *
+ * Example:
+ *   ZipWriter zip(path);
+ *   zip.AddFile(packet_path);
+ *   if (!zip.Close()) { ... }
+ */
+class ZipWriter final {
+public:
+  explicit ZipWriter(const std::filesystem::path& path);
+  ZipWriter(const ZipWriter&) = delete;
+  ZipWriter& operator=(const ZipWriter&) = delete;
+  /** Closes the archive if Close has not been called. */
+  ~ZipWriter();
+
+  [[nodiscard]] bool is_open() const noexcept { return file_.IsOpen(); }
+  explicit operator bool() const noexcept { return is_open(); }
+
+  /** Adds a file named filename containing contents. */
+  bool Add(const std::string& filename, const std::string& contents, time_t dt);
+  /** Adds the file at path, stored under its filename without any directory. */
+  bool AddFile(const std::filesystem::path& path);
+  /** Writes the central directory and closes the archive. */
+  bool Close();
+
+private:
+  core::File file_;
+  std::vector<zip_entry_t> entries_;
+  bool ok_{true};
+};
+
+/** Compresses data as a raw deflate (RFC 1951) stream. */
+[[nodiscard]] std::string deflate_bytes(std::string_view data);
+
+/**
+ * Decompresses the raw deflate (RFC 1951) stream in data, or returns nullopt
+ * if the stream is invalid or would decompress to more than max_size bytes.
+ */
+[[nodiscard]] std::optional<std::string>
+inflate_bytes(std::string_view data, size_t max_size = std::numeric_limits<size_t>::max());
+
+/** Returns true if arc is the ZIP archiver, which can be handled in process. */
+[[nodiscard]] bool is_zip_arcrec(const arcrec& arc);
+
+} // namespace wwiv::sdk::files
+
+#endif
@@ -0,0 +1,225 @@
+/**************************************************************************/
+/*                                                                        */
+/*                          WWIV Version 5.x                              */
+/*           Copyright (C)2022, WWIV Software Services                    */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/**************************************************************************/
+#include "gtest/gtest.h"
+
+#include "core/file.h"
+#include "core/test/file_helper.h"
+#include "core/test/wwivtest.h"
+#include "sdk/files/arc.h"
+#include "sdk/files/zip.h"
+#include <cstring>
+#include <ctime>
+#include <string>
+
+using namespace wwiv::core;
+using namespace wwiv::core::test;
+using namespace wwiv::sdk::files;
+
+class ZipTestDataTest : public TestDataTest {};
+
+static std::string lines(int count) {
+  std::string s;
+  for (auto i = 1; i <= count; i++) {
+    s += "Line " + std::to_string(i) + ": The quick brown fox jumps over the lazy dog.\r\n";
+  }
+  return s;
+}
+
+TEST(DeflateTest, RoundTrip) {
+  const auto text = lines(200);
+  const auto compressed = deflate_bytes(text);
+  EXPECT_LT(compressed.size(), text.size() / 4);
+  EXPECT_EQ(text, inflate_bytes(compressed).value_or(""));
+}
+
+TEST(DeflateTest, RoundTrip_Binary) {
+  std::string data;
+  uint32_t seed = 1;
+  for (auto i = 0; i < 100000; i++) {
+    seed = seed * 1103515245 + 12345;
+    data.push_back(static_cast<char>(i % 7 == 0 ? (seed >> 16) & 0xff : i & 0x0f));
+  }
+  EXPECT_EQ(data, inflate_bytes(deflate_bytes(data)).value_or(""));
+}
+
+TEST(DeflateTest, Empty) {
+  EXPECT_EQ("", inflate_bytes(deflate_bytes("")).value_or("x"));
+}
+
+TEST(DeflateTest, Inflate_Invalid) {
+  EXPECT_FALSE(inflate_bytes("").has_value());
+  EXPECT_FALSE(inflate_bytes("\xff\xff\xff\xff").has_value());
+}
+
+TEST(DeflateTest, Inflate_PastMaxSize) {
+  const std::string data(100000, 'a');
+  const auto compressed = deflate_bytes(data);
+  EXPECT_EQ(data, inflate_bytes(compressed, data.size()).value_or(""));
+  EXPECT_FALSE(inflate_bytes(compressed, 100).has_value());
+  EXPECT_FALSE(inflate_bytes(compressed, data.size() - 1).has_value());
+}
+
+TEST_F(ZipTestDataTest, Read) {
+  // Created with Python's zipfile, which uses zlib's dynamic Huffman codes.
+  ZipReader zip(FilePath(FileHelper::TestData(), "zip/test.zip"));
+  ASSERT_TRUE(zip);
+  ASSERT_EQ(2u, zip.entries().size());
+  const auto& e = zip.entries().front();
+  EXPECT_EQ("HELLO.TXT", e.filename);
+  EXPECT_EQ(archive_method_t::ZIP_DEFLATED, e.method);
+  EXPECT_EQ(lines(200), zip.Read(e).value_or(""));
+  EXPECT_EQ("stored", zip.Read("sub/stored.txt").value_or(""));
+  EXPECT_FALSE(zip.Read("missing.txt").has_value());
+}
+
+TEST_F(ZipTestDataTest, ExtractAll) {
+  FileHelper helper;
+  ZipReader zip(FilePath(FileHelper::TestData(), "zip/test.zip"));
+  ASSERT_TRUE(zip);
+  const auto names = zip.ExtractAll(helper.TempDir());
+  ASSERT_TRUE(names.has_value());
+  EXPECT_EQ(2u, names->size());
+  EXPECT_EQ(lines(200), helper.ReadFile(FilePath(helper.TempDir(), "HELLO.TXT")));
+  // Paths within the archive are not used.
+  EXPECT_TRUE(File::Exists(FilePath(helper.TempDir(), "STORED.TXT")));
+}
+
+TEST(ZipTest, WriteAndRead) {
+  FileHelper helper;
+  const auto path = FilePath(helper.TempDir(), "test.zip");
+  const auto pkt = helper.CreateTempFile("12345678.pkt", lines(50));
+  const auto now = time(nullptr);
+  {
+    ZipWriter zip(path);
+    ASSERT_TRUE(zip);
+    ASSERT_TRUE(zip.AddFile(pkt));
+    ASSERT_TRUE(zip.Add("small.txt", "abc", now));
+    ASSERT_TRUE(zip.Close());
+  }
+
+  ZipReader zip(path);
+  ASSERT_TRUE(zip);
+  ASSERT_EQ(2u, zip.entries().size());
+  EXPECT_EQ("12345678.pkt", zip.entries().at(0).filename);
+  EXPECT_EQ(archive_method_t::ZIP_DEFLATED, zip.entries().at(0).method);
+  EXPECT_EQ(lines(50), zip.Read("12345678.pkt").value_or(""));
+  // Too small to compress.
+  EXPECT_EQ(archive_method_t::ZIP_STORED, zip.entries().at(1).method);
+  EXPECT_EQ("abc", zip.Read("small.txt").value_or(""));
+  EXPECT_LE(std::abs(zip.entries().at(1).dt - now), 2);
+
+  // The generic archive listing reads the same entries.
+  const auto list = list_archive(path);
+  ASSERT_TRUE(list.has_value());
+  ASSERT_EQ(2u, list->size());
+  EXPECT_EQ("small.txt", list->at(1).filename);
+}
+
+TEST(ZipTest, InMemory) {
+  FileHelper helper;
+  const auto path = FilePath(helper.TempDir(), "test.zip");
+  {
+    ZipWriter zip(path);
+    ASSERT_TRUE(zip.Add("a.txt", lines(10), time(nullptr)));
+  }
+  ZipReader zip(helper.ReadFile(path));
+  ASSERT_TRUE(zip);
+  EXPECT_EQ(lines(10), zip.Read("a.txt").value_or(""));
+}
+
+TEST(ZipTest, EntryLargerThanHeader) {
+  FileHelper helper;
+  const auto path = FilePath(helper.TempDir(), "test.zip");
+  {
+    ZipWriter zip(path);
+    ASSERT_TRUE(zip.Add("a.txt", std::string(100000, 'a'), time(nullptr)));
+  }
+  // Claim the entry is only 10 bytes in the central directory.
+  auto contents = helper.ReadFile(path);
+  const auto central = contents.find("PK\x01\x02");
+  ASSERT_NE(std::string::npos, central);
+  const uint32_t small = 10;
+  memcpy(&contents[central + 24], &small, sizeof(small));
+
+  ZipReader zip(contents);
+  ASSERT_TRUE(zip);
+  ASSERT_EQ(10u, zip.entries().at(0).uncompress_size);
+  EXPECT_FALSE(zip.Read("a.txt").has_value());
+}
+
+TEST(ZipTest, ExtractAll_Large) {
+  FileHelper helper;
+  const auto path = FilePath(helper.TempDir(), "test.zip");
+  // Larger than the chunks that are written at a time.
+  const auto text = lines(20000);
+  {
+    ZipWriter zip(path);
+    ASSERT_TRUE(zip.Add("big.txt", text, time(nullptr)));
+  }
+  ZipReader zip(path);
+  ASSERT_TRUE(zip);
+  const auto& out = helper.TempDir();
+  ASSERT_TRUE(zip.ExtractAll(out).has_value());
+  EXPECT_EQ(text, helper.ReadFile(FilePath(out, "big.txt")));
+}
+
+TEST(ZipTest, MaxSize) {
+  FileHelper helper;
+  const auto path = FilePath(helper.TempDir(), "test.zip");
+  {
+    ZipWriter zip(path);
+    ASSERT_TRUE(zip.Add("a.txt", lines(100), time(nullptr)));
+  }
+  ZipReader zip(path);
+  ASSERT_TRUE(zip);
+  const auto size = lines(100).size();
+  EXPECT_EQ(lines(100), zip.Read("a.txt", size).value_or(""));
+  EXPECT_FALSE(zip.Read("a.txt", size - 1).has_value());
+
+  const auto& out = helper.TempDir();
+  EXPECT_FALSE(zip.ExtractAll(out, size - 1).has_value());
+  EXPECT_FALSE(File::Exists(FilePath(out, "a.txt")));
+}
+
+TEST(ZipTest, ExtractAll_Corrupt) {
+  FileHelper helper;
+  const auto path = FilePath(helper.TempDir(), "test.zip");
+  {
+    ZipWriter zip(path);
+    ASSERT_TRUE(zip.Add("a.txt", std::string(100000, 'a'), time(nullptr)));
+  }
+  // Claim the entry is only 10 bytes in the central directory.
+  auto contents = helper.ReadFile(path);
+  const auto central = contents.find("PK\x01\x02");
+  ASSERT_NE(std::string::npos, central);
+  const uint32_t small = 10;
+  memcpy(&contents[central + 24], &small, sizeof(small));
+
+  ZipReader zip(contents);
+  ASSERT_TRUE(zip);
+  const auto& out = helper.TempDir();
+  EXPECT_FALSE(zip.ExtractAll(out).has_value());
+  // The partly written file is removed.
+  EXPECT_FALSE(File::Exists(FilePath(out, "a.txt")));
+}
+
+TEST(ZipTest, NotAZip) {
+  ZipReader zip(std::string("This is not a zip file, it is just some text."));
+  EXPECT_FALSE(zip);
+  EXPECT_TRUE(zip.entries().empty());
+}
@@ -21,6 +21,7 @@
 #include "bbs/instmsg.h"
 #include "core/datafile.h"
 #include "core/file.h"
+#include "core/log.h"
 #include "core/strings.h"
 #include "fmt/format.h"
 #include "sdk/chains.h"
@@ -31,6 +32,8 @@
 #include "sdk/files/dirs.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <filesystem>
 
 using namespace wwiv::core;
@@ -38,6 +41,12 @@ using namespace wwiv::strings;
 
 namespace wwiv::sdk {
 
+static constexpr char kInstanceDatSignature[] = "WWIVINS\x1A";
+
+static std::atomic<uint64_t>& atomic_of(uint64_t& v) {
+  return *reinterpret_cast<std::atomic<uint64_t>*>(&v);
+}
+
 const std::filesystem::path& Instances::fn_path() const {
   return path_;
 }
@@ -269,48 +278,122 @@ Instances::Instances(const Config& config)
   instances_ = all();
 }
 
-Instances::size_type Instances::size() const {
-  if (const auto file = DataFile<instancerec>(path_, File::modeBinary | File::modeReadOnly)) {
-    return std::max<int>(0, file.number_of_records() - 1);
+bool Instances::OpenHeader() const {
+#ifdef __OS2__
+  // Without shared mappings there is no cheap way to see the generation, so
+  // instance.dat is reread on every lookup.
+  return false;
+#else
+  if (header_file_) {
+    return true;
   }
-  return 0;
+  if (!File::Exists(path_)) {
+    return false;
+  }
+  auto f = std::make_unique<MemoryMappedFile>(path_, MemoryMappedFile::Mode::read_write);
+  if (!f->is_open() || f->size() < sizeof(instance_dat_header_t)) {
+    return false;
+  }
+  header_file_ = std::move(f);
+  return true;
+#endif
 }
 
-// ReSharper disable once CppMemberFunctionMayBeConst
-Instance Instances::at(size_type pos) {
+uint64_t Instances::generation() const {
+  if (!OpenHeader()) {
+    return 0;
+  }
+  auto* h = reinterpret_cast<instance_dat_header_t*>(header_file_->mutable_data());
+  if (memcmp(h->signature, kInstanceDatSignature, sizeof(h->signature)) != 0) {
+    return 0;
+  }
+  return atomic_of(h->generation).load(std::memory_order_acquire);
+}
+
+void Instances::Revalidate() const {
+  // Read the generation before the records, so a concurrent update is
+  // at worst seen as a stale snapshot and reread next time.
+  const auto gen = generation();
+  if (loaded_ && gen != 0 && gen == generation_) {
+    return;
+  }
+  records_.clear();
   if (auto file = DataFile<instancerec>(path_, File::modeBinary | File::modeReadOnly)) {
-    instancerec ir{};
-    if (file.Read(pos, &ir)) {
-      return Instance(root_dir_, data_dir_, ir);
+    if (!file.ReadVector(records_)) {
+      records_.clear();
     }
   }
+  if (!records_.empty()) {
+    // Record 0 is the header, not an instance.
+    records_.front() = instancerec{};
+  }
+  generation_ = gen;
+  loaded_ = true;
+}
+
+Instances::size_type Instances::size() const {
+  Revalidate();
+  return records_.empty() ? 0 : records_.size() - 1;
+}
+
+// ReSharper disable once CppMemberFunctionMayBeConst
+Instance Instances::at(size_type pos) {
+  Revalidate();
+  if (pos < records_.size()) {
+    return Instance(root_dir_, data_dir_, records_.at(pos));
+  }
   return Instance(root_dir_, data_dir_, pos);
 }
 
 // ReSharper disable once CppMemberFunctionMayBeConst
 std::vector<Instance> Instances::all() {
-  if (auto file = DataFile<instancerec>(path_, File::modeBinary | File::modeReadOnly)) {
-    std::vector<instancerec> ir;
-    if (file.ReadVector(ir)) {
-      std::vector<Instance> r;
-      for (const auto& i : ir) {
-        r.emplace_back(root_dir_, data_dir_, i);
-      }
-      return r;
-    }
+  Revalidate();
+  std::vector<Instance> r;
+  r.reserve(records_.size());
+  for (const auto& i : records_) {
+    r.emplace_back(root_dir_, data_dir_, i);
   }
-  return {};
+  return r;
 }
 
 // ReSharper disable once CppMemberFunctionMayBeConst
 bool Instances::upsert(size_type pos, const instancerec& ir) {
+  if (pos == 0) {
+    LOG(ERROR) << "Instance 0 is reserved for the instance.dat header.";
+    return false;
+  }
   instancerec mir{ ir };
   mir.last_update = daten_t_now();
-  if (auto file = DataFile<instancerec>(path_, File::modeBinary | File::modeReadWrite |
-                                                   File::modeCreateFile)) {
-    return file.Write(pos, &mir);
+  {
+    auto file = DataFile<instancerec>(path_, File::modeBinary | File::modeReadWrite |
+                                                  File::modeCreateFile);
+    if (!file || !file.Write(pos, &mir)) {
+      return false;
+    }
   }
-  return false;
+  if (!OpenHeader()) {
+    loaded_ = false;
+    return true;
+  }
+  auto* h = reinterpret_cast<instance_dat_header_t*>(header_file_->mutable_data());
+  if (memcmp(h->signature, kInstanceDatSignature, sizeof(h->signature)) != 0) {
+    // Files written before the header existed have an empty record 0.
+    memset(h, 0, sizeof(instance_dat_header_t));
+    memcpy(h->signature, kInstanceDatSignature, sizeof(h->signature));
+  }
+  const auto prev = atomic_of(h->generation).fetch_add(1, std::memory_order_acq_rel);
+  if (loaded_ && prev != 0 && prev == generation_) {
+    // Nobody else changed instance.dat since the snapshot was taken, so
+    // only this record needs updating.
+    if (records_.size() <= pos) {
+      records_.resize(pos + 1);
+    }
+    records_[pos] = mir;
+    generation_ = prev + 1;
+  } else {
+    loaded_ = false;
+  }
+  return true;
 }
 
 bool Instances::upsert(size_type pos, const Instance& ir) {
@@ -19,10 +19,13 @@
 #define INCLUDED_SDK_INSTANCE_H
 
 #include "core/datetime.h"
+#include "core/mmap_file.h"
 
 #include "sdk/config.h"
 #include "sdk/vardec.h"
+#include <cstdint>
 #include <filesystem>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -166,6 +169,28 @@ constexpr char sINST_LOC_CH9[] = "INST_LOC_CH9";
 constexpr char sINST_LOC_CH10[] = "INST_LOC_CH10";
 constexpr char sINST_LOC_WFC[] = "INST_LOC_WFC";
 
+#pragma pack(push, 1)
+
+/**
+ * Record 0 of instance.dat is not used by any instance, it holds a generation
+ * counter that is incremented on every update so that Instances may keep a
+ * snapshot of the file in memory.  The number field is always 0 so older
+ * code still sees an unused instance record.
+ */
+struct instance_dat_header_t {
+  int16_t number;
+  uint8_t reserved1[14];
+  // "WWIVINS\x1A"
+  char signature[8];
+  uint64_t generation;
+  uint8_t reserved2[68];
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(instance_dat_header_t) == sizeof(instancerec),
+              "instance_dat_header_t == instancerec");
+
 class Instance final {
 public:
   Instance(std::filesystem::path root_dir, std::filesystem::path data_dir, instancerec ir);
@@ -279,23 +304,48 @@ public:
 
   [[nodiscard]] bool IsInitialized() const { return initialized_; }
 
+  /**
+   * size, at and all are served from an in-memory snapshot of instance.dat,
+   * which is only reread when the generation in the file header changes.
+   * Iterating over Instances uses the snapshot taken at construction time.
+   */
   size_type size() const;
   Instance at(size_type pos);
   std::vector<Instance> all();
 
+  /**
+   * Writes the instance record at pos (which must be > 0) and increments the
+   * generation of instance.dat.
+   */
   bool upsert(size_type pos, const instancerec& ir);
   bool upsert(size_type pos, const Instance& ir);
 
+  /**
+   * The generation of instance.dat, incremented by every upsert.  Returns 0
+   * when the generation is not known, in which case instance.dat is reread
+   * on every lookup.
+   */
+  [[nodiscard]] uint64_t generation() const;
+
   explicit operator bool() const noexcept { return IsInitialized(); }
 
 private:
   [[nodiscard]] const std::filesystem::path& fn_path() const;
+  // Maps the header record of instance.dat, returning false if unavailable.
+  bool OpenHeader() const;
+  // Rereads instance.dat into records_ if it changed since it was last read.
+  void Revalidate() const;
 
   bool initialized_;
   const std::filesystem::path path_;
   const std::filesystem::path root_dir_;
   const std::filesystem::path data_dir_;
   std::vector<Instance> instances_;
+
+  mutable std::unique_ptr<core::MemoryMappedFile> header_file_;
+  mutable std::vector<instancerec> records_;
+  mutable uint64_t generation_{0};
+  mutable bool loaded_{false};
 };
 
 } // namespace wwiv::sdk
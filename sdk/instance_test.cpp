@@ -0,0 +1,109 @@
+/**************************************************************************/
+/*                                                                        */
+/*                          WWIV Version 5.x                              */
+/*           Copyright (C)2022, WWIV Software Services                    */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/**************************************************************************/
+#include "gtest/gtest.h"
+
+#include "core/datafile.h"
+#include "core/file.h"
+#include "sdk/filenames.h"
+#include "sdk/instance.h"
+#include "sdk/sdk_helper.h"
+
+using namespace wwiv::core;
+using namespace wwiv::sdk;
+
+class InstancesTest : public testing::Test {
+public:
+  InstancesTest() = default;
+
+  static instancerec rec(int num, int user, int loc) {
+    instancerec ir{};
+    ir.number = static_cast<int16_t>(num);
+    ir.user = static_cast<int16_t>(user);
+    ir.flags = INST_FLAGS_ONLINE;
+    ir.loc = static_cast<uint16_t>(loc);
+    return ir;
+  }
+
+  SdkHelper helper;
+};
+
+TEST_F(InstancesTest, Empty) {
+  Instances instances(helper.config());
+  EXPECT_FALSE(instances);
+  EXPECT_EQ(0u, instances.size());
+  EXPECT_EQ(0u, instances.generation());
+  EXPECT_EQ(3, instances.at(3).node_number());
+  EXPECT_FALSE(instances.at(3).online());
+}
+
+TEST_F(InstancesTest, Upsert) {
+  Instances instances(helper.config());
+  ASSERT_TRUE(instances.upsert(1, rec(1, 10, INST_LOC_MAIN)));
+  ASSERT_TRUE(instances.upsert(2, rec(2, 20, INST_LOC_XFER)));
+  EXPECT_EQ(2u, instances.generation());
+
+  EXPECT_EQ(2u, instances.size());
+  EXPECT_EQ(10, instances.at(1).user_number());
+  EXPECT_EQ(INST_LOC_XFER, instances.at(2).loc_code());
+  const auto all = instances.all();
+  ASSERT_EQ(3u, all.size());
+  EXPECT_EQ(0, all.at(0).node_number());
+  EXPECT_FALSE(all.at(0).online());
+  EXPECT_EQ(20, all.at(2).user_number());
+}
+
+TEST_F(InstancesTest, SeesOtherWriter) {
+  Instances reader(helper.config());
+  Instances writer(helper.config());
+  ASSERT_TRUE(writer.upsert(1, rec(1, 10, INST_LOC_MAIN)));
+  EXPECT_EQ(1u, reader.size());
+  EXPECT_EQ(10, reader.at(1).user_number());
+
+  ASSERT_TRUE(writer.upsert(1, rec(1, 11, INST_LOC_CHAINS)));
+  ASSERT_TRUE(writer.upsert(4, rec(4, 40, INST_LOC_MAIN)));
+  EXPECT_EQ(reader.generation(), writer.generation());
+  EXPECT_EQ(4u, reader.size());
+  EXPECT_EQ(11, reader.at(1).user_number());
+  EXPECT_EQ(INST_LOC_CHAINS, reader.at(1).loc_code());
+  EXPECT_EQ(40, reader.at(4).user_number());
+}
+
+TEST_F(InstancesTest, LegacyFile) {
+  // instance.dat written before the header existed.
+  {
+    DataFile<instancerec> file(FilePath(helper.config().datadir(), INSTANCE_DAT),
+                               File::modeBinary | File::modeReadWrite | File::modeCreateFile);
+    ASSERT_TRUE(file);
+    auto ir = rec(1, 10, INST_LOC_MAIN);
+    ASSERT_TRUE(file.Write(1, &ir));
+  }
+  Instances instances(helper.config());
+  EXPECT_EQ(0u, instances.generation());
+  EXPECT_EQ(10, instances.at(1).user_number());
+
+  ASSERT_TRUE(instances.upsert(2, rec(2, 20, INST_LOC_MAIN)));
+  EXPECT_EQ(1u, instances.generation());
+  EXPECT_EQ(2u, instances.size());
+  EXPECT_EQ(10, instances.at(1).user_number());
+  EXPECT_EQ(20, instances.at(2).user_number());
+}
+
+TEST_F(InstancesTest, Upsert_ZeroIsReserved) {
+  Instances instances(helper.config());
+  EXPECT_FALSE(instances.upsert(0, rec(0, 10, INST_LOC_MAIN)));
+}
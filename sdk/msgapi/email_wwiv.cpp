@@ -20,6 +20,7 @@
 #include "core/datafile.h"
 #include "core/datetime.h"
 #include "core/file.h"
+#include "core/metrics.h"
 #include "core/stl.h"
 #include "core/strings.h"
 #include "sdk/config.h"
@@ -124,7 +125,14 @@ bool WWIVEmail::AddMessage(EmailData& data) {
   }
   m.msg = msg.value();
   increment_email_counters(config_, m.touser);
-  return add_email(m);
+  if (!add_email(m)) {
+    return false;
+  }
+  static auto& added = metrics().counter("msgapi_messages_added_total",
+                                         "Messages added to the message bases.",
+                                         {{"type", "email"}});
+  added.inc();
+  return true;
 }
 
 static bool is_mailrec_deleted(const mailrec& h) {
@@ -21,6 +21,7 @@
 #include "core/datetime.h"
 #include "core/file.h"
 #include "core/log.h"
+#include "core/metrics.h"
 #include "core/stl.h"
 #include "core/strings.h"
 #include "core/version.h"
@@ -32,6 +33,7 @@
 #include "sdk/usermanager.h"
 #include "sdk/vardec.h"
 #include "sdk/msgapi/message_api_wwiv.h"
+#include "sdk/msgapi/sub_stats.h"
 #include "sdk/net/packets.h"
 
 #include <memory>
@@ -88,6 +90,18 @@ static std::unique_ptr<WWIVMessageAreaHeader> ReadHeader(DataFile<postrec>& file
   return std::make_unique<WWIVMessageAreaHeader>(raw_header);
 }
 
+// Keeps substats.dat in sync with the sub so newscan doesn't need to
+// open the sub to see if anything is new.
+static void UpdateSubStats(const std::filesystem::path& datadir, const std::string& filename,
+                           DataFile<postrec>& file, uint32_t num_messages) {
+  postrec last{};
+  if (num_messages > 0 && !file.Read(num_messages, &last)) {
+    return;
+  }
+  SubStats stats(datadir);
+  stats.update(filename, {num_messages, last.qscan});
+}
+
 
 WWIVMessageAreaHeader::WWIVMessageAreaHeader(int ver, uint32_t num_messages)
     : header_(subfile_header_t()) {
@@ -472,6 +486,10 @@ bool WWIVMessageArea::AddMessage(Message& message, const MessageAreaOptions& opt
   p.msg = msg.value();
   auto result = add_post(p);
   if (result) {
+    static auto& added = metrics().counter("msgapi_messages_added_total",
+                                           "Messages added to the message bases.",
+                                           {{"type", "post"}});
+    added.inc();
     DeleteExcess();
   }
   return result;
@@ -517,6 +535,7 @@ bool WWIVMessageArea::DeleteMessage(int message_number) {
   --header.owneruser;
   header.owneruser = static_cast<uint16_t>(std::max(0, num_messages - 1));
   sub.Write(0, &header);
+  UpdateSubStats(wwiv_api_->config().datadir(), sub_.filename, sub, header.owneruser);
 
   return true;
 }
@@ -689,7 +708,11 @@ bool WWIVMessageArea::add_post(const postrec& post) {
   // No reason other than make sure we're not const.
   ++nonce_;
   // Write the header now.
-  return WriteHeader(sub, *wwiv_header);
+  if (!WriteHeader(sub, *wwiv_header)) {
+    return false;
+  }
+  UpdateSubStats(wwiv_api_->config().datadir(), sub_.filename, sub, msgnum);
+  return true;
 }
 
 } // namespace wwiv::sdk::msgapi
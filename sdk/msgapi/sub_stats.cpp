@@ -0,0 +1,244 @@
+/**************************************************************************/
+/*                                                                        */
+/*                          WWIV Version 5.x                              */
+/*           Copyright (C)2022, WWIV Software Services                    */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/**************************************************************************/
+#include "sdk/msgapi/sub_stats.h"
+
+#include "core/datafile.h"
+#include "core/file.h"
+#include "core/log.h"
+#include "core/strings.h"
+#include "sdk/filenames.h"
+
+#include <algorithm>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <utility>
+
+namespace wwiv::sdk::msgapi {
+
+using namespace wwiv::core;
+using namespace wwiv::strings;
+
+static constexpr char kSubStatsSignature[8] = {'W', 'W', 'I', 'V', 'S', 'U', 'B', '\x1A'};
+
+static std::string key_for(const std::string& filename) {
+  return ToStringLowerCase(filename);
+}
+
+static std::optional<uint64_t> header_generation(const sub_stats_rec_t& r) {
+  sub_stats_header_t h{};
+  memcpy(&h, &r, sizeof(sub_stats_header_t));
+  if (h.filename[0] || memcmp(h.signature, kSubStatsSignature, sizeof(h.signature)) != 0) {
+    return std::nullopt;
+  }
+  return h.generation;
+}
+
+static sub_stats_rec_t header_rec(uint64_t generation) {
+  sub_stats_header_t h{};
+  memcpy(h.signature, kSubStatsSignature, sizeof(h.signature));
+  h.generation = generation;
+  sub_stats_rec_t r{};
+  memcpy(&r, &h, sizeof(sub_stats_rec_t));
+  return r;
+}
+
+SubStats::SubStats(std::filesystem::path datadir)
+  : path_(FilePath(datadir, SUBSTATS_DAT)) {}
+
+bool SubStats::Load() {
+  records_.clear();
+  index_.clear();
+  loaded_ = true;
+  generation_ = 0;
+
+  if (!File::Exists(path_)) {
+    // No file yet is fine, every lookup will just miss.
+    return true;
+  }
+
+  DataFile<sub_stats_rec_t> file(path_, File::modeBinary | File::modeReadOnly);
+  if (!file) {
+    return false;
+  }
+  auto lock = file.file().lock(FileLockType::read_lock);
+  if (!file.ReadVector(records_)) {
+    LOG(ERROR) << "Unable to read: " << path_;
+    records_.clear();
+    return false;
+  }
+  const auto gen = records_.empty() ? std::nullopt : header_generation(records_.front());
+  if (!gen) {
+    // Empty, or written before the header existed.  Every lookup will miss
+    // until the next write replaces it.
+    records_.clear();
+    return true;
+  }
+  generation_ = gen.value();
+  for (size_t i = 1; i < records_.size(); i++) {
+    const auto& r = records_[i];
+    if (r.filename[0]) {
+      index_.emplace(key_for(std::string(r.filename, strnlen(r.filename, sizeof(r.filename)))), i);
+    }
+  }
+  return true;
+}
+
+bool SubStats::Refresh() {
+  if (!loaded_) {
+    return Load();
+  }
+  if (!File::Exists(path_)) {
+    if (records_.empty()) {
+      return true;
+    }
+    return Load();
+  }
+  {
+    DataFile<sub_stats_rec_t> file(path_, File::modeBinary | File::modeReadOnly);
+    if (!file) {
+      return Load();
+    }
+    auto lock = file.file().lock(FileLockType::read_lock);
+    sub_stats_rec_t r{};
+    if (file.number_of_records() > 0 && file.Read(0, &r)) {
+      if (const auto gen = header_generation(r); gen && gen.value() == generation_) {
+        return true;
+      }
+    }
+  }
+  return Load();
+}
+
+std::optional<sub_stats_t> SubStats::get(const std::string& filename) {
+  if (!loaded_) {
+    Load();
+  }
+  const auto it = index_.find(key_for(filename));
+  if (it == std::end(index_)) {
+    return std::nullopt;
+  }
+  const auto& r = records_.at(it->second);
+  return sub_stats_t{r.num_messages, r.last_qscan};
+}
+
+bool SubStats::update(const std::string& filename, const sub_stats_t& stats) {
+  return Write(filename, stats, true);
+}
+
+bool SubStats::seed(const std::string& filename, const sub_stats_t& stats) {
+  return Write(filename, stats, false);
+}
+
+bool SubStats::remove(const std::string& filename) {
+  return Write(filename, std::nullopt, true);
+}
+
+bool SubStats::Write(const std::string& filename, const std::optional<sub_stats_t>& stats,
+                     bool overwrite) {
+  const auto key = key_for(filename);
+  if (key.empty() || key.size() >= sizeof(sub_stats_rec_t::filename)) {
+    return false;
+  }
+
+  DataFile<sub_stats_rec_t> file(path_, File::modeBinary | File::modeCreateFile |
+                                            File::modeReadWrite);
+  if (!file) {
+    LOG(ERROR) << "Unable to open: " << path_;
+    return false;
+  }
+  auto lock = file.file().lock(FileLockType::write_lock);
+
+  // Re-read everything under the lock since other instances may have
+  // written since we last looked.  This is a small file (one record per sub).
+  std::vector<sub_stats_rec_t> records;
+  if (!file.ReadVector(records)) {
+    return false;
+  }
+  auto gen = records.empty() ? std::nullopt : header_generation(records.front());
+  const auto rewrite_all = !gen.has_value();
+  if (rewrite_all) {
+    // Empty, or written before the header existed.  Free every old record,
+    // readers fall back to the .sub files and seed them again.
+    std::fill(std::begin(records), std::end(records), sub_stats_rec_t{});
+    if (records.empty()) {
+      records.emplace_back();
+    }
+    gen = 0;
+  }
+  std::optional<size_t> pos;
+  std::optional<size_t> free_slot;
+  for (size_t i = 1; i < records.size(); i++) {
+    const auto& r = records[i];
+    if (!r.filename[0]) {
+      if (!free_slot) {
+        free_slot = i;
+      }
+      continue;
+    }
+    if (key == key_for(std::string(r.filename, strnlen(r.filename, sizeof(r.filename))))) {
+      pos = i;
+      break;
+    }
+  }
+
+  if (pos && !overwrite) {
+    // Someone else already recorded it, theirs is at least as new as ours.
+    loaded_ = false;
+    return true;
+  }
+  if (!pos && !stats) {
+    // Nothing to remove.
+    return true;
+  }
+
+  sub_stats_rec_t r{};
+  if (pos) {
+    r = records.at(pos.value());
+  } else {
+    pos = free_slot.value_or(records.size());
+  }
+  if (stats) {
+    to_char_array(r.filename, key);
+    r.num_messages = stats->num_messages;
+    r.last_qscan = stats->last_qscan;
+    ++r.mod_count;
+  } else {
+    memset(&r, 0, sizeof(sub_stats_rec_t));
+  }
+  auto result = true;
+  if (rewrite_all) {
+    if (pos.value() >= records.size()) {
+      records.resize(pos.value() + 1);
+    }
+    records[pos.value()] = r;
+    result = file.Seek(0) && file.WriteVector(records);
+  } else {
+    result = file.Write(static_cast<DataFile<sub_stats_rec_t>::size_type>(pos.value()), &r);
+  }
+  // Bump the generation after the record is written so any reader that sees
+  // the new generation also sees the new record.
+  const auto header = header_rec(gen.value() + 1);
+  result = result && file.Write(0, &header);
+  // Force a reload on the next lookup to pick up our change along with
+  // anyone else's.
+  loaded_ = false;
+  return result;
+}
+
+} // namespace wwiv::sdk::msgapi
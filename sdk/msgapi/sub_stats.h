@@ -0,0 +1,124 @@
+/**************************************************************************/
+/*                                                                        */
+/*                          WWIV Version 5.x                              */
+/*           Copyright (C)2022, WWIV Software Services                    */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/**************************************************************************/
+#ifndef INCLUDED_SDK_MSGAPI_SUB_STATS_H
+#define INCLUDED_SDK_MSGAPI_SUB_STATS_H
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace wwiv::sdk::msgapi {
+
+#pragma pack(push, 1)
+/**
+ * On disk record for substats.dat.  One record per type-2 sub, keyed by
+ * the base filename of the sub.  An empty filename marks a free slot.
+ * Record 0 is the sub_stats_header_t.
+ */
+struct sub_stats_rec_t {
+  // Base filename of the sub (i.e. "general") without the extension.
+  char filename[32];
+  // Number of active messages in the sub.
+  uint32_t num_messages;
+  // qscan pointer of the last (highest) message in the sub.
+  uint32_t last_qscan;
+  // Number of times this record has been written.
+  uint32_t mod_count;
+  // UNUSED
+  uint8_t padding[4];
+};
+
+/**
+ * Record 0 of substats.dat.  Holds a generation counter that is incremented
+ * on every write so that readers can tell when their copy is stale.  The
+ * filename is always empty so it never matches a sub.
+ */
+struct sub_stats_header_t {
+  char filename[32];
+  // "WWIVSUB\x1A"
+  char signature[8];
+  uint64_t generation;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(sub_stats_rec_t) == 48, "sub_stats_rec_t == 48");
+static_assert(sizeof(sub_stats_header_t) == sizeof(sub_stats_rec_t),
+              "sub_stats_header_t == sub_stats_rec_t");
+
+struct sub_stats_t {
+  uint32_t num_messages{0};
+  uint32_t last_qscan{0};
+};
+
+/**
+ * Shared summary of every type-2 sub's message count and highest qscan
+ * pointer, stored in DATA/substats.dat.
+ *
+ * This lets newscan, QWK and the sub listing decide if a sub has anything
+ * new for a user without opening the sub's .sub file.  Anything which
+ * adds or removes posts from a sub must call update so the summary does
+ * not go stale; when a sub has no entry callers must fall back to reading
+ * the .sub file.
+ */
+class SubStats final {
+public:
+  explicit SubStats(std::filesystem::path datadir);
+  ~SubStats() = default;
+
+  /**
+   * Reloads substats.dat if it has changed on disk since it was last loaded.
+   * This only reads the header record when nothing has changed.
+   */
+  bool Refresh();
+
+  /** Returns the stats for the sub with base filename, if known. */
+  [[nodiscard]] std::optional<sub_stats_t> get(const std::string& filename);
+
+  /** Sets the stats for the sub with base filename, adding it if needed. */
+  bool update(const std::string& filename, const sub_stats_t& stats);
+
+  /**
+   * Sets the stats for the sub with base filename only if there is no
+   * entry for it already.  Used by readers that fell back to reading the
+   * .sub file so they never clobber a newer value written by a poster.
+   */
+  bool seed(const std::string& filename, const sub_stats_t& stats);
+
+  /** Removes the entry for filename, used when a sub is renamed or removed. */
+  bool remove(const std::string& filename);
+
+  [[nodiscard]] const std::filesystem::path& path() const noexcept { return path_; }
+
+private:
+  bool Load();
+  bool Write(const std::string& filename, const std::optional<sub_stats_t>& stats, bool overwrite);
+
+  const std::filesystem::path path_;
+  std::vector<sub_stats_rec_t> records_;
+  std::map<std::string, size_t> index_;
+  // Generation from the header when last loaded, 0 when there is no file.
+  uint64_t generation_{0};
+  bool loaded_{false};
+};
+
+} // namespace wwiv::sdk::msgapi
+
+#endif
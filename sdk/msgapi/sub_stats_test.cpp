@@ -0,0 +1,156 @@
+/**************************************************************************/
+/*                                                                        */
+/*                          WWIV Version 5.x                              */
+/*           Copyright (C)2022, WWIV Software Services                    */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/**************************************************************************/
+#include "gtest/gtest.h"
+
+#include "core/file.h"
+#include "core/strings.h"
+#include "sdk/config.h"
+#include "sdk/msgapi/message_api_wwiv.h"
+#include "sdk/msgapi/msgapi.h"
+#include "sdk/msgapi/sub_stats.h"
+#include "sdk/sdk_helper.h"
+#include <filesystem>
+#include <memory>
+#include <string>
+
+using namespace wwiv::core;
+using namespace wwiv::sdk;
+using namespace wwiv::sdk::msgapi;
+
+class SubStatsTest : public testing::Test {
+public:
+  SdkHelper helper;
+};
+
+TEST_F(SubStatsTest, Missing) {
+  SubStats stats(helper.datadir());
+  EXPECT_FALSE(stats.get("general").has_value());
+}
+
+TEST_F(SubStatsTest, Update) {
+  SubStats stats(helper.datadir());
+  ASSERT_TRUE(stats.update("general", {10, 1234}));
+  ASSERT_TRUE(stats.update("other", {1, 5}));
+
+  const auto s = stats.get("GENERAL");
+  ASSERT_TRUE(s.has_value());
+  EXPECT_EQ(10u, s->num_messages);
+  EXPECT_EQ(1234u, s->last_qscan);
+
+  ASSERT_TRUE(stats.update("general", {11, 1240}));
+  SubStats other(helper.datadir());
+  EXPECT_EQ(1240u, other.get("general")->last_qscan);
+  EXPECT_EQ(5u, other.get("other")->last_qscan);
+}
+
+TEST_F(SubStatsTest, Seed_DoesNotOverwrite) {
+  SubStats stats(helper.datadir());
+  ASSERT_TRUE(stats.update("general", {10, 1234}));
+  ASSERT_TRUE(stats.seed("general", {9, 1000}));
+  EXPECT_EQ(1234u, stats.get("general")->last_qscan);
+
+  ASSERT_TRUE(stats.seed("other", {2, 7}));
+  EXPECT_EQ(7u, stats.get("other")->last_qscan);
+}
+
+TEST_F(SubStatsTest, Remove_ReusesSlot) {
+  SubStats stats(helper.datadir());
+  ASSERT_TRUE(stats.update("a", {1, 1}));
+  ASSERT_TRUE(stats.update("b", {2, 2}));
+  ASSERT_TRUE(stats.remove("a"));
+  EXPECT_FALSE(stats.get("a").has_value());
+  ASSERT_TRUE(stats.update("c", {3, 3}));
+  // The header and two subs.
+  EXPECT_EQ(3 * sizeof(sub_stats_rec_t), std::filesystem::file_size(stats.path()));
+  EXPECT_EQ(2u, stats.get("b")->last_qscan);
+  EXPECT_EQ(3u, stats.get("c")->last_qscan);
+}
+
+TEST_F(SubStatsTest, Refresh_SeesOtherWriters) {
+  SubStats stats(helper.datadir());
+  EXPECT_FALSE(stats.get("general").has_value());
+  SubStats other(helper.datadir());
+  ASSERT_TRUE(other.update("general", {1, 42}));
+  ASSERT_TRUE(stats.Refresh());
+  EXPECT_EQ(42u, stats.get("general")->last_qscan);
+}
+
+TEST_F(SubStatsTest, Refresh_SeesSameSizeRewrite) {
+  SubStats stats(helper.datadir());
+  ASSERT_TRUE(stats.update("general", {1, 42}));
+  EXPECT_EQ(42u, stats.get("general")->last_qscan);
+  const auto size = std::filesystem::file_size(stats.path());
+  const auto mtime = std::filesystem::last_write_time(stats.path());
+
+  SubStats other(helper.datadir());
+  ASSERT_TRUE(other.update("general", {1, 43}));
+  // Make this look like an in-place rewrite within one mtime tick.
+  std::filesystem::last_write_time(stats.path(), mtime);
+  ASSERT_EQ(size, std::filesystem::file_size(stats.path()));
+
+  ASSERT_TRUE(stats.Refresh());
+  EXPECT_EQ(43u, stats.get("general")->last_qscan);
+}
+
+TEST_F(SubStatsTest, NoHeader_IsReplaced) {
+  SubStats stats(helper.datadir());
+  {
+    File f(stats.path());
+    ASSERT_TRUE(f.Open(File::modeBinary | File::modeCreateFile | File::modeReadWrite));
+    sub_stats_rec_t r{};
+    wwiv::strings::to_char_array(r.filename, "general");
+    r.last_qscan = 10;
+    ASSERT_EQ(static_cast<File::size_type>(sizeof(r)), f.Write(&r, sizeof(r)));
+  }
+  EXPECT_FALSE(stats.get("general").has_value());
+  ASSERT_TRUE(stats.update("other", {1, 5}));
+  EXPECT_FALSE(stats.get("general").has_value());
+  EXPECT_EQ(5u, stats.get("other")->last_qscan);
+}
+
+TEST_F(SubStatsTest, MessageApi_AddAndDelete) {
+  MessageApiOptions options;
+  options.overflow_strategy = OverflowStrategy::delete_none;
+  WWIVMessageApi api(options, helper.config(), {}, new NullLastReadImpl());
+
+  subboard_t sub{};
+  sub.filename = "a1";
+  ASSERT_TRUE(api.Create(sub, -1));
+  auto area(api.Open(sub, -1));
+  for (auto i = 0; i < 2; i++) {
+    auto m = area->CreateMessage();
+    m.header().set_title("Title");
+    m.header().set_from("From");
+    m.header().set_daten(915192000 + i);
+    m.set_text("Text\r\n");
+    ASSERT_TRUE(area->AddMessage(m, {}));
+  }
+  const auto last = area->ReadMessageHeader(2)->last_read();
+
+  SubStats stats(helper.datadir());
+  auto s = stats.get("a1");
+  ASSERT_TRUE(s.has_value());
+  EXPECT_EQ(2u, s->num_messages);
+  EXPECT_EQ(last, s->last_qscan);
+
+  ASSERT_TRUE(area->DeleteMessage(2));
+  ASSERT_TRUE(stats.Refresh());
+  s = stats.get("a1");
+  EXPECT_EQ(1u, s->num_messages);
+  EXPECT_EQ(area->ReadMessageHeader(1)->last_read(), s->last_qscan);
+}
@@ -21,11 +21,15 @@
 #include "core/datetime.h"
 #include "core/file.h"
 #include "core/log.h"
+#include "core/stl.h"
 #include "core/strings.h"
 #include "sdk/filenames.h"
 #include "sdk/fido/fido_address.h"
 #include "sdk/net/networks.h"
+#include <cstring>
+#include <algorithm>
 #include <map>
+#include <set>
 #include <sstream>
 #include <string>
 #include <utility>
@@ -66,7 +70,8 @@ Contact::Contact(Network net, bool save_on_destructor)
     initialized_ = file.ReadVector(vs);
   }
 
-  for (const auto& v : vs) {
+  for (auto i = 0; i < stl::ssize(vs); i++) {
+    const auto& v = vs.at(i);
     if (v.systemnumber == 0) {
       VLOG(2) << "Skipping contact.net entry for system #0 from file: " << file.file();
       continue;
@@ -74,7 +79,9 @@ Contact::Contact(Network net, bool save_on_destructor)
     network_contact_record r{};
     r.address = NetworkContact::CreateFakeFtnAddress(v.systemnumber);
     r.ncr = v;
-    contacts_.emplace(r.address, NetworkContact(r));
+    if (contacts_.emplace(r.address, NetworkContact(r)).second) {
+      on_disk_.emplace(r.address, v);
+    }
   }
 
   if (!initialized_ && !contacts_.empty()) {
@@ -94,33 +101,144 @@ Contact::Contact(Network net, std::initializer_list<NetworkContact> l)
   }
 }
 
-bool Contact::Save() {
+/**
+ * Applies the changes made to a record since it was read (from base to ours)
+ * to the record currently on disk, so updates made by another process since
+ * are kept.
+ */
+static net_contact_rec merge_contact(const net_contact_rec& disk, const net_contact_rec& base,
+                                     const net_contact_rec& ours) {
+  auto r = disk;
+  const auto add_delta = [](auto d, auto b, auto o) {
+    return o >= b ? static_cast<decltype(d)>(d + (o - b)) : o;
+  };
+  r.numcontacts = add_delta(disk.numcontacts, base.numcontacts, ours.numcontacts);
+  r.numfails = add_delta(disk.numfails, base.numfails, ours.numfails);
+  r.bytes_received = add_delta(disk.bytes_received, base.bytes_received, ours.bytes_received);
+  r.bytes_sent = add_delta(disk.bytes_sent, base.bytes_sent, ours.bytes_sent);
+  if (ours.firstcontact != 0 && (r.firstcontact == 0 || ours.firstcontact < r.firstcontact)) {
+    r.firstcontact = ours.firstcontact;
+  }
+  r.lastcontact = std::max(disk.lastcontact, ours.lastcontact);
+  r.lastcontactsent = std::max(disk.lastcontactsent, ours.lastcontactsent);
+  r.lasttry = std::max(disk.lasttry, ours.lasttry);
+  if (ours.bytes_waiting != base.bytes_waiting) {
+    r.bytes_waiting = ours.bytes_waiting;
+  }
+  return r;
+}
+
+bool Contact::Flush() {
   if (net_.dir.empty()) {
     return false;
   }
+  std::vector<std::string> changed;
+  for (const auto& [address, c] : contacts_) {
+    const auto it = on_disk_.find(address);
+    if (it == std::end(on_disk_) ||
+        memcmp(&it->second, &c.ncr(), sizeof(net_contact_rec)) != 0) {
+      changed.push_back(address);
+    }
+  }
+  std::set<uint16_t> removed;
+  for (const auto& [address, ncr] : on_disk_) {
+    if (!stl::contains(contacts_, address)) {
+      removed.insert(ncr.systemnumber);
+    }
+  }
+  if (changed.empty() && removed.empty()) {
+    return !contacts_.empty();
+  }
 
-  VLOG(3) << "Saving contact.net to: " << FilePath(net_.dir, CONTACT_NET).string();
   DataFile<net_contact_rec> file(FilePath(net_.dir, CONTACT_NET),
-                 File::modeBinary | File::modeReadWrite | File::modeCreateFile | File::modeTruncate,
-                 File::shareDenyReadWrite);
+                                 File::modeBinary | File::modeReadWrite | File::modeCreateFile,
+                                 File::shareDenyNone);
   if (!file) {
     return false;
   }
-  if (contacts_.empty()) {
+  // Another process may have changed the file since it was read, so re-read
+  // it under the lock and merge our changes into what is there now.
+  auto lock = file.file().lock(FileLockType::write_lock);
+  std::vector<net_contact_rec> vs;
+  if (file.number_of_records() > 0 && !file.ReadVector(vs)) {
+    LOG(ERROR) << "Error reading: " << file.file();
     return false;
   }
+  if (!removed.empty()) {
+    vs.erase(std::remove_if(std::begin(vs), std::end(vs),
+                            [&](const net_contact_rec& v) {
+                              return stl::contains(removed, v.systemnumber);
+                            }),
+             std::end(vs));
+  }
+  std::map<uint16_t, int> record_for;
+  for (auto i = 0; i < stl::ssize(vs); i++) {
+    record_for.emplace(vs[i].systemnumber, i);
+  }
 
-  std::vector<net_contact_rec> vs;
-  for (const auto& v : contacts_) {
-    vs.emplace_back(v.second.ncr());
+  std::vector<int> dirty;
+  for (const auto& address : changed) {
+    const auto& ours = contacts_.at(address).ncr();
+    if (const auto it = record_for.find(ours.systemnumber); it != std::end(record_for)) {
+      const auto base = on_disk_.find(address);
+      vs[it->second] = base == std::end(on_disk_)
+                           ? ours
+                           : merge_contact(vs[it->second], base->second, ours);
+      dirty.push_back(it->second);
+    } else {
+      record_for.emplace(ours.systemnumber, stl::size_int(vs));
+      dirty.push_back(stl::size_int(vs));
+      vs.push_back(ours);
+    }
+  }
+
+  VLOG(3) << "Updating " << dirty.size() << " records in: " << file.file();
+  if (!removed.empty()) {
+    // Records were removed, so compact the file.
+    if (!file.Seek(0) || !file.WriteVector(vs) ||
+        !file.file().set_length(stl::ssize(vs) * sizeof(net_contact_rec))) {
+      LOG(ERROR) << "Error writing: " << file.file();
+      return false;
+    }
+  } else {
+    for (const auto record : dirty) {
+      if (!file.Write(record, &vs[record])) {
+        LOG(ERROR) << "Error writing contact.net record #" << record << " in: " << file.file();
+        return false;
+      }
+    }
+  }
+
+  // Pick up what other processes wrote, too.
+  std::map<uint16_t, std::string> address_for;
+  for (const auto& [address, c] : contacts_) {
+    address_for.emplace(c.ncr().systemnumber, address);
+  }
+  on_disk_.clear();
+  for (const auto& v : vs) {
+    if (v.systemnumber == 0) {
+      continue;
+    }
+    const auto it = address_for.find(v.systemnumber);
+    const auto address = it != std::end(address_for)
+                             ? it->second
+                             : NetworkContact::CreateFakeFtnAddress(v.systemnumber);
+    network_contact_record r{};
+    r.address = address;
+    r.ncr = v;
+    contacts_.insert_or_assign(address, NetworkContact(r));
+    on_disk_.insert_or_assign(address, v);
   }
+  return true;
+}
 
-  return file.WriteVector(vs);
+bool Contact::Save() {
+  return Flush();
 }
 
 Contact::~Contact() {
   if (save_on_destructor_) {
-    Save();
+    Flush();
   }
 }
 
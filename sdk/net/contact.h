@@ -108,6 +108,15 @@ class Contact {
   /** Removes the entry for a node */
   void remove(int node);
 
+  /**
+   * Writes the records changed since contact.net was read or last flushed.
+   * The file is re-read while holding a lock on it and our changes are merged
+   * into it, so updates from other processes are kept.  Changed records are
+   * written in place and new ones appended.  The whole file is only rewritten
+   * when records were removed.
+   */
+  bool Flush();
+  /** Same as Flush. */
   bool Save();
   [[nodiscard]] const std::map<std::string, NetworkContact>& contacts() const noexcept { return contacts_; }
   [[nodiscard]] std::map<std::string, NetworkContact>& mutable_contacts() { return contacts_; }
@@ -125,6 +134,9 @@ class Contact {
    bool initialized_{false};
 
    NetworkContact empty_contact{};
+
+   // Contents of each contact as last read or written.
+   std::map<std::string, net_contact_rec> on_disk_;
 };
 
 
@@ -15,8 +15,11 @@
 /*    either  express  or implied.  See  the  License for  the specific   */
 /*    language governing permissions and limitations under the License.   */
 /**************************************************************************/
+#include "core/datafile.h"
 #include "core/datetime.h"
 #include "core/strings.h"
+#include "core/test/file_helper.h"
+#include "sdk/filenames.h"
 #include "sdk/net/contact.h"
 #include "gtest/gtest.h"
 #include <chrono>
@@ -108,3 +111,122 @@ TEST_F(ContactTest, EnsureBytesWaitingClears) {
   EXPECT_EQ(0u, ncr1->bytes_waiting());
 }
 
+
+class ContactFileTest : public testing::Test {
+protected:
+  ContactFileTest() : net(net::network_type_t::wwivnet, "Test", helper.TempDir(), 1) {}
+
+  int num_records() {
+    DataFile<net_contact_rec> f(FilePath(net.dir, CONTACT_NET));
+    return f ? f.number_of_records() : -1;
+  }
+
+  test::FileHelper helper;
+  net::Network net;
+  DateTime now{DateTime::now()};
+};
+
+TEST_F(ContactFileTest, Flush_UpdatesInPlace) {
+  {
+    Contact c(net, false);
+    c.add_connect(1, now, 100, 200);
+    c.add_connect(2, now, 100, 200);
+    c.add_connect(3, now, 100, 200);
+    ASSERT_TRUE(c.Flush());
+  }
+  ASSERT_EQ(3, num_records());
+
+  // Two writers each updating a different node don't lose each others changes.
+  Contact a(net, false);
+  Contact b(net, false);
+  a.add_failure(1, now);
+  ASSERT_TRUE(a.Flush());
+  b.add_connect(3, now, 1000, 2000);
+  ASSERT_TRUE(b.Flush());
+  ASSERT_EQ(3, num_records());
+
+  Contact c(net, false);
+  EXPECT_EQ(1u, c.contact_rec_for(1)->numfails());
+  EXPECT_EQ(1100u, c.contact_rec_for(3)->bytes_sent());
+  EXPECT_EQ(1u, c.contact_rec_for(2)->numcontacts());
+}
+
+TEST_F(ContactFileTest, Flush_Appends) {
+  Contact a(net, false);
+  a.add_connect(1, now, 100, 200);
+  ASSERT_TRUE(a.Flush());
+  a.add_connect(2, now, 100, 200);
+  ASSERT_TRUE(a.Flush());
+  // Nothing changed, nothing is written.
+  ASSERT_TRUE(a.Flush());
+  EXPECT_EQ(2, num_records());
+
+  Contact b(net, false);
+  EXPECT_EQ(2u, b.contacts().size());
+  ASSERT_NE(nullptr, b.contact_rec_for(2));
+}
+
+TEST_F(ContactFileTest, Flush_Remove) {
+  Contact a(net, false);
+  a.add_connect(1, now, 100, 200);
+  a.add_connect(2, now, 100, 200);
+  ASSERT_TRUE(a.Flush());
+  a.remove(1);
+  ASSERT_TRUE(a.Flush());
+  EXPECT_EQ(1, num_records());
+
+  Contact b(net, false);
+  EXPECT_EQ(nullptr, b.contact_rec_for(1));
+  EXPECT_NE(nullptr, b.contact_rec_for(2));
+}
+
+TEST_F(ContactFileTest, Flush_FileRewrittenByOther) {
+  Contact a(net, false);
+  a.add_connect(1, now, 100, 200);
+  a.add_connect(2, now, 100, 200);
+  ASSERT_TRUE(a.Flush());
+
+  Contact b(net, false);
+  {
+    // Another process rewrites the file with a different order.
+    Contact other(net, false);
+    other.remove(1);
+    ASSERT_TRUE(other.Flush());
+    other.add_connect(1, now, 5, 5);
+    ASSERT_TRUE(other.Flush());
+  }
+  b.add_failure(1, now);
+  ASSERT_TRUE(b.Flush());
+
+  // Both the other process's connect and our failure are kept.
+  Contact c(net, false);
+  EXPECT_EQ(2u, c.contacts().size());
+  EXPECT_EQ(1u, c.contact_rec_for(1)->numfails());
+  EXPECT_EQ(2u, c.contact_rec_for(1)->numcontacts());
+  EXPECT_EQ(5u, c.contact_rec_for(1)->bytes_sent());
+  EXPECT_EQ(1u, c.contact_rec_for(2)->numcontacts());
+  EXPECT_EQ(5u, b.contact_rec_for(1)->bytes_sent());
+}
+
+TEST_F(ContactFileTest, Flush_SameRecordFromTwoWriters) {
+  {
+    Contact c(net, false);
+    c.add_connect(1, now, 100, 200);
+    ASSERT_TRUE(c.Flush());
+  }
+  Contact a(net, false);
+  Contact b(net, false);
+  a.add_connect(1, now, 10, 20);
+  b.add_failure(1, now);
+  b.add_connect(2, now, 1, 2);
+  ASSERT_TRUE(a.Flush());
+  ASSERT_TRUE(b.Flush());
+  EXPECT_EQ(2, num_records());
+
+  Contact c(net, false);
+  EXPECT_EQ(3u, c.contact_rec_for(1)->numcontacts());
+  EXPECT_EQ(1u, c.contact_rec_for(1)->numfails());
+  EXPECT_EQ(110u, c.contact_rec_for(1)->bytes_sent());
+  EXPECT_EQ(220u, c.contact_rec_for(1)->bytes_received());
+  EXPECT_NE(nullptr, c.contact_rec_for(2));
+}
@@ -17,18 +17,25 @@
 /**************************************************************************/
 #include "sdk/net/ftn_msgdupe.h"
 
-#include "core/crc32.h"
+#include "core/crc.h"
 #include "core/datafile.h"
 #include "core/file.h"
+#include "core/log.h"
+#include "core/mmap_file.h"
 #include "core/stl.h"
 #include "fmt/printf.h"
 #include "sdk/config.h"
 #include "sdk/fido/fido_packets.h"
 #include "sdk/fido/fido_util.h"
 #include "sdk/filenames.h"
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <ctime>
+#include <iterator>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -39,53 +46,404 @@ using namespace wwiv::strings;
 
 namespace wwiv::sdk {
 
-FtnMessageDupe::FtnMessageDupe(const Config& config) : FtnMessageDupe(config.datadir(), true) {}
+namespace {
+
+constexpr char kSignature[8] = {'W', 'W', 'I', 'V', 'D', 'U', 'P', '\x1A'};
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kMinCapacity = 1024;
+// Bits of bloom filter per slot, with 3 probes this keeps false positives
+// well under 1% at the maximum load factor.
+constexpr uint32_t kBloomBitsPerSlot = 16;
+constexpr uint32_t kBloomProbes = 3;
+constexpr uint32_t kSecondsPerDay = 24 * 60 * 60;
+
+enum msgdupe_kind_t : uint8_t { kind_header = 1, kind_msgid = 2 };
+enum msgdupe_state_t : uint8_t { state_empty = 0, state_used = 1, state_removed = 2 };
+
+uint32_t mix(uint32_t h) {
+  h ^= h >> 16;
+  h *= 0x85ebca6b;
+  h ^= h >> 13;
+  h *= 0xc2b2ae35;
+  h ^= h >> 16;
+  return h;
+}
+
+uint32_t hash_of(uint8_t kind, uint32_t crc) { return mix(crc ^ (kind * 0x9e3779b9u)); }
+
+size_t table_size(uint32_t capacity, uint32_t bloom_bytes) {
+  return sizeof(msgdupe_header_t) + bloom_bytes + capacity * sizeof(msgdupe_slot_t);
+}
+
+const msgdupe_header_t* header_of(const uint8_t* d) {
+  return reinterpret_cast<const msgdupe_header_t*>(d);
+}
+msgdupe_header_t* header_of(uint8_t* d) { return reinterpret_cast<msgdupe_header_t*>(d); }
+
+const uint8_t* bloom_of(const uint8_t* d) { return d + sizeof(msgdupe_header_t); }
+uint8_t* bloom_of(uint8_t* d) { return d + sizeof(msgdupe_header_t); }
+
+const msgdupe_slot_t* slots_of(const uint8_t* d) {
+  return reinterpret_cast<const msgdupe_slot_t*>(bloom_of(d) + header_of(d)->bloom_bytes);
+}
+msgdupe_slot_t* slots_of(uint8_t* d) {
+  return reinterpret_cast<msgdupe_slot_t*>(bloom_of(d) + header_of(d)->bloom_bytes);
+}
+
+bool is_valid_table(std::string_view v) {
+  if (v.size() < sizeof(msgdupe_header_t)) {
+    return false;
+  }
+  const auto* h = header_of(reinterpret_cast<const uint8_t*>(v.data()));
+  if (memcmp(h->signature, kSignature, sizeof(kSignature)) != 0 || h->version != kVersion) {
+    return false;
+  }
+  if (h->capacity == 0 || (h->capacity & (h->capacity - 1)) != 0) {
+    return false;
+  }
+  return v.size() == table_size(h->capacity, h->bloom_bytes);
+}
 
-FtnMessageDupe::FtnMessageDupe(const std::filesystem::path& datadir, bool use_filesystem)
-    : datadir_(datadir), use_filesystem_(use_filesystem) {
-  if (!datadir_.empty()) {
-    initialized_ = Load();
+/** Returns the smallest capacity that holds num_entries at a load under 50%. */
+uint32_t capacity_for(size_t num_entries) {
+  uint32_t capacity = kMinCapacity;
+  while (num_entries * 2 > capacity) {
+    capacity <<= 1;
   }
+  return capacity;
 }
 
-bool FtnMessageDupe::Load() {
-  if (!use_filesystem_) {
+std::string create_table(uint32_t capacity, uint32_t retention_days, uint32_t now) {
+  const auto bloom_bytes = capacity * kBloomBitsPerSlot / 8;
+  std::string contents(table_size(capacity, bloom_bytes), '\0');
+  auto* h = header_of(reinterpret_cast<uint8_t*>(contents.data()));
+  memcpy(h->signature, kSignature, sizeof(kSignature));
+  h->version = kVersion;
+  h->capacity = capacity;
+  h->retention_days = retention_days;
+  h->bloom_bytes = bloom_bytes;
+  h->created = now;
+  return contents;
+}
+
+/** Calls fn with each of the bloom filter bit numbers for kind and crc. */
+template <typename F> void for_each_bloom_bit(const uint8_t* d, uint8_t kind, uint32_t crc, F fn) {
+  const auto num_bits = header_of(d)->bloom_bytes * 8;
+  const auto h1 = hash_of(kind, crc);
+  const auto h2 = mix(h1 ^ 0x5bd1e995) | 1;
+  for (uint32_t i = 0; i < kBloomProbes; i++) {
+    fn((h1 + i * h2) % num_bits);
+  }
+}
+
+bool bloom_contains(const uint8_t* d, uint8_t kind, uint32_t crc) {
+  if (header_of(d)->bloom_bytes == 0) {
     return true;
   }
-  DataFile<msgids> file(FilePath(datadir_, MSGDUPE_DAT),
-                        File::modeReadWrite | File::modeBinary | File::modeCreateFile);
-  if (!file) {
-    LOG(ERROR) << "Unable to initialize FtnMessageDupe: Unable to create file.";
+  const auto* bloom = bloom_of(d);
+  auto found = true;
+  for_each_bloom_bit(d, kind, crc, [&](uint32_t bit) {
+    if ((bloom[bit / 8] & (1 << (bit % 8))) == 0) {
+      found = false;
+    }
+  });
+  return found;
+}
+
+void bloom_add(uint8_t* d, uint8_t kind, uint32_t crc) {
+  if (header_of(d)->bloom_bytes == 0) {
+    return;
+  }
+  auto* bloom = bloom_of(d);
+  for_each_bloom_bit(d, kind, crc,
+                     [&](uint32_t bit) { bloom[bit / 8] |= static_cast<uint8_t>(1 << (bit % 8)); });
+}
+
+bool is_live(const msgdupe_slot_t& s, uint32_t now, uint32_t retention_days) {
+  if (s.state != state_used) {
+    return false;
+  }
+  if (retention_days == 0 || now <= s.added) {
+    return true;
+  }
+  return now - s.added <= retention_days * kSecondsPerDay;
+}
+
+/**
+ * Returns the slot holding kind/crc, whether or not it has expired.  Uses
+ * the bloom filter to skip probing the table for unseen messages.
+ */
+std::optional<uint32_t> find_in(const uint8_t* d, uint8_t kind, uint32_t crc) {
+  if (!bloom_contains(d, kind, crc)) {
+    return std::nullopt;
+  }
+  const auto* h = header_of(d);
+  const auto* slots = slots_of(d);
+  const auto mask = h->capacity - 1;
+  auto idx = hash_of(kind, crc) & mask;
+  for (uint32_t i = 0; i < h->capacity; i++, idx = (idx + 1) & mask) {
+    const auto& s = slots[idx];
+    if (s.state == state_empty) {
+      return std::nullopt;
+    }
+    if (s.state == state_used && s.kind == kind && s.crc == crc) {
+      return idx;
+    }
+  }
+  return std::nullopt;
+}
+
+/**
+ * Stores kind/crc in the table, which must not already contain a live entry
+ * for it.  Removed and expired slots along the probe sequence are reused.
+ */
+bool place(uint8_t* d, uint8_t kind, uint32_t crc, uint32_t added, uint32_t now,
+           uint32_t retention_days) {
+  auto* h = header_of(d);
+  auto* slots = slots_of(d);
+  const auto mask = h->capacity - 1;
+  std::optional<uint32_t> reuse;
+  auto idx = hash_of(kind, crc) & mask;
+  for (uint32_t i = 0; i < h->capacity; i++, idx = (idx + 1) & mask) {
+    const auto& s = slots[idx];
+    if (s.state == state_empty) {
+      if (!reuse) {
+        reuse = idx;
+        ++h->used;
+      }
+      break;
+    }
+    if (!reuse && !is_live(s, now, retention_days)) {
+      reuse = idx;
+    }
+  }
+  if (!reuse) {
     return false;
   }
+  auto& s = slots[reuse.value()];
+  s.crc = crc;
+  s.added = added;
+  s.kind = kind;
+  s.state = state_used;
+  bloom_add(d, kind, crc);
+  return true;
+}
+
+} // namespace
+
+FtnMessageDupe::FtnMessageDupe(const Config& config) : FtnMessageDupe(config.datadir(), true) {}
+
+FtnMessageDupe::FtnMessageDupe(const std::filesystem::path& datadir, bool use_filesystem,
+                               int retention_days)
+    : datadir_(datadir), use_filesystem_(use_filesystem),
+      retention_days_(static_cast<uint32_t>(std::max(0, retention_days))),
+      clock_(system_clock_) {
+  initialized_ = !datadir_.empty();
+}
+
+FtnMessageDupe::FtnMessageDupe(const std::filesystem::path& datadir, bool use_filesystem,
+                               int retention_days, const Clock& clock)
+    : datadir_(datadir), use_filesystem_(use_filesystem),
+      retention_days_(static_cast<uint32_t>(std::max(0, retention_days))), clock_(clock) {
+  initialized_ = !datadir_.empty();
+}
 
-  const auto num_records = file.number_of_records();
-  if (num_records == 0) {
-    // nothing to read.
+FtnMessageDupe::~FtnMessageDupe() = default;
+
+bool FtnMessageDupe::Load() const {
+  if (loaded_) {
+    return data() != nullptr;
+  }
+  loaded_ = true;
+  if (!initialized_) {
+    return false;
+  }
+  if (!use_filesystem_) {
+    memory_ = create_table(kMinCapacity, retention_days_, now());
     return true;
   }
-  if (!file.ReadVector(dupes_)) {
-    LOG(ERROR) << "Unable to initialize FtnMessageDupe: Read Failed";
+
+  const auto path = FilePath(datadir_, MSGDUPE_IDX);
+  if (File::Exists(path)) {
+    auto f = std::make_unique<MemoryMappedFile>(path, MemoryMappedFile::Mode::read_write);
+    if (f->is_open() && is_valid_table(f->view())) {
+      file_ = std::move(f);
+      header_of(file_->mutable_data())->retention_days = retention_days_;
+      return true;
+    }
+    LOG(WARNING) << "Recreating invalid message dupe index: " << path.string();
+  }
+
+  // Import any entries from the msgdupe.dat used before msgdupe.idx.
+  std::vector<msgids> legacy;
+  const auto legacy_path = FilePath(datadir_, MSGDUPE_DAT);
+  if (File::Exists(legacy_path)) {
+    DataFile<msgids> file(legacy_path, File::modeReadOnly | File::modeBinary);
+    if (!file || !file.ReadVector(legacy)) {
+      LOG(WARNING) << "Unable to read legacy message dupe file: " << legacy_path.string();
+      legacy.clear();
+    }
+  }
+  const auto t = now();
+  auto contents = create_table(capacity_for(legacy.size() * 2), retention_days_, t);
+  auto* d = reinterpret_cast<uint8_t*>(contents.data());
+  for (const auto& ids : legacy) {
+    for (const auto& [kind, crc] : {std::make_pair(kind_header, ids.header),
+                                    std::make_pair(kind_msgid, ids.msgid)}) {
+      if (crc != 0 && !find_in(d, kind, crc)) {
+        place(d, kind, crc, t, t, retention_days_);
+      }
+    }
+  }
+  if (!Open(std::move(contents))) {
+    LOG(ERROR) << "Unable to initialize FtnMessageDupe: Unable to create: " << path.string();
     return false;
   }
-  for (const auto& d : dupes_) {
-    header_dupes_.insert(d.header);
-    msgid_dupes_.insert(d.msgid);
+  if (!legacy.empty()) {
+    LOG(INFO) << "Imported " << legacy.size() << " entries from " << legacy_path.string();
+    File::Remove(legacy_path);
   }
   return true;
 }
 
-bool FtnMessageDupe::Save() {
+bool FtnMessageDupe::Open(std::string contents) const {
   if (!use_filesystem_) {
+    memory_ = std::move(contents);
     return true;
   }
-  DataFile<msgids> file(FilePath(datadir_, MSGDUPE_DAT),
-                        File::modeReadWrite | File::modeBinary | File::modeCreateFile |
-                            File::modeTruncate);
-  if (!file) {
+  // Write the new table next to the old one and rename it over the top, so
+  // a crash never leaves a partially written index behind.
+  const auto path = FilePath(datadir_, MSGDUPE_IDX);
+  const auto tmp_path = FilePath(datadir_, StrCat(MSGDUPE_IDX, ".tmp"));
+  file_.reset();
+  {
+    File f(tmp_path);
+    if (!f.Open(File::modeBinary | File::modeReadWrite | File::modeCreateFile |
+                File::modeTruncate)) {
+      return false;
+    }
+    if (f.Write(contents.data(), contents.size()) != static_cast<File::size_type>(contents.size())) {
+      f.Close();
+      File::Remove(tmp_path);
+      return false;
+    }
+  }
+  if (!File::Rename(tmp_path, path)) {
+    File::Remove(tmp_path);
+    return false;
+  }
+  file_ = std::make_unique<MemoryMappedFile>(path, MemoryMappedFile::Mode::read_write);
+  if (!file_->is_open()) {
+    file_.reset();
+    return false;
+  }
+  return true;
+}
+
+bool FtnMessageDupe::Rehash() {
+  const auto* d = data();
+  const auto t = now();
+  const auto* h = header_of(d);
+  const auto* slots = slots_of(d);
+  std::vector<msgdupe_slot_t> live;
+  for (uint32_t i = 0; i < h->capacity; i++) {
+    if (is_live(slots[i], t, retention_days_)) {
+      live.push_back(slots[i]);
+    }
+  }
+  const auto capacity = capacity_for(live.size() + 1);
+  VLOG(1) << "Rehashing message dupe index: " << live.size() << " live of " << h->used
+          << " used slots; capacity " << h->capacity << " -> " << capacity;
+  auto contents = create_table(capacity, retention_days_, h->created);
+  auto* nd = reinterpret_cast<uint8_t*>(contents.data());
+  for (const auto& s : live) {
+    place(nd, s.kind, s.crc, s.added, t, retention_days_);
+  }
+  return Open(std::move(contents));
+}
+
+uint8_t* FtnMessageDupe::data() {
+  if (use_filesystem_) {
+    return file_ ? file_->mutable_data() : nullptr;
+  }
+  return memory_.empty() ? nullptr : reinterpret_cast<uint8_t*>(memory_.data());
+}
+
+const uint8_t* FtnMessageDupe::data() const {
+  if (use_filesystem_) {
+    return file_ ? file_->data() : nullptr;
+  }
+  return memory_.empty() ? nullptr : reinterpret_cast<const uint8_t*>(memory_.data());
+}
+
+uint32_t FtnMessageDupe::now() const {
+  return static_cast<uint32_t>(clock_.Now().to_time_t());
+}
+
+std::optional<uint32_t> FtnMessageDupe::find(uint8_t kind, uint32_t crc) const {
+  if (crc == 0 || !Load()) {
+    return std::nullopt;
+  }
+  const auto* d = data();
+  const auto idx = find_in(d, kind, crc);
+  if (!idx || !is_live(slots_of(d)[idx.value()], now(), retention_days_)) {
+    return std::nullopt;
+  }
+  return idx;
+}
+
+bool FtnMessageDupe::insert(uint8_t kind, uint32_t crc) {
+  if (crc == 0) {
+    return true;
+  }
+  if (find(kind, crc)) {
+    return true;
+  }
+  if (!Load()) {
+    return false;
+  }
+  const auto* h = header_of(data());
+  if ((h->used + 1) * 4 > h->capacity * 3) {
+    if (!Rehash()) {
+      LOG(ERROR) << "Unable to rehash message dupe index.";
+      return false;
+    }
+  }
+  const auto t = now();
+  return place(data(), kind, crc, t, t, retention_days_);
+}
+
+bool FtnMessageDupe::erase(uint8_t kind, uint32_t crc) {
+  const auto idx = find(kind, crc);
+  if (!idx) {
     return false;
   }
-  return file.WriteVector(dupes_);
+  // The bloom filter bits are left set, they are cleared on the next rehash.
+  slots_of(data())[idx.value()].state = state_removed;
+  return true;
+}
+
+int FtnMessageDupe::size() const {
+  if (!Load()) {
+    return 0;
+  }
+  const auto* d = data();
+  const auto t = now();
+  const auto* slots = slots_of(d);
+  int count = 0;
+  for (uint32_t i = 0; i < header_of(d)->capacity; i++) {
+    if (is_live(slots[i], t, retention_days_)) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+int FtnMessageDupe::capacity() const {
+  if (!Load()) {
+    return 0;
+  }
+  return static_cast<int>(header_of(data())->capacity);
 }
 
 std::string FtnMessageDupe::CreateMessageID(const wwiv::sdk::fido::FidoAddress& a) {
@@ -129,11 +487,25 @@ std::string FtnMessageDupe::CreateMessageID(const wwiv::sdk::fido::FidoAddress&
 }
 
 // static
-std::string FtnMessageDupe::GetMessageIDFromText(const std::string& text) {
+std::string FtnMessageDupe::GetMessageIDFromText(std::string_view text) {
   static const std::string kMSGID = "MSGID: ";
-  auto lines = wwiv::sdk::fido::split_message(text);
-  for (const auto& line : lines) {
-    if (line.empty() || line.front() != '\001' || line.size() < 2) {
+  // Lines end in \r, and like split_message any \n or soft CR (0x8d) are
+  // ignored.  Only kludge lines are copied.
+  for (size_t start = 0; start < text.size();) {
+    auto end = text.find('\r', start);
+    if (end == std::string_view::npos) {
+      end = text.size();
+    }
+    const auto raw = text.substr(start, end - start);
+    start = end + 1;
+    const auto first = raw.find_first_not_of("\n\x8d");
+    if (first == std::string_view::npos || raw[first] != '\001') {
+      continue;
+    }
+    std::string line;
+    std::copy_if(std::begin(raw) + first, std::end(raw), std::back_inserter(line),
+                 [](char c) { return c != '\n' && c != '\x8d'; });
+    if (line.size() < 2) {
       continue;
     }
     auto s = line.substr(1);
@@ -163,22 +535,37 @@ std::string FtnMessageDupe::GetMessageIDFromWWIVText(const std::string& text) {
 }
 
 // static
+static uint32_t header_crc32_of(const fido::fido_packed_message_t& nh, std::string_view date_time,
+                                std::string_view from_user_name, std::string_view subject,
+                                std::string_view to_user_name) {
+  std::ostringstream s;
+  s << nh.orig_net << "/" << nh.orig_node << "\r\n";
+  s << nh.dest_net << "/" << nh.dest_node << "\r\n";
+  s << date_time << "\r\n";
+  s << from_user_name << "\r\n";
+  s << subject << "\r\n";
+  s << to_user_name << "\r\n";
+  return crc32string(s.str());
+}
+
 bool FtnMessageDupe::GetMessageCrc32s(const wwiv::sdk::fido::FidoPackedMessage& msg,
                                       uint32_t& header_crc32, uint32_t& msgid_crc32) {
-  std::ostringstream s;
-  s << msg.nh.orig_net << "/" << msg.nh.orig_node << "\r\n";
-  s << msg.nh.dest_net << "/" << msg.nh.dest_node << "\r\n";
-  s << msg.vh.date_time << "\r\n";
-  s << msg.vh.from_user_name << "\r\n";
-  s << msg.vh.subject << "\r\n";
-  s << msg.vh.to_user_name << "\r\n";
-
-  header_crc32 = crc32string(s.str());
+  header_crc32 = header_crc32_of(msg.nh, msg.vh.date_time, msg.vh.from_user_name,
+                                 msg.vh.subject, msg.vh.to_user_name);
   const auto msgid = FtnMessageDupe::GetMessageIDFromText(msg.vh.text);
   msgid_crc32 = crc32string(msgid);
   return true;
 }
 
+bool FtnMessageDupe::GetMessageCrc32s(const fido::fido_packed_message_view_t& msg,
+                                      uint32_t& header_crc32, uint32_t& msgid_crc32) {
+  header_crc32 = header_crc32_of(msg.nh, msg.date_time, msg.from_user_name, msg.subject,
+                                 msg.to_user_name);
+  const auto msgid = FtnMessageDupe::GetMessageIDFromText(msg.text);
+  msgid_crc32 = crc32string(msgid);
+  return true;
+}
+
 bool FtnMessageDupe::add(const FidoPackedMessage& msg) {
   uint32_t header_crc32 = 0;
   uint32_t msgid_crc32 = 0;
@@ -191,43 +578,19 @@ bool FtnMessageDupe::add(const FidoPackedMessage& msg) {
 }
 
 bool FtnMessageDupe::add(uint32_t header_crc32, uint32_t msgid_crc32) {
-  if (header_crc32 != 0) {
-    header_dupes_.insert(header_crc32);
-  }
-  if (msgid_crc32 != 0) {
-    msgid_dupes_.insert(msgid_crc32);
-  }
-
-  msgids ids{};
-  ids.header = header_crc32;
-  ids.msgid = msgid_crc32;
-
-  dupes_.emplace_back(ids);
-  return Save();
+  const auto header_ok = insert(kind_header, header_crc32);
+  const auto msgid_ok = insert(kind_msgid, msgid_crc32);
+  return header_ok && msgid_ok;
 }
 
 bool FtnMessageDupe::remove(uint32_t header_crc32, uint32_t msgid_crc32) {
-  for (auto it = dupes_.begin(); it != std::end(dupes_);) {
-    const auto& d = *it;
-    if (d.header == header_crc32 && d.msgid == msgid_crc32) {
-      dupes_.erase(it);
-      header_dupes_.erase(header_crc32);
-      msgid_dupes_.erase(msgid_crc32);
-      return Save();
-    }
-    ++it;
-  }
-  return false;
+  const auto header_removed = erase(kind_header, header_crc32);
+  const auto msgid_removed = erase(kind_msgid, msgid_crc32);
+  return header_removed || msgid_removed;
 }
 
 bool FtnMessageDupe::is_dupe(uint32_t header_crc32, uint32_t msgid_crc32) const {
-  if (contains(header_dupes_, header_crc32) && header_crc32 != 0) {
-    return true;
-  }
-  if (contains(msgid_dupes_, msgid_crc32) && msgid_crc32 != 0) {
-    return true;
-  }
-  return false;
+  return find(kind_header, header_crc32).has_value() || find(kind_msgid, msgid_crc32).has_value();
 }
 
 bool FtnMessageDupe::is_dupe(const FidoPackedMessage& msg) const {
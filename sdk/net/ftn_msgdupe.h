@@ -18,31 +18,90 @@
 #ifndef INCLUDED_SDK_FTN_MSGDUPE_H
 #define INCLUDED_SDK_FTN_MSGDUPE_H
 
-#include <filesystem>
-#include <string>
-#include <set>
-#include <vector>
+#include "core/clock.h"
+#include "core/mmap_file.h"
 #include "sdk/config.h"
 #include "sdk/fido/fido_address.h"
 #include "sdk/fido/fido_packets.h"
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
 
 namespace wwiv::sdk {
 
 #pragma pack(push, 1)
+/** Record format of the legacy msgdupe.dat, only read to migrate it to msgdupe.idx */
  struct msgids {
    uint32_t msgid;
    uint32_t header;
  };
+
+/**
+ * Header of msgdupe.idx.  The header is followed by bloom_bytes of bloom
+ * filter and then capacity msgdupe_slot_t entries.
+ */
+struct msgdupe_header_t {
+  // "WWIVDUP\x1A"
+  char signature[8];
+  uint32_t version;
+  // Number of slots, always a power of 2.
+  uint32_t capacity;
+  // Slots which are not empty (live, expired or removed).
+  uint32_t used;
+  uint32_t retention_days;
+  uint32_t bloom_bytes;
+  // time_t of when this table was created.
+  uint32_t created;
+  uint8_t reserved[32];
+};
+
+/** One entry in the msgdupe.idx open addressed hash table. */
+struct msgdupe_slot_t {
+  uint32_t crc;
+  // time_t of when this entry was added.
+  uint32_t added;
+  // msgdupe_kind_t
+  uint8_t kind;
+  // msgdupe_state_t
+  uint8_t state;
+  uint16_t reserved;
+};
 #pragma pack(pop)
 
 static_assert(std::is_trivial<msgids>::value == true);
 static_assert(sizeof(msgids) == sizeof(uint64_t), "sizeof(msgids) must be the same as an int64.");
+static_assert(sizeof(msgdupe_header_t) == 64, "msgdupe_header_t must be 64 bytes");
+static_assert(sizeof(msgdupe_slot_t) == 12, "msgdupe_slot_t must be 12 bytes");
 
+/**
+ * Tracks the header and MSGID CRCs of FTN messages seen, to detect dupes.
+ *
+ * The CRCs are kept in DATA/msgdupe.idx, an open addressed hash table which
+ * is memory mapped and updated in place, so lookups and adds do not need to
+ * read the whole history.  A bloom filter in front of the table lets most
+ * new messages skip probing the table altogether.
+ *
+ * Entries older than retention_days are treated as missing and their slots
+ * are reused.  When the table gets too full it is rewritten without the
+ * expired and removed entries, growing it if still needed.
+ */
 class FtnMessageDupe final {
 public:
+  static constexpr int kDefaultRetentionDays = 180;
+
   explicit FtnMessageDupe(const Config& config);
-  FtnMessageDupe(const std::filesystem::path& datadir, bool use_filesystem);
-  ~FtnMessageDupe() = default;
+  /**
+   * Creates a FtnMessageDupe using msgdupe.idx in datadir, or an in-memory
+   * table when use_filesystem is false.  A retention_days of 0 keeps entries
+   * forever.
+   */
+  FtnMessageDupe(const std::filesystem::path& datadir, bool use_filesystem,
+                 int retention_days = kDefaultRetentionDays);
+  FtnMessageDupe(const std::filesystem::path& datadir, bool use_filesystem,
+                 int retention_days, const core::Clock& clock);
+  ~FtnMessageDupe();
 
   [[nodiscard]] bool IsInitialized() const { return initialized_; }
   [[nodiscard]] std::string CreateMessageID(const fido::FidoAddress& a);
@@ -54,9 +113,12 @@ public:
   [[nodiscard]] bool is_dupe(const fido::FidoPackedMessage& msg) const;
 
   /** Returns the MSGID from this message or an empty string. */
-  [[nodiscard]] static std::string GetMessageIDFromText(const std::string& text);
+  [[nodiscard]] static std::string GetMessageIDFromText(std::string_view text);
   static bool GetMessageCrc32s(const fido::FidoPackedMessage& msg,
                                uint32_t& header_crc32, uint32_t& msgid_crc32);
+  /** Like above, but works from a view so the message is not copied. */
+  static bool GetMessageCrc32s(const fido::fido_packed_message_view_t& msg,
+                               uint32_t& header_crc32, uint32_t& msgid_crc32);
 
   /**
    * Returns the MSGID from this message in WWIV format 
@@ -64,16 +126,35 @@ public:
    */
   [[nodiscard]] static std::string GetMessageIDFromWWIVText(const std::string& text);
 
+  /** Number of live (not expired or removed) entries in the table. */
+  [[nodiscard]] int size() const;
+  /** Number of slots in the table. */
+  [[nodiscard]] int capacity() const;
+
 private:
-  bool Load();
-  bool Save();
+  // The table is opened on first use, since callers that only need
+  // CreateMessageID (like the BBS) should never touch it.
+  bool Load() const;
+  bool Open(std::string contents) const;
+  bool Rehash();
+  [[nodiscard]] std::optional<uint32_t> find(uint8_t kind, uint32_t crc) const;
+  bool insert(uint8_t kind, uint32_t crc);
+  bool erase(uint8_t kind, uint32_t crc);
+  [[nodiscard]] uint8_t* data();
+  [[nodiscard]] const uint8_t* data() const;
+  [[nodiscard]] uint32_t now() const;
 
   bool initialized_{ false };
   const std::filesystem::path datadir_;
-  std::vector<msgids> dupes_;
-  std::set<uint32_t> msgid_dupes_;
-  std::set<uint32_t> header_dupes_;
   bool use_filesystem_{true};
+  const uint32_t retention_days_;
+  const core::SystemClock system_clock_;
+  const core::Clock& clock_;
+  mutable bool loaded_{false};
+  // The table when use_filesystem_ is true.
+  mutable std::unique_ptr<core::MemoryMappedFile> file_;
+  // The table when use_filesystem_ is false.
+  mutable std::string memory_;
 };
 
 }
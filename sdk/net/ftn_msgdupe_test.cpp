@@ -20,6 +20,7 @@
 
 #include "core/datafile.h"
 #include "core/datetime.h"
+#include "core/fake_clock.h"
 #include "core/file.h"
 #include "core/log.h"
 #include "core/stl.h"
@@ -29,6 +30,7 @@
 #include "sdk/fido/fido_address.h"
 #include "sdk/net/ftn_msgdupe.h"
 #include "sdk/sdk_helper.h"
+#include <chrono>
 #include <cstdint>
 #include <cstring>
 #include <ctime>
@@ -119,6 +121,42 @@ TEST_F(FtnMsgDupeTest, Exists) {
                                       << "; delta: " << (id - last_message_id);
 }
 
+TEST_F(FtnMsgDupeTest, GetMessageIDFromText) {
+  const std::string text = "\001PID: WWIV\r\n\001MSGID: 1:2/3 1234abcd \r\nHi\r";
+  EXPECT_EQ("1:2/3 1234abcd", FtnMessageDupe::GetMessageIDFromText(text));
+  EXPECT_EQ("1:2/3 1", FtnMessageDupe::GetMessageIDFromText("Hello\r\x8d\001MSGID: 1:2/3 1"));
+  EXPECT_EQ("", FtnMessageDupe::GetMessageIDFromText("MSGID: 1:2/3 1\r"));
+  EXPECT_EQ("", FtnMessageDupe::GetMessageIDFromText(""));
+}
+
+TEST_F(FtnMsgDupeTest, GetMessageCrc32s_View) {
+  FidoPackedMessage msg;
+  msg.nh.orig_net = 2;
+  msg.nh.orig_node = 3;
+  msg.nh.dest_net = 4;
+  msg.nh.dest_node = 5;
+  msg.vh.date_time = "01 Jan 20  01:02:03";
+  msg.vh.to_user_name = "All";
+  msg.vh.from_user_name = "Sysop";
+  msg.vh.subject = "Hello";
+  msg.vh.text = "AREA:TEST\r\001MSGID: 1:2/3 1234abcd\rHi\r";
+
+  fido_packed_message_view_t view;
+  view.nh = msg.nh;
+  view.date_time = msg.vh.date_time;
+  view.to_user_name = msg.vh.to_user_name;
+  view.from_user_name = msg.vh.from_user_name;
+  view.subject = msg.vh.subject;
+  view.text = msg.vh.text;
+
+  uint32_t header = 0, msgid = 0, view_header = 0, view_msgid = 0;
+  ASSERT_TRUE(FtnMessageDupe::GetMessageCrc32s(msg, header, msgid));
+  ASSERT_TRUE(FtnMessageDupe::GetMessageCrc32s(view, view_header, view_msgid));
+  EXPECT_EQ(header, view_header);
+  EXPECT_EQ(msgid, view_msgid);
+  EXPECT_NE(0u, msgid);
+}
+
 TEST_F(FtnMsgDupeTest, Smoke) {
   FtnMessageDupe dupe(helper.datadir(), false);
   dupe.add(1, 2);
@@ -132,4 +170,116 @@ TEST_F(FtnMsgDupeTest, Remove) {
   EXPECT_TRUE(dupe.is_dupe(1, 2));
   dupe.remove(1, 2);
   EXPECT_FALSE(dupe.is_dupe(1, 2));
-}
\ No newline at end of file
+}
+TEST_F(FtnMsgDupeTest, Remove_Missing) {
+  FtnMessageDupe dupe(helper.datadir(), false);
+  dupe.add(1, 2);
+  EXPECT_FALSE(dupe.remove(3, 4));
+  EXPECT_TRUE(dupe.is_dupe(1, 2));
+}
+
+TEST_F(FtnMsgDupeTest, ZeroCrc_IsNeverDupe) {
+  FtnMessageDupe dupe(helper.datadir(), false);
+  dupe.add(0, 2);
+  EXPECT_FALSE(dupe.is_dupe(0, 0));
+  EXPECT_TRUE(dupe.is_dupe(0, 2));
+  EXPECT_EQ(1, dupe.size());
+}
+
+TEST_F(FtnMsgDupeTest, Persisted) {
+  {
+    FtnMessageDupe dupe(helper.datadir(), true);
+    dupe.add(1, 2);
+    dupe.add(3, 4);
+  }
+  EXPECT_TRUE(File::Exists(FilePath(helper.datadir(), MSGDUPE_IDX)));
+  FtnMessageDupe dupe(helper.datadir(), true);
+  EXPECT_TRUE(dupe.is_dupe(1, 0));
+  EXPECT_TRUE(dupe.is_dupe(0, 4));
+  EXPECT_FALSE(dupe.is_dupe(5, 6));
+  EXPECT_EQ(4, dupe.size());
+}
+
+TEST_F(FtnMsgDupeTest, Expired) {
+  FakeClock clock(DateTime::now());
+  FtnMessageDupe dupe(helper.datadir(), false, 10, clock);
+  dupe.add(1, 2);
+  clock.tick(std::chrono::hours(24 * 5));
+  dupe.add(3, 4);
+  EXPECT_TRUE(dupe.is_dupe(1, 2));
+
+  clock.tick(std::chrono::hours(24 * 6));
+  EXPECT_FALSE(dupe.is_dupe(1, 2));
+  EXPECT_TRUE(dupe.is_dupe(3, 4));
+  EXPECT_EQ(2, dupe.size());
+
+  // Expired slots are reused.
+  dupe.add(1, 2);
+  EXPECT_TRUE(dupe.is_dupe(1, 2));
+}
+
+TEST_F(FtnMsgDupeTest, NoRetention) {
+  FakeClock clock(DateTime::now());
+  FtnMessageDupe dupe(helper.datadir(), false, 0, clock);
+  dupe.add(1, 2);
+  clock.tick(std::chrono::hours(24 * 365 * 5));
+  EXPECT_TRUE(dupe.is_dupe(1, 2));
+}
+
+TEST_F(FtnMsgDupeTest, Grows) {
+  FtnMessageDupe dupe(helper.datadir(), true);
+  const auto initial_capacity = dupe.capacity();
+  const uint32_t num = initial_capacity * 2;
+  for (uint32_t i = 1; i <= num; i++) {
+    ASSERT_TRUE(dupe.add(i, i + 0x10000));
+  }
+  EXPECT_GT(dupe.capacity(), initial_capacity);
+  EXPECT_EQ(static_cast<int>(num * 2), dupe.size());
+  for (uint32_t i = 1; i <= num; i++) {
+    ASSERT_TRUE(dupe.is_dupe(i, 0)) << i;
+  }
+
+  FtnMessageDupe reopened(helper.datadir(), true);
+  EXPECT_EQ(dupe.capacity(), reopened.capacity());
+  EXPECT_TRUE(reopened.is_dupe(num, 0));
+}
+
+TEST_F(FtnMsgDupeTest, Rehash_DropsExpired) {
+  FakeClock clock(DateTime::now());
+  FtnMessageDupe dupe(helper.datadir(), true, 1, clock);
+  const auto initial_capacity = dupe.capacity();
+  for (int round = 0; round < 8; round++) {
+    for (int i = 1; i <= initial_capacity / 8; i++) {
+      ASSERT_TRUE(dupe.add(round * 100000 + i, 0));
+    }
+    clock.tick(std::chrono::hours(48));
+  }
+  // Only one round is ever live, so the table never needs to grow.
+  EXPECT_EQ(initial_capacity, dupe.capacity());
+}
+
+TEST_F(FtnMsgDupeTest, MigratesLegacyDupes) {
+  ASSERT_TRUE(CreateDupes({{2, 1}, {4, 3}}));
+  {
+    FtnMessageDupe dupe(helper.datadir(), true);
+    EXPECT_TRUE(dupe.is_dupe(1, 0));
+    EXPECT_TRUE(dupe.is_dupe(0, 4));
+    EXPECT_FALSE(dupe.is_dupe(2, 0));
+    EXPECT_EQ(4, dupe.size());
+  }
+  EXPECT_FALSE(File::Exists(FilePath(helper.datadir(), MSGDUPE_DAT)));
+  FtnMessageDupe dupe(helper.datadir(), true);
+  EXPECT_TRUE(dupe.is_dupe(3, 0));
+}
+
+TEST_F(FtnMsgDupeTest, InvalidIndex_IsRecreated) {
+  {
+    File f(FilePath(helper.datadir(), MSGDUPE_IDX));
+    ASSERT_TRUE(f.Open(File::modeBinary | File::modeReadWrite | File::modeCreateFile));
+    f.Write("garbage");
+  }
+  FtnMessageDupe dupe(helper.datadir(), true);
+  EXPECT_FALSE(dupe.is_dupe(1, 2));
+  EXPECT_TRUE(dupe.add(1, 2));
+  EXPECT_TRUE(dupe.is_dupe(1, 2));
+}
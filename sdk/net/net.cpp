@@ -33,7 +33,7 @@ using namespace wwiv::strings;
 namespace wwiv::sdk::net {
 
 bool Network::try_load_nodelist() {
-  if (nodelist && nodelist->initialized() && !nodelist->entries().empty()) {
+  if (nodelist && nodelist->initialized() && !nodelist->empty()) {
     return true;
   }
 
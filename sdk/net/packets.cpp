@@ -27,7 +27,12 @@
 #include "sdk/filenames.h"
 #include "sdk/subxtr.h"
 #include "sdk/net/subscribers.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <limits>
 #include <string>
+#include <string_view>
 #include <utility>
 
 using namespace wwiv::core;
@@ -70,22 +75,23 @@ bool delete_packet(File& f, NetPacket& packet) {
   return false;
 }
 
-std::tuple<NetPacket, ReadNetPacketResponse> read_packet(File& f, bool process_de) {
-  NetPacket packet{};
+// Reads the header and list of addresses for the packet at the current position
+// of f, leaving f positioned at the start of the packet text.
+static ReadNetPacketResponse read_header_and_list(File& f, NetPacket& packet) {
   // Since this packet is read from disk, mark it as such, and note the current position
   // as the packet offset.
   packet.set_source(NetPacketSource::DISK);
   packet.set_offset(f.current_position());
-  auto num_read = f.Read(&packet.nh, sizeof(net_header_rec));
+  const auto num_read = f.Read(&packet.nh, sizeof(net_header_rec));
   if (num_read == 0) {
     // at the end of the NetPacket.
-    return std::make_tuple(packet, ReadNetPacketResponse::END_OF_FILE);
+    return ReadNetPacketResponse::END_OF_FILE;
   }
 
   if (num_read != sizeof(net_header_rec)) {
     LOG(INFO) << "error reading header, got short read of size: " << num_read
               << "; expected: " << sizeof(net_header_rec);
-    return std::make_tuple(packet, ReadNetPacketResponse::ERROR);
+    return ReadNetPacketResponse::ERROR;
   }
 
   if (packet.nh.method > 0) {
@@ -98,13 +104,37 @@ std::tuple<NetPacket, ReadNetPacketResponse> read_packet(File& f, bool process_d
     f.Read(&packet.list[0], sizeof(uint16_t) * packet.nh.list_len);
   }
 
-  if (packet.nh.length != 0) {
-    const auto length = packet.nh.length;
+  if (packet.nh.length > static_cast<uint32_t>(std::numeric_limits<int32_t>::max())) {
+    LOG(INFO) << "error reading header, got length too big (underflow?): " << packet.nh.length;
+    return ReadNetPacketResponse::ERROR;
+  }
+  return ReadNetPacketResponse::OK;
+}
 
-    if (length > static_cast<uint32_t>(std::numeric_limits<int32_t>::max())) {
-      LOG(INFO) << "error reading header, got length too big (underflow?): " << length;
-      return std::make_tuple(packet, ReadNetPacketResponse::ERROR);
+std::tuple<NetPacket, ReadNetPacketResponse> read_packet_header(File& f, bool process_de) {
+  NetPacket packet{};
+  if (const auto r = read_header_and_list(f, packet); r != ReadNetPacketResponse::OK) {
+    return std::make_tuple(packet, r);
+  }
+  if (packet.nh.length != 0) {
+    f.Seek(packet.nh.length, File::Whence::current);
+    if (packet.nh.method == 1 && process_de && packet.nh.length > 146) {
+      // Match the length read_packet reports once the DE header is removed.
+      packet.nh.length -= 146;
     }
+  }
+  packet.set_end_offset(f.current_position());
+  return std::make_tuple(packet, ReadNetPacketResponse::OK);
+}
+
+std::tuple<NetPacket, ReadNetPacketResponse> read_packet(File& f, bool process_de) {
+  NetPacket packet{};
+  if (const auto r = read_header_and_list(f, packet); r != ReadNetPacketResponse::OK) {
+    return std::make_tuple(packet, r);
+  }
+
+  if (packet.nh.length != 0) {
+    const auto length = packet.nh.length;
 
     if (packet.nh.method == 1  && process_de &&
         packet.nh.length > 146 /* Make sure we have enough for a header */) {
@@ -116,7 +146,7 @@ std::tuple<NetPacket, ReadNetPacketResponse> read_packet(File& f, bool process_d
     }
     std::string read_text;
     read_text.resize(length);
-    num_read = f.Read(&read_text[0], packet.nh.length);
+    const auto num_read = f.Read(&read_text[0], packet.nh.length);
     read_text.resize(num_read);
     packet.set_text(std::move(read_text));
   }
@@ -133,42 +163,128 @@ bool write_deadnet_packet(const std::filesystem::path& dir, NetPacket& packet) {
   return write_wwivnet_packet(path, packet);
 }
 
-bool write_wwivnet_packet(const std::filesystem::path& path, const NetPacket& p) {
-  VLOG(2) << "write_wwivnet_packet: " << path.string();
-  LOG(INFO) << "write_wwivnet_packet: Writing type " << p.nh.main_type << "/" << p.nh.minor_type
-            << " message to NetPacket: " << path.string();
+// Checks that p can be written to the wwivnet file at path, logging any problems.
+static bool validate_packet_for_write(const std::filesystem::path& path, const NetPacket& p) {
   if (p.nh.length != p.text().size()) {
     LOG(ERROR) << "Error while writing NetPacket: " << path.string();
     LOG(ERROR) << "Mismatched text and p.nh.length.  text =" << p.text().size()
                << " nh.length = " << p.nh.length;
     return false;
   }
+  if (p.nh.list_len != p.list.size()) {
+    LOG(WARNING) << "p.nh.list_len [" << p.nh.list_len << "] != p.list.size() [" << p.list.size()
+                 << "]";
+  }
+  VLOG(4) << "p.nh.list_len: " << p.nh.list_len;
+  return true;
+}
+
+// Appends the on disk form of p (header, list and text) to buf.
+static void append_packet(std::string& buf, const NetPacket& p) {
+  buf.append(reinterpret_cast<const char*>(&p.nh), sizeof(net_header_rec));
+  if (p.nh.list_len) {
+    buf.append(reinterpret_cast<const char*>(&p.list[0]), sizeof(uint16_t) * p.nh.list_len);
+  }
+  buf.append(p.text());
+}
+
+bool write_wwivnet_packet(const std::filesystem::path& path, const NetPacket& p) {
+  VLOG(2) << "write_wwivnet_packet: " << path.string();
+  LOG(INFO) << "write_wwivnet_packet: Writing type " << p.nh.main_type << "/" << p.nh.minor_type
+            << " message to NetPacket: " << path.string();
+  if (!validate_packet_for_write(path, p)) {
+    return false;
+  }
   File file(path);
   if (!file.Open(File::modeReadWrite | File::modeBinary | File::modeCreateFile)) {
     LOG(ERROR) << "Error while writing NetPacket: " << path.string() << "Unable to open file.";
     return false;
   }
   file.Seek(0L, File::Whence::end);
-  const auto num = file.Write(&p.nh, sizeof(net_header_rec));
-  if (num != sizeof(net_header_rec)) {
-    // Let's fail now since we didn't write this right.
+  std::string buf;
+  append_packet(buf, p);
+  const auto num = file.Write(buf);
+  if (num != ssize(buf)) {
     LOG(ERROR) << "Error while writing NetPacket: " << path.string() << " num written (" << num
-               << ") != net_header_rec size.";
+               << ") != packet size: " << buf.size();
     return false;
   }
-  if (p.nh.list_len != p.list.size()) {
-    LOG(WARNING) << "p.nh.list_len [" << p.nh.list_len << "] != p.list.size() [" << p.list.size()
-                 << "]";
+  file.Close();
+  return true;
+}
+
+PacketSink::PacketSink(int buffer_size) : buffer_size_(buffer_size) {}
+
+PacketSink::~PacketSink() { Close(); }
+
+bool PacketSink::Write(const std::filesystem::path& path, const NetPacket& p) {
+  VLOG(2) << "PacketSink::Write: " << path.string();
+  LOG(INFO) << "PacketSink::Write: Writing type " << p.nh.main_type << "/" << p.nh.minor_type
+            << " message to NetPacket: " << path.string();
+  if (!validate_packet_for_write(path, p)) {
+    return false;
   }
-  VLOG(4) << "p.nh.list_len: " << p.nh.list_len;
-  if (p.nh.list_len) {
-    file.Write(&p.list[0], sizeof(uint16_t) * (p.nh.list_len));
+  auto& f = files_[path];
+  if (!f.file) {
+    auto file = std::make_unique<File>(path);
+    if (!file->Open(File::modeReadWrite | File::modeBinary | File::modeCreateFile,
+                    File::shareDenyReadWrite)) {
+      LOG(ERROR) << "Error while writing NetPacket: " << path.string() << "Unable to open file.";
+      files_.erase(path);
+      return false;
+    }
+    f.size = file->Seek(0L, File::Whence::end);
+    f.file = std::move(file);
+    f.buffer.reserve(buffer_size_);
+  }
+  const auto before = f.buffer.size();
+  append_packet(f.buffer, p);
+  f.size += static_cast<File::size_type>(f.buffer.size() - before);
+  if (ssize(f.buffer) >= buffer_size_) {
+    return flush(f);
   }
-  file.Write(p.text());
-  file.Close();
   return true;
 }
 
+bool PacketSink::flush(sink_file_t& f) {
+  if (f.buffer.empty()) {
+    return true;
+  }
+  const auto num = f.file->Write(f.buffer);
+  const auto result = num == ssize(f.buffer);
+  if (!result) {
+    LOG(ERROR) << "Error while writing NetPacket: " << f.file->path().string()
+               << " num written (" << num << ") != buffer size: " << f.buffer.size();
+    ok_ = false;
+  }
+  f.buffer.clear();
+  return result;
+}
+
+bool PacketSink::Close() {
+  for (auto& [path, f] : files_) {
+    if (!f.file) {
+      continue;
+    }
+    flush(f);
+    if (!f.file->fsync()) {
+      LOG(ERROR) << "Error syncing NetPacket file: " << path.string();
+      ok_ = false;
+    }
+    f.file->Close();
+    f.file.reset();
+    f.buffer = {};
+  }
+  return ok_;
+}
+
+std::optional<File::size_type> PacketSink::file_size(const std::filesystem::path& path) const {
+  if (const auto it = files_.find(path); it != std::end(files_)) {
+    return it->second.size;
+  }
+  return std::nullopt;
+}
+
 static std::string NetInfoFileName(uint16_t type) {
   switch (type) {
   case net_info_bbslist:
@@ -375,6 +491,53 @@ std::tuple<NetPacket, ReadNetPacketResponse> NetMailFile::Read() {
 }
 
 
+std::tuple<NetPacket, ReadNetPacketResponse> NetMailFile::ReadHeaderOnly() {
+  auto t = read_packet_header(file_, process_de_);
+  last_read_response_ = std::get<1>(t);
+  return t;
+}
+
+const std::vector<net_packet_index_t>& NetMailFile::index() {
+  if (index_) {
+    return index_.value();
+  }
+  std::vector<net_packet_index_t> index;
+  const auto saved_position = file_.current_position();
+  file_.Seek(0, File::Whence::begin);
+  for (;;) {
+    auto [packet, response] = read_packet_header(file_, process_de_);
+    if (response != ReadNetPacketResponse::OK) {
+      if (response == ReadNetPacketResponse::ERROR) {
+        LOG(WARNING) << "Stopped indexing " << file_ << " at bad packet at offset: "
+                     << packet.offset();
+      }
+      break;
+    }
+    index.push_back({packet.offset(), packet.end_offset() - packet.offset()});
+  }
+  file_.Seek(saved_position, File::Whence::begin);
+  index_ = std::move(index);
+  return index_.value();
+}
+
+int NetMailFile::num_packets() {
+  return size_int(index());
+}
+
+bool NetMailFile::SeekToPacket(int n) {
+  const auto& idx = index();
+  if (n < 0 || n > size_int(idx)) {
+    return false;
+  }
+  if (n == size_int(idx)) {
+    // Just past the last packet, the next read will be END_OF_FILE.
+    const auto end = idx.empty() ? 0 : idx.back().offset + idx.back().length;
+    return file_.Seek(end, File::Whence::begin) == end;
+  }
+  const auto offset = idx.at(n).offset;
+  return file_.Seek(offset, File::Whence::begin) == offset;
+}
+
 NetMailFile::iterator NetMailFile::begin() {
   file_.Seek(0, File::Whence::begin);
   return iterator(*this); 
@@ -392,6 +555,139 @@ NetMailFile::iterator::iterator(NetMailFile& f, ReadNetPacketResponse response)
 }
 
 
+/////////////////////////////////////////////////////////////////////////////
+// MappedNetMailFile
+
+uint16_t NetPacketView::list_at(int n) const {
+  uint16_t node;
+  std::memcpy(&node, list_.data() + n * sizeof(uint16_t), sizeof(uint16_t));
+  return node;
+}
+
+NetPacket NetPacketView::ToNetPacket() const {
+  NetPacket packet{};
+  packet.set_source(NetPacketSource::DISK);
+  packet.set_offset(offset_);
+  packet.set_end_offset(end_offset_);
+  packet.nh = nh_;
+  packet.list.resize(list_size());
+  if (!list_.empty()) {
+    std::memcpy(&packet.list[0], list_.data(), list_.size());
+  }
+  if (nh_.length != 0) {
+    packet.set_text(std::string(text_));
+  }
+  return packet;
+}
+
+// Returns a view of the packet starting at offset within data, which holds the
+// whole WWIVnet mail file.  Checks the packet the same way as read_packet.
+static std::tuple<NetPacketView, ReadNetPacketResponse>
+read_packet_view(std::string_view data, File::size_type offset, bool process_de) {
+  const auto start = static_cast<size_t>(offset);
+  if (offset < 0 || start >= data.size()) {
+    // at the end of the NetPacket.
+    return std::make_tuple(NetPacketView{}, ReadNetPacketResponse::END_OF_FILE);
+  }
+  if (data.size() - start < sizeof(net_header_rec)) {
+    LOG(INFO) << "error reading header, got short read of size: " << data.size() - start
+              << "; expected: " << sizeof(net_header_rec);
+    return std::make_tuple(NetPacketView{}, ReadNetPacketResponse::ERROR);
+  }
+  net_header_rec nh{};
+  std::memcpy(&nh, data.data() + start, sizeof(net_header_rec));
+  if (nh.method > 0) {
+    LOG(INFO) << "compression: de" << nh.method;
+  }
+  auto pos = start + sizeof(net_header_rec);
+  const auto list_len = std::min<size_t>(sizeof(uint16_t) * nh.list_len, data.size() - pos);
+  const auto list = data.substr(pos, list_len);
+  pos += list_len;
+
+  if (nh.length > static_cast<uint32_t>(std::numeric_limits<int32_t>::max())) {
+    LOG(INFO) << "error reading header, got length too big (underflow?): " << nh.length;
+    return std::make_tuple(NetPacketView{}, ReadNetPacketResponse::ERROR);
+  }
+  // Like read_packet, a short packet at the end of the file gets the text that is there.
+  const auto text_len = std::min<size_t>(nh.length, data.size() - pos);
+  auto text = data.substr(pos, text_len);
+  if (nh.method == 1 && process_de && nh.length > 146) {
+    // HACK - this should do this in a shim DE 146 is the sizeof EN/DE header for de1.
+    LOG(INFO) << text.substr(0, 146);
+    text.remove_prefix(std::min<size_t>(146, text.size()));
+  }
+  const auto end_offset = static_cast<File::size_type>(pos + text_len);
+  return std::make_tuple(NetPacketView(nh, list, text, offset, end_offset),
+                         ReadNetPacketResponse::OK);
+}
+
+MappedNetMailFile::MappedNetMailFile(const std::filesystem::path& path, bool process_de,
+                                     bool allow_write)
+    : file_(path, allow_write ? MemoryMappedFile::Mode::read_write
+                              : MemoryMappedFile::Mode::read_only),
+      process_de_(process_de) {
+  if (!file_) {
+    LOG(ERROR) << "Unable to open file: " << path.string();
+  }
+}
+
+File::size_type MappedNetMailFile::size() const noexcept {
+  return static_cast<File::size_type>(file_.size());
+}
+
+std::tuple<NetPacketView, ReadNetPacketResponse> MappedNetMailFile::Read(File::size_type offset) {
+  auto t = read_packet_view(file_.view(), offset, process_de_);
+  last_read_response_ = std::get<1>(t);
+  return t;
+}
+
+bool MappedNetMailFile::Delete(const NetPacketView& packet) {
+  auto* data = file_.mutable_data();
+  if (data == nullptr || packet.offset() < 0 ||
+      static_cast<size_t>(packet.offset()) + sizeof(net_header_rec) > file_.size()) {
+    return false;
+  }
+  constexpr uint16_t deleted = 0xFFFF;
+  std::memcpy(data + packet.offset() + offsetof(net_header_rec, main_type), &deleted,
+              sizeof(deleted));
+  return true;
+}
+
+const std::vector<net_packet_index_t>& MappedNetMailFile::index() {
+  if (index_) {
+    return index_.value();
+  }
+  std::vector<net_packet_index_t> index;
+  const auto data = file_.view();
+  for (File::size_type offset = 0;;) {
+    auto [packet, response] = read_packet_view(data, offset, process_de_);
+    if (response != ReadNetPacketResponse::OK) {
+      if (response == ReadNetPacketResponse::ERROR) {
+        LOG(WARNING) << "Stopped indexing " << file_.path() << " at bad packet at offset: "
+                     << offset;
+      }
+      break;
+    }
+    index.push_back({packet.offset(), packet.end_offset() - packet.offset()});
+    offset = packet.end_offset();
+  }
+  index_ = std::move(index);
+  return index_.value();
+}
+
+MappedNetMailFile::iterator::iterator(MappedNetMailFile& f, File::size_type offset)
+    : f_(&f), offset_(offset) {
+  if (offset >= 0) {
+    std::tie(packet_, response_) = f_->Read(offset);
+  }
+}
+
+MappedNetMailFile::iterator& MappedNetMailFile::iterator::operator++() {
+  offset_ = packet_.end_offset();
+  std::tie(packet_, response_) = f_->Read(offset_);
+  return *this;
+}
+
 uint16_t get_forsys(const wwiv::sdk::BbsListNet& b, uint16_t node) {
   VLOG(2) << "get_forsys (forward to systen number) for node: " << node;
 
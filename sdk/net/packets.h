@@ -19,12 +19,17 @@
 #define INCLUDED_SDK_NET_PACKETS_H
 
 #include "core/file.h"
+#include "core/mmap_file.h"
 #include "sdk/bbslist.h"
 #include "sdk/msgapi/message.h"
 #include "sdk/net/net.h"
 #include <filesystem>
+#include <map>
+#include <memory>
+#include <optional>
 #include <set>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace wwiv::sdk {
@@ -154,6 +159,14 @@ private:
   std::string text_;
 };
 
+/** Location of a packet within a WWIVnet mail file. */
+struct net_packet_index_t {
+  // Offset of the start of the packet header.
+  core::File::size_type offset;
+  // Length of the whole packet including the header, list and text.
+  core::File::size_type length;
+};
+
 /**
  * Class for reading a WWIVnet mail file, which contians a series of WWIVnet packets.  
  * 
@@ -231,6 +244,21 @@ public:
   // Reads a packet, returning the packet and repsonse.
   std::tuple<NetPacket, ReadNetPacketResponse> Read();
 
+  // Reads the header and list of the next packet, skipping over the text
+  // which is left empty.
+  std::tuple<NetPacket, ReadNetPacketResponse> ReadHeaderOnly();
+
+  // Positions the file so that the next Read returns packet number n (starting
+  // at 0).  n may be num_packets() to position at the end of the file.
+  bool SeekToPacket(int n);
+
+  // Number of packets in the file.
+  [[nodiscard]] int num_packets();
+
+  // Offsets of the packets in this file.  Built from a scan of the packet
+  // headers the first time it is needed, the file position is unchanged.
+  const std::vector<net_packet_index_t>& index();
+
   // Returns the underlying file.
   wwiv::core::File& file() { return file_; }
 
@@ -240,8 +268,142 @@ private:
   bool process_de_{false};
   bool open_{false};
   ReadNetPacketResponse last_read_response_{ReadNetPacketResponse::NOT_OPENED};
+  std::optional<std::vector<net_packet_index_t>> index_;
+};
+
+
+/**
+ * A packet within a MappedNetMailFile.  The list and text point into the
+ * mapped file, so a view is only valid while the file it came from is open.
+ * The header is copied, since packets start at any offset and it may not be
+ * aligned in the file.  Use ToNetPacket to get a copy of the packet to modify.
+ */
+class NetPacketView final {
+public:
+  NetPacketView() = default;
+  NetPacketView(const net_header_rec& nh, std::string_view list, std::string_view text,
+                core::File::size_type offset, core::File::size_type end_offset)
+      : nh_(nh), list_(list), text_(text), offset_(offset), end_offset_(end_offset) {}
+
+  // The header as it was in the file when read.  nh().length includes any DE
+  // header which is not part of text().
+  [[nodiscard]] const net_header_rec& nh() const noexcept { return nh_; }
+  // The raw bytes of the list of destination systems.
+  [[nodiscard]] std::string_view list() const noexcept { return list_; }
+  [[nodiscard]] int list_size() const noexcept { return static_cast<int>(list_.size() / 2); }
+  // Returns destination system number n from the list.
+  [[nodiscard]] uint16_t list_at(int n) const;
+  [[nodiscard]] std::string_view text() const noexcept { return text_; }
+  [[nodiscard]] bool deleted() const noexcept { return nh_.main_type == 0xFFFF; }
+
+  // Offset for the start of the packet
+  [[nodiscard]] core::File::size_type offset() const noexcept { return offset_; }
+  // Offset for the end of the packet
+  [[nodiscard]] core::File::size_type end_offset() const noexcept { return end_offset_; }
+
+  /** Copies this packet into a NetPacket, just like read_packet would return. */
+  [[nodiscard]] NetPacket ToNetPacket() const;
+
+private:
+  net_header_rec nh_{};
+  std::string_view list_;
+  std::string_view text_;
+  core::File::size_type offset_{-1};
+  core::File::size_type end_offset_{-1};
 };
 
+/**
+ * Reads a WWIVnet mail file by mapping it into memory, returning each packet as
+ * a NetPacketView without copying it.  The file is mapped once when opened, so
+ * packets appended to the file afterwards are not seen.
+ *
+ * // Example:
+ * MappedNetMailFile packets(path, true, true);
+ * if (!packets) {
+ *   return error;
+ * }
+ *
+ * for (const auto& packet : packets) {
+ *   if (!packet.deleted()) {
+ *     auto p = packet.ToNetPacket();
+ *     process_wwivnet_packet(p);
+ *   }
+ * }
+ */
+class MappedNetMailFile final {
+public:
+  class iterator {
+  public:
+    // iterator traits
+    using difference_type = std::ptrdiff_t;
+    using value_type = NetPacketView;
+    using pointer = const NetPacketView*;
+    using reference = const NetPacketView&;
+    using iterator_category = std::forward_iterator_tag;
+
+    iterator(MappedNetMailFile& f, core::File::size_type offset);
+    // prefix (++iter)
+    iterator& operator++();
+    // postfix (iter++)
+    iterator operator++(int) {
+      iterator retval = *this;
+      ++(*this);
+      return retval;
+    }
+    // Iterators are equal at the end of the file, or after reading a bad packet.
+    [[nodiscard]] bool operator==(const iterator& other) const noexcept {
+      return (done() && other.done()) || (!done() && !other.done() && offset_ == other.offset_);
+    }
+    bool operator!=(const iterator& other) const noexcept { return !(*this == other); }
+    [[nodiscard]] const NetPacketView& operator*() const noexcept { return packet_; }
+    [[nodiscard]] const NetPacketView* operator->() const noexcept { return &packet_; }
+
+  private:
+    [[nodiscard]] bool done() const noexcept { return response_ != ReadNetPacketResponse::OK; }
+    MappedNetMailFile* f_;
+    core::File::size_type offset_;
+    NetPacketView packet_;
+    ReadNetPacketResponse response_{ReadNetPacketResponse::END_OF_FILE};
+  };
+
+  MappedNetMailFile(const std::filesystem::path& path, bool process_de, bool allow_write);
+  MappedNetMailFile(const std::filesystem::path& path, bool process_de)
+      : MappedNetMailFile(path, process_de, false) {}
+  MappedNetMailFile(const MappedNetMailFile&) = delete;
+  MappedNetMailFile& operator=(const MappedNetMailFile&) = delete;
+  ~MappedNetMailFile() = default;
+
+  // Unmaps the file, which must be done before the file is moved or removed.
+  void Close() noexcept { file_.close(); }
+
+  [[nodiscard]] iterator begin() { return iterator(*this, 0); }
+  [[nodiscard]] iterator end() { return iterator(*this, -1); }
+
+  explicit operator bool() const noexcept { return file_.is_open(); }
+  // Response from the last packet read from the WWIVnet mail file.
+  [[nodiscard]] ReadNetPacketResponse last_read_response() const noexcept { return last_read_response_; }
+  // Size of the file in bytes.
+  [[nodiscard]] core::File::size_type size() const noexcept;
+
+  // Reads the packet that starts at offset.
+  std::tuple<NetPacketView, ReadNetPacketResponse> Read(core::File::size_type offset);
+
+  // Marks the packet deleted in the file.  The file must be opened with allow_write.
+  bool Delete(const NetPacketView& packet);
+
+  // Offsets of the packets in this file.  Built from a scan of the packet
+  // headers the first time it is needed.
+  const std::vector<net_packet_index_t>& index();
+
+  // Number of packets in the file.
+  [[nodiscard]] int num_packets() { return static_cast<int>(index().size()); }
+
+private:
+  core::MemoryMappedFile file_;
+  bool process_de_{false};
+  ReadNetPacketResponse last_read_response_{ReadNetPacketResponse::NOT_OPENED};
+  std::optional<std::vector<net_packet_index_t>> index_;
+};
 
 /**
  * Gets the next message field from a NetPacket text c with iterator iter.
@@ -281,6 +443,11 @@ uint16_t get_forsys(const wwiv::sdk::BbsListNet& b, uint16_t node);
 // Read the packet from disk, returning the packet and the response status.
 std::tuple<NetPacket, ReadNetPacketResponse> read_packet(wwiv::core::File& file, bool process_de);
 
+// Read the header and list of the packet from disk, seeking past the text which
+// is not read.  Returns the packet and the response status.
+std::tuple<NetPacket, ReadNetPacketResponse> read_packet_header(wwiv::core::File& file,
+                                                                 bool process_de);
+
 // Update the packet's header to be marked as deleted, rewrite the packet and seek
 // back to the end_offset of the packet.
 bool delete_packet(wwiv::core::File& f, NetPacket& packet);
@@ -290,6 +457,60 @@ bool delete_packet(wwiv::core::File& f, NetPacket& packet);
  */
 bool write_wwivnet_packet(const std::filesystem::path& path, const NetPacket& packet);
 
+/**
+ * Appends packets to WWIVnet files, keeping one open handle per destination
+ * file until Close is called.  The files are opened deny read/write so nothing
+ * else can touch them while the sink holds them.  Packets are buffered and
+ * written in blocks of up to buffer_size bytes, and each file is synced to disk
+ * once by Close.
+ *
+ * Use this instead of write_wwivnet_packet when many packets are routed at once.
+ */
+class PacketSink final {
+public:
+  static constexpr int kDefaultBufferSize = 256 * 1024;
+
+  explicit PacketSink(int buffer_size);
+  PacketSink() : PacketSink(kDefaultBufferSize) {}
+  PacketSink(const PacketSink&) = delete;
+  PacketSink& operator=(const PacketSink&) = delete;
+  // Closes the sink if Close wasn't called.
+  ~PacketSink();
+
+  /** Apends packet to the wwivnet file specified by path. */
+  bool Write(const std::filesystem::path& path, const NetPacket& packet);
+
+  /**
+   * Writes any buffered packets, syncs and closes all of the files.  Returns
+   * false if any packet could not be written.  Files written to after Close are
+   * opened again.
+   */
+  bool Close();
+
+  /**
+   * The length that the file at path has once all of the packets written to it
+   * are flushed, or nullopt if no packets were written to path.
+   */
+  [[nodiscard]] std::optional<core::File::size_type> file_size(const std::filesystem::path& path) const;
+
+  /** Number of destination files written to. */
+  [[nodiscard]] int num_files() const noexcept { return static_cast<int>(files_.size()); }
+
+private:
+  struct sink_file_t {
+    // The open file, or null once the sink has been closed.
+    std::unique_ptr<core::File> file;
+    std::string buffer;
+    core::File::size_type size{0};
+  };
+
+  bool flush(sink_file_t& f);
+
+  const int buffer_size_;
+  std::map<std::filesystem::path, sink_file_t> files_;
+  bool ok_{true};
+};
+
 /**
  * Apends packet to a wwivnet DEAD.NET file located in the dir directory.
  */
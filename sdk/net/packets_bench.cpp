@@ -0,0 +1,108 @@
+/**************************************************************************/
+/*                                                                        */
+/*                          WWIV Version 5.x                              */
+/*           Copyright (C)2022, WWIV Software Services                    */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/**************************************************************************/
+// Compares the throughput of reading a WWIVnet packet file with NetMailFile
+// and MappedNetMailFile.
+//
+// Usage: sdk_benchmarks [benchmark flags]
+#include "benchmark/benchmark.h"
+
+#include "core/file.h"
+#include "core/strings.h"
+#include "sdk/net/packets.h"
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+using namespace wwiv::core;
+using namespace wwiv::sdk::net;
+using namespace wwiv::strings;
+
+namespace {
+
+// Size of the synthetic packet file.
+constexpr int64_t kFileSize = 100 << 20;
+
+// Creates (once) a packet file of about kFileSize bytes of posts with text
+// between 500 bytes and 4k, returning the path to it.
+const std::filesystem::path& packet_file() {
+  static const auto path = [] {
+    auto p = std::filesystem::temp_directory_path() / "wwiv_packets_bench.net";
+    std::string buf;
+    buf.reserve(kFileSize + 8192);
+    uint32_t seed = 1;
+    for (auto i = 0; static_cast<int64_t>(buf.size()) < kFileSize; i++) {
+      seed = seed * 1103515245 + 12345;
+      auto text = StrCat("SUB", i, '\0', "Title ", i, '\0', "Sysop #1\r\n", "date\r\n");
+      text.append(500 + (seed >> 16) % 3500, 'x');
+      net_header_rec nh{};
+      nh.tosys = 1;
+      nh.fromsys = 2;
+      nh.main_type = main_type_new_post;
+      nh.length = static_cast<uint32_t>(text.size());
+      buf.append(reinterpret_cast<const char*>(&nh), sizeof(net_header_rec));
+      buf.append(text);
+    }
+    File f(p);
+    f.Open(File::modeBinary | File::modeReadWrite | File::modeCreateFile | File::modeTruncate);
+    f.Write(buf.data(), buf.size());
+    return p;
+  }();
+  return path;
+}
+
+void BM_NetMailFile(benchmark::State& state) {
+  const auto& path = packet_file();
+  for (auto _ : state) {
+    NetMailFile file(path, false);
+    for (const auto& p : file) {
+      benchmark::DoNotOptimize(p.nh.main_type);
+    }
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(std::filesystem::file_size(path)));
+}
+
+void BM_MappedNetMailFile(benchmark::State& state) {
+  const auto& path = packet_file();
+  for (auto _ : state) {
+    MappedNetMailFile file(path, false);
+    for (const auto& p : file) {
+      benchmark::DoNotOptimize(p.nh().main_type);
+    }
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(std::filesystem::file_size(path)));
+}
+
+// Like network1, which copies every packet to route it.
+void BM_MappedNetMailFile_ToNetPacket(benchmark::State& state) {
+  const auto& path = packet_file();
+  for (auto _ : state) {
+    MappedNetMailFile file(path, false);
+    for (const auto& p : file) {
+      benchmark::DoNotOptimize(p.ToNetPacket());
+    }
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(std::filesystem::file_size(path)));
+}
+
+} // namespace
+
+BENCHMARK(BM_NetMailFile)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_MappedNetMailFile)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_MappedNetMailFile_ToNetPacket)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
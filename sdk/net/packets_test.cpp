@@ -216,3 +216,174 @@ TEST_F(PacketsTest, PacketFileReader_Smoke) {
   const auto num = std::count_if(iter2, end, [](NetPacket) { return true; });
   EXPECT_EQ(3, num);
 }
+
+TEST_F(PacketsTest, PacketFileReader_SeekToPacket) {
+  const auto net = sdk_helper_.CreateTestNetwork(wwiv::sdk::net::network_type_t::wwivnet);
+  const auto path = FilePath(net.dir, LOCAL_NET);
+  for (auto i = 0; i < 5; i++) {
+    ASSERT_TRUE(write_wwivnet_packet(
+        path, CreatePacket("MYSUB", StrCat("Title", i), "Sysop #1", std::string(i * 10, 'x'))));
+  }
+
+  NetMailFile reader(path, false);
+  ASSERT_EQ(5, reader.num_packets());
+  EXPECT_EQ(0, reader.index().front().offset);
+
+  ASSERT_TRUE(reader.SeekToPacket(3));
+  auto [p3, r3] = reader.Read();
+  ASSERT_EQ(ReadNetPacketResponse::OK, r3);
+  EXPECT_EQ("Title3", ParsedNetPacketText::FromNetPacket(p3).title());
+  EXPECT_EQ(reader.index().at(3).offset, p3.offset());
+
+  ASSERT_TRUE(reader.SeekToPacket(1));
+  auto [p1, r1] = reader.Read();
+  ASSERT_EQ(ReadNetPacketResponse::OK, r1);
+  EXPECT_EQ("Title1", ParsedNetPacketText::FromNetPacket(p1).title());
+
+  ASSERT_TRUE(reader.SeekToPacket(5));
+  EXPECT_EQ(ReadNetPacketResponse::END_OF_FILE, std::get<1>(reader.Read()));
+  EXPECT_FALSE(reader.SeekToPacket(6));
+}
+
+TEST_F(PacketsTest, PacketFileReader_ReadHeaderOnly) {
+  const auto net = sdk_helper_.CreateTestNetwork(wwiv::sdk::net::network_type_t::wwivnet);
+  const auto path = FilePath(net.dir, LOCAL_NET);
+  const auto p1 = CreatePacket("MYSUB", "Title1", "Sysop #1", "Hello World");
+  ASSERT_TRUE(write_wwivnet_packet(path, p1));
+  ASSERT_TRUE(write_wwivnet_packet(path, CreatePacket("MYSUB", "Title2", "Sysop #1", "Hello")));
+
+  NetMailFile reader(path, false);
+  auto [h1, r1] = reader.ReadHeaderOnly();
+  ASSERT_EQ(ReadNetPacketResponse::OK, r1);
+  EXPECT_EQ(p1.nh.length, h1.nh.length);
+  EXPECT_EQ(main_type_new_post, h1.nh.main_type);
+  EXPECT_TRUE(h1.text().empty());
+
+  // The next full read starts at the following packet.
+  auto [p2, r2] = reader.Read();
+  ASSERT_EQ(ReadNetPacketResponse::OK, r2);
+  EXPECT_EQ(h1.end_offset(), p2.offset());
+  EXPECT_EQ("Title2", ParsedNetPacketText::FromNetPacket(p2).title());
+  EXPECT_EQ(ReadNetPacketResponse::END_OF_FILE, std::get<1>(reader.ReadHeaderOnly()));
+}
+
+TEST_F(PacketsTest, MappedNetMailFile_Smoke) {
+  const auto net = sdk_helper_.CreateTestNetwork(wwiv::sdk::net::network_type_t::wwivnet);
+  const auto path = FilePath(net.dir, LOCAL_NET);
+  for (auto i = 0; i < 3; i++) {
+    // Odd sized text, so that some of the headers aren't aligned in the file.
+    ASSERT_TRUE(write_wwivnet_packet(
+        path, CreatePacket("MYSUB", StrCat("Title", i), "Sysop #1", std::string(i * 10 + 1, 'x'))));
+  }
+
+  NetMailFile reader(path, false);
+  MappedNetMailFile mapped(path, false);
+  ASSERT_TRUE(mapped);
+  auto num{0};
+  for (const auto& view : mapped) {
+    auto [expected, response] = reader.Read();
+    ASSERT_EQ(ReadNetPacketResponse::OK, response);
+    EXPECT_EQ(expected.offset(), view.offset());
+    EXPECT_EQ(expected.end_offset(), view.end_offset());
+    EXPECT_EQ(expected.nh.main_type, view.nh().main_type);
+    EXPECT_EQ(expected.text(), view.text());
+
+    const auto p = view.ToNetPacket();
+    // Copied since the fields of the packed header may not be aligned.
+    EXPECT_EQ(uint32_t{expected.nh.length}, uint32_t{p.nh.length});
+    EXPECT_EQ(StrCat("Title", num), ParsedNetPacketText::FromNetPacket(p).title());
+    ++num;
+  }
+  EXPECT_EQ(3, num);
+  EXPECT_NE(0, mapped.index().at(1).offset % 4);
+  EXPECT_EQ(ReadNetPacketResponse::END_OF_FILE, mapped.last_read_response());
+  EXPECT_EQ(3, mapped.num_packets());
+  EXPECT_EQ(reader.index().at(2).offset, mapped.index().at(2).offset);
+}
+
+TEST_F(PacketsTest, MappedNetMailFile_Delete) {
+  const auto net = sdk_helper_.CreateTestNetwork(wwiv::sdk::net::network_type_t::wwivnet);
+  const auto path = FilePath(net.dir, LOCAL_NET);
+  ASSERT_TRUE(write_wwivnet_packet(path, CreatePacket("MYSUB", "Title1", "Sysop #1", "Hello")));
+  ASSERT_TRUE(write_wwivnet_packet(path, CreatePacket("MYSUB", "Title2", "Sysop #1", "World")));
+
+  {
+    MappedNetMailFile mapped(path, false, true);
+    auto [p1, r1] = mapped.Read(0);
+    ASSERT_EQ(ReadNetPacketResponse::OK, r1);
+    ASSERT_FALSE(p1.deleted());
+    ASSERT_TRUE(mapped.Delete(p1));
+    // The view has a copy of the header, so read it again to see the change.
+    EXPECT_TRUE(std::get<0>(mapped.Read(0)).deleted());
+  }
+
+  NetMailFile reader(path, false);
+  auto [p1, r1] = reader.Read();
+  ASSERT_EQ(ReadNetPacketResponse::OK, r1);
+  EXPECT_EQ(0xFFFF, p1.nh.main_type);
+  auto [p2, r2] = reader.Read();
+  ASSERT_EQ(ReadNetPacketResponse::OK, r2);
+  EXPECT_EQ(main_type_new_post, p2.nh.main_type);
+}
+
+TEST_F(PacketsTest, MappedNetMailFile_ReadOnlyDelete) {
+  const auto net = sdk_helper_.CreateTestNetwork(wwiv::sdk::net::network_type_t::wwivnet);
+  const auto path = FilePath(net.dir, LOCAL_NET);
+  ASSERT_TRUE(write_wwivnet_packet(path, CreatePacket("MYSUB", "Title1", "Sysop #1", "Hello")));
+
+  MappedNetMailFile mapped(path, false);
+  auto [p1, r1] = mapped.Read(0);
+  ASSERT_EQ(ReadNetPacketResponse::OK, r1);
+  EXPECT_FALSE(mapped.Delete(p1));
+  EXPECT_FALSE(p1.deleted());
+}
+
+TEST_F(PacketsTest, PacketSink_Smoke) {
+  const auto net = sdk_helper_.CreateTestNetwork(wwiv::sdk::net::network_type_t::wwivnet);
+  const auto local = FilePath(net.dir, LOCAL_NET);
+  const auto s2 = FilePath(net.dir, "s2.net");
+  // An existing packet that the sink must append after.
+  ASSERT_TRUE(write_wwivnet_packet(s2, CreatePacket("MYSUB", "Existing", "Sysop #1", "Hello")));
+  const auto existing_size = static_cast<File::size_type>(std::filesystem::file_size(s2));
+
+  // Small enough that some packets are flushed before Close.
+  PacketSink sink(100);
+  for (auto i = 0; i < 5; i++) {
+    ASSERT_TRUE(
+        sink.Write(local, CreatePacket("MYSUB", StrCat("Title", i), "Sysop #1", "Hello World")));
+  }
+  ASSERT_TRUE(sink.Write(s2, CreatePacket("MYSUB", "Title5", "Sysop #1", "Hello World")));
+  EXPECT_EQ(2, sink.num_files());
+  EXPECT_FALSE(sink.file_size(FilePath(net.dir, "s3.net")));
+  const auto s2_size = sink.file_size(s2);
+  ASSERT_TRUE(s2_size);
+  EXPECT_GT(*s2_size, existing_size);
+  ASSERT_TRUE(sink.Close());
+
+  EXPECT_EQ(sink.file_size(local).value(),
+            static_cast<File::size_type>(std::filesystem::file_size(local)));
+  EXPECT_EQ(*s2_size, static_cast<File::size_type>(std::filesystem::file_size(s2)));
+
+  NetMailFile reader(local, false);
+  ASSERT_EQ(5, reader.num_packets());
+  for (auto i = 0; i < 5; i++) {
+    auto [p, r] = reader.Read();
+    ASSERT_EQ(ReadNetPacketResponse::OK, r);
+    EXPECT_EQ(StrCat("Title", i), ParsedNetPacketText::FromNetPacket(p).title());
+  }
+
+  NetMailFile s2_reader(s2, false);
+  ASSERT_EQ(2, s2_reader.num_packets());
+  EXPECT_EQ("Existing", ParsedNetPacketText::FromNetPacket(std::get<0>(s2_reader.Read())).title());
+  EXPECT_EQ("Title5", ParsedNetPacketText::FromNetPacket(std::get<0>(s2_reader.Read())).title());
+}
+
+TEST_F(PacketsTest, PacketSink_BadLength) {
+  const auto net = sdk_helper_.CreateTestNetwork(wwiv::sdk::net::network_type_t::wwivnet);
+  auto p = CreatePacket("MYSUB", "Title", "Sysop #1", "Hello World");
+  p.nh.length += 10;
+  PacketSink sink;
+  EXPECT_FALSE(sink.Write(FilePath(net.dir, LOCAL_NET), p));
+  EXPECT_TRUE(sink.Close());
+  EXPECT_FALSE(File::Exists(FilePath(net.dir, LOCAL_NET)));
+}
@@ -25,6 +25,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <system_error>
 
 using namespace wwiv::core;
 using namespace wwiv::strings;
@@ -101,6 +102,23 @@ bool WriteFidoSubcriberFile(const std::filesystem::path& path, const std::set<Fi
   return true;
 }
 
+SubscriberCache::fido_subscribers_t
+SubscriberCache::fido_subscribers(const std::filesystem::path& path) {
+  std::error_code ec;
+  const auto mtime = File::Exists(path) ? File::last_write_time(path) : 0;
+  const auto size = std::filesystem::file_size(path, ec);
+  if (auto it = entries_.find(path); it != std::end(entries_)) {
+    if (!ec && it->second.mtime == mtime && it->second.size == size) {
+      return it->second.subscribers;
+    }
+  }
 
+  const auto subscribers = ReadFidoSubcriberFile(path);
+  auto v = std::make_shared<const std::vector<FidoAddress>>(std::begin(subscribers),
+                                                           std::end(subscribers));
+  // Use the file as it is now, since ReadFidoSubcriberFile creates missing ones.
+  entries_[path] = entry_t{File::last_write_time(path), std::filesystem::file_size(path, ec), v};
+  return v;
 }
 
+}
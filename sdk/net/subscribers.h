@@ -19,8 +19,13 @@
 #define INCLUDED_SDK_SUBSCRIBERS_H
 
 #include "sdk/fido/fido_address.h"
+#include <cstdint>
+#include <ctime>
 #include <filesystem>
+#include <map>
+#include <memory>
 #include <set>
+#include <vector>
 
 namespace wwiv::sdk {
 
@@ -30,6 +35,37 @@ bool WriteSubcriberFile(const std::filesystem::path& path, const std::set<uint16
 bool WriteFidoSubcriberFile(const std::filesystem::path& path,
                             const std::set<fido::FidoAddress>& subscribers);
 
+/**
+ * Caches the contents of FTN subscriber files so that they are only parsed
+ * once.  An entry is reread when the modification time or size of the file
+ * changes.
+ */
+class SubscriberCache final {
+public:
+  /** Sorted, immutable list of subscriber addresses shared by all callers. */
+  using fido_subscribers_t = std::shared_ptr<const std::vector<fido::FidoAddress>>;
+
+  SubscriberCache() = default;
+  ~SubscriberCache() = default;
+
+  /**
+   * Returns the subscribers in the FTN subscriber file at path, creating
+   * an empty file if none exists like ReadFidoSubcriberFile.
+   */
+  [[nodiscard]] fido_subscribers_t fido_subscribers(const std::filesystem::path& path);
+
+  /** Drops all cached entries. */
+  void clear() { entries_.clear(); }
+
+private:
+  struct entry_t {
+    time_t mtime{0};
+    uintmax_t size{0};
+    fido_subscribers_t subscribers;
+  };
+  std::map<std::filesystem::path, entry_t> entries_;
+};
+
 } // namespace wwiv::sdk
 
 #endif
@@ -0,0 +1,67 @@
+/**************************************************************************/
+/*                                                                        */
+/*                          WWIV Version 5.x                              */
+/*           Copyright (C)2022, WWIV Software Services                    */
+/*                                                                        */
+/*    Licensed  under the  Apache License, Version  2.0 (the "License");  */
+/*    you may not use this  file  except in compliance with the License.  */
+/*    You may obtain a copy of the License at                             */
+/*                                                                        */
+/*                http://www.apache.org/licenses/LICENSE-2.0              */
+/*                                                                        */
+/*    Unless  required  by  applicable  law  or agreed to  in  writing,   */
+/*    software  distributed  under  the  License  is  distributed on an   */
+/*    "AS IS"  BASIS, WITHOUT  WARRANTIES  OR  CONDITIONS OF ANY  KIND,   */
+/*    either  express  or implied.  See  the  License for  the specific   */
+/*    language governing permissions and limitations under the License.   */
+/**************************************************************************/
+#include "core/file.h"
+#include "core/test/file_helper.h"
+#include "sdk/net/subscribers.h"
+#include "gtest/gtest.h"
+
+using namespace wwiv::core;
+using namespace wwiv::sdk;
+using namespace wwiv::sdk::fido;
+
+class SubscriberCacheTest : public testing::Test {
+protected:
+  SubscriberCacheTest() { path = helper_.CreateTempFile("n1.net", "1:2/3\n1:2/1\n\n21:1/100\n"); }
+
+  test::FileHelper helper_;
+  std::filesystem::path path;
+  SubscriberCache cache;
+};
+
+TEST_F(SubscriberCacheTest, Smoke) {
+  const auto subs = cache.fido_subscribers(path);
+  ASSERT_EQ(3u, subs->size());
+  EXPECT_EQ(FidoAddress("1:2/1"), subs->at(0));
+  EXPECT_EQ(FidoAddress("1:2/3"), subs->at(1));
+  EXPECT_EQ(FidoAddress("21:1/100"), subs->at(2));
+}
+
+TEST_F(SubscriberCacheTest, Cached) {
+  const auto subs1 = cache.fido_subscribers(path);
+  const auto subs2 = cache.fido_subscribers(path);
+  EXPECT_EQ(subs1.get(), subs2.get());
+}
+
+TEST_F(SubscriberCacheTest, Changed) {
+  const auto subs1 = cache.fido_subscribers(path);
+  ASSERT_TRUE(WriteFidoSubcriberFile(path, {FidoAddress("1:2/4")}));
+  // Make sure the change is seen even within the same second.
+  ASSERT_TRUE(File::set_last_write_time(path, File::last_write_time(path) + 10));
+  const auto subs2 = cache.fido_subscribers(path);
+  ASSERT_EQ(1u, subs2->size());
+  EXPECT_EQ(FidoAddress("1:2/4"), subs2->front());
+  // Earlier callers still see the list they were given.
+  EXPECT_EQ(3u, subs1->size());
+}
+
+TEST_F(SubscriberCacheTest, Missing) {
+  const auto missing = FilePath(helper_.TempDir(), "n2.net");
+  const auto subs = cache.fido_subscribers(missing);
+  EXPECT_TRUE(subs->empty());
+  EXPECT_TRUE(File::Exists(missing));
+}
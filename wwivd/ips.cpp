@@ -28,10 +28,10 @@
 #include "wwivd/connection_data.h"
 #include <cereal/archives/json.hpp>
 #include <cereal/types/memory.hpp>
+#include <algorithm>
 #include <map>
 #include <memory>
 #include <string>
-#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -44,13 +44,22 @@ using namespace wwiv::stl;
 using namespace wwiv::strings;
 using namespace wwiv::os;
 
-static bool LoadLinesIntoSet(std::unordered_set<std::string>& s, const std::vector<std::string>& lines) {
+// Minimum number of seconds between saves of the autoblock list.
+static constexpr time_t kAutoBlockSaveSeconds = 10;
+
+static bool LoadLinesIntoSet(IpPrefixTree& s, const std::vector<std::string>& lines) {
   for (auto line : lines) {
     const auto space = line.find(' ');
     if (space != std::string::npos) {
       line = line.substr(0, space);
     }
-    s.emplace(StringTrim(line));
+    StringTrim(&line);
+    if (line.empty() || line.front() == '#') {
+      continue;
+    }
+    if (!s.insert(line)) {
+      LOG(WARNING) << "Ignoring invalid IP address or prefix: '" << line << "'";
+    }
   }
   return true;
 }
@@ -70,10 +79,7 @@ GoodIp::GoodIp(const std::filesystem::path& fn) {
 }
 
 bool GoodIp::IsAlwaysAllowed(const std::string& ip) {
-  if (ips_.empty()) {
-    return false;
-  }
-  return ips_.find(ip) != ips_.end();
+  return ips_.contains(ip);
 }
 
 BadIp::BadIp(const std::filesystem::path& fn, Clock& clock) : fn_(fn), clock_(clock) {
@@ -85,13 +91,16 @@ BadIp::BadIp(const std::filesystem::path& fn, Clock& clock) : fn_(fn), clock_(cl
 }
 
 bool BadIp::IsBlocked(const std::string& ip) {
-  if (ips_.empty()) {
-    return false;
-  }
-  return ips_.find(ip) != ips_.end();
+  std::lock_guard<std::mutex> lock(mu_);
+  return ips_.contains(ip);
 }
+
 bool BadIp::Block(const std::string& ip) {
-  ips_.emplace(ip);
+  std::lock_guard<std::mutex> lock(mu_);
+  if (!ips_.insert(ip)) {
+    LOG(WARNING) << "Unable to block invalid IP address: '" << ip << "'";
+    return false;
+  }
   TextFile appender(fn_, "at");
   const auto now = clock_.Now();
   const auto written =
@@ -99,8 +108,140 @@ bool BadIp::Block(const std::string& ip) {
   return written > 0;
 }
 
+ConnectionRateLimiter::ConnectionRateLimiter(int max_addresses, int max_sessions,
+                                             int window_seconds)
+    : max_sessions_(std::clamp(max_sessions, 1, kMaxSessions)), window_seconds_(window_seconds),
+      entries_(std::max(1, max_addresses)),
+      times_(static_cast<size_t>(std::max(1, max_addresses)) * max_sessions_) {
+  size_t num_buckets = 1;
+  while (num_buckets < entries_.size()) {
+    num_buckets <<= 1;
+  }
+  buckets_.resize(num_buckets, -1);
+}
+
+uint32_t ConnectionRateLimiter::bucket(const ip_address& ip) const noexcept {
+  // FNV-1a
+  uint32_t h = 2166136261u;
+  const auto* d = ip.data();
+  for (auto i = 0; i < 16; i++) {
+    h ^= static_cast<uint8_t>(d[i]);
+    h *= 16777619u;
+  }
+  return h & static_cast<uint32_t>(buckets_.size() - 1);
+}
+
+int32_t ConnectionRateLimiter::find(const ip_address& ip) const noexcept {
+  for (auto e = buckets_[bucket(ip)]; e != -1; e = entries_[e].hash_next) {
+    if (entries_[e].ip == ip) {
+      return e;
+    }
+  }
+  return -1;
+}
+
+int ConnectionRateLimiter::count(int32_t e, time_t now) const noexcept {
+  const auto& entry = entries_[e];
+  const auto* times = &times_[static_cast<size_t>(e) * max_sessions_];
+  const auto oldest_in_window = now - window_seconds_;
+  auto n = 0;
+  for (auto i = 0; i < entry.num_times; i++) {
+    if (times[(entry.first_time + i) % max_sessions_] >= oldest_in_window) {
+      ++n;
+    }
+  }
+  return n;
+}
+
+int ConnectionRateLimiter::count(const ip_address& ip, time_t now) const {
+  const auto e = find(ip);
+  return e == -1 ? 0 : count(e, now);
+}
+
+void ConnectionRateLimiter::unlink_lru(int32_t e) noexcept {
+  auto& entry = entries_[e];
+  if (entry.prev != -1) {
+    entries_[entry.prev].next = entry.next;
+  } else {
+    lru_head_ = entry.next;
+  }
+  if (entry.next != -1) {
+    entries_[entry.next].prev = entry.prev;
+  } else {
+    lru_tail_ = entry.prev;
+  }
+  entry.prev = entry.next = -1;
+}
+
+void ConnectionRateLimiter::push_front_lru(int32_t e) noexcept {
+  auto& entry = entries_[e];
+  entry.prev = -1;
+  entry.next = lru_head_;
+  if (lru_head_ != -1) {
+    entries_[lru_head_].prev = e;
+  }
+  lru_head_ = e;
+  if (lru_tail_ == -1) {
+    lru_tail_ = e;
+  }
+}
+
+void ConnectionRateLimiter::unlink_hash(int32_t e) noexcept {
+  auto* p = &buckets_[bucket(entries_[e].ip)];
+  while (*p != e) {
+    p = &entries_[*p].hash_next;
+  }
+  *p = entries_[e].hash_next;
+  entries_[e].hash_next = -1;
+}
+
+int ConnectionRateLimiter::Connection(const ip_address& ip, time_t now) {
+  auto e = find(ip);
+  if (e != -1) {
+    unlink_lru(e);
+  } else {
+    if (size_ < ssize(entries_)) {
+      e = size_++;
+    } else {
+      // Reuse the least recently seen address.
+      e = lru_tail_;
+      unlink_lru(e);
+      unlink_hash(e);
+    }
+    auto& entry = entries_[e];
+    entry.ip = ip;
+    entry.num_times = 0;
+    entry.first_time = 0;
+    const auto b = bucket(ip);
+    entry.hash_next = buckets_[b];
+    buckets_[b] = e;
+  }
+  push_front_lru(e);
+
+  auto& entry = entries_[e];
+  auto* times = &times_[static_cast<size_t>(e) * max_sessions_];
+  if (entry.num_times < max_sessions_) {
+    times[(entry.first_time + entry.num_times++) % max_sessions_] = now;
+  } else {
+    // Replace the oldest time.
+    times[entry.first_time] = now;
+    entry.first_time = (entry.first_time + 1) % max_sessions_;
+  }
+  return count(e, now);
+}
+
+// The first connection is always allowed, so the smallest number of sessions
+// that will block an address is 2.  The limiter never counts more than
+// kMaxSessions, so larger values would never block.
+static int auto_bl_sessions(const wwivd_blocking_t& b) {
+  return std::clamp(b.auto_bl_sessions, 2, ConnectionRateLimiter::kMaxSessions);
+}
+
 AutoBlocker::AutoBlocker(std::shared_ptr<BadIp> bip, wwivd_blocking_t b, std::filesystem::path datadir, Clock& clock)
-    : bip_(std::move(bip)), b_(std::move(b)), datadir_(std::move(datadir)), clock_(clock) {
+    : bip_(std::move(bip)), b_(std::move(b)), datadir_(std::move(datadir)),
+      limiter_(b_.auto_blocklist ? ConnectionRateLimiter::kDefaultMaxAddresses : 1,
+               auto_bl_sessions(b_), b_.auto_bl_seconds),
+      clock_(clock) {
   if (b_.block_duration.empty()) {
     b_.block_duration.emplace_back("15m");
   }
@@ -131,7 +272,11 @@ AutoBlocker::AutoBlocker(std::shared_ptr<BadIp> bip, wwivd_blocking_t b, std::fi
   }
 }
 
-AutoBlocker::~AutoBlocker() = default;
+AutoBlocker::~AutoBlocker() {
+  if (dirty_) {
+    Save();
+  }
+}
 
 
 void AutoBlocker::escalate_block(const std::string& ip) {
@@ -150,6 +295,14 @@ void AutoBlocker::escalate_block(const std::string& ip) {
     auto_blocked_.erase(ip);
     bip_->Block(ip);
   }
+  dirty_ = true;
+  MaybeSave(now.to_time_t());
+}
+
+void AutoBlocker::MaybeSave(time_t now) {
+  if (!dirty_ || now - last_save_ < kAutoBlockSaveSeconds) {
+    return;
+  }
   Save();
 }
 
@@ -159,12 +312,18 @@ bool AutoBlocker::Connection(const std::string& ip) {
     return true;
   }
 
-  const auto now = clock_.Now();
+  const auto addr = ip_address::from_string(ip);
+  if (!addr) {
+    LOG(WARNING) << "AutoBlocker::Connection: Unable to parse ip: " << ip;
+    return true;
+  }
+  const auto now = clock_.Now().to_time_t();
 
   //
   // Synchronized from here on down
   //
   std::lock_guard<std::mutex> lock(mu_);
+  MaybeSave(now);
 
   if (blocked(ip)) {
     // We have an auto-block and we're still blocked.
@@ -172,34 +331,15 @@ bool AutoBlocker::Connection(const std::string& ip) {
     return false;
   }
 
-  const auto auto_bl_sessions = b_.auto_bl_sessions;
-  const auto auto_bl_seconds = b_.auto_bl_seconds;
-  const auto oldest_in_window = now.to_time_t() - auto_bl_seconds;
-
-  auto& s = sessions_[ip];
-  s.emplace(now.to_time_t());
-  if (s.size() == 1) {
-    VLOG(1) << "OK: num sessions: " << size_int(s);
-    return true;
-  }
-
-  for (auto iter = s.begin(); iter != s.end();) {
-    if (*iter < oldest_in_window) {
-      VLOG(1) << "Erasing old session for IP: " << ip;
-      iter = s.erase(iter);
-    } else {
-      ++iter;
-    }
-  }
-
-  if (ssize(s) >= auto_bl_sessions) {
-    LOG(INFO) << "Blocking since we have " << s.size() << " sessions within " << auto_bl_seconds
-              << " seconds.";
+  const auto num_sessions = limiter_.Connection(addr.value(), now);
+  if (num_sessions >= auto_bl_sessions(b_)) {
+    LOG(INFO) << "Blocking since we have " << num_sessions << " sessions within "
+              << b_.auto_bl_seconds << " seconds.";
     // Don't do the hard block here, just escalate.
     escalate_block(ip);
     return false;
   }
-  VLOG(1) << "OK: num sessions: " << size_int(s);
+  VLOG(1) << "OK: num sessions: " << num_sessions;
   return true;
 }
 
@@ -211,6 +351,8 @@ void serialize(Archive & ar, auto_blocked_entry_t &a) {
 
 bool AutoBlocker::Save() {
   LOG(INFO) << "AutoBlocker: Save";
+  dirty_ = false;
+  last_save_ = clock_.Now().to_time_t();
   JsonFile<std::map<std::string, auto_blocked_entry_t>> file(FilePath(datadir_, "wwivd.autoblock.json"), "autoblock", auto_blocked_);
   return file.Save();
 }
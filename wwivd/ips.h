@@ -19,20 +19,26 @@
 #define INCLUDED_WWIVD_IPS_H
 
 #include "core/clock.h"
+#include "core/ip_address.h"
+#include "core/ip_prefix_tree.h"
 #include "sdk/wwivd_config.h"
+#include <cstdint>
 #include <ctime>
 #include <filesystem>
+#include <map>
 #include <memory>
 #include <mutex>
-#include <set>
-#include <unordered_map>
-#include <unordered_set>
+#include <string>
 #include <vector>
 
 namespace wwiv::wwivd {
 
 using namespace wwiv::core;
 
+/**
+ * Addresses from goodip.txt which are always allowed to connect.  Each line
+ * is either an address or a prefix in CIDR notation, such as 10.0.0.0/8.
+ */
 class GoodIp {
 public:
   explicit GoodIp(const std::filesystem::path& fn);
@@ -41,19 +47,93 @@ public:
 
 private:
   [[nodiscard]] bool LoadLines(const std::vector<std::string>& ips);
-  std::unordered_set<std::string> ips_;
+  IpPrefixTree ips_;
 };
 
+/**
+ * Addresses from badip.txt which are never allowed to connect.  Each line
+ * is either an address or a prefix in CIDR notation, such as 10.0.0.0/8.
+ */
 class BadIp {
 public:
   BadIp(const std::filesystem::path& fn, Clock& clock);
   [[nodiscard]] bool IsBlocked(const std::string& ip);
+  /** Blocks ip and appends it to badip.txt */
   bool Block(const std::string& ip);
 
 private:
   const std::filesystem::path fn_;
-  std::unordered_set<std::string> ips_;
+  IpPrefixTree ips_;
   Clock& clock_;
+  std::mutex mu_;
+};
+
+/**
+ * Counts the recent connections from each address within a sliding window of
+ * window_seconds.  Only the most recent max_sessions (at most kMaxSessions)
+ * connection times are kept for each address, and only for the max_addresses most recently seen
+ * addresses, so all of the memory used is allocated up front and
+ * Connection() never allocates.
+ *
+ * This class is not thread safe.
+ */
+class ConnectionRateLimiter final {
+public:
+  ConnectionRateLimiter(int max_addresses, int max_sessions, int window_seconds);
+
+  /**
+   * Records a connection from ip at now, returning the number of connections
+   * from ip within the window, including this one.  The result is never more
+   * than max_sessions.
+   */
+  int Connection(const ip_address& ip, time_t now);
+
+  /**
+   * Returns the number of connections from ip within the window ending at
+   * now, without recording a new one.
+   */
+  [[nodiscard]] int count(const ip_address& ip, time_t now) const;
+
+  /** The number of addresses being tracked. */
+  [[nodiscard]] int size() const noexcept { return size_; }
+
+  /** The number of connection times kept for each address. */
+  [[nodiscard]] int max_sessions() const noexcept { return max_sessions_; }
+
+  static constexpr int kDefaultMaxAddresses = 16384;
+  // Bounds the memory used, since max_sessions comes from the config.
+  static constexpr int kMaxSessions = 100;
+
+private:
+  struct entry_t {
+    ip_address ip;
+    // The next entry in the same hash bucket.
+    int32_t hash_next{-1};
+    // The neighbours of this entry in the LRU list, prev is more recent.
+    int32_t prev{-1};
+    int32_t next{-1};
+    // The number of times stored, and the index of the oldest one.
+    int32_t num_times{0};
+    int32_t first_time{0};
+  };
+
+  [[nodiscard]] uint32_t bucket(const ip_address& ip) const noexcept;
+  [[nodiscard]] int32_t find(const ip_address& ip) const noexcept;
+  [[nodiscard]] int count(int32_t e, time_t now) const noexcept;
+  void unlink_lru(int32_t e) noexcept;
+  void push_front_lru(int32_t e) noexcept;
+  void unlink_hash(int32_t e) noexcept;
+
+  const int max_sessions_;
+  const int window_seconds_;
+  std::vector<entry_t> entries_;
+  // max_sessions_ connection times for each entry, used as a ring buffer.
+  std::vector<time_t> times_;
+  // The first entry for each hash bucket, the size is a power of 2.
+  std::vector<int32_t> buckets_;
+  int32_t lru_head_{-1};
+  int32_t lru_tail_{-1};
+  int size_{0};
 };
 
 struct auto_blocked_entry_t {
@@ -66,11 +146,13 @@ public:
   AutoBlocker(std::shared_ptr<BadIp> bip, sdk::wwivd_blocking_t b, std::filesystem::path datadir, Clock& clock);
   ~AutoBlocker();
   void escalate_block(const std::string& ip);
+  /**
+   * Records a connection from ip, returning false if ip is auto-blocked or
+   * has made auto_bl_sessions connections within auto_bl_seconds.
+   */
   bool Connection(const std::string& ip);
   bool Save();
 
-  // Used for testing
-  const std::map<std::string, std::set<time_t>>& recent_sessions() const { return sessions_; }
   // Used for testing
   const std::map<std::string, auto_blocked_entry_t>& auto_blocked() const { return auto_blocked_; }
 
@@ -78,13 +160,17 @@ public:
 
 private:
   bool Load();
+  // Saves the autoblock list if it has changed and hasn't been saved recently.
+  void MaybeSave(time_t now);
   std::shared_ptr<BadIp> bip_;
   sdk::wwivd_blocking_t b_;
   std::filesystem::path datadir_;
-  std::map<std::string, std::set<time_t>> sessions_;
+  ConnectionRateLimiter limiter_;
   std::map<std::string, auto_blocked_entry_t> auto_blocked_;
   Clock& clock_;
   std::mutex mu_;
+  bool dirty_{false};
+  time_t last_save_{0};
 };
 
 } // namespace
@@ -18,6 +18,7 @@
 
 #include "core/datetime.h"
 #include "core/log.h"
+#include "core/metrics.h"
 #include "core/os.h"
 #include "core/stl.h"
 #include "core/strings.h"
@@ -34,6 +35,7 @@
 #include "wwivd/wwivd_non_http.h"
 
 #include <atomic>
+#include <chrono>
 #include <map>
 #include <memory>
 #include <string>
@@ -55,6 +57,26 @@ std::atomic<bool> need_to_reload_config;
 
 // TODO(rushfan): Add tests for new stuff in here.
 
+// Runs the callout command cmd for the network type 'type', recording how long
+// it took and whether it succeeded.
+static bool exec_callout(const wwivd_config_t& c, NodeManager& nodes, const std::string& cmd,
+                         const std::string& type) {
+  static const std::vector<double> buckets{5, 15, 30, 60, 120, 300, 600, 1800};
+  const auto start = std::chrono::steady_clock::now();
+  const auto ok =
+      ExecCommandAndWait(c, nodes, cmd, StrCat("[", get_pid(), "]"), -1, INVALID_SOCKET);
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  metrics()
+      .histogram("wwivd_callout_duration_seconds", "Length of network callouts in seconds.",
+                 buckets, {{"type", type}})
+      .observe(elapsed.count());
+  metrics()
+      .counter("wwivd_callouts_total", "Network callouts made by wwivd.",
+               {{"type", type}, {"result", ok ? "ok" : "error"}})
+      .inc();
+  return ok;
+}
+
 static NetworkContact network_contact_from_last_time(const fido::FidoAddress& address,
                                                      const DateTime& t, int ftn_bytes_waiting) {
   network_contact_record ncr{};
@@ -100,7 +122,7 @@ static void one_net_ftn_callout(const Config& config, const Network& net, const
     const std::map<char, std::string> params = {{'N', address.as_string()},
                                            {'T', std::to_string(network_number)}};
     const auto cmd = CreateCommandLine(c.network_callout_cmd, params);
-    if (!ExecCommandAndWait(c, *nodes, cmd, StrCat("[", get_pid(), "]"), -1, INVALID_SOCKET)) {
+    if (!exec_callout(c, *nodes, cmd, "ftn")) {
       LOG(ERROR) << "Error executing command: '" << cmd << "'";
     }
   }
@@ -131,7 +153,7 @@ static void one_net_wwivnet_callout(const Network& net, const wwivd_config_t& c,
     const std::map<char, std::string> params = {{'N', std::to_string(kv.first)},
                                            {'T', std::to_string(network_number)}};
     const auto cmd = CreateCommandLine(c.network_callout_cmd, params);
-    if (!ExecCommandAndWait(c, *nodes, cmd, StrCat("[", get_pid(), "]"), -1, INVALID_SOCKET)) {
+    if (!exec_callout(c, *nodes, cmd, "wwivnet")) {
       LOG(ERROR) << "Error executing command: " << cmd;
     }
   }
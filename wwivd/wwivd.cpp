@@ -28,6 +28,7 @@
 #include "core/strings.h"
 #include "core/version.h"
 #include "sdk/config.h"
+#include "sdk/filenames.h"
 #include "wwivd/connection_data.h"
 #include "wwivd/nets.h"
 #include "wwivd/node_manager.h"
@@ -177,6 +178,8 @@ int Main(CommandLine& cmdline) {
     using namespace std::placeholders;
     svr = std::make_unique<httplib::Server>();    
     svr->Get("/status", std::bind(StatusHandler, data.nodes, _1, _2));
+    svr->Get("/metrics", std::bind(MetricsHandler, data.nodes,
+                                   FilePath(config.datadir(), METRICS_DIR), _1, _2));
     svr->set_logger(
         [](const httplib::Request& req, const httplib::Response& res) { VLOG(1) << res.body; });
     srv_thread = std::thread([&](const std::string http_address, int p) { 
@@ -30,13 +30,16 @@
 #include <cereal/types/vector.hpp>
 #include <nlohmann/json.hpp>
 
+#include "core/findfiles.h"
 #include "core/jsonfile.h"
 #include "core/log.h"
+#include "core/metrics.h"
 #include "core/net.h"
 #include "core/os.h"
 #include "core/socket_connection.h"
 #include "core/stl.h"
 #include "core/strings.h"
+#include "core/textfile.h"
 #include "httplib.h"
 #include "sdk/config.h"
 #include "wwivd/connection_data.h"
@@ -47,6 +50,7 @@
 namespace wwiv::wwivd {
 
 static const char MIME_TYPE_JSON[] = "application/json";
+static const char MIME_TYPE_PROMETHEUS[] = "text/plain; version=0.0.4";
 
 using namespace wwiv::core;
 using namespace wwiv::sdk;
@@ -201,4 +205,26 @@ void StatusHandler(std::map<const std::string, std::shared_ptr<NodeManager>>* no
   }
 }
 
+void MetricsHandler(std::map<const std::string, std::shared_ptr<NodeManager>>* nodes,
+                    const std::filesystem::path& metrics_dir, const httplib::Request&,
+                    httplib::Response& res) {
+  for (const auto& [name, nm] : *nodes) {
+    metrics()
+        .gauge("wwivd_nodes", "Nodes available to wwivd.", {{"name", name}})
+        .set(nm->total_nodes());
+    metrics()
+        .gauge("wwivd_nodes_used", "Nodes in use by a session.", {{"name", name}})
+        .set(nm->nodes_used());
+  }
+  auto text = metrics().ToPrometheusText();
+
+  // Add the metrics written by the network programs, summed over all of their runs.
+  const FindFiles ff(FilePath(metrics_dir, "*.prom"), FindFiles::FindFilesType::files);
+  for (const auto& f : ff) {
+    TextFile tf(FilePath(metrics_dir, f.name), "rb");
+    text.append(tf.ReadFileIntoString());
+  }
+  res.set_content(text, MIME_TYPE_PROMETHEUS);
+}
+
 } // namespace wwiv::wwivd
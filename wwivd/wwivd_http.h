@@ -32,6 +32,14 @@ namespace wwiv::wwivd {
 void StatusHandler(std::map<const std::string, std::shared_ptr<NodeManager>>* nodes,
                    const httplib::Request&, httplib::Response& res);
 
+/**
+ * Returns the metrics for wwivd in the Prometheus text format, followed by
+ * those written to metrics_dir by the programs wwivd runs.
+ */
+void MetricsHandler(std::map<const std::string, std::shared_ptr<NodeManager>>* nodes,
+                    const std::filesystem::path& metrics_dir, const httplib::Request&,
+                    httplib::Response& res);
+
 } // namespace wwiv::wwivd
 
 #endif
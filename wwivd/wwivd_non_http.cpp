@@ -19,6 +19,7 @@
 
 #include "core/file.h"
 #include "core/log.h"
+#include "core/metrics.h"
 #include "core/net.h"
 #include "core/os.h"
 #include "core/scope_exit.h"
@@ -56,6 +57,19 @@ using namespace wwiv::stl;
 using namespace wwiv::strings;
 using namespace wwiv::os;
 
+// Upper bounds in seconds for the session length histograms.
+static const std::vector<double> kSessionSecondsBuckets{10, 30, 60, 300, 900, 1800, 3600, 7200};
+
+static std::string metric_label(ConnectionType t) { return ToStringLowerCase(to_string(t)); }
+
+// Counts a connection denied by wwivd for reason.
+static void count_denied_connection(const std::string& reason) {
+  metrics()
+      .counter("wwivd_connections_denied_total", "Connections denied by wwivd.",
+               {{"reason", reason}})
+      .inc();
+}
+
 std::string to_string(const wwivd_matrix_entry_t& e) {
   std::ostringstream ss;
   ss << "[" << e.key << "] " << e.name << " (" << e.description << ")";
@@ -193,6 +207,12 @@ static bool telnet_to(const std::string& host_port, int /*node_number*/, SOCKET
 #if defined(WWIV_USE_PIPES)
 static bool socket_pipe_loop_one(SOCKET sock, Pipe& data_pipe, Pipe& control_pipe) {
   LOG(INFO) << "Starting socket_pipe_loop_one";
+  static auto& bytes_to_socket =
+      metrics().counter("wwivd_pipe_bytes_total", "Bytes bridged between sockets and pipes.",
+                        {{"direction", "to_socket"}});
+  static auto& bytes_from_socket =
+      metrics().counter("wwivd_pipe_bytes_total", "Bytes bridged between sockets and pipes.",
+                        {{"direction", "from_socket"}});
   if (!data_pipe.Create()) {
     LOG(ERROR) << "Failed to create pipe: " << data_pipe.name();
     return false;
@@ -247,6 +267,7 @@ static bool socket_pipe_loop_one(SOCKET sock, Pipe& data_pipe, Pipe& control_pip
           // TODO(rushfan): Care to check ENOWOULDBLOCK?
 	        return true;
         }
+        bytes_to_socket.inc(static_cast<uint64_t>(o.value()));
       } else {
 	      VLOG(1) << "ERROR: read failed after peek was true.";
       }
@@ -260,6 +281,7 @@ static bool socket_pipe_loop_one(SOCKET sock, Pipe& data_pipe, Pipe& control_pip
           LOG(ERROR) << "Failed to write to pipe";
 	        return true; // recent change
         }
+        bytes_from_socket.inc(static_cast<uint64_t>(num_read));
       } else {
         LOG(INFO) << "Remote session closed; read returned 0";
 	      return true;
@@ -306,6 +328,19 @@ static bool launch_cmd(const wwivd_config_t& wc, const std::string& raw_cmd,
 
   VLOG(2) << "raw_cmd: " << raw_cmd;
   auto at_exit = finally([=] { nodes->ReleaseNode(node_number); });
+
+  const auto type = metric_label(connection_type);
+  auto& active =
+      metrics().gauge("wwivd_sessions_active", "Sessions in progress.", {{"type", type}});
+  auto& session_seconds =
+      metrics().histogram("wwivd_session_duration_seconds", "Length of sessions in seconds.",
+                          kSessionSecondsBuckets, {{"type", type}});
+  active.inc();
+  const auto start = steady_clock::now();
+  auto at_exit_metrics = finally([&] {
+    active.dec();
+    session_seconds.observe(duration<double>(steady_clock::now() - start).count());
+  });
   if (starts_with(raw_cmd, "@telnet:")) {
     return telnet_to(raw_cmd.substr(8), node_number, sock);
   }
@@ -495,6 +530,10 @@ ConnectionHandler::BlockedConnectionResult ConnectionHandler::CheckForBlockedCon
     return BlockedConnectionResult(BlockedConnectionAction::ALLOW, "???");
   }
   const auto remote_peer = o.value();
+  metrics()
+      .counter("wwivd_connections_total", "Connections accepted by wwivd.",
+               {{"type", metric_label(connection_type_for(*data.c, r.port))}})
+      .inc();
 
   VLOG(4) << "ConnectionHandler::CheckForBlockedConnection; (3): " << sock;
   const auto& b = data.c->blocking;
@@ -512,6 +551,7 @@ ConnectionHandler::BlockedConnectionResult ConnectionHandler::CheckForBlockedCon
     if (data.bad_ips_->IsBlocked(remote_peer)) {
       // We have a connection from a blocked country
       LOG(INFO) << "Denying connection attempt from badip.txt blocked peer: " << remote_peer;
+      count_denied_connection("badip");
       return BlockedConnectionResult(BlockedConnectionAction::DENY, remote_peer);
     }
   }
@@ -532,6 +572,7 @@ ConnectionHandler::BlockedConnectionResult ConnectionHandler::CheckForBlockedCon
     if (contains(data.c->blocking.block_cc_countries, cc)) {
       // We have a connection from a blocked country
       LOG(INFO) << "Denying connection attempt from country " << cc << " for peer: " << remote_peer;
+      count_denied_connection("country");
       return BlockedConnectionResult(BlockedConnectionAction::DENY, remote_peer);
     }
   }
@@ -543,6 +584,7 @@ ConnectionHandler::BlockedConnectionResult ConnectionHandler::CheckForBlockedCon
     if (!data.auto_blocker_->Connection(remote_peer)) {
       // We have a newly blocked address.
       LOG(INFO) << "Denying connection attempt from AutoBlocker: " << remote_peer;
+      count_denied_connection("autoblock");
       return BlockedConnectionResult(BlockedConnectionAction::DENY, remote_peer);
     }
   }
@@ -565,6 +607,7 @@ void ConnectionHandler::HandleBinkPConnection() {
     }
     if (!data.concurrent_connections_->aquire(result.remote_peer)) {
       LOG(INFO) << " BINKP BUSY (Concurrent Limit Reached): " << result.remote_peer;
+      count_denied_connection("concurrent");
       SocketConnection conn(r.client_socket);
       conn.send_line("BUSY (Concurrent Limit Reached)\r\n", 10s);
       closesocket(sock);
@@ -629,6 +672,7 @@ void ConnectionHandler::HandleConnection() {
     VLOG(4) << "After block check";
     if (!data.concurrent_connections_->aquire(result.remote_peer)) {
       LOG(INFO) << " BUSY (Concurrent Limit Reached): " << result.remote_peer;
+      count_denied_connection("concurrent");
       conn.send_line("BUSY (Concurrent Limit Reached)\r\n", 10s);
       closesocket(sock);
       return;
@@ -19,6 +19,7 @@
 #include "core/clock.h"
 #include "core/fake_clock.h"
 #include "core/file.h"
+#include "core/ip_address.h"
 #include "core/strings.h"
 #include "core/textfile.h"
 #include "core/test/file_helper.h"
@@ -45,6 +46,18 @@ TEST(GoodIps, IsAlwaysAllowed) {
   EXPECT_FALSE(ip.IsAlwaysAllowed("10.0.0.2"));
 }
 
+TEST(GoodIps, IsAlwaysAllowed_Prefix) {
+  const std::vector<std::string> lines{"# comment", "", "10.0.0.0/8", "2001:db8::/32 # v6",
+                                       "bogus"};
+  GoodIp ip(lines);
+  EXPECT_TRUE(ip.IsAlwaysAllowed("10.1.2.3"));
+  EXPECT_TRUE(ip.IsAlwaysAllowed("2001:db8::1"));
+
+  EXPECT_FALSE(ip.IsAlwaysAllowed("11.0.0.1"));
+  EXPECT_FALSE(ip.IsAlwaysAllowed("2001:db9::1"));
+  EXPECT_FALSE(ip.IsAlwaysAllowed("bogus"));
+}
+
 TEST(BadIps, Smoke) {
   wwiv::core::test::FileHelper helper;
   auto fn = helper.CreateTempFile("badip.txt", "10.0.0.1\r\n8.8.8.8\r\n");
@@ -64,6 +77,56 @@ TEST(BadIps, Smoke) {
   EXPECT_FALSE(ip.IsBlocked("4.4.4.4"));
 }
 
+TEST(BadIps, Prefix) {
+  wwiv::core::test::FileHelper helper;
+  auto fn = helper.CreateTempFile("badip.txt", "10.0.0.0/24\r\n192.168.0.0/16 # lan\r\n");
+  FakeClock clock(DateTime::now());
+  BadIp ip(fn, clock);
+  EXPECT_TRUE(ip.IsBlocked("10.0.0.1"));
+  EXPECT_TRUE(ip.IsBlocked("10.0.0.255"));
+  EXPECT_TRUE(ip.IsBlocked("192.168.5.5"));
+  EXPECT_FALSE(ip.IsBlocked("10.0.1.1"));
+}
+
+TEST(ConnectionRateLimiter, SlidingWindow) {
+  ConnectionRateLimiter l(10, 3, 10);
+  const auto ip = ip_address::from_string("1.1.1.1").value();
+  EXPECT_EQ(1, l.Connection(ip, 100));
+  EXPECT_EQ(2, l.Connection(ip, 105));
+  EXPECT_EQ(3, l.Connection(ip, 110));
+  // 100 is now outside of the window.
+  EXPECT_EQ(2, l.count(ip, 111));
+  EXPECT_EQ(3, l.Connection(ip, 111));
+  EXPECT_EQ(2, l.Connection(ip, 121));
+  EXPECT_EQ(1, l.Connection(ip, 200));
+}
+
+TEST(ConnectionRateLimiter, EvictsLeastRecent) {
+  ConnectionRateLimiter l(2, 2, 10);
+  const auto ip1 = ip_address::from_string("1.1.1.1").value();
+  const auto ip2 = ip_address::from_string("2.2.2.2").value();
+  const auto ip3 = ip_address::from_string("::3").value();
+  EXPECT_EQ(1, l.Connection(ip1, 100));
+  EXPECT_EQ(1, l.Connection(ip2, 100));
+  EXPECT_EQ(2, l.Connection(ip1, 101));
+  // ip2 is the least recently seen, so it's replaced by ip3.
+  EXPECT_EQ(1, l.Connection(ip3, 102));
+  EXPECT_EQ(2, l.size());
+  EXPECT_EQ(2, l.count(ip1, 102));
+  EXPECT_EQ(0, l.count(ip2, 102));
+  EXPECT_EQ(1, l.count(ip3, 102));
+}
+
+TEST(ConnectionRateLimiter, ClampsMaxSessions) {
+  ConnectionRateLimiter l(2, 1000000, 10);
+  EXPECT_EQ(ConnectionRateLimiter::kMaxSessions, l.max_sessions());
+  const auto ip = ip_address::from_string("1.1.1.1").value();
+  for (int i = 1; i <= ConnectionRateLimiter::kMaxSessions; i++) {
+    EXPECT_EQ(i, l.Connection(ip, 100));
+  }
+  EXPECT_EQ(ConnectionRateLimiter::kMaxSessions, l.Connection(ip, 100));
+}
+
 TEST(AutoBlock, ShouldBlock) {
   wwivd_blocking_t b{};
   b.auto_blocklist = true;
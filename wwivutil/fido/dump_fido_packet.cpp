@@ -118,23 +118,16 @@ static int dump_stored_message(const std::string& filename) {
 }
 
 static int dump_packet_file(const std::string& filename) {
-  File f(filename);
-  if (!f.Open(File::modeBinary | File::modeReadOnly)) {
+  FtnPacketReader reader(filename);
+  if (!reader) {
     LOG(ERROR) << "Unable to open file: " << filename;
     return 1;
   }
 
-  auto done = false;
-  packet_header_2p_t header = {};
-  auto num_header_read = f.Read(&header, sizeof(packet_header_2p_t));
-  if (num_header_read < static_cast<int>(sizeof(packet_header_2p_t))) {
-    LOG(ERROR) << "Read less than packet header";
-    return 1;
-  }
-
-  while (!done) {
-    FidoPackedMessage msg;
-    auto response = read_packed_message(f, msg);
+  const auto& header = reader.header();
+  fido_packed_message_view_t view;
+  for (;;) {
+    const auto response = reader.Next(view);
     if (response == ReadNetPacketResponse::END_OF_FILE) {
       return 0;
     }
@@ -142,6 +135,7 @@ static int dump_packet_file(const std::string& filename) {
       return 1;
     }
 
+    const auto msg = view.to_message();
     auto from_address = get_address_from_packet(msg, header);
     auto dt = fido_to_daten(msg.vh.date_time);
     auto roundtrip_dt = daten_to_fido(dt);
@@ -177,7 +171,6 @@ static int dump_packet_file(const std::string& filename) {
     std::cout << "=============================================================================="
          << std::endl;
   }
-  return 0;
 }
 
 static int dump_file(const std::string& filename) {
@@ -28,6 +28,7 @@
 #include "sdk/names.h"
 #include "sdk/msgapi/message_api_wwiv.h"
 #include "sdk/msgapi/msgapi.h"
+#include "sdk/msgapi/sub_stats.h"
 #include "sdk/net/networks.h"
 #include "wwivutil/util.h"
 
@@ -340,6 +341,11 @@ public:
     if (!File::Rename(new_dat_fn, orig_dat_fn)) {
       std::clog << "Unable to move dat";
     }
+    // The packed sub was written under the ".new" name, so drop both
+    // entries and let the next reader reseed it from the .sub file.
+    SubStats stats(config()->config()->datadir());
+    stats.remove(basename);
+    stats.remove(newsub.filename);
 
     return 0;
   }
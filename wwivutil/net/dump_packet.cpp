@@ -39,7 +39,7 @@ using namespace wwiv::strings;
 
 namespace wwiv::wwivutil {
 
-int dump_file(const std::filesystem::path& filename) {
+int dump_file(const std::filesystem::path& filename, int start, bool headers_only) {
   NetMailFile file(filename, true);
   if (!file) {
     LOG(ERROR) << "Unable to open file: " << filename;
@@ -47,7 +47,19 @@ int dump_file(const std::filesystem::path& filename) {
   }
 
   auto current{0};
-  for (auto packet : file) {
+  if (start > 0) {
+    if (!file.SeekToPacket(start)) {
+      LOG(ERROR) << "Unable to seek to packet #" << start << "; there are only "
+                 << file.num_packets() << " packets in: " << filename;
+      return 1;
+    }
+    current = start;
+  }
+  for (;;) {
+    auto [packet, response] = headers_only ? file.ReadHeaderOnly() : file.Read();
+    if (response != ReadNetPacketResponse::OK) {
+      break;
+    }
     std::cout << "Header for Packet Index Number: #" << std::setw(5) << std::left << current++ << std::endl;
     std::cout << "=============================================================================="
          << std::endl;
@@ -76,7 +88,7 @@ int dump_file(const std::filesystem::path& filename) {
       }
       std::cout << std::endl;
     }
-    if (packet.nh.length) {
+    if (packet.nh.length && !headers_only) {
       std::cout << "=============================================================================="
            << std::endl;
       std::cout << "Raw Packet Text:" << std::endl;
@@ -95,8 +107,9 @@ int dump_file(const std::filesystem::path& filename) {
 
 std::string DumpPacketCommand::GetUsage() const {
   std::ostringstream ss;
-  ss << "Usage:   dump <filename>" << std::endl;
+  ss << "Usage:   dump [--start=N] [--headers_only] <filename>" << std::endl;
   ss << "Example: dump s1.net" << std::endl;
+  ss << "Example: dump --start=100 --headers_only dead.net" << std::endl;
   return ss.str();
 }
 
@@ -106,10 +119,12 @@ int DumpPacketCommand::Execute() {
     return 2;
   }
   const std::filesystem::path filename(remaining().front());
-  return dump_file(filename);
+  return dump_file(filename, iarg("start"), barg("headers_only"));
 }
 
 bool DumpPacketCommand::AddSubCommands() {
+  add_argument({"start", "Packet index number to start dumping from.", "0"});
+  add_argument(BooleanCommandLineArgument("headers_only", 'H', "Only dump the packet headers.", false));
   return true;
 }
 